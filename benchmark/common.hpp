@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __quadruped_walkgen_benchmark_common_hpp__
+#define __quadruped_walkgen_benchmark_common_hpp__
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Helpers shared by the benchmarks
+
+// Percentile of sorted samples, nearest rank
+inline double percentile(const std::vector<double>& sorted, const double p) {
+  const std::size_t rank = static_cast<std::size_t>(
+      std::ceil(p / 100. * static_cast<double>(sorted.size())));
+  return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+inline double mean(const std::vector<double>& samples) {
+  double sum = 0.;
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    sum += samples[i];
+  }
+  return sum / static_cast<double>(samples.size());
+}
+
+// Print the mean, the p50, p99 and p99.9 and the max of the samples
+inline void report(const std::string& name, std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  std::cout << "  " << name << ": mean " << mean(samples) << ", p50 "
+            << percentile(samples, 50.) << ", p99 " << percentile(samples, 99.)
+            << ", p99.9 " << percentile(samples, 99.9) << ", max "
+            << samples.back() << std::endl;
+}
+
+// Trotting gait, the feet 0 and 3 then 1 and 2 in contact for 8 nodes
+inline Eigen::Matrix<double, 4, 1> trot(const unsigned int k) {
+  Eigen::Matrix<double, 4, 1> S;
+  if ((k / 8) % 2 == 0) {
+    S << 1, 0, 0, 1;
+  } else {
+    S << 0, 1, 1, 0;
+  }
+  return S;
+}
+
+#endif
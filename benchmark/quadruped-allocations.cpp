@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/gain_interpolator.hpp>
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_augmented.hpp>
+#include <quadruped-walkgen/quadruped_augmented_time.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+#include <quadruped-walkgen/quadruped_step.hpp>
+#include <quadruped-walkgen/quadruped_step_period.hpp>
+#include <quadruped-walkgen/quadruped_step_time.hpp>
+#include <quadruped-walkgen/quadruped_time.hpp>
+#include <quadruped-walkgen/receding_horizon.hpp>
+#include <quadruped-walkgen/solver_quadruped_ddp.hpp>
+#include <quadruped-walkgen/solver_quadruped_qp.hpp>
+
+#include "crocoddyl/core/solvers/ddp.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Heap allocations of a steady-state control cycle : update_model, calc and
+// calcDiff of each model family and solve of the solvers, counted after a
+// first cycle with another contact status so that the buffers are already
+// sized. With glibc, malloc and free are interposed and every allocation is
+// counted (operator new and Eigen use malloc). Otherwise only the global
+// operator new is replaced, the allocations of Eigen are not seen.
+
+namespace {
+std::size_t n_allocations = 0;
+}
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(std::size_t size) __THROW {
+  ++n_allocations;
+  return __libc_malloc(size);
+}
+void* calloc(std::size_t n, std::size_t size) __THROW {
+  ++n_allocations;
+  return __libc_calloc(n, size);
+}
+void* realloc(void* ptr, std::size_t size) __THROW {
+  ++n_allocations;
+  return __libc_realloc(ptr, size);
+}
+void free(void* ptr) __THROW { __libc_free(ptr); }
+}
+#else
+void* operator new(std::size_t size) {
+  ++n_allocations;
+  void* ptr = std::malloc(size);
+  if (ptr == NULL) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+#endif
+
+// Number of allocations done by f
+template <typename F>
+std::size_t allocations(F f) {
+  const std::size_t n = n_allocations;
+  f();
+  return n_allocations - n;
+}
+
+// Allocations of update(S), calc and calcDiff, after a first cycle with the
+// contact status S0
+template <typename Model, typename Update>
+void run(const std::string& name, Model& model, Update update,
+         const Eigen::Matrix<double, 4, 1>& S0,
+         const Eigen::Matrix<double, 4, 1>& S) {
+  boost::shared_ptr<crocoddyl::ActionDataAbstract> data = model.createData();
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(model.get_state()->get_nx());
+  x(2) = 0.2;
+  Eigen::VectorXd u = Eigen::VectorXd::Constant(model.get_nu(), 0.05);
+
+  update(S0);
+  model.calc(data, x, u);
+  model.calcDiff(data, x, u);
+
+  const std::size_t n_update = allocations([&]() { update(S); });
+  const std::size_t n_calc = allocations([&]() { model.calc(data, x, u); });
+  const std::size_t n_calc_diff =
+      allocations([&]() { model.calcDiff(data, x, u); });
+  std::cout << "  " << name << " : update_model " << n_update << ", calc "
+            << n_calc << ", calcDiff " << n_calc_diff << std::endl;
+}
+
+// Allocations of the second solve, warm started by the first one
+template <typename Solver>
+void run_solver(const std::string& name, Solver& solver,
+                const unsigned int MAXITER) {
+  solver.solve(solver.get_xs(), solver.get_us(), MAXITER);
+  const std::size_t n_solve = allocations(
+      [&]() { solver.solve(solver.get_xs(), solver.get_us(), MAXITER); });
+  std::cout << "  " << name << ".solve : " << n_solve << std::endl;
+}
+
+template <typename Model>
+boost::shared_ptr<crocoddyl::ShootingProblem> create_problem(
+    const Eigen::Matrix<double, 12, 1>& x0, const unsigned int N) {
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0., 0.;
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 4, 1> S;
+
+  std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> >
+      running_models;
+  for (unsigned int k = 0; k < N; ++k) {
+    if ((2 * k) / N % 2 == 0) {
+      S << 1, 0, 0, 1;
+    } else {
+      S << 0, 1, 1, 0;
+    }
+    boost::shared_ptr<Model> model = boost::make_shared<Model>();
+    model->update_model(l_feet, xref, S);
+    running_models.push_back(model);
+  }
+  boost::shared_ptr<Model> terminal_model = boost::make_shared<Model>();
+  S.setOnes();
+  terminal_model->update_model(l_feet, xref, S);
+  terminal_model->set_force_weights(Eigen::Matrix<double, 12, 1>::Zero());
+  terminal_model->set_friction_weight(0.);
+  return boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
+                                                        terminal_model);
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int N = 16;  // number of nodes
+  unsigned int MAXITER = 3;
+  if (argc > 1) {
+    MAXITER = atoi(argv[1]);
+  }
+
+  using namespace quadruped_walkgen;
+  typedef Eigen::Matrix<double, 4, 1> Vector4;
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0., 0.;
+  Eigen::Matrix<double, 3, 4> zero34 = Eigen::Matrix<double, 3, 4>::Zero();
+  Eigen::Matrix<double, 3, 3> oRh = Eigen::Matrix<double, 3, 3>::Identity();
+  Eigen::Matrix<double, 3, 1> oTh = Eigen::Matrix<double, 3, 1>::Zero();
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0, 0.1, 0, 0, 0, 0, 0;
+  Vector4 trot_1, trot_2, step;
+  trot_1 << 1, 0, 0, 1;
+  trot_2 << 0, 1, 1, 0;
+  step << 0, 1, 1, 0;
+
+  std::cout << "Heap allocations per call in steady state" << std::endl;
+
+  ActionModelQuadruped linear;
+  run("ActionModelQuadruped", linear,
+      [&](const Vector4& S) { linear.update_model(l_feet, xref, S); }, trot_1,
+      trot_2);
+  ActionModelQuadrupedNonLinear non_linear;
+  run("ActionModelQuadrupedNonLinear", non_linear,
+      [&](const Vector4& S) { non_linear.update_model(l_feet, xref, S); },
+      trot_1, trot_2);
+  ActionModelQuadrupedAugmented augmented;
+  run("ActionModelQuadrupedAugmented", augmented,
+      [&](const Vector4& S) {
+        augmented.update_model(l_feet, l_feet, xref, S);
+      },
+      trot_1, trot_2);
+  ActionModelQuadrupedAugmentedTime augmented_time;
+  run("ActionModelQuadrupedAugmentedTime", augmented_time,
+      [&](const Vector4& S) {
+        augmented_time.update_model(l_feet, l_feet, xref, S);
+      },
+      trot_1, trot_2);
+  ActionModelQuadrupedTime time;
+  run("ActionModelQuadrupedTime", time,
+      [&](const Vector4& S) { time.update_model(l_feet, xref, S); }, trot_1,
+      trot_2);
+  ActionModelQuadrupedStep step_model;
+  run("ActionModelQuadrupedStep", step_model,
+      [&](const Vector4& S) {
+        step_model.update_model(l_feet, xref, S, zero34, zero34, zero34,
+                                zero34, oRh, oTh, 0.16);
+      },
+      trot_2, step);
+  ActionModelQuadrupedStepPeriod step_period;
+  run("ActionModelQuadrupedStepPeriod", step_period,
+      [&](const Vector4& S) { step_period.update_model(l_feet, xref, S); },
+      trot_2, step);
+  ActionModelQuadrupedStepTime step_time;
+  run("ActionModelQuadrupedStepTime", step_time,
+      [&](const Vector4& S) {
+        step_time.update_model(l_feet, zero34, zero34, xref, S);
+      },
+      trot_2, step);
+
+  Eigen::Matrix<double, 12, 1> x0;
+  x0 << 0, 0, 0.2, 0, 0, 0, 0.2, 0, 0, 0, 0, 0;
+  crocoddyl::SolverDDP ddp(create_problem<ActionModelQuadruped>(x0, N));
+  run_solver("SolverDDP, ActionModelQuadruped", ddp, MAXITER);
+  SolverQuadrupedDDP quadruped_ddp(
+      create_problem<ActionModelQuadruped>(x0, N));
+  run_solver("SolverQuadrupedDDP", quadruped_ddp, MAXITER);
+  crocoddyl::SolverDDP ddp_nl(
+      create_problem<ActionModelQuadrupedNonLinear>(x0, N));
+  run_solver("SolverDDP, ActionModelQuadrupedNonLinear", ddp_nl, MAXITER);
+
+  SolverQuadrupedQP qp(create_problem<ActionModelQuadruped>(x0, N));
+  qp.solve(MAXITER);
+  const std::size_t n_qp = allocations([&]() { qp.solve(MAXITER); });
+  std::cout << "  SolverQuadrupedQP.solve : " << n_qp << std::endl;
+
+  // MPC cycle of the receding horizon : shift, update of the models and
+  // warm started solve
+  Eigen::Matrix<double, 3, 13> fsteps;
+  fsteps << 8, 0.19, 0.15, 0.0, 0.19, -0.15, 0.0, -0.19, 0.15, 0.0, -0.19,
+      -0.15, 0.0, 8, 0.19, 0.15, 0.0, 0.19, -0.15, 0.0, -0.19, 0.15, 0.0,
+      -0.19, -0.15, 0.0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 3, 5> gait;
+  gait << 8, 1, 0, 0, 1, 8, 0, 1, 1, 0, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 12, 17> xrefs = xref.replicate<1, 17>();
+  RecedingHorizonQuadruped horizon(x0, N);
+  horizon.update(gait, fsteps, xrefs);
+  SolverQuadrupedDDP mpc(horizon.get_problem());
+  Eigen::Matrix<double, 3, 5> gait_shifted;
+  gait_shifted << 7, 1, 0, 0, 1, 8, 0, 1, 1, 0, 1, 1, 0, 0, 1;
+  mpc.solve(horizon.get_xs(), horizon.get_us(), MAXITER);
+  horizon.set_warm_start(mpc.get_xs(), mpc.get_us());
+  const std::size_t n_cycle = allocations([&]() {
+    horizon.shift();
+    horizon.update(gait_shifted, fsteps, xrefs);
+    mpc.solve(horizon.get_xs(), horizon.get_us(), MAXITER);
+    horizon.set_warm_start(mpc.get_xs(), mpc.get_us());
+  });
+  std::cout << "  RecedingHorizonQuadruped cycle : " << n_cycle << std::endl;
+
+  // Low-level loop between two solves
+  GainInterpolator interpolator(N);
+  const std::size_t n_interpolator = allocations([&]() {
+    interpolator.set_solution(mpc.get_xs(), mpc.get_us(), mpc.get_K());
+    for (int i = 0; i < 20; ++i) {
+      interpolator.compute(x0, 0.001 * i);
+    }
+  });
+  std::cout << "  GainInterpolator set_solution and 20 compute : "
+            << n_interpolator << std::endl;
+}
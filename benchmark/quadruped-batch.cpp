@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/batch_scalar.hpp>
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+
+#include "crocoddyl/core/utils/timer.hpp"
+
+// Throughput of the rollout (calc and calcDiff of each node of the horizon)
+// of independent problems on one core, one problem per evaluation with the
+// plain scalars and one problem per lane with the batch scalars. Problem p
+// starts from a different state and its trotting gait is shifted by p nodes.
+
+template <typename Scalar>
+struct Lanes {
+  enum { Size = 1 };
+  static Scalar set(const Eigen::ArrayXd& values) {
+    return Scalar(values(0));
+  }
+};
+
+template <typename T, int N>
+struct Lanes<quadruped_walkgen::BatchScalar<T, N> > {
+  enum { Size = N };
+  static quadruped_walkgen::BatchScalar<T, N> set(
+      const Eigen::ArrayXd& values) {
+    return quadruped_walkgen::BatchScalar<T, N>(
+        values.head(N).template cast<T>());
+  }
+};
+
+template <template <typename> class Model, typename Scalar>
+void run(const std::string& name, const unsigned int N, const unsigned int T) {
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixXs;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorXs;
+  const int L = Lanes<Scalar>::Size;
+
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0., 0.;
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+
+  // Values of the L problems, broadcast to the lanes
+  MatrixXs l_feet_s(3, 4), xref_s(12, 1), S_s(4, 1);
+  VectorXs x0(12), u0(12);
+  for (int i = 0; i < 12; ++i) {
+    l_feet_s(i % 3, i / 3) = Scalar(l_feet(i % 3, i / 3));
+    xref_s(i, 0) = Scalar(xref(i));
+    u0(i) = Scalar(i % 3 == 2 ? 2.5 : 0.);
+  }
+  Eigen::ArrayXd values(L);
+  for (int i = 0; i < 12; ++i) {
+    for (int p = 0; p < L; ++p) {
+      values(p) = xref(i) + (i == 6 ? 0.05 * (p + 1) : 0.);
+    }
+    x0(i) = Lanes<Scalar>::set(values);
+  }
+
+  std::vector<boost::shared_ptr<Model<Scalar> > > models;
+  std::vector<boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> > >
+      datas;
+  for (unsigned int k = 0; k < N; ++k) {
+    for (int i = 0; i < 4; ++i) {
+      for (int p = 0; p < L; ++p) {
+        const unsigned int phase = ((k + p) % N) / (N / 2);
+        values(p) = (i == 0 || i == 3) == (phase == 0) ? 1. : 0.;
+      }
+      S_s(i, 0) = Lanes<Scalar>::set(values);
+    }
+    models.push_back(boost::make_shared<Model<Scalar> >());
+    models.back()->update_model(l_feet_s, xref_s, S_s);
+    datas.push_back(models.back()->createData());
+  }
+
+  Eigen::ArrayXd duration(T);
+  VectorXs x(12);
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    x = x0;
+    for (unsigned int k = 0; k < N; ++k) {
+      models[k]->calc(datas[k], x, u0);
+      models[k]->calcDiff(datas[k], x, u0);
+      x = datas[k]->xnext;
+    }
+    duration[i] = timer.get_duration();
+  }
+
+  const double avrg_duration = duration.sum() / T;
+  std::cout << "  " << name << ", " << L << " problem(s) per rollout [ms]: "
+            << avrg_duration << " (" << duration.minCoeff() << "-"
+            << duration.maxCoeff() << "), " << L / avrg_duration * 1e3
+            << " rollouts/s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int N = 16;    // number of nodes
+  unsigned int T = 1000;  // number of trials
+  if (argc > 1) {
+    T = atoi(argv[1]);
+  }
+
+  using quadruped_walkgen::ActionModelQuadrupedNonLinearTpl;
+  using quadruped_walkgen::ActionModelQuadrupedTpl;
+  using quadruped_walkgen::BatchScalar;
+
+  std::cout << "ActionModelQuadruped" << std::endl;
+  run<ActionModelQuadrupedTpl, double>("double", N, T);
+  run<ActionModelQuadrupedTpl, BatchScalar<double, 4> >("double x4", N, T);
+  run<ActionModelQuadrupedTpl, float>("float", N, T);
+  run<ActionModelQuadrupedTpl, BatchScalar<float, 8> >("float x8", N, T);
+
+  std::cout << "ActionModelQuadrupedNonLinear" << std::endl;
+  run<ActionModelQuadrupedNonLinearTpl, double>("double", N, T);
+  run<ActionModelQuadrupedNonLinearTpl, BatchScalar<double, 4> >("double x4",
+                                                                  N, T);
+  run<ActionModelQuadrupedNonLinearTpl, float>("float", N, T);
+  run<ActionModelQuadrupedNonLinearTpl, BatchScalar<float, 8> >("float x8", N,
+                                                                 T);
+}
@@ -0,0 +1,247 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped_nl.hpp>
+#include <quadruped-walkgen/receding_horizon.hpp>
+#include <quadruped-walkgen/solver_quadruped_ddp.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+#include "common.hpp"
+
+// Closed loop of the MPC as it runs on the robot : every period, the state of
+// the plant is read, the receding horizon of ActionModelQuadruped is shifted
+// and updated, SolverQuadrupedDDP is warm started and the first control is
+// applied to the plant, ActionModelQuadrupedNonLinear integrated over one
+// node. The robot trots in place, each foot landing under its shoulder, and
+// is pushed regularly.
+//
+//   quadruped-closed-loop [--cycles 3000] [--period 20] [--maxiter 1]
+//                         [--fifo 80] [--push 50]
+//
+// The cycles are released at absolute deadlines every --period ms (0 runs
+// them back to back, without sleeping), the simulated time advances by one
+// node per cycle whatever the period. With --fifo the process runs under
+// SCHED_FIFO with this priority and its memory is locked with mlockall
+// (Linux, needs the privileges). A push adds 0.3 m/s to the lateral velocity
+// every --push cycles. The worst cases are reported : latency of the
+// controller, wake-up jitter, deadline misses (controller done after the
+// release of the next cycle) and tracking error of the height, attitude and
+// velocity of the base (the horizontal position is not a reference, the MPC
+// works in the frame of the base).
+
+typedef std::chrono::steady_clock Clock;
+
+// Move the gait matrix forward by one node, the phases of the periodic gait
+// are moved to the end of the matrix when they are over
+void roll_gait(Eigen::Matrix<double, 6, 5>& gait) {
+  const Eigen::Matrix<double, 1, 5> first_gait = gait.row(0);
+  gait(0, 0) -= 1;
+  if (gait(0, 0) == 0) {
+    for (int j = 0; j < 5; j++) {
+      gait.row(j) = gait.row(j + 1);
+    }
+    gait.row(5).setZero();
+  }
+
+  int last = int(gait.block(0, 0, 6, 1).array().min(1.).matrix().sum()) - 1;
+  if (last >= 0 && gait.block(last, 1, 1, 4) == first_gait.segment(1, 4)) {
+    gait(last, 0) += 1;
+  } else {
+    gait.row(last + 1) << 1, first_gait.segment(1, 4);
+  }
+}
+
+// Footsteps matrix of the gait in the horizontal frame of the base : the feet
+// in contact during the first phase are at their position, the next
+// footholds are under the shoulders
+const Eigen::Matrix<double, 6, 13>& plan_footsteps(
+    const Eigen::Matrix<double, 6, 5>& gait,
+    const Eigen::Matrix<double, 3, 4>& feet,
+    const Eigen::Matrix<double, 3, 4>& shoulders, const Eigen::VectorXd& x,
+    Eigen::Matrix<double, 6, 13>& fsteps) {
+  fsteps.setZero();
+  for (int j = 0; j < 6 && gait(j, 0) > 0; ++j) {
+    fsteps(j, 0) = gait(j, 0);
+    for (int i = 0; i < 4; ++i) {
+      if (j == 0 && gait(0, 1 + i) == 1.) {
+        fsteps(j, 1 + 3 * i) = feet(0, i) - x(0);
+        fsteps(j, 2 + 3 * i) = feet(1, i) - x(1);
+      } else {
+        fsteps(j, 1 + 3 * i) = shoulders(0, i);
+        fsteps(j, 2 + 3 * i) = shoulders(1, i);
+      }
+    }
+  }
+  return fsteps;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int cycles = 3000;
+  double period = 20.;  // [ms]
+  unsigned int MAXITER = 1;
+  int fifo = 0;
+  unsigned int push = 50;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "--cycles") {
+      cycles = atoi(argv[i + 1]);
+    } else if (arg == "--period") {
+      period = atof(argv[i + 1]);
+    } else if (arg == "--maxiter") {
+      MAXITER = atoi(argv[i + 1]);
+    } else if (arg == "--fifo") {
+      fifo = atoi(argv[i + 1]);
+    } else if (arg == "--push") {
+      push = atoi(argv[i + 1]);
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 2;
+    }
+  }
+  if (cycles == 0) {
+    std::cerr << "--cycles should be positive" << std::endl;
+    return 2;
+  }
+
+  if (fifo > 0) {
+#ifdef __linux__
+    sched_param param;
+    param.sched_priority = fifo;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+      std::cerr << "cannot run under SCHED_FIFO, priority " << fifo
+                << std::endl;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      std::cerr << "cannot lock the memory" << std::endl;
+    }
+#else
+    std::cerr << "SCHED_FIFO is only supported on Linux" << std::endl;
+#endif
+  }
+
+  // Trot of 16 nodes in place
+  const unsigned int N = 16;
+  Eigen::Matrix<double, 3, 4> shoulders;
+  shoulders << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0.,
+      0.;
+  Eigen::Matrix<double, 12, 1> x_ref;
+  x_ref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 6, 5> gait = Eigen::Matrix<double, 6, 5>::Zero();
+  gait.row(0) << 8, 1, 0, 0, 1;
+  gait.row(1) << 8, 0, 1, 1, 0;
+
+  // Plant, integrated over one node with the first control of the MPC. The
+  // feet land under the shoulders and stay there until their next flight.
+  quadruped_walkgen::ActionModelQuadrupedNonLinear plant;
+  boost::shared_ptr<crocoddyl::ActionDataAbstract> plant_data =
+      plant.createData();
+  Eigen::VectorXd x = x_ref;
+  Eigen::Matrix<double, 3, 4> feet = shoulders;
+  Eigen::Matrix<double, 4, 1> contact = gait.block<1, 4>(0, 1).transpose();
+
+  // As on the robot, the MPC works in the horizontal frame of the base : the
+  // measured position is 0, the feet in contact are where they landed and
+  // the next footholds are under the shoulders
+  Eigen::Matrix<double, 6, 13> fsteps;
+  Eigen::Matrix<double, 12, N + 1> xref = x_ref.replicate<1, N + 1>();
+  quadruped_walkgen::RecedingHorizonQuadruped horizon(x_ref, N);
+  horizon.update(gait, plan_footsteps(gait, feet, shoulders, x, fsteps), xref);
+  quadruped_walkgen::SolverQuadrupedDDP mpc(horizon.get_problem());
+  mpc.solve(horizon.get_xs(), horizon.get_us(), MAXITER);
+  horizon.set_warm_start(mpc.get_xs(), mpc.get_us());
+
+  std::vector<double> latency(cycles), jitter(cycles);
+  std::vector<double> height_error(cycles), attitude_error(cycles);
+  std::vector<double> velocity_error(cycles);
+  unsigned int misses = 0;
+  const Clock::duration T = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double, std::milli>(period));
+  Clock::time_point release = Clock::now();
+  for (unsigned int i = 0; i < cycles; ++i) {
+    if (period > 0.) {
+      release += T;
+#ifdef __linux__
+      // steady_clock is CLOCK_MONOTONIC on Linux
+      const std::chrono::nanoseconds ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              release.time_since_epoch());
+      timespec ts;
+      ts.tv_sec = static_cast<time_t>(ns.count() / 1000000000);
+      ts.tv_nsec = static_cast<long>(ns.count() % 1000000000);
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+             EINTR) {
+      }
+#else
+      std::this_thread::sleep_until(release);
+#endif
+    } else {
+      release = Clock::now();
+    }
+    const Clock::time_point start = Clock::now();
+
+    // Controller : the gait moves by one node, the feet that land are put
+    // under their shoulder and the first column of xref is the measured state
+    roll_gait(gait);
+    for (int j = 0; j < 4; ++j) {
+      if (gait(0, 1 + j) == 1. && contact(j) == 0.) {
+        feet.block<2, 1>(0, j) = x.head<2>() + shoulders.block<2, 1>(0, j);
+      }
+    }
+    contact = gait.block<1, 4>(0, 1).transpose();
+    xref.col(0) = x;
+    xref.block<2, 1>(0, 0).setZero();
+    horizon.shift();
+    horizon.set_x0(xref.col(0));
+    horizon.update(gait, plan_footsteps(gait, feet, shoulders, x, fsteps),
+                   xref);
+    mpc.solve(horizon.get_xs(), horizon.get_us(), MAXITER);
+    horizon.set_warm_start(mpc.get_xs(), mpc.get_us());
+
+    const Clock::time_point end = Clock::now();
+    latency[i] = std::chrono::duration<double, std::milli>(end - start).count();
+    jitter[i] =
+        std::chrono::duration<double, std::milli>(start - release).count();
+    if (period > 0. && end > release + T) {
+      ++misses;
+    }
+
+    // Plant, with the contact status of the first node
+    plant.update_model(feet, x_ref, contact);
+    plant.calc(plant_data, x, mpc.get_us()[0]);
+    x = plant_data->xnext;
+    if (push > 0 && (i + 1) % push == 0) {
+      x(7) += 0.3;
+    }
+    height_error[i] = std::abs(x(2) - x_ref(2));
+    attitude_error[i] = (x.segment<3>(3) - x_ref.segment<3>(3)).norm();
+    velocity_error[i] = (x.segment<3>(6) - x_ref.segment<3>(6)).norm();
+  }
+
+  std::cout << cycles << " cycles of " << period << " ms, " << MAXITER
+            << " iteration(s) of the solver" << std::endl;
+  report("controller latency [ms]", latency);
+  if (period > 0.) {
+    report("wake-up jitter [ms]", jitter);
+    std::cout << "  deadline misses: " << misses << " ("
+              << 100. * misses / cycles << " %)" << std::endl;
+  }
+  report("height error [m]", height_error);
+  report("attitude error [rad]", attitude_error);
+  report("velocity error [m/s]", velocity_error);
+}
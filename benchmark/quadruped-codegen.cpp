@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped_codegen.hpp>
+
+#include "crocoddyl/core/utils/timer.hpp"
+
+// Largest difference between the derivatives written by hand in data and the
+// generated ones in data_cg
+double maxError(
+    const boost::shared_ptr<crocoddyl::ActionDataAbstract>& data,
+    const boost::shared_ptr<crocoddyl::ActionDataAbstract>& data_cg) {
+  double error = std::abs(data->cost - data_cg->cost);
+  error = std::max(error, (data->xnext - data_cg->xnext).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Fx - data_cg->Fx).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Fu - data_cg->Fu).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Lx - data_cg->Lx).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Lu - data_cg->Lu).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Lxx - data_cg->Lxx).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Lxu - data_cg->Lxu).cwiseAbs().maxCoeff());
+  error = std::max(error, (data->Luu - data_cg->Luu).cwiseAbs().maxCoeff());
+  return error;
+}
+
+// Time calc + calcDiff of model on T random points
+Eigen::ArrayXd timeCalcDiff(
+    const boost::shared_ptr<crocoddyl::ActionModelAbstract>& model,
+    const boost::shared_ptr<crocoddyl::ActionDataAbstract>& data,
+    const std::vector<Eigen::VectorXd>& xs,
+    const std::vector<Eigen::VectorXd>& us) {
+  Eigen::ArrayXd duration(xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    crocoddyl::Timer timer;
+    model->calc(data, xs[i], us[i]);
+    model->calcDiff(data, xs[i], us[i]);
+    duration[i] = timer.get_duration();
+  }
+  return duration;
+}
+
+void printDuration(const std::string& name, const Eigen::ArrayXd& duration) {
+  std::cout << "  " << name << ".calc + calcDiff [us]: "
+            << 1e3 * duration.mean() << " (" << 1e3 * duration.minCoeff()
+            << "-" << 1e3 * duration.maxCoeff() << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int T = 20000;  // number of trials
+  if (argc > 1) {
+    T = atoi(argv[1]);
+  }
+
+  // Parameters of the node : feet positions, reference state and contacts
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0.0, 0.0, 0.0,
+      0.0;
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0.1, 0.2, 0, 0, 0, 0, 0.1;
+  Eigen::Matrix<double, 4, 1> S;
+  S << 1, 0, 0, 1;
+
+  // Random states and forces around the reference, the shoulder and friction
+  // costs are active on a part of them
+  std::vector<Eigen::VectorXd> xs, us, xs_aug;
+  for (unsigned int i = 0; i < T; ++i) {
+    xs.push_back(xref + 0.1 * Eigen::VectorXd::Random(12));
+    us.push_back(Eigen::VectorXd::Random(12) + 3 * Eigen::VectorXd::Ones(12));
+    Eigen::VectorXd x_aug(20);
+    x_aug.head(12) = xs.back();
+    for (int j = 0; j < 4; j = j + 1) {
+      x_aug.segment(12 + 2 * j, 2) =
+          l_feet.block(0, j, 2, 1) + 0.05 * Eigen::Vector2d::Random();
+    }
+    xs_aug.push_back(x_aug);
+  }
+
+  std::cout << "Non-linear model, " << T << " trials" << std::endl;
+  {
+    boost::shared_ptr<quadruped_walkgen::ActionModelQuadrupedNonLinear> model =
+        boost::make_shared<quadruped_walkgen::ActionModelQuadrupedNonLinear>();
+    model->update_model(l_feet, xref, S);
+    crocoddyl::Timer timer;
+    boost::shared_ptr<quadruped_walkgen::ActionModelQuadrupedNonLinearCodeGen>
+        model_cg = boost::make_shared<
+            quadruped_walkgen::ActionModelQuadrupedNonLinearCodeGen>(
+            model, "quadruped_nl_cg");
+    std::cout << "  Code generation and compilation [ms]: "
+              << timer.get_duration() << std::endl;
+
+    boost::shared_ptr<crocoddyl::ActionDataAbstract> data =
+        model->createData();
+    boost::shared_ptr<crocoddyl::ActionDataAbstract> data_cg =
+        model_cg->createData();
+    model_cg->update_model(data_cg, l_feet, xref, S);
+
+    double error = 0.;
+    for (unsigned int i = 0; i < T; ++i) {
+      model->calc(data, xs[i], us[i]);
+      model->calcDiff(data, xs[i], us[i]);
+      model_cg->calc(data_cg, xs[i], us[i]);
+      model_cg->calcDiff(data_cg, xs[i], us[i]);
+      error = std::max(error, maxError(data, data_cg));
+    }
+    std::cout << "  Max difference of the derivatives: " << error << std::endl;
+    printDuration("ActionModelQuadrupedNonLinear",
+                  timeCalcDiff(model, data, xs, us));
+    printDuration("ActionModelQuadrupedNonLinearCodeGen",
+                  timeCalcDiff(model_cg, data_cg, xs, us));
+  }
+
+  std::cout << "Augmented model, " << T << " trials" << std::endl;
+  {
+    boost::shared_ptr<quadruped_walkgen::ActionModelQuadrupedAugmented> model =
+        boost::make_shared<quadruped_walkgen::ActionModelQuadrupedAugmented>();
+    model->update_model(l_feet, l_feet, xref, S);
+    crocoddyl::Timer timer;
+    boost::shared_ptr<quadruped_walkgen::ActionModelQuadrupedAugmentedCodeGen>
+        model_cg = boost::make_shared<
+            quadruped_walkgen::ActionModelQuadrupedAugmentedCodeGen>(
+            model, "quadruped_augmented_cg");
+    std::cout << "  Code generation and compilation [ms]: "
+              << timer.get_duration() << std::endl;
+
+    boost::shared_ptr<crocoddyl::ActionDataAbstract> data =
+        model->createData();
+    boost::shared_ptr<crocoddyl::ActionDataAbstract> data_cg =
+        model_cg->createData();
+    model_cg->update_model(data_cg, l_feet, l_feet, xref, S);
+
+    double error = 0.;
+    for (unsigned int i = 0; i < T; ++i) {
+      model->calc(data, xs_aug[i], us[i]);
+      model->calcDiff(data, xs_aug[i], us[i]);
+      model_cg->calc(data_cg, xs_aug[i], us[i]);
+      model_cg->calcDiff(data_cg, xs_aug[i], us[i]);
+      error = std::max(error, maxError(data, data_cg));
+    }
+    std::cout << "  Max difference of the derivatives: " << error << std::endl;
+    printDuration("ActionModelQuadrupedAugmented",
+                  timeCalcDiff(model, data, xs_aug, us));
+    printDuration("ActionModelQuadrupedAugmentedCodeGen",
+                  timeCalcDiff(model_cg, data_cg, xs_aug, us));
+  }
+
+  return 0;
+}
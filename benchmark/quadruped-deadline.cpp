@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+#include <quadruped-walkgen/solver_deadline.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "common.hpp"
+
+// Cost reached by the deadline-driven solver against its budget, for the
+// linear model (SolverDeadlineQuadrupedDDP) and the non-linear model
+// (SolverDeadlineDDP) :
+//
+//   quadruped-deadline [--nodes 16] [--trials 200]
+//                      [--budgets 0.05,0.1,0.2,0.5,1,2,5]
+//
+// Each solve starts from the same perturbed state without warm start, so
+// that several iterations are needed. For each budget [ms] are reported :
+// the mean number of iterations, the mean gap between the cost and the cost
+// of the converged solution, the p99 and max duration of the solve and the
+// number of solves that ended after the budget.
+
+// Problem of N nodes of Model, the feet under the shoulders
+template <typename Model>
+boost::shared_ptr<crocoddyl::ShootingProblem> make_problem(
+    const unsigned int N, const Eigen::Matrix<double, 12, 1>& x0) {
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0., 0.;
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+
+  std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> >
+      running_models;
+  for (unsigned int k = 0; k < N; ++k) {
+    boost::shared_ptr<Model> model = boost::make_shared<Model>();
+    model->update_model(l_feet, xref, trot(k));
+    running_models.push_back(model);
+  }
+  boost::shared_ptr<Model> terminal_model = boost::make_shared<Model>();
+  terminal_model->update_model(l_feet, xref, trot(N - 1));
+  terminal_model->set_force_weights(Eigen::Matrix<double, 12, 1>::Zero());
+  terminal_model->set_friction_weight(0);
+  return boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
+                                                        terminal_model);
+}
+
+template <typename Solver>
+void run(const std::string& name,
+         boost::shared_ptr<crocoddyl::ShootingProblem> problem,
+         const std::vector<double>& budgets, const unsigned int trials) {
+  const std::size_t N = problem->get_T();
+  const Eigen::VectorXd x0 = problem->get_x0();
+  std::vector<Eigen::VectorXd> xs(N + 1, x0);
+  Eigen::Matrix<double, 12, 1> u0;
+  u0 << 0, 0, 6, 0, 0, 6, 0, 0, 6, 0, 0, 6;
+  std::vector<Eigen::VectorXd> us(N, u0);
+
+  Solver solver(problem);
+  solver.solve(xs, us, 100);
+  const double reference = solver.get_cost();
+  std::cout << name << ", " << N << " nodes, converged cost " << reference
+            << " in " << solver.get_iter() + 1 << " iterations ("
+            << solver.get_elapsed() << " ms)" << std::endl;
+  std::cout << "  budget [ms]  iterations  cost gap [%]  p99 [ms]  max [ms]"
+               "  overruns"
+            << std::endl;
+
+  std::vector<double> elapsed(trials);
+  for (std::size_t b = 0; b < budgets.size(); ++b) {
+    solver.set_budget(budgets[b]);
+    double iterations = 0., gap = 0.;
+    unsigned int overruns = 0;
+    for (unsigned int i = 0; i < trials; ++i) {
+      solver.solve(xs, us, 100);
+      iterations += static_cast<double>(solver.get_best_iter());
+      gap += 100. * (solver.get_cost() - reference) / std::abs(reference);
+      elapsed[i] = solver.get_elapsed();
+      if (elapsed[i] > budgets[b]) {
+        ++overruns;
+      }
+    }
+    std::sort(elapsed.begin(), elapsed.end());
+    std::cout << "  " << budgets[b] << "  " << iterations / trials << "  "
+              << gap / trials << "  " << percentile(elapsed, 99.) << "  "
+              << elapsed.back() << "  " << overruns << std::endl;
+  }
+}
+
+std::vector<double> parse_list(const std::string& list) {
+  std::vector<double> values;
+  std::istringstream is(list);
+  std::string value;
+  while (std::getline(is, value, ',')) {
+    values.push_back(atof(value.c_str()));
+  }
+  return values;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int N = 16;
+  unsigned int trials = 200;
+  std::vector<double> budgets = parse_list("0.05,0.1,0.2,0.5,1,2,5");
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "--nodes") {
+      N = atoi(argv[i + 1]);
+    } else if (arg == "--trials") {
+      trials = atoi(argv[i + 1]);
+    } else if (arg == "--budgets") {
+      budgets = parse_list(argv[i + 1]);
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 2;
+    }
+  }
+  if (N == 0 || trials == 0 || budgets.empty() ||
+      *std::min_element(budgets.begin(), budgets.end()) <= 0.) {
+    std::cerr << "--nodes, --trials and --budgets should be positive"
+              << std::endl;
+    return 2;
+  }
+
+  // Perturbation of the velocity and of the attitude
+  Eigen::Matrix<double, 12, 1> x0;
+  x0 << 0, 0, 0.25, 0.15, 0.1, 0, 0.2, 0, 0, 0, 0, 0;
+
+  run<quadruped_walkgen::SolverDeadlineQuadrupedDDP>(
+      "ActionModelQuadruped",
+      make_problem<quadruped_walkgen::ActionModelQuadruped>(N, x0), budgets,
+      trials);
+  run<quadruped_walkgen::SolverDeadlineDDP>(
+      "ActionModelQuadrupedNonLinear",
+      make_problem<quadruped_walkgen::ActionModelQuadrupedNonLinear>(N, x0),
+      budgets, trials);
+}
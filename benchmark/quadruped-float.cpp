@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "crocoddyl/core/utils/timer.hpp"
+
+// Solve latency and accuracy of the float instantiation of the models, against
+// the double one. crocoddyl::SolverDDP is only available in double precision,
+// the problem is solved by the Gauss-Newton iterations below (Riccati backward
+// pass, full step rollout of the model) written for both scalars.
+
+template <typename Scalar>
+struct Horizon {
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorXs;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixXs;
+  typedef crocoddyl::ActionModelAbstractTpl<Scalar> ActionModelAbstract;
+  typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
+  typedef crocoddyl::ShootingProblemTpl<Scalar> ShootingProblem;
+
+  // Trotting gait of N nodes, 4 contacts on the first node of each half period
+  template <template <typename> class Model>
+  static boost::shared_ptr<ShootingProblem> create(
+      const Eigen::Matrix<double, 12, 1>& x0, const unsigned int N) {
+    Eigen::Matrix<double, 3, 4> l_feet;
+    l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0.,
+        0.;
+    Eigen::Matrix<double, 12, 1> xref;
+    xref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+
+    std::vector<boost::shared_ptr<ActionModelAbstract> > running_models;
+    boost::shared_ptr<Model<Scalar> > model;
+    for (unsigned int k = 0; k <= N; ++k) {
+      Eigen::Matrix<double, 4, 1> S = Eigen::Matrix<double, 4, 1>::Ones();
+      if (k % (N / 2) != 0) {
+        if ((2 * k) / N % 2 == 0) {
+          S << 1, 0, 0, 1;
+        } else {
+          S << 0, 1, 1, 0;
+        }
+      }
+      model = boost::make_shared<Model<Scalar> >();
+      model->update_model(l_feet.cast<Scalar>(), xref.cast<Scalar>(),
+                          S.cast<Scalar>());
+      if (k < N) {
+        running_models.push_back(model);
+      }
+    }
+    model->set_force_weights(Eigen::Matrix<Scalar, 12, 1>::Zero());
+    model->set_friction_weight(Scalar(0.));
+    return boost::make_shared<ShootingProblem>(x0.cast<Scalar>(),
+                                               running_models, model);
+  }
+
+  // Returns the cost after maxiter Gauss-Newton iterations from (xs, us)
+  static Scalar solve(ShootingProblem& problem, std::vector<VectorXs>& xs,
+                      std::vector<VectorXs>& us, const unsigned int maxiter) {
+    const std::size_t T = problem.get_T();
+    const std::vector<boost::shared_ptr<ActionModelAbstract> >& models =
+        problem.get_runningModels();
+    const std::vector<boost::shared_ptr<ActionDataAbstract> >& datas =
+        problem.get_runningDatas();
+    std::vector<MatrixXs> K(T);
+    std::vector<VectorXs> k(T);
+    Eigen::LLT<MatrixXs> Quu_llt(12);
+    MatrixXs Vxx, Qxx, Qux, Quu, FxTVxx;
+    VectorXs Vx, Qx, Qu, dx;
+
+    for (unsigned int iter = 0; iter < maxiter; ++iter) {
+      problem.calc(xs, us);
+      problem.calcDiff(xs, us);
+
+      // Backward pass
+      Vxx = problem.get_terminalData()->Lxx;
+      Vx = problem.get_terminalData()->Lx;
+      for (std::size_t t = T; t-- > 0;) {
+        const ActionDataAbstract& d = *datas[t];
+        FxTVxx.noalias() = d.Fx.transpose() * Vxx;
+        Qx = d.Lx + d.Fx.transpose() * Vx;
+        Qu = d.Lu + d.Fu.transpose() * Vx;
+        Qxx = d.Lxx + FxTVxx * d.Fx;
+        Qux = d.Lxu.transpose() + d.Fu.transpose() * FxTVxx.transpose();
+        Quu = d.Luu + d.Fu.transpose() * Vxx * d.Fu;
+        Quu.diagonal().array() += Scalar(1e-6);
+        Quu_llt.compute(Quu);
+        K[t] = -Quu_llt.solve(Qux);
+        k[t] = -Quu_llt.solve(Qu);
+        Vx = Qx + Qux.transpose() * k[t];
+        Vxx = Qxx + Qux.transpose() * K[t];
+        Vxx = Scalar(0.5) * (Vxx + Vxx.transpose()).eval();
+      }
+
+      // Forward pass, full step
+      VectorXs x = problem.get_x0();
+      for (std::size_t t = 0; t < T; ++t) {
+        dx = x - xs[t];
+        us[t] += k[t] + K[t] * dx;
+        xs[t] = x;
+        models[t]->calc(datas[t], xs[t], us[t]);
+        x = datas[t]->xnext;
+      }
+      xs[T] = x;
+    }
+    return problem.calc(xs, us);
+  }
+};
+
+template <template <typename> class Model>
+void run(const std::string& name, const unsigned int N, const unsigned int T,
+         const unsigned int MAXITER) {
+  Eigen::Matrix<double, 12, 1> x0;
+  x0 << 0, 0, 0.2, 0, 0, 0, 0.2, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 12, 1> u0;
+  u0 << 0, 0, 2.5, 0, 0, 2.5, 0, 0, 2.5, 0, 0, 2.5;
+
+  boost::shared_ptr<crocoddyl::ShootingProblemTpl<double> > problem =
+      Horizon<double>::create<Model>(x0, N);
+  boost::shared_ptr<crocoddyl::ShootingProblemTpl<float> > problem_f =
+      Horizon<float>::create<Model>(x0, N);
+
+  std::vector<Eigen::VectorXd> xs, us;
+  std::vector<Eigen::VectorXf> xs_f, us_f;
+  Eigen::ArrayXd duration(T), duration_f(T);
+  double cost = 0.;
+  float cost_f = 0.f;
+  for (unsigned int i = 0; i < T; ++i) {
+    xs.assign(N + 1, x0);
+    us.assign(N, u0);
+    crocoddyl::Timer timer;
+    cost = Horizon<double>::solve(*problem, xs, us, MAXITER);
+    duration[i] = timer.get_duration();
+
+    xs_f.assign(N + 1, x0.cast<float>());
+    us_f.assign(N, u0.cast<float>());
+    timer.reset();
+    cost_f = Horizon<float>::solve(*problem_f, xs_f, us_f, MAXITER);
+    duration_f[i] = timer.get_duration();
+  }
+
+  std::cout << name << std::endl;
+  std::cout << "  solve, double [ms]: " << duration.sum() / T << " ("
+            << duration.minCoeff() << "-" << duration.maxCoeff() << ")"
+            << std::endl;
+  std::cout << "  solve, float [ms]: " << duration_f.sum() / T << " ("
+            << duration_f.minCoeff() << "-" << duration_f.maxCoeff() << ")"
+            << std::endl;
+
+  // Accuracy of the float solution
+  double err_x = 0., err_u = 0., norm_u = 0.;
+  for (unsigned int k = 0; k < N; ++k) {
+    err_x = std::max(err_x, (xs_f[k].cast<double>() - xs[k]).lpNorm<1>());
+    err_u = std::max(err_u, (us_f[k].cast<double>() - us[k]).lpNorm<1>());
+    norm_u = std::max(norm_u, us[k].lpNorm<1>());
+  }
+  std::cout << "  float vs double : cost " << cost_f << " / " << cost
+            << ", max |dx| " << err_x << ", max |du| / max |u| "
+            << err_u / norm_u << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int N = 16;    // number of nodes
+  unsigned int T = 1000;  // number of trials
+  unsigned int MAXITER = 3;
+  if (argc > 1) {
+    T = atoi(argv[1]);
+    MAXITER = atoi(argv[2]);
+  }
+
+  run<quadruped_walkgen::ActionModelQuadrupedTpl>("ActionModelQuadruped", N, T,
+                                                  MAXITER);
+  run<quadruped_walkgen::ActionModelQuadrupedNonLinearTpl>(
+      "ActionModelQuadrupedNonLinear", N, T, MAXITER);
+}
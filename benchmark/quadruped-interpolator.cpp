@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/gain_interpolator.hpp>
+#include <quadruped-walkgen/receding_horizon.hpp>
+#include <quadruped-walkgen/solver_quadruped_ddp.hpp>
+
+#include <chrono>
+#include <iostream>
+
+#include "common.hpp"
+
+// Cost of the low-level feedback between two solves of the MPC : a trot of
+// 16 nodes is solved once, then GainInterpolator.compute is called at 1 kHz
+// over the 20 ms of the first node, with and without the interpolation of
+// the controls and gains, and set_solution is timed.
+//
+//   quadruped-interpolator [--trials 100000]
+//
+// The duration of a tick is the mean over batches of 20 ticks (one node),
+// so that the overhead of the clock is not counted; the p99 and max of the
+// batches are reported as well, in nanoseconds per tick.
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char* argv[]) {
+  unsigned int trials = 100000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "--trials") {
+      trials = atoi(argv[i + 1]);
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 2;
+    }
+  }
+  if (trials == 0) {
+    std::cerr << "--trials should be positive" << std::endl;
+    return 2;
+  }
+
+  const unsigned int N = 16;
+  Eigen::Matrix<double, 12, 1> x0;
+  x0 << 0, 0, 0.2, 0, 0, 0, 0.2, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 12, 1> x_ref;
+  x_ref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+  Eigen::Matrix<double, 2, 13> fsteps;
+  fsteps << 8, 0.19, 0.15, 0.0, 0, 0, 0, 0, 0, 0, -0.19, -0.15, 0.0, 8, 0, 0,
+      0, 0.19, -0.15, 0.0, -0.19, 0.15, 0.0, 0, 0, 0;
+  Eigen::Matrix<double, 2, 5> gait;
+  gait << 8, 1, 0, 0, 1, 8, 0, 1, 1, 0;
+  Eigen::Matrix<double, 12, N + 1> xref = x_ref.replicate<1, N + 1>();
+  xref.col(0) = x0;
+
+  quadruped_walkgen::RecedingHorizonQuadruped horizon(x0, N);
+  horizon.update(gait, fsteps, xref);
+  quadruped_walkgen::SolverQuadrupedDDP mpc(horizon.get_problem());
+  mpc.solve(horizon.get_xs(), horizon.get_us(), 10);
+
+  quadruped_walkgen::GainInterpolator interpolator(N, 0.02);
+  std::vector<double> duration(trials);
+  for (unsigned int i = 0; i < trials; ++i) {
+    const Clock::time_point start = Clock::now();
+    interpolator.set_solution(mpc.get_xs(), mpc.get_us(), mpc.get_K());
+    duration[i] =
+        std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  }
+  std::cout << "GainInterpolator, " << N << " nodes" << std::endl;
+  report("set_solution [ns]", duration);
+
+  // The measured state drifts from the reference within the node
+  Eigen::Matrix<double, 12, 1> x = x0;
+  Eigen::Matrix<double, 12, 1> u = Eigen::Matrix<double, 12, 1>::Zero();
+  for (int interpolate = 1; interpolate >= 0; --interpolate) {
+    interpolator.set_interpolate(interpolate == 1);
+    for (unsigned int i = 0; i < trials; ++i) {
+      x(6) = 0.2 + 1e-6 * (i % 7);
+      const Clock::time_point start = Clock::now();
+      for (int tick = 0; tick < 20; ++tick) {
+        u += interpolator.compute(x, 0.001 * tick);
+      }
+      duration[i] = std::chrono::duration<double, std::nano>(Clock::now() -
+                                                             start)
+                        .count() /
+                    20.;
+    }
+    report(interpolate == 1 ? "compute, interpolated [ns]"
+                            : "compute, held on the node [ns]",
+           duration);
+  }
+  // Keeps the computation of u
+  std::cout << "  (sum of the forces " << u.sum() << ")" << std::endl;
+}
@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_augmented.hpp>
+#include <quadruped-walkgen/quadruped_augmented_time.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "crocoddyl/core/utils/timer.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "common.hpp"
+
+// Memory footprint of the nodes of a long horizon : size of the model and data
+// objects, bytes they hold on the heap (measured with mallinfo2 around their
+// creation, glibc >= 2.33) and cache misses of calc and calcDiff over the
+// whole horizon (perf hardware counter, Linux). The quantities that cannot be
+// measured on the platform are reported as n/a.
+
+// Bytes in use on the heap, -1 if unknown
+long heap_in_use() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  return static_cast<long>(mallinfo2().uordblks);
+#else
+  return -1;
+#endif
+}
+
+// Counter of the cache misses of the calling thread, disabled if the
+// hardware counters are not available
+class CacheMisses {
+ public:
+  CacheMisses() : fd_(-1) {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  ~CacheMisses() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+
+  bool available() const { return fd_ >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // Cache misses since start
+  long stop() {
+    long long count = 0;
+#ifdef __linux__
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+      }
+    }
+#endif
+    return static_cast<long>(count);
+  }
+
+ private:
+  int fd_;
+};
+
+std::string bytes(const long n) {
+  return n < 0 ? std::string("n/a") : std::to_string(n);
+}
+
+template <typename Model>
+void update(Model& model, const Eigen::Matrix<double, 3, 4>& l_feet,
+            const Eigen::Matrix<double, 12, 1>& xref,
+            const Eigen::Matrix<double, 4, 1>& S) {
+  model.update_model(l_feet, xref, S);
+}
+void update(quadruped_walkgen::ActionModelQuadrupedAugmented& model,
+            const Eigen::Matrix<double, 3, 4>& l_feet,
+            const Eigen::Matrix<double, 12, 1>& xref,
+            const Eigen::Matrix<double, 4, 1>& S) {
+  model.update_model(l_feet, l_feet, xref, S);
+}
+void update(quadruped_walkgen::ActionModelQuadrupedAugmentedTime& model,
+            const Eigen::Matrix<double, 3, 4>& l_feet,
+            const Eigen::Matrix<double, 12, 1>& xref,
+            const Eigen::Matrix<double, 4, 1>& S) {
+  model.update_model(l_feet, l_feet, xref, S);
+}
+
+template <typename Model, typename Data>
+void run(const std::string& name, const unsigned int N, const unsigned int T) {
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0., 0.;
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0, 0.2, 0, 0, 0, 0, 0;
+
+  // Heap held by the N models, then by their N data
+  std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> > models;
+  std::vector<boost::shared_ptr<crocoddyl::ActionDataAbstract> > datas;
+  long heap = heap_in_use();
+  for (unsigned int k = 0; k < N; ++k) {
+    boost::shared_ptr<Model> model = boost::make_shared<Model>();
+    update(*model, l_feet, xref, trot(k));
+    models.push_back(model);
+  }
+  const long heap_model = heap < 0 ? -1 : (heap_in_use() - heap) / N;
+  heap = heap_in_use();
+  for (unsigned int k = 0; k < N; ++k) {
+    datas.push_back(models[k]->createData());
+  }
+  const long heap_data = heap < 0 ? -1 : (heap_in_use() - heap) / N;
+
+  std::cout << name << std::endl;
+  std::cout << "  model : sizeof " << sizeof(Model) << ", heap "
+            << bytes(heap_model) << " bytes" << std::endl;
+  std::cout << "  data  : sizeof " << sizeof(Data) << ", heap "
+            << bytes(heap_data) << " bytes" << std::endl;
+
+  // calc and calcDiff of the nodes along a rollout of the horizon
+  const std::size_t nx = models[0]->get_state()->get_nx();
+  Eigen::VectorXd x0 = Eigen::VectorXd::Zero(nx);
+  x0.head(12) = xref;
+  x0.tail(nx - 12).setConstant(0.02);
+  Eigen::VectorXd u = Eigen::VectorXd::Zero(models[0]->get_nu());
+  for (int i = 0; i < 4; ++i) {
+    u(3 * i + 2) = 2.5;
+  }
+
+  CacheMisses cache_misses;
+  Eigen::ArrayXd duration(T), misses(T);
+  Eigen::VectorXd x(nx);
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    cache_misses.start();
+    x = x0;
+    for (unsigned int k = 0; k < N; ++k) {
+      models[k]->calc(datas[k], x, u);
+      models[k]->calcDiff(datas[k], x, u);
+      x = datas[k]->xnext;
+    }
+    misses[i] = static_cast<double>(cache_misses.stop());
+    duration[i] = timer.get_duration();
+  }
+
+  std::cout << "  horizon of " << N << " nodes : " << duration.sum() / T
+            << " ms (" << duration.minCoeff() << "-" << duration.maxCoeff()
+            << "), cache misses ";
+  if (cache_misses.available()) {
+    std::cout << misses.sum() / T << " (" << misses.minCoeff() << "-"
+              << misses.maxCoeff() << ")" << std::endl;
+  } else {
+    std::cout << "n/a" << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int N = 2000;  // number of nodes
+  unsigned int T = 100;   // number of trials
+  if (argc > 1) {
+    T = atoi(argv[1]);
+  }
+
+  using namespace quadruped_walkgen;
+  run<ActionModelQuadruped, ActionDataQuadruped>("ActionModelQuadruped", N, T);
+  run<ActionModelQuadrupedNonLinear, ActionDataQuadrupedNonLinear>(
+      "ActionModelQuadrupedNonLinear", N, T);
+  run<ActionModelQuadrupedAugmented, ActionDataQuadrupedAugmented>(
+      "ActionModelQuadrupedAugmented", N, T);
+  run<ActionModelQuadrupedAugmentedTime, ActionDataQuadrupedAugmentedTime>(
+      "ActionModelQuadrupedAugmentedTime", N, T);
+}
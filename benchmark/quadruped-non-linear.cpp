@@ -182,6 +182,9 @@ int main(int argc, char* argv[]) {
   boost::shared_ptr<crocoddyl::ShootingProblem> problem =
       boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
                                                      terminal_model);
+#ifdef QUADRUPED_WALKGEN_WITH_MULTITHREADING
+  problem->set_nthreads(QUADRUPED_WALKGEN_WITH_NTHREADS);
+#endif
   crocoddyl::SolverDDP ddp(problem);
 
   std::vector<Eigen::VectorXd> xs(int(N) + 1, x0);
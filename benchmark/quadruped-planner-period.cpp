@@ -92,16 +92,7 @@ int main(int argc, char* argv[]) {
           boost::shared_ptr<crocoddyl::ActionModelAbstract> model =
               boost::make_shared<quadruped_walkgen::ActionModelQuadrupedTime>();
           running_models.push_back(model);
-          std::cout << "okok1" << std::endl;
         }
-        // if ( j == 2 and k == 9){
-        //   boost::shared_ptr<crocoddyl::ActionModelAbstract> model
-        //              =
-        //              boost::make_shared<quadruped_walkgen::ActionModelQuadrupedTime>()
-        //              ;
-        //   running_models.push_back(model) ;
-        //   std::cout<<"okok2"<<std::endl ;
-        // }
         boost::shared_ptr<crocoddyl::ActionModelAbstract> model =
             boost::make_shared<
                 quadruped_walkgen::ActionModelQuadrupedAugmentedTime>();
@@ -175,16 +166,9 @@ int main(int argc, char* argv[]) {
                   xref.block(0, k, 12, 1).data(), 12, 1),
               Eigen::Map<Eigen::Matrix<double, 4, 1> >(S_tmp.data(), 4, 1));
 
-          std::cout << "ok1" << std::endl;
           gap = gap + 1;
           us.push_back(u0_time);
         }
-        // if ( j == 2 and k == 9){
-        //   std::cout << "ok2" << std::endl ;
-        //   gap = gap + 1 ;
-        //   us.push_back(u0_time)  ;
-        // }
-        // std::cout << "indice :" <<  gap << std::endl ;
 
         boost::shared_ptr<quadruped_walkgen::ActionModelQuadrupedAugmentedTime>
             model2 = boost::dynamic_pointer_cast<
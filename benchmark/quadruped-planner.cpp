@@ -13,6 +13,9 @@
 #include <quadruped-walkgen/quadruped_step_time.hpp>
 #include <quadruped-walkgen/quadruped_time.hpp>
 
+#include <Eigen/Geometry>
+#include <stdexcept>
+
 #include "crocoddyl/core/actions/unicycle.hpp"
 #include "crocoddyl/core/solvers/ddp.hpp"
 #include "crocoddyl/core/utils/callbacks.hpp"
@@ -22,6 +25,58 @@
   std::sqrt(((vec - vec.mean())).square().sum() / (double(vec.size()) - 1.))
 #define AVG(vec) (vec.mean())
 
+// Time calc and calcDiff of a step model, with the number of samples of the
+// feet trajectories chosen at runtime or at compile time. The base has a yaw,
+// so that the Hessians of the feet terms have off-diagonal terms, and two
+// consecutive calcDiff have to give the same Lxx.
+template <typename Model>
+void benchmarkStepModel(const std::string& name, const unsigned int T,
+                        const Eigen::Matrix<double, 3, 4>& l_feet,
+                        const Eigen::Matrix<double, 4, 1>& S) {
+  boost::shared_ptr<Model> model = boost::make_shared<Model>();
+  Eigen::Matrix<double, 12, 1> xref = Eigen::Matrix<double, 12, 1>::Zero();
+  Eigen::Matrix<double, 3, 4> velocity, acceleration;
+  velocity.setConstant(0.3);
+  acceleration.setConstant(5.);
+  const Eigen::Matrix<double, 3, 3> oRh =
+      Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+  model->update_model(l_feet, xref, S, Eigen::Matrix<double, 3, 4>::Zero(),
+                      velocity, acceleration,
+                      Eigen::Matrix<double, 3, 4>::Zero(), oRh,
+                      Eigen::Matrix<double, 3, 1>::Zero(), 0.16);
+  boost::shared_ptr<crocoddyl::ActionDataAbstract> data = model->createData();
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(20);
+  Eigen::VectorXd u = Eigen::VectorXd::Constant(8, 0.05);
+
+  Eigen::ArrayXd duration(T);
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    model->calc(data, x, u);
+    duration[i] = timer.get_duration();
+  }
+  std::cout << "  " << name << ".calc [us]: " << 1e3 * AVG(duration) << " ("
+            << 1e3 * duration.minCoeff() << "-" << 1e3 * duration.maxCoeff()
+            << ")" << std::endl;
+
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    model->calcDiff(data, x, u);
+    duration[i] = timer.get_duration();
+  }
+  std::cout << "  " << name << ".calcDiff [us]: " << 1e3 * AVG(duration)
+            << " (" << 1e3 * duration.minCoeff() << "-"
+            << 1e3 * duration.maxCoeff() << ")" << std::endl;
+
+  // The derivatives only depend on x and u
+  model->calcDiff(data, x, u);
+  const Eigen::MatrixXd Lxx = data->Lxx;
+  model->calcDiff(data, x, u);
+  if (!(data->Lxx - Lxx).isZero(0.)) {
+    throw std::runtime_error(name + ".calcDiff: Lxx changed between two "
+                                    "calls with the same x and u");
+  }
+}
+
 int main(int argc, char* argv[]) {
   // The time of the cycle contol is 0.02s, and last 0.32s --> 16nodes
   // Control cycle during one gait period
@@ -265,4 +320,12 @@ int main(int argc, char* argv[]) {
   max_duration = duration.maxCoeff();
   std::cout << "  ShootingProblem.calcDiff [ms]: " << avrg_duration << " ("
             << min_duration << "-" << max_duration << ")" << std::endl;
+
+  // Step model alone, the feet 0 and 3 are moving
+  Eigen::Matrix<double, 4, 1> S_step;
+  S_step << 1, 0, 0, 1;
+  benchmarkStepModel<quadruped_walkgen::ActionModelQuadrupedStep>(
+      "ActionModelQuadrupedStep", T, l_feet, S_step);
+  benchmarkStepModel<quadruped_walkgen::ActionModelQuadrupedStep5>(
+      "ActionModelQuadrupedStep5", T, l_feet, S_step);
 }
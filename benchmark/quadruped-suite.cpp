@@ -0,0 +1,453 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_augmented.hpp>
+#include <quadruped-walkgen/quadruped_augmented_time.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+#include <quadruped-walkgen/quadruped_step.hpp>
+#include <quadruped-walkgen/quadruped_step_period.hpp>
+#include <quadruped-walkgen/quadruped_step_time.hpp>
+#include <quadruped-walkgen/quadruped_time.hpp>
+#include <quadruped-walkgen/solver_quadruped_ddp.hpp>
+
+#include "crocoddyl/core/solvers/ddp.hpp"
+#include "crocoddyl/core/utils/timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "common.hpp"
+
+// Latencies of update_model (all the nodes of the horizon), calc, calcDiff
+// and solve of a shooting problem made of one model family, for each family
+// and horizon length :
+//
+//   quadruped-suite [--nodes 16,32] [--trials 1000] [--maxiter 1] [--cpu 0]
+//                   [--family ActionModelQuadruped] [--json results.json]
+//                   [--csv results.csv] [--baseline baseline.csv]
+//                   [--tolerance 0.1]
+//
+// The process is pinned on --cpu (Linux) so that the samples are not spread
+// over cores with different caches and frequencies. The results are printed
+// as a table and written in JSON and/or CSV. A CSV written by a previous run
+// can be given as --baseline : every result whose p50 is more than
+// --tolerance slower than the baseline is reported and the exit code is 1.
+// The problems repeat the same model on every node with a trotting gait,
+// they measure the cost of the nodes and not the quality of the solutions.
+
+struct Options {
+  Options()
+      : nodes(1, 16),
+        trials(1000),
+        maxiter(1),
+        cpu(-1),
+        tolerance(0.1) {}
+
+  std::vector<unsigned int> nodes;  // horizon lengths
+  unsigned int trials;              // samples per measure
+  unsigned int maxiter;             // iterations of the solvers
+  int cpu;                          // cpu of the process, -1 to not pin
+  std::string family;               // only run this family if not empty
+  std::string json;
+  std::string csv;
+  std::string baseline;
+  double tolerance;  // relative regression of p50 against the baseline
+};
+
+struct Result {
+  std::string family;
+  unsigned int nodes;
+  std::string phase;
+  std::size_t samples;
+  double mean, stddev, p50, p90, p99, max;  // [us]
+
+  std::string key() const {
+    std::ostringstream os;
+    os << family << "," << nodes << "," << phase;
+    return os.str();
+  }
+};
+
+// Statistics of the samples in milliseconds, converted to microseconds.
+// The percentiles are the nearest-rank ones of the sorted samples.
+Result statistics(const std::string& family, const unsigned int nodes,
+                  const std::string& phase, std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  const std::size_t n = samples.size();
+  Result r;
+  r.family = family;
+  r.nodes = nodes;
+  r.phase = phase;
+  r.samples = n;
+  double sum = 0., sum2 = 0.;
+  for (std::size_t i = 0; i < n; ++i) {
+    sum += samples[i];
+    sum2 += samples[i] * samples[i];
+  }
+  r.mean = 1e3 * sum / n;
+  r.stddev = 1e3 * std::sqrt(std::max(0., sum2 / n - sum * sum / (n * n)));
+  const double p[3] = {50., 90., 99.};
+  double* q[3] = {&r.p50, &r.p90, &r.p99};
+  for (int i = 0; i < 3; ++i) {
+    *q[i] = 1e3 * percentile(samples, p[i]);
+  }
+  r.max = 1e3 * samples.back();
+  return r;
+}
+
+// update_model of each family with the feet at rest under the shoulders
+struct Update {
+  Update() {
+    l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0.,
+        0.;
+    xref << 0, 0, 0.2, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+    zero34.setZero();
+    oRh.setIdentity();
+    oTh.setZero();
+  }
+
+  template <typename Model>
+  void operator()(Model& model, const Eigen::Matrix<double, 4, 1>& S) const {
+    model.update_model(l_feet, xref, S);
+  }
+  void operator()(quadruped_walkgen::ActionModelQuadrupedAugmented& model,
+                  const Eigen::Matrix<double, 4, 1>& S) const {
+    model.update_model(l_feet, l_feet, xref, S);
+  }
+  void operator()(quadruped_walkgen::ActionModelQuadrupedAugmentedTime& model,
+                  const Eigen::Matrix<double, 4, 1>& S) const {
+    model.update_model(l_feet, l_feet, xref, S);
+  }
+  void operator()(quadruped_walkgen::ActionModelQuadrupedStep& model,
+                  const Eigen::Matrix<double, 4, 1>& S) const {
+    model.update_model(l_feet, xref, S, zero34, zero34, zero34, zero34, oRh,
+                       oTh, 0.16);
+  }
+  void operator()(quadruped_walkgen::ActionModelQuadrupedStepTime& model,
+                  const Eigen::Matrix<double, 4, 1>& S) const {
+    model.update_model(l_feet, zero34, zero34, xref, S);
+  }
+
+  Eigen::Matrix<double, 3, 4> l_feet;
+  Eigen::Matrix<double, 12, 1> xref;
+  Eigen::Matrix<double, 3, 4> zero34;
+  Eigen::Matrix<double, 3, 3> oRh;
+  Eigen::Matrix<double, 3, 1> oTh;
+};
+
+template <typename Solver>
+std::vector<double> time_solve(
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem,
+    const std::vector<Eigen::VectorXd>& xs,
+    const std::vector<Eigen::VectorXd>& us, const Options& options) {
+  Solver solver(problem);
+  std::vector<double> duration(options.trials);
+  solver.solve(xs, us, options.maxiter);
+  for (unsigned int i = 0; i < options.trials; ++i) {
+    crocoddyl::Timer timer;
+    solver.solve(xs, us, options.maxiter);
+    duration[i] = timer.get_duration();
+  }
+  return duration;
+}
+
+template <typename Model>
+void run(const std::string& name, const Options& options,
+         std::vector<Result>& results) {
+  if (!options.family.empty() && options.family != name) {
+    return;
+  }
+  const Update update;
+  for (std::size_t n = 0; n < options.nodes.size(); ++n) {
+    const unsigned int N = options.nodes[n];
+
+    std::vector<boost::shared_ptr<Model> > models;
+    std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> >
+        running_models;
+    for (unsigned int k = 0; k < N; ++k) {
+      models.push_back(boost::make_shared<Model>());
+      update(*models.back(), trot(k));
+      running_models.push_back(models.back());
+    }
+    boost::shared_ptr<Model> terminal_model = boost::make_shared<Model>();
+    update(*terminal_model, Eigen::Matrix<double, 4, 1>::Ones());
+
+    // State at the reference, feet under the shoulders and nodes of 20 ms
+    const std::size_t nx = terminal_model->get_state()->get_nx();
+    const std::size_t nu = terminal_model->get_nu();
+    Eigen::VectorXd x0 = Eigen::VectorXd::Zero(nx);
+    x0.head(12) = update.xref;
+    x0(6) = 0.2;
+    if (nx >= 20) {
+      for (int i = 0; i < 4; ++i) {
+        x0.segment(12 + 2 * i, 2) = update.l_feet.block<2, 1>(0, i);
+      }
+    }
+    if (nx == 21) {
+      x0(20) = 0.02;
+    }
+    Eigen::VectorXd u0 = Eigen::VectorXd::Constant(nu, 0.01);
+    if (nu == 12) {
+      for (int i = 0; i < 4; ++i) {
+        u0(3 * i + 2) = 2.5;
+      }
+    } else if (nu == 1) {
+      u0(0) = 0.02;
+    }
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem =
+        boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
+                                                       terminal_model);
+    const std::vector<Eigen::VectorXd> xs(N + 1, x0);
+    const std::vector<Eigen::VectorXd> us(N, u0);
+
+    // update_model of the whole horizon, the gait moves by one node at each
+    // trial as in the receding horizon
+    std::vector<double> duration(options.trials);
+    for (unsigned int i = 0; i < options.trials; ++i) {
+      crocoddyl::Timer timer;
+      for (unsigned int k = 0; k < N; ++k) {
+        update(*models[k], trot(k + i + 1));
+      }
+      duration[i] = timer.get_duration();
+    }
+    results.push_back(statistics(name, N, "update_model", duration));
+
+    problem->calc(xs, us);
+    for (unsigned int i = 0; i < options.trials; ++i) {
+      crocoddyl::Timer timer;
+      problem->calc(xs, us);
+      duration[i] = timer.get_duration();
+    }
+    results.push_back(statistics(name, N, "calc", duration));
+
+    problem->calcDiff(xs, us);
+    for (unsigned int i = 0; i < options.trials; ++i) {
+      crocoddyl::Timer timer;
+      problem->calcDiff(xs, us);
+      duration[i] = timer.get_duration();
+    }
+    results.push_back(statistics(name, N, "calcDiff", duration));
+
+    results.push_back(
+        statistics(name, N, "solve",
+                   time_solve<crocoddyl::SolverDDP>(problem, xs, us, options)));
+  }
+}
+
+// Solver of the linear model specialized for the structure of its nodes
+void run_solver_quadruped_ddp(const Options& options,
+                              std::vector<Result>& results) {
+  const std::string name = "ActionModelQuadruped";
+  if (!options.family.empty() && options.family != name) {
+    return;
+  }
+  const Update update;
+  for (std::size_t n = 0; n < options.nodes.size(); ++n) {
+    const unsigned int N = options.nodes[n];
+    std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> >
+        running_models;
+    for (unsigned int k = 0; k < N; ++k) {
+      boost::shared_ptr<quadruped_walkgen::ActionModelQuadruped> model =
+          boost::make_shared<quadruped_walkgen::ActionModelQuadruped>();
+      update(*model, trot(k));
+      running_models.push_back(model);
+    }
+    boost::shared_ptr<quadruped_walkgen::ActionModelQuadruped>
+        terminal_model =
+            boost::make_shared<quadruped_walkgen::ActionModelQuadruped>();
+    update(*terminal_model, Eigen::Matrix<double, 4, 1>::Ones());
+
+    Eigen::VectorXd x0 = update.xref;
+    x0(6) = 0.2;
+    Eigen::VectorXd u0 = Eigen::VectorXd::Zero(12);
+    for (int i = 0; i < 4; ++i) {
+      u0(3 * i + 2) = 2.5;
+    }
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem =
+        boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
+                                                       terminal_model);
+    results.push_back(statistics(
+        name, N, "solve_quadruped_ddp",
+        time_solve<quadruped_walkgen::SolverQuadrupedDDP>(
+            problem, std::vector<Eigen::VectorXd>(N + 1, x0),
+            std::vector<Eigen::VectorXd>(N, u0), options)));
+  }
+}
+
+void write_json(const std::string& filename,
+                const std::vector<Result>& results) {
+  std::ofstream os(filename.c_str());
+  os << "[" << std::endl;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    os << "  {\"family\": \"" << r.family << "\", \"nodes\": " << r.nodes
+       << ", \"phase\": \"" << r.phase << "\", \"samples\": " << r.samples
+       << ", \"mean_us\": " << r.mean << ", \"stddev_us\": " << r.stddev
+       << ", \"p50_us\": " << r.p50 << ", \"p90_us\": " << r.p90
+       << ", \"p99_us\": " << r.p99 << ", \"max_us\": " << r.max << "}"
+       << (i + 1 < results.size() ? "," : "") << std::endl;
+  }
+  os << "]" << std::endl;
+}
+
+void write_csv(const std::string& filename,
+               const std::vector<Result>& results) {
+  std::ofstream os(filename.c_str());
+  os << "family,nodes,phase,samples,mean_us,stddev_us,p50_us,p90_us,p99_us,"
+        "max_us"
+     << std::endl;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    os << r.key() << "," << r.samples << "," << r.mean << "," << r.stddev
+       << "," << r.p50 << "," << r.p90 << "," << r.p99 << "," << r.max
+       << std::endl;
+  }
+}
+
+// p50 of the results of a CSV written by write_csv, by family, nodes and
+// phase
+std::map<std::string, double> read_baseline(const std::string& filename) {
+  std::map<std::string, double> p50;
+  std::ifstream is(filename.c_str());
+  if (!is) {
+    throw std::runtime_error("cannot read the baseline " + filename);
+  }
+  std::string line;
+  std::getline(is, line);  // header
+  while (std::getline(is, line)) {
+    std::vector<std::string> fields;
+    std::istringstream ls(line);
+    std::string field;
+    while (std::getline(ls, field, ',')) {
+      fields.push_back(field);
+    }
+    if (fields.size() == 10) {
+      p50[fields[0] + "," + fields[1] + "," + fields[2]] =
+          std::atof(fields[6].c_str());
+    }
+  }
+  return p50;
+}
+
+std::vector<unsigned int> parse_list(const std::string& list) {
+  std::vector<unsigned int> values;
+  std::istringstream is(list);
+  std::string value;
+  while (std::getline(is, value, ',')) {
+    values.push_back(static_cast<unsigned int>(atoi(value.c_str())));
+  }
+  return values;
+}
+
+int main(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    const std::string value = argv[i + 1];
+    if (arg == "--nodes") {
+      options.nodes = parse_list(value);
+    } else if (arg == "--trials") {
+      options.trials = atoi(value.c_str());
+    } else if (arg == "--maxiter") {
+      options.maxiter = atoi(value.c_str());
+    } else if (arg == "--cpu") {
+      options.cpu = atoi(value.c_str());
+    } else if (arg == "--family") {
+      options.family = value;
+    } else if (arg == "--json") {
+      options.json = value;
+    } else if (arg == "--csv") {
+      options.csv = value;
+    } else if (arg == "--baseline") {
+      options.baseline = value;
+    } else if (arg == "--tolerance") {
+      options.tolerance = atof(value.c_str());
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 2;
+    }
+  }
+  if (options.trials == 0 || options.nodes.empty()) {
+    std::cerr << "--trials and --nodes should not be empty" << std::endl;
+    return 2;
+  }
+
+  if (options.cpu >= 0) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(options.cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+      std::cerr << "cannot pin the process on cpu " << options.cpu
+                << std::endl;
+    }
+#else
+    std::cerr << "pinning is only supported on Linux" << std::endl;
+#endif
+  }
+
+  using namespace quadruped_walkgen;
+  std::vector<Result> results;
+  run<ActionModelQuadruped>("ActionModelQuadruped", options, results);
+  run_solver_quadruped_ddp(options, results);
+  run<ActionModelQuadrupedNonLinear>("ActionModelQuadrupedNonLinear", options,
+                                     results);
+  run<ActionModelQuadrupedAugmented>("ActionModelQuadrupedAugmented", options,
+                                     results);
+  run<ActionModelQuadrupedAugmentedTime>("ActionModelQuadrupedAugmentedTime",
+                                         options, results);
+  run<ActionModelQuadrupedTime>("ActionModelQuadrupedTime", options, results);
+  run<ActionModelQuadrupedStep>("ActionModelQuadrupedStep", options, results);
+  run<ActionModelQuadrupedStepPeriod>("ActionModelQuadrupedStepPeriod",
+                                      options, results);
+  run<ActionModelQuadrupedStepTime>("ActionModelQuadrupedStepTime", options,
+                                    results);
+
+  std::cout << "family nodes phase [us]: p50 p90 p99 max (mean +- stddev)"
+            << std::endl;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    std::cout << "  " << r.family << " " << r.nodes << " " << r.phase << ": "
+              << r.p50 << " " << r.p90 << " " << r.p99 << " " << r.max << " ("
+              << r.mean << " +- " << r.stddev << ")" << std::endl;
+  }
+  if (!options.json.empty()) {
+    write_json(options.json, results);
+  }
+  if (!options.csv.empty()) {
+    write_csv(options.csv, results);
+  }
+
+  int status = 0;
+  if (!options.baseline.empty()) {
+    const std::map<std::string, double> baseline =
+        read_baseline(options.baseline);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      std::map<std::string, double>::const_iterator it =
+          baseline.find(results[i].key());
+      if (it != baseline.end() &&
+          results[i].p50 > (1. + options.tolerance) * it->second) {
+        std::cout << "regression " << results[i].key() << ": p50 "
+                  << results[i].p50 << " us, baseline " << it->second << " us"
+                  << std::endl;
+        status = 1;
+      }
+    }
+  }
+  return status;
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2018-2019, LAAS-CNRS
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/quadruped_nl.hpp>
+
+#include <sstream>
+
+#include "common.hpp"
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "crocoddyl/core/utils/timer.hpp"
+
+// Duration of ShootingProblem::calcDiff against the number of threads of the
+// problem, for the linear and the non-linear models :
+//
+//   quadruped-threads [nodes = 16] [trials = 1000]
+//
+// The number of threads goes from 1 to BUILD_WITH_NTHREADS. Without
+// BUILD_WITH_MULTITHREADS, or with a crocoddyl built without multithreading,
+// the nodes are evaluated in one thread whatever the number of threads.
+
+template <typename Model>
+boost::shared_ptr<crocoddyl::ShootingProblem> make_problem(
+    const unsigned int N, const Eigen::Matrix<double, 12, 1>& x0) {
+  Eigen::Matrix<double, 3, 4> l_feet;
+  l_feet << 0.19, 0.19, -0.19, -0.19, 0.15, -0.15, 0.15, -0.15, 0., 0., 0., 0.;
+  Eigen::Matrix<double, 12, 1> xref;
+  xref << 0, 0, 0.2, 0, 0, 0, 0.1, 0, 0, 0, 0, 0;
+
+  std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> >
+      running_models;
+  for (unsigned int k = 0; k < N; ++k) {
+    boost::shared_ptr<Model> model = boost::make_shared<Model>();
+    model->update_model(l_feet, xref, trot(k));
+    running_models.push_back(model);
+  }
+  boost::shared_ptr<Model> terminal_model = boost::make_shared<Model>();
+  terminal_model->update_model(l_feet, xref, trot(N - 1));
+  terminal_model->set_force_weights(Eigen::Matrix<double, 12, 1>::Zero());
+  terminal_model->set_friction_weight(0);
+  return boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
+                                                        terminal_model);
+}
+
+template <typename Model>
+void run(const std::string& name, const unsigned int N,
+         const unsigned int trials, const std::size_t max_threads) {
+  Eigen::Matrix<double, 12, 1> x0;
+  x0 << 0, 0, 0.2, 0, 0, 0, 0.1, 0, 0, 0, 0, 0;
+  boost::shared_ptr<crocoddyl::ShootingProblem> problem =
+      make_problem<Model>(N, x0);
+
+  Eigen::Matrix<double, 12, 1> u0;
+  u0 << 1, 0.2, 8, 1, 1, 8, -1, 1, 8, -1, -1, 8;
+  const std::vector<Eigen::VectorXd> xs(N + 1, x0);
+  const std::vector<Eigen::VectorXd> us(N, u0);
+
+  std::cout << name << std::endl;
+  std::vector<double> samples(trials);
+  for (std::size_t n = 1; n <= max_threads; ++n) {
+    problem->set_nthreads(static_cast<int>(n));
+    problem->calc(xs, us);
+    problem->calcDiff(xs, us);
+    for (unsigned int i = 0; i < trials; ++i) {
+      problem->calc(xs, us);
+      crocoddyl::Timer timer;
+      problem->calcDiff(xs, us);
+      samples[i] = 1e3 * timer.get_duration();
+    }
+    std::ostringstream label;
+    label << "calcDiff, " << n << " thread(s) [us]";
+    report(label.str(), samples);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int N = 16;  // number of nodes
+  unsigned int trials = 1000;
+  if (argc > 1) {
+    N = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    trials = atoi(argv[2]);
+  }
+
+#ifdef QUADRUPED_WALKGEN_WITH_MULTITHREADING
+  const std::size_t max_threads = QUADRUPED_WALKGEN_WITH_NTHREADS;
+#else
+  const std::size_t max_threads = 1;
+  std::cout << "Built without BUILD_WITH_MULTITHREADS, one thread only"
+            << std::endl;
+#endif
+
+  run<quadruped_walkgen::ActionModelQuadruped>("ActionModelQuadruped", N,
+                                               trials, max_threads);
+  run<quadruped_walkgen::ActionModelQuadrupedNonLinear>(
+      "ActionModelQuadrupedNonLinear", N, trials, max_threads);
+}
@@ -6,7 +6,9 @@
 // All rights reserved.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <quadruped-walkgen/horizon_batch.hpp>
 #include <quadruped-walkgen/quadruped.hpp>
+#include <quadruped-walkgen/receding_horizon.hpp>
 
 #include "crocoddyl/core/actions/unicycle.hpp"
 #include "crocoddyl/core/solvers/ddp.hpp"
@@ -55,6 +57,36 @@ void updateModel(
   terminal_model_2->set_friction_weight(0);
 }
 
+// Move the gait and fsteps matrices forward by one node : one node is removed
+// from the first phase and appended to the last phase, or in a new phase if
+// the contact status or the footholds differ (periodic gait)
+void rollGait(Eigen::Matrix<double, 6, 5>& gait,
+              Eigen::Matrix<double, 6, 13>& fsteps) {
+  const Eigen::Matrix<double, 1, 5> first_gait = gait.row(0);
+  const Eigen::Matrix<double, 1, 13> first_fsteps = fsteps.row(0);
+  gait(0, 0) -= 1;
+  fsteps(0, 0) -= 1;
+  if (gait(0, 0) == 0) {
+    for (int j = 0; j < 5; j++) {
+      gait.row(j) = gait.row(j + 1);
+      fsteps.row(j) = fsteps.row(j + 1);
+    }
+    gait.row(5).setZero();
+    fsteps.row(5).setZero();
+  }
+
+  int last = int(gait.block(0, 0, 6, 1).array().min(1.).matrix().sum()) - 1;
+  if (last >= 0 &&
+      gait.block(last, 1, 1, 4) == first_gait.segment(1, 4) &&
+      fsteps.block(last, 1, 1, 12) == first_fsteps.segment(1, 12)) {
+    gait(last, 0) += 1;
+    fsteps(last, 0) += 1;
+  } else {
+    gait.row(last + 1) << 1, first_gait.segment(1, 4);
+    fsteps.row(last + 1) << 1, first_fsteps.segment(1, 12);
+  }
+}
+
 int main(int argc, char* argv[]) {
   // The time of the cycle contol is 0.02s, and last 0.32s --> 16nodes
   // Control cycle during one gait period
@@ -178,6 +210,9 @@ int main(int argc, char* argv[]) {
   boost::shared_ptr<crocoddyl::ShootingProblem> problem =
       boost::make_shared<crocoddyl::ShootingProblem>(x0, running_models,
                                                      terminal_model);
+#ifdef QUADRUPED_WALKGEN_WITH_MULTITHREADING
+  problem->set_nthreads(QUADRUPED_WALKGEN_WITH_NTHREADS);
+#endif
   crocoddyl::SolverDDP ddp(problem);
 
   std::vector<Eigen::VectorXd> xs(int(N) + 1, x0);
@@ -250,4 +285,119 @@ int main(int argc, char* argv[]) {
   max_duration = duration.maxCoeff();
   std::cout << "  ShootingProblem.calcDiff [ms]: " << avrg_duration << " ("
             << min_duration << "-" << max_duration << ")" << std::endl;
+
+  // Running calcDiff, rebuilding the constant derivative blocks at each call
+  // (behaviour without the caching based on the version of the models)
+  for (unsigned int i = 0; i < T; ++i) {
+    for (int k = 0; k < int(N); ++k) {
+      running_models_2[k]->set_mu(running_models_2[k]->get_mu());
+    }
+    terminal_model_2->set_mu(terminal_model_2->get_mu());
+    crocoddyl::Timer timer;
+    problem->calcDiff(xs, us);
+    duration[i] = timer.get_duration();
+  }
+
+  avrg_duration = duration.sum() / T;
+  min_duration = duration.minCoeff();
+  max_duration = duration.maxCoeff();
+  std::cout << "  ShootingProblem.calcDiff, no caching [ms]: " << avrg_duration
+            << " (" << min_duration << "-" << max_duration << ")"
+            << std::endl;
+
+  // Same evaluation with all the nodes of the horizon in one pass
+  quadruped_walkgen::HorizonQuadrupedBatch batch(problem);
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    batch.calc(xs, us);
+    duration[i] = timer.get_duration();
+  }
+
+  avrg_duration = duration.sum() / T;
+  min_duration = duration.minCoeff();
+  max_duration = duration.maxCoeff();
+  std::cout << "  HorizonQuadrupedBatch.calc [ms]: " << avrg_duration << " ("
+            << min_duration << "-" << max_duration << ")" << std::endl;
+
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    batch.calcDiff(xs, us);
+    duration[i] = timer.get_duration();
+  }
+
+  avrg_duration = duration.sum() / T;
+  min_duration = duration.minCoeff();
+  max_duration = duration.maxCoeff();
+  std::cout << "  HorizonQuadrupedBatch.calcDiff [ms]: " << avrg_duration
+            << " (" << min_duration << "-" << max_duration << ")"
+            << std::endl;
+
+  // Receding horizon : shift by one node and update the changed nodes only
+  quadruped_walkgen::RecedingHorizonQuadruped horizon(x0, N);
+  horizon.update(gait, fsteps, xref);
+  Eigen::Matrix<double, 6, 5> gait_rolled = gait;
+  Eigen::Matrix<double, 6, 13> fsteps_rolled = fsteps;
+  std::size_t n_updated = 0;
+  for (unsigned int i = 0; i < T; ++i) {
+    rollGait(gait_rolled, fsteps_rolled);
+    crocoddyl::Timer timer;
+    horizon.shift();
+    n_updated += horizon.update(gait_rolled, fsteps_rolled, xref);
+    duration[i] = timer.get_duration();
+  }
+
+  avrg_duration = duration.sum() / T;
+  min_duration = duration.minCoeff();
+  max_duration = duration.maxCoeff();
+  std::cout << "  RecedingHorizonQuadruped.shift + update [ms]: "
+            << avrg_duration << " (" << min_duration << "-" << max_duration
+            << "), " << double(n_updated) / T << " models updated per cycle"
+            << std::endl;
+
+  // Same cycle with a reference moving forward at 0.2 m/s, the nodes whose
+  // contacts did not change only get a new reference
+  Eigen::Matrix<double, 12, 17> xref_moving = xref;
+  n_updated = 0;
+  for (unsigned int i = 0; i < T; ++i) {
+    rollGait(gait_rolled, fsteps_rolled);
+    xref_moving.row(0).array() += 0.2 * 0.02;
+    crocoddyl::Timer timer;
+    horizon.shift();
+    n_updated += horizon.update(gait_rolled, fsteps_rolled, xref_moving);
+    duration[i] = timer.get_duration();
+  }
+
+  avrg_duration = duration.sum() / T;
+  min_duration = duration.minCoeff();
+  max_duration = duration.maxCoeff();
+  std::cout << "  RecedingHorizonQuadruped.shift + update, moving reference "
+               "[ms]: "
+            << avrg_duration << " (" << min_duration << "-" << max_duration
+            << "), " << double(n_updated) / T << " models updated per cycle"
+            << std::endl;
+
+  // Whole horizon in one call, with the same references and contacts
+  Eigen::MatrixXd l_feet_horizon(3, 4 * N);
+  Eigen::MatrixXd xref_horizon = xref.block(0, 1, 12, N);
+  Eigen::MatrixXd S_horizon(4, N);
+  for (int k = 0; k < int(N); ++k) {
+    for (int i = 0; i < 4; i++) {
+      l_feet_horizon.col(4 * k + i) =
+          fsteps.block(0, 1 + 3 * i, 1, 3).transpose();
+    }
+    S_horizon.col(k) = running_models_2[k]->get_gait();
+  }
+  for (unsigned int i = 0; i < T; ++i) {
+    crocoddyl::Timer timer;
+    quadruped_walkgen::ActionModelQuadruped::update_models(
+        running_models_2, l_feet_horizon, xref_horizon, S_horizon);
+    duration[i] = timer.get_duration();
+  }
+
+  avrg_duration = duration.sum() / T;
+  min_duration = duration.minCoeff();
+  max_duration = duration.maxCoeff();
+  std::cout << "  ActionModelQuadruped::update_models [ms]: " << avrg_duration
+            << " (" << min_duration << "-" << max_duration << ")"
+            << std::endl;
 }
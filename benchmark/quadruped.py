@@ -5,7 +5,7 @@ import time
 import crocoddyl
 import numpy as np
 
-from quadruped_walkgen import ActionModelQuadruped
+from quadruped_walkgen import ActionModelQuadruped, GaitProblemBuilder
 
 N = 16  # number of nodes
 T = int(sys.argv[1]) if (len(sys.argv) > 1) else int(5000)  # number of trials
@@ -222,6 +222,22 @@ def runUpdateProblemBenchmark(fsteps, xref, x0, problem):
     return avrg_duration, min_duration, max_duration
 
 
+def runGaitProblemBuilderBenchmark(fsteps, xref, x0, problem):
+    builder = GaitProblemBuilder(problem)
+    duration = []
+    for i in range(T):
+        c_start = time.time()
+        builder.update(fsteps, xref)
+        problem.x0 = x0
+        c_end = time.time()
+        duration.append(1e3 * (c_end - c_start))
+
+    avrg_duration = sum(duration) / len(duration)
+    min_duration = min(duration)
+    max_duration = max(duration)
+    return avrg_duration, min_duration, max_duration
+
+
 def runDDPSolveBenchmark(xs, us, problem):
     ddp = crocoddyl.SolverDDP(problem)
     duration = []
@@ -276,6 +292,14 @@ print(
         avrg_duration, min_duration, max_duration
     )
 )
+avrg_duration, min_duration, max_duration = runGaitProblemBuilderBenchmark(
+    fsteps, xref, x0, problem
+)
+print(
+    "  GaitProblemBuilder.update [ms]: {0} ({1}, {2})".format(
+        avrg_duration, min_duration, max_duration
+    )
+)
 avrg_duration, min_duration, max_duration = runDDPSolveBenchmark(xs, us, problem)
 print(
     "  DDP.solve [ms]: {0} ({1}, {2})".format(avrg_duration, min_duration, max_duration)
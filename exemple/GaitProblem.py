@@ -4,7 +4,7 @@ import numpy as np
 
 import crocoddyl
 
-from quadruped_walkgen import ActionModelQuadruped
+from quadruped_walkgen import ActionModelQuadruped, GaitProblemBuilder
 
 
 class GaitProblem:
@@ -39,6 +39,9 @@ class GaitProblem:
         # ddp
         self.ddp = None
 
+        # Update of the models from the footsteps
+        self.builder = None
+
         # Mu, important parameter that need to be changed from the main file
         self.mu = mu
 
@@ -61,59 +64,18 @@ class GaitProblem:
             np.zeros(12), self.ListAction, self.terminalModel
         )
         self.ddp = crocoddyl.SolverDDP(self.problem)
+        self.builder = GaitProblemBuilder(self.problem)
 
     def updateProblem(self, fsteps, xref, x0):
 
-        self.fsteps = fsteps
-        self.createGaitMatrix()
-
-        j = 0
-        k_cum = 0
-        # L = []
-
-        # Iterate over all phases of the gait
-        # The first column of xref correspond to the current state
-        while self.gait[j, 0] != 0:
-            for i in range(k_cum, k_cum + np.int(self.gait[j, 0])):
-
-                # Update model
-                self.ListAction[i].updateModel(
-                    np.reshape(self.fsteps[j, 1:], (3, 4), order="F"),
-                    xref[:, i + 1],
-                    self.gait[j, 1:],
-                )
-                print(j, " ", i + 1, " ", j)
-
-            k_cum += np.int(self.gait[j, 0])
-            j += 1
-
-        print(self.gait)
-
-        # Update model of the terminal model
-        self.terminalModel.updateModel(
-            np.reshape(self.fsteps[j - 1, 1:], (3, 4), order="F"),
-            xref[:, -1],
-            self.gait[j - 1, 1:],
-        )
+        # Decode the gait matrix and update all the models in one call
+        self.builder.update(fsteps, xref)
+        self.gait = self.builder.gait
+        self.fsteps = self.builder.fsteps
 
         # update initial state of the problem
         self.problem.x0 = x0
 
-    def createGaitMatrix(self):
-
-        # Construction of the gait matrix representing the feet
-        # in contact with the ground
-        index = next(
-            (idx for idx, val in np.ndenumerate(self.fsteps[:, 0]) if val == 0.0), 0.0
-        )[0]
-        self.gait[:, 0] = self.fsteps[:, 0]
-        self.gait[:index, 1:] = 1.0 - (
-            np.isnan(self.fsteps[:index, 1::3]) | (self.fsteps[:index, 1::3] == 0.0)
-        )
-
-        # Replace NaN values by zeroes
-        self.fsteps[np.isnan(self.fsteps)] = 0.0
-
     def runProblem(self):
 
         self.ddp.solve([], [], self.max_iteration)
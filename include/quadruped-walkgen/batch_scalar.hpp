@@ -0,0 +1,213 @@
+#ifndef __quadruped_walkgen_batch_scalar_hpp__
+#define __quadruped_walkgen_batch_scalar_hpp__
+
+#include <Eigen/Core>
+#include <cmath>
+#include <limits>
+
+#include "quadruped-walkgen/conditional.hpp"
+#include "quadruped-walkgen/contact_mask.hpp"
+
+namespace quadruped_walkgen {
+
+// N values of T evaluated together, lane k of every quantity belongs to the
+// problem k. ActionModelQuadrupedTpl and ActionModelQuadrupedNonLinearTpl
+// instantiated with this scalar evaluate N robots or scenarios (different
+// states, commands, references and gaits) in one instruction stream, each
+// operation being done on the N lanes with the SIMD instructions of Eigen.
+// The models do not branch on scalar values : the contact status is applied
+// with products by gait(i) and the other conditions are masked selects of
+// ConditionalTpl, specialized below. The comparison operators are reductions
+// over the lanes (true if the comparison holds for all of them), used only by
+// the caching of the models and by the code of crocoddyl.
+template <typename T, int N>
+struct BatchScalar {
+  typedef Eigen::Array<T, N, 1> Lanes;
+  typedef Eigen::Map<Lanes> LanesMap;
+  typedef Eigen::Map<const Lanes> ConstLanesMap;
+
+  BatchScalar() {}
+  BatchScalar(const T& value) { lanes().setConstant(value); }
+  template <typename Derived>
+  explicit BatchScalar(const Eigen::ArrayBase<Derived>& values) {
+    lanes() = values;
+  }
+
+  LanesMap lanes() { return LanesMap(v); }
+  ConstLanesMap lanes() const { return ConstLanesMap(v); }
+  T& operator[](const int k) { return v[k]; }
+  const T& operator[](const int k) const { return v[k]; }
+
+  BatchScalar& operator+=(const BatchScalar& y) {
+    lanes() += y.lanes();
+    return *this;
+  }
+  BatchScalar& operator-=(const BatchScalar& y) {
+    lanes() -= y.lanes();
+    return *this;
+  }
+  BatchScalar& operator*=(const BatchScalar& y) {
+    lanes() *= y.lanes();
+    return *this;
+  }
+  BatchScalar& operator/=(const BatchScalar& y) {
+    lanes() /= y.lanes();
+    return *this;
+  }
+
+  friend BatchScalar operator-(const BatchScalar& x) {
+    return BatchScalar(-x.lanes());
+  }
+  friend BatchScalar operator+(const BatchScalar& x, const BatchScalar& y) {
+    return BatchScalar(x.lanes() + y.lanes());
+  }
+  friend BatchScalar operator-(const BatchScalar& x, const BatchScalar& y) {
+    return BatchScalar(x.lanes() - y.lanes());
+  }
+  friend BatchScalar operator*(const BatchScalar& x, const BatchScalar& y) {
+    return BatchScalar(x.lanes() * y.lanes());
+  }
+  friend BatchScalar operator/(const BatchScalar& x, const BatchScalar& y) {
+    return BatchScalar(x.lanes() / y.lanes());
+  }
+
+  friend bool operator==(const BatchScalar& x, const BatchScalar& y) {
+    return (x.lanes() == y.lanes()).all();
+  }
+  friend bool operator!=(const BatchScalar& x, const BatchScalar& y) {
+    return !(x == y);
+  }
+  friend bool operator<(const BatchScalar& x, const BatchScalar& y) {
+    return (x.lanes() < y.lanes()).all();
+  }
+  friend bool operator<=(const BatchScalar& x, const BatchScalar& y) {
+    return (x.lanes() <= y.lanes()).all();
+  }
+  friend bool operator>(const BatchScalar& x, const BatchScalar& y) {
+    return (x.lanes() > y.lanes()).all();
+  }
+  friend bool operator>=(const BatchScalar& x, const BatchScalar& y) {
+    return (x.lanes() >= y.lanes()).all();
+  }
+
+  friend BatchScalar sqrt(const BatchScalar& x) {
+    return BatchScalar(x.lanes().sqrt());
+  }
+  friend BatchScalar abs(const BatchScalar& x) {
+    return BatchScalar(x.lanes().abs());
+  }
+  friend BatchScalar cos(const BatchScalar& x) {
+    return BatchScalar(x.lanes().cos());
+  }
+  friend BatchScalar sin(const BatchScalar& x) {
+    return BatchScalar(x.lanes().sin());
+  }
+  friend BatchScalar exp(const BatchScalar& x) {
+    return BatchScalar(x.lanes().exp());
+  }
+  friend BatchScalar log(const BatchScalar& x) {
+    return BatchScalar(x.lanes().log());
+  }
+  friend bool isfinite(const BatchScalar& x) {
+    return x.lanes().isFinite().all();
+  }
+  friend bool isnan(const BatchScalar& x) { return x.lanes().isNaN().any(); }
+  friend bool isinf(const BatchScalar& x) { return x.lanes().isInf().any(); }
+
+  T v[N];
+};
+
+// Masked selects, lane by lane
+template <typename T, int N>
+struct ConditionalTpl<BatchScalar<T, N> > {
+  typedef BatchScalar<T, N> Scalar;
+
+  template <typename Derived>
+  static typename Derived::PlainObject positive_part(
+      const Eigen::MatrixBase<Derived>& x) {
+    typename Derived::PlainObject y(x);
+    for (Eigen::Index i = 0; i < y.size(); ++i) {
+      y(i).lanes() = y(i).lanes().max(T(0.));
+    }
+    return y;
+  }
+
+  template <typename Derived>
+  static typename Derived::PlainObject nonnegative(
+      const Eigen::MatrixBase<Derived>& x) {
+    typename Derived::PlainObject y(x);
+    for (Eigen::Index i = 0; i < y.size(); ++i) {
+      y(i).lanes() = (y(i).lanes() >= T(0.)).template cast<T>();
+    }
+    return y;
+  }
+
+  static Scalar positive(const Scalar& x) {
+    return Scalar((x.lanes() > T(0.)).template cast<T>());
+  }
+
+  static Scalar max(const Scalar& x, const Scalar& y) {
+    return Scalar(x.lanes().max(y.lanes()));
+  }
+};
+
+// The lanes may have different gaits, the kernels of the full mask are used
+// and the feet in swing phase are cancelled by the products with gait(i)
+template <typename T, int N>
+struct ContactMaskTpl<BatchScalar<T, N> > {
+  template <typename Derived>
+  static int from_gait(const Eigen::MatrixBase<Derived>&) {
+    return 15;
+  }
+};
+
+}  // namespace quadruped_walkgen
+
+namespace Eigen {
+
+template <typename T, int N>
+struct NumTraits<quadruped_walkgen::BatchScalar<T, N> >
+    : GenericNumTraits<quadruped_walkgen::BatchScalar<T, N> > {
+  typedef quadruped_walkgen::BatchScalar<T, N> Real;
+  typedef quadruped_walkgen::BatchScalar<T, N> NonInteger;
+  typedef quadruped_walkgen::BatchScalar<T, N> Nested;
+  typedef quadruped_walkgen::BatchScalar<T, N> Literal;
+
+  enum {
+    IsComplex = 0,
+    IsInteger = 0,
+    IsSigned = 1,
+    RequireInitialization = 1,
+    ReadCost = N * NumTraits<T>::ReadCost,
+    AddCost = N * NumTraits<T>::AddCost,
+    MulCost = N * NumTraits<T>::MulCost
+  };
+
+  static inline Real epsilon() { return Real(NumTraits<T>::epsilon()); }
+  static inline Real dummy_precision() {
+    return Real(NumTraits<T>::dummy_precision());
+  }
+  static inline Real highest() { return Real(NumTraits<T>::highest()); }
+  static inline Real lowest() { return Real(NumTraits<T>::lowest()); }
+  static inline int digits10() { return NumTraits<T>::digits10(); }
+};
+
+}  // namespace Eigen
+
+namespace std {
+
+template <typename T, int N>
+class numeric_limits<quadruped_walkgen::BatchScalar<T, N> >
+    : public numeric_limits<T> {
+ public:
+  typedef quadruped_walkgen::BatchScalar<T, N> Scalar;
+  static Scalar infinity() { return Scalar(numeric_limits<T>::infinity()); }
+  static Scalar max() { return Scalar(numeric_limits<T>::max()); }
+  static Scalar min() { return Scalar(numeric_limits<T>::min()); }
+  static Scalar lowest() { return Scalar(numeric_limits<T>::lowest()); }
+  static Scalar epsilon() { return Scalar(numeric_limits<T>::epsilon()); }
+};
+
+}  // namespace std
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __quadruped_walkgen_conditional_hpp__
+#define __quadruped_walkgen_conditional_hpp__
+
+#include <Eigen/Core>
+
+#ifdef QUADRUPED_WALKGEN_WITH_CODEGEN
+#include <cppad/cppad.hpp>
+#endif
+
+namespace quadruped_walkgen {
+
+// Conditionals used by the models on Scalar values. The comparisons of an AD
+// scalar are not recorded on its tape, so they are written as CondExp for
+// CppAD::AD and the generated code keeps both branches.
+template <typename Scalar>
+struct ConditionalTpl {
+  // max(x, 0), component-wise
+  template <typename Derived>
+  static typename Derived::PlainObject positive_part(
+      const Eigen::MatrixBase<Derived>& x) {
+    return x.cwiseMax(Scalar(0.));
+  }
+
+  // 1 if x >= 0, 0 otherwise, component-wise
+  template <typename Derived>
+  static typename Derived::PlainObject nonnegative(
+      const Eigen::MatrixBase<Derived>& x) {
+    return (x.array() >= Scalar(0.)).matrix().template cast<Scalar>();
+  }
+
+  // 1 if x > 0, 0 otherwise
+  static Scalar positive(const Scalar& x) {
+    return x > Scalar(0.) ? Scalar(1.) : Scalar(0.);
+  }
+
+  // max(x, y)
+  static Scalar max(const Scalar& x, const Scalar& y) {
+    return x < y ? y : x;
+  }
+};
+
+#ifdef QUADRUPED_WALKGEN_WITH_CODEGEN
+template <typename Base>
+struct ConditionalTpl<CppAD::AD<Base> > {
+  typedef CppAD::AD<Base> Scalar;
+
+  template <typename Derived>
+  static typename Derived::PlainObject positive_part(
+      const Eigen::MatrixBase<Derived>& x) {
+    typename Derived::PlainObject y(x);
+    for (Eigen::Index i = 0; i < y.size(); ++i) {
+      y(i) = CppAD::CondExpLt(y(i), Scalar(0.), Scalar(0.), y(i));
+    }
+    return y;
+  }
+
+  template <typename Derived>
+  static typename Derived::PlainObject nonnegative(
+      const Eigen::MatrixBase<Derived>& x) {
+    typename Derived::PlainObject y(x);
+    for (Eigen::Index i = 0; i < y.size(); ++i) {
+      y(i) = CppAD::CondExpGe(y(i), Scalar(0.), Scalar(1.), Scalar(0.));
+    }
+    return y;
+  }
+
+  static Scalar positive(const Scalar& x) {
+    return CppAD::CondExpGt(x, Scalar(0.), Scalar(1.), Scalar(0.));
+  }
+
+  static Scalar max(const Scalar& x, const Scalar& y) {
+    return CppAD::CondExpLt(x, y, y, x);
+  }
+};
+#endif
+
+}  // namespace quadruped_walkgen
+
+#endif
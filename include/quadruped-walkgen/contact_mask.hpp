@@ -0,0 +1,62 @@
+#ifndef __quadruped_walkgen_contact_mask_hpp__
+#define __quadruped_walkgen_contact_mask_hpp__
+
+#include <Eigen/Core>
+
+#ifdef QUADRUPED_WALKGEN_WITH_CODEGEN
+#include <cppad/cppad.hpp>
+#endif
+
+namespace quadruped_walkgen {
+
+// The 4 feet give 16 contact patterns, numbered by the mask whose bit i is set
+// when the foot i is in contact (S(i) != 0 in update_model). The models keep
+// one instantiation of their calc and calcDiff kernels per mask, in which the
+// feet in swing phase are removed at compile time from the dynamics and the
+// costs. update_model selects the kernels of the current mask once, calc and
+// calcDiff call them through a member function pointer.
+template <typename Scalar>
+struct ContactMaskTpl {
+  // Mask of the contact status S (4x1)
+  template <typename Derived>
+  static int from_gait(const Eigen::MatrixBase<Derived>& S) {
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+      if (S(i) != Scalar(0.)) {
+        mask |= 1 << i;
+      }
+    }
+    return mask;
+  }
+};
+
+#ifdef QUADRUPED_WALKGEN_WITH_CODEGEN
+// The contact status is a parameter of the generated code, which has to hold
+// for every gait : the kernels of the full mask are recorded, the feet in
+// swing phase are cancelled by the products with gait(i).
+template <typename Base>
+struct ContactMaskTpl<CppAD::AD<Base> > {
+  template <typename Derived>
+  static int from_gait(const Eigen::MatrixBase<Derived>&) {
+    return 15;
+  }
+};
+#endif
+
+}  // namespace quadruped_walkgen
+
+// The 16 instantiations of the member function template Kernel of Class,
+// indexed by the mask, to initialize the table of the kernels
+#define QUADRUPED_WALKGEN_CONTACT_KERNELS(Class, Kernel)                   \
+  {                                                                        \
+    &Class::template Kernel<0>, &Class::template Kernel<1>,                \
+        &Class::template Kernel<2>, &Class::template Kernel<3>,            \
+        &Class::template Kernel<4>, &Class::template Kernel<5>,            \
+        &Class::template Kernel<6>, &Class::template Kernel<7>,            \
+        &Class::template Kernel<8>, &Class::template Kernel<9>,            \
+        &Class::template Kernel<10>, &Class::template Kernel<11>,          \
+        &Class::template Kernel<12>, &Class::template Kernel<13>,          \
+        &Class::template Kernel<14>, &Class::template Kernel<15>           \
+  }
+
+#endif
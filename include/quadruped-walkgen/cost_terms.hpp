@@ -0,0 +1,99 @@
+#ifndef __quadruped_walkgen_cost_terms_hpp__
+#define __quadruped_walkgen_cost_terms_hpp__
+
+#include <Eigen/Core>
+#include <atomic>
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+
+namespace quadruped_walkgen {
+
+// Terms of the costs of the models. When the recording is enabled, calc
+// writes the terms of the node in the cost_terms vector of the data, the terms
+// that the model does not have are 0 and the sum of the vector is the cost :
+//   State         0.5 ||state_weights * (x - xref)||^2 (times dt for the
+//                 augmented time model)
+//   Force         0.5 ||force_weights * (u - uref)||^2 (same)
+//   Friction      friction pyramids of the feet in contact
+//   Shoulder      height of the shoulders above the feet in contact
+//   Heuristic     feet around their heuristic or shoulder position
+//   Stop          feet around their position at the end of the flying phase
+//   Step          length of the steps, command of the step models
+//   Period        period of the gait, reference and bounds of dt
+//   Acceleration  limit on the acceleration of the feet trajectories
+//   Velocity      limit on the velocity of the feet trajectories
+//   Jerk          jerk of the feet trajectories
+struct CostTerm {
+  enum Index {
+    State = 0,
+    Force,
+    Friction,
+    Shoulder,
+    Heuristic,
+    Stop,
+    Step,
+    Period,
+    Acceleration,
+    Velocity,
+    Jerk,
+    Size
+  };
+};
+
+// Part of the data of the models holding the recorded terms
+template <typename _Scalar>
+struct CostTermsDataTpl {
+  typedef _Scalar Scalar;
+  typedef Eigen::Matrix<Scalar, CostTerm::Size, 1> VectorTerms;
+
+  CostTermsDataTpl() { cost_terms.setZero(); }
+
+  VectorTerms cost_terms;  // Last terms recorded by calc
+};
+
+// Runtime switch of the recording, shared by all the models and disabled by
+// default. Production solves only pay for the test of the switch in calc.
+// It can be toggled while the nodes are evaluated by other threads, the
+// relaxed accesses only guarantee that each calc sees one of the values.
+inline std::atomic<bool>& cost_terms_switch() {
+  static std::atomic<bool> enabled(false);
+  return enabled;
+}
+
+inline bool get_log_cost_terms() {
+  return cost_terms_switch().load(std::memory_order_relaxed);
+}
+
+inline void set_log_cost_terms(const bool enabled) {
+  cost_terms_switch().store(enabled, std::memory_order_relaxed);
+}
+
+// Terms of the nodes of a problem, one row per node and the terminal node
+// last. The rows of the nodes whose data do not record the terms (models of
+// crocoddyl, generated code) are 0.
+template <typename Scalar>
+Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> get_cost_terms(
+    const crocoddyl::ShootingProblemTpl<Scalar>& problem) {
+  typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
+  const std::vector<boost::shared_ptr<ActionDataAbstract> >& datas =
+      problem.get_runningDatas();
+  const std::size_t T = datas.size();
+
+  Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> terms =
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
+          T + 1, CostTerm::Size);
+  for (std::size_t t = 0; t <= T; ++t) {
+    const ActionDataAbstract* data =
+        t < T ? datas[t].get() : problem.get_terminalData().get();
+    const CostTermsDataTpl<Scalar>* d =
+        dynamic_cast<const CostTermsDataTpl<Scalar>*>(data);
+    if (d != NULL) {
+      terms.row(t) = d->cost_terms.transpose();
+    }
+  }
+  return terms;
+}
+
+}  // namespace quadruped_walkgen
+
+#endif
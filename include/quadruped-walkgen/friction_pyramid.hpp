@@ -0,0 +1,84 @@
+#ifndef __quadruped_walkgen_friction_pyramid_hpp__
+#define __quadruped_walkgen_friction_pyramid_hpp__
+
+#include <Eigen/Core>
+
+#include "quadruped-walkgen/conditional.hpp"
+
+namespace quadruped_walkgen {
+
+// Penalty on the friction pyramids of the 4 feet, shared by the models whose
+// command u = [f1, ..., f4] holds the contact forces. Each foot has 6 faces :
+//   fx - mu fz, -fx - mu fz, fy - mu fz, -fy - mu fz, -fz, fz <= ub
+// and the cost is 0.5 * ||max(residual, 0)||^2. The faces are stored as 4x6
+// matrices, column k holds the face k of the 4 feet, so that every operation
+// is done on the 4 feet at once.
+template <typename _Scalar>
+struct FrictionPyramidTpl {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef _Scalar Scalar;
+  typedef ConditionalTpl<Scalar> Conditional;
+  typedef Eigen::Matrix<Scalar, 4, 1> VectorFeet;
+  typedef Eigen::Matrix<Scalar, 4, 6> MatrixFaces;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorXs;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixXs;
+  typedef Eigen::Map<const VectorFeet, 0, Eigen::InnerStride<3> > ForcesAxis;
+  typedef Eigen::Map<VectorFeet, 0, Eigen::InnerStride<3> > GradientAxis;
+
+  FrictionPyramidTpl() {
+    rub.setZero();
+    active.setZero();
+  }
+
+  // Residuals of the faces for the forces u (12) and the bounds ub, returns
+  // the unweighted cost
+  Scalar calc(const Eigen::Ref<const VectorXs>& u, const Scalar& mu,
+              const MatrixFaces& ub) {
+    const ForcesAxis fx(u.data()), fy(u.data() + 1), fz(u.data() + 2);
+    const VectorFeet mu_fz = mu * fz;
+    rub.col(0) = fx - mu_fz;
+    rub.col(1) = -fx - mu_fz;
+    rub.col(2) = fy - mu_fz;
+    rub.col(3) = -fy - mu_fz;
+    rub.col(4) = -fz;
+    rub.col(5) = fz;
+    rub -= ub;
+    active = Conditional::nonnegative(rub);
+    rub = Conditional::positive_part(rub);
+    return Scalar(0.5) * rub.squaredNorm();
+  }
+
+  // Gradient and Gauss-Newton hessian of weight * cost with respect to u, from
+  // the residuals of the last calc. Lu (12) is overwritten, as the 3x3
+  // diagonal blocks of Luu (12x12), the other blocks are left unchanged.
+  void calcDiff(const Scalar& weight, const Scalar& mu,
+                Eigen::Ref<VectorXs> Lu, Eigen::Ref<MatrixXs> Luu) const {
+    const MatrixFaces r = weight * rub;
+    GradientAxis(Lu.data()) = r.col(0) - r.col(1);
+    GradientAxis(Lu.data() + 1) = r.col(2) - r.col(3);
+    GradientAxis(Lu.data() + 2) =
+        -mu * (r.col(0) + r.col(1) + r.col(2) + r.col(3)) - r.col(4) +
+        r.col(5);
+
+    const MatrixFaces a = weight * active;
+    const VectorFeet h_xx = a.col(0) + a.col(1);
+    const VectorFeet h_yy = a.col(2) + a.col(3);
+    const VectorFeet h_xz = mu * (a.col(1) - a.col(0));
+    const VectorFeet h_yz = mu * (a.col(3) - a.col(2));
+    const VectorFeet h_zz =
+        mu * mu * (a.col(0) + a.col(1) + a.col(2) + a.col(3)) + a.col(4) +
+        a.col(5);
+    for (int i = 0; i < 4; ++i) {
+      Luu.template block<3, 3>(3 * i, 3 * i) << h_xx(i), Scalar(0.), h_xz(i),
+          Scalar(0.), h_yy(i), h_yz(i), h_xz(i), h_yz(i), h_zz(i);
+    }
+  }
+
+  MatrixFaces rub;     // max(residual, 0)
+  MatrixFaces active;  // 1 on the active faces, 0 otherwise
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
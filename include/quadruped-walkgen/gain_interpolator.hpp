@@ -0,0 +1,78 @@
+#ifndef __quadruped_walkgen_gain_interpolator_hpp__
+#define __quadruped_walkgen_gain_interpolator_hpp__
+
+#include <vector>
+
+#include "crocoddyl/core/solvers/ddp.hpp"
+#include "quadruped-walkgen/mpc_pipeline.hpp"
+
+namespace quadruped_walkgen {
+
+// Feedback controller of the low-level loop between two solves of the MPC.
+// It keeps the last solution of the quadruped horizon (xs, us and the gains
+// K of the DDP) and, at time t since the first node, returns
+//   u = us(t) - K(t) (x - xs(t))
+// with the sign convention of crocoddyl. The node is k = floor(t / dt) and
+// the trajectories are interpolated linearly within the node : xs(t)
+// between xs[k] and xs[k + 1], us(t) and K(t) between the nodes k and k + 1
+// (or held on node k, as in the discrete model, with set_interpolate(false)).
+// After the horizon, the end of the last node is held.
+//
+// The solution is copied in fixed-size storage allocated by the
+// constructor, set_solution and compute do not allocate and compute does
+// not throw, so they can be called from a real-time thread.
+class GainInterpolator {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<double, 12, 12> Matrix12;
+  typedef Eigen::Matrix<double, 12, 1> Vector12;
+  typedef std::vector<Matrix12, Eigen::aligned_allocator<Matrix12> >
+      StdVecMatrix12;
+  typedef std::vector<Vector12, Eigen::aligned_allocator<Vector12> >
+      StdVecVector12;
+
+  explicit GainInterpolator(const std::size_t N = 16, const double dt = 0.02);
+  ~GainInterpolator();
+
+  // Copy a solution of N nodes, xs has N + 1 states, us and K have N
+  // elements of dimension 12 and 12x12. Throws without changing the current
+  // solution if one of them has another size.
+  void set_solution(
+      const std::vector<Eigen::VectorXd>& xs,
+      const std::vector<Eigen::VectorXd>& us,
+      const std::vector<crocoddyl::SolverDDP::MatrixXdRowMajor>& K);
+  void set_solution(const MpcSolution& solution);
+
+  // Control for the state x at time t [s] since the first node
+  const Vector12& compute(const Eigen::Ref<const Vector12>& x, const double t);
+
+  // Interpolated reference state of the last compute
+  const Vector12& get_xref() const;
+
+  const bool& get_interpolate() const;
+  void set_interpolate(const bool& interpolate);
+
+  // Cycle of the last MpcSolution, 0 for a solution given as xs, us, K
+  std::size_t get_cycle() const;
+  std::size_t get_N() const;
+  const double& get_dt() const;
+
+ protected:
+  std::size_t N_;
+  double dt_;
+  bool interpolate_;
+  std::size_t cycle_;
+
+  StdVecVector12 xs_;
+  StdVecVector12 us_;
+  StdVecMatrix12 K_;
+
+  Vector12 xref_;
+  Vector12 dx_;
+  Vector12 u_;
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef __quadruped_walkgen_gait_problem_builder_hpp__
+#define __quadruped_walkgen_gait_problem_builder_hpp__
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "quadruped-walkgen/quadruped.hpp"
+
+namespace quadruped_walkgen {
+
+// Update all the ActionModelQuadruped of a shooting problem from the
+// footsteps of the gait, in one call.
+//   fsteps : nx13, [nb of nodes, x1, y1, z1, ... x4, y4, z4] for each phase,
+//            NaN (or 0) for the feet in swing phase, the phases are read
+//            until the first row with 0 nodes
+//   gait   : nx5, [nb of nodes, S1, S2, S3, S4], decoded from fsteps if not
+//            given
+//   xref   : 12x(N+1), the first column is the current state
+// Node k is updated with column k+1 of xref, the terminal node with the last
+// column and the last phase.
+class GaitProblemBuilder {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  explicit GaitProblemBuilder(
+      boost::shared_ptr<crocoddyl::ShootingProblem> problem);
+  ~GaitProblemBuilder();
+
+  // Decode the gait matrix from fsteps and update the models
+  void update(const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+              const Eigen::Ref<const Eigen::MatrixXd>& xref);
+
+  // Update the models from a given gait matrix
+  void update(const Eigen::Ref<const Eigen::MatrixXd>& gait,
+              const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+              const Eigen::Ref<const Eigen::MatrixXd>& xref);
+
+  // Gait matrix of the footsteps (a foot is in contact if its x position is
+  // neither NaN nor 0)
+  static Eigen::MatrixXd gait_from_fsteps(
+      const Eigen::Ref<const Eigen::MatrixXd>& fsteps);
+
+  const boost::shared_ptr<crocoddyl::ShootingProblem>& get_problem() const;
+  const Eigen::MatrixXd& get_gait() const;    // Last gait matrix
+  const Eigen::MatrixXd& get_fsteps() const;  // Last fsteps, NaN set to 0
+
+ protected:
+  // Model of node k (k = T for the terminal node), throws if it is not an
+  // ActionModelQuadruped
+  ActionModelQuadruped& get_quadruped_model(const std::size_t k) const;
+
+  boost::shared_ptr<crocoddyl::ShootingProblem> problem_;
+  Eigen::MatrixXd gait_;
+  Eigen::MatrixXd fsteps_;
+  Eigen::Matrix<double, 3, 4> l_feet_;
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
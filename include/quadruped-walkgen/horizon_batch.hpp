@@ -0,0 +1,93 @@
+#ifndef __quadruped_walkgen_horizon_batch_hpp__
+#define __quadruped_walkgen_horizon_batch_hpp__
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "quadruped-walkgen/quadruped.hpp"
+
+namespace quadruped_walkgen {
+
+// calc and calcDiff of a shooting problem whose running nodes are all
+// ActionModelQuadruped, without the virtual calls and the checks of each node.
+// The parameters and the evaluation of the nodes are stored with one column
+// per node (xref of node k in xref_.col(k) ...), so that the residuals and
+// their derivatives are computed with element-wise operations over the whole
+// horizon. The terms that mix the components of a node (shoulders, dynamics,
+// friction pyramids) are then evaluated node by node with fixed-size
+// operations, and written in the data of the problem as ShootingProblem::calc
+// and calcDiff do.
+// The parameters of node k are read again when its version changes (after
+// update_model or a setter), or when the problem holds another model or data
+// for it (after ShootingProblem::circularAppend or updateModel, as done by
+// RecedingHorizonQuadruped), there is no need to notify the batch.
+class HorizonQuadrupedBatch {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<double, 12, Eigen::Dynamic> Matrix12N;
+
+  explicit HorizonQuadrupedBatch(
+      boost::shared_ptr<crocoddyl::ShootingProblem> problem);
+  ~HorizonQuadrupedBatch();
+
+  // Same as ShootingProblem::calc, returns the total cost
+  double calc(const std::vector<Eigen::VectorXd>& xs,
+              const std::vector<Eigen::VectorXd>& us);
+
+  // Same as ShootingProblem::calcDiff, calc has to be called first with the
+  // same xs and us
+  void calcDiff(const std::vector<Eigen::VectorXd>& xs,
+                const std::vector<Eigen::VectorXd>& us);
+
+  const boost::shared_ptr<crocoddyl::ShootingProblem>& get_problem() const;
+
+ private:
+  void check_inputs(const std::vector<Eigen::VectorXd>& xs,
+                    const std::vector<Eigen::VectorXd>& us) const;
+
+  // Read the models and the data of the nodes from the problem, the nodes
+  // whose model or data changed are read again by calc. Returns true if one
+  // changed.
+  bool update_nodes();
+
+  // Copy the parameters of node k in the columns k
+  void update_node(const std::size_t k);
+
+  boost::shared_ptr<crocoddyl::ShootingProblem> problem_;
+  std::vector<ActionModelQuadruped*> models_;
+  std::vector<ActionDataQuadruped*> datas_;
+  std::vector<std::size_t> versions_;  // 0 : parameters not read yet
+
+  // Parameters of the nodes
+  Matrix12N xref_;
+  Matrix12N uref_;
+  Matrix12N state_weights_;
+  Matrix12N force_weights_;
+  Matrix12N force_weights2_;  // Squared force weights, diagonal of Luu
+  Eigen::RowVectorXd dt_;  // A is the identity with dt on its top right
+  Matrix12N g_;
+  Eigen::Matrix<double, 6, Eigen::Dynamic> B_;  // Bottom 6x12 block of B
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> implicit_;
+  Eigen::RowVectorXd friction_weight_;
+  Eigen::RowVectorXd sh_weight_;
+  Eigen::RowVectorXd sh_hlim2_;  // Squared shoulder height limit
+  Eigen::Matrix<double, 3, Eigen::Dynamic> offset_com_;
+  // (x, y) of the shoulders and of the feet, foot i in rows 2i, 2i+1
+  Eigen::Matrix<double, 8, Eigen::Dynamic> pshoulder_;
+  Eigen::Matrix<double, 8, Eigen::Dynamic> lever_arms_;
+  Eigen::Matrix<bool, 4, Eigen::Dynamic> contact_;
+  Eigen::RowVectorXd mu_;
+  Eigen::Matrix<double, 4, Eigen::Dynamic> ub_;  // Node k in columns 6k-6k+5
+
+  // Evaluation of the nodes, kept from calc to calcDiff
+  Matrix12N X_;
+  Matrix12N U_;
+  Eigen::Matrix<double, 24, Eigen::Dynamic> r_;
+
+  // Work space of calcDiff
+  Matrix12N Lx_;
+  Matrix12N Lu_;  // Without the friction cone
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
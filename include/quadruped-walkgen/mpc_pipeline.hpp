@@ -0,0 +1,128 @@
+#ifndef __quadruped_walkgen_mpc_pipeline_hpp__
+#define __quadruped_walkgen_mpc_pipeline_hpp__
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "quadruped-walkgen/receding_horizon.hpp"
+#include "quadruped-walkgen/solver_deadline.hpp"
+#include "quadruped-walkgen/triple_buffer.hpp"
+
+namespace quadruped_walkgen {
+
+// Solution of a cycle of the MPC, as read by the low-level controller :
+//   u(x) = us[k] - K[k] (x - xs[k]) at node k
+struct MpcSolution {
+  std::size_t cycle;  // Cycle of the solve, 0 before the first solution
+  std::vector<Eigen::VectorXd> xs;
+  std::vector<Eigen::VectorXd> us;
+  std::vector<crocoddyl::SolverDDP::MatrixXdRowMajor> K;
+  double cost;
+  std::size_t iter;  // Iterations of the solver
+  bool converged;
+};
+
+// Double-buffered MPC of the quadruped. Two receding horizons, each with its
+// models, data and solver, are used in turn : while a worker thread solves
+// the horizon of the current cycle, the planner thread updates the models
+// of the other horizon for the next cycle, so that update_model does not
+// add to the latency of the solve. A cycle of the planner thread is
+//
+//   pipeline.prepare(gait, fsteps, xref);  // next cycle, while solving
+//   ... wait for the measured state ...
+//   pipeline.start(x0);                    // solve the prepared horizon
+//
+// start waits for the previous solve, warm starts the prepared horizon from
+// its solution and hands it to the worker. Each solution is published in a
+// TripleBuffer, read without lock nor wait by the control thread with read.
+// The planner and the worker are synchronised by a mutex, the control
+// thread is not.
+//
+// The solver is SolverDeadlineQuadrupedDDP, the budget is applied to each
+// solve. The first column of xref is ignored, the initial state is given to
+// start.
+class MpcPipelineQuadruped {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  MpcPipelineQuadruped(const Eigen::Ref<const Eigen::VectorXd>& x0,
+                       const std::size_t N = 16);
+  ~MpcPipelineQuadruped();
+
+  // Planner thread : update the models of the idle horizon for the next
+  // cycle, one node after the previous call (same format as
+  // RecedingHorizonQuadruped::update). Returns the number of calls to
+  // update_model.
+  std::size_t prepare(const Eigen::Ref<const Eigen::MatrixXd>& gait,
+                      const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+                      const Eigen::Ref<const Eigen::MatrixXd>& xref);
+
+  // Planner thread : wait for the running solve, then solve the prepared
+  // horizon from x0 in the worker thread, with at most maxiter iterations
+  void start(const Eigen::Ref<const Eigen::VectorXd>& x0,
+             const std::size_t maxiter = 1);
+
+  // Planner thread : wait for the running solve. An exception thrown by the
+  // solve is thrown again here (and by start).
+  void wait();
+
+  // True while the worker is solving
+  bool is_busy() const;
+
+  // Control thread : last published solution. The reference is valid until
+  // the next call to read.
+  const MpcSolution& read();
+
+  // Budget of each solve [ms], infinite by default
+  double get_budget() const;
+  void set_budget(const double& budget);
+
+  std::size_t get_N() const;
+
+  // Horizon and solver of buffer i (0 or 1), only to be used while the
+  // worker is idle
+  const RecedingHorizonQuadruped& get_horizon(const std::size_t i) const;
+  const SolverDeadlineQuadrupedDDP& get_solver(const std::size_t i) const;
+
+ protected:
+  struct Buffer {
+    boost::shared_ptr<RecedingHorizonQuadruped> horizon;
+    boost::shared_ptr<SolverDeadlineQuadrupedDDP> solver;
+    std::size_t cycle;  // Cycle of the last prepare, 0 if never prepared
+  };
+
+  // Worker thread
+  void run();
+  void solve(Buffer& buffer);
+
+  // Wait for the running solve, the lock is on mutex_
+  void wait(std::unique_lock<std::mutex>& lock);
+
+  std::size_t N_;
+  Buffer buffers_[2];
+  std::size_t idle_;   // Buffer prepared by the planner thread
+  std::size_t cycle_;  // Cycle of the last prepare
+  std::size_t maxiter_;
+
+  // Warm start shifted from the last solution
+  std::vector<Eigen::VectorXd> xs_warm_;
+  std::vector<Eigen::VectorXd> us_warm_;
+  std::size_t solved_;  // Buffer of the last solve, 2 if none
+
+  TripleBuffer<MpcSolution> solution_;
+
+  std::thread worker_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::size_t job_;  // Buffer to solve, 2 if none
+  bool busy_;
+  bool stop_;
+  std::exception_ptr error_;
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
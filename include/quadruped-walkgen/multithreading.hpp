@@ -0,0 +1,27 @@
+#ifndef __quadruped_walkgen_multithreading_hpp__
+#define __quadruped_walkgen_multithreading_hpp__
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+
+namespace quadruped_walkgen {
+
+// Give the number of threads of the build (cmake options
+// BUILD_WITH_MULTITHREADS and BUILD_WITH_NTHREADS) to a shooting problem,
+// which then evaluates its nodes in parallel in calc and calcDiff. A number
+// of threads already set above 1 is kept. Called on the problems built or
+// given to RecedingHorizonQuadruped, GaitProblemBuilder and
+// SolverQuadrupedDDP, does nothing without multithreading.
+template <typename Scalar>
+void set_default_nthreads(crocoddyl::ShootingProblemTpl<Scalar>& problem) {
+#ifdef QUADRUPED_WALKGEN_WITH_MULTITHREADING
+  if (problem.get_nthreads() <= 1) {
+    problem.set_nthreads(QUADRUPED_WALKGEN_WITH_NTHREADS);
+  }
+#else
+  (void)problem;
+#endif
+}
+
+}  // namespace quadruped_walkgen
+
+#endif
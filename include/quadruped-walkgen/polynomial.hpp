@@ -0,0 +1,153 @@
+#ifndef __quadruped_walkgen_polynomial_hpp__
+#define __quadruped_walkgen_polynomial_hpp__
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+
+namespace quadruped_walkgen {
+
+// Polynomials of degree at most 4 over the normalized time t in [0, 1],
+// c(t) = c0 + c1 t + ... + c4 t^4. Used to evaluate the swing trajectories of
+// the feet. The roots are found without allocation, in closed form up to the
+// degree 2. Above, the roots of the derivative split [0, 1] into intervals
+// where the polynomial is monotonic, each of them holds at most one root found
+// by a safeguarded Newton method.
+template <typename Scalar>
+struct PolynomialTpl {
+  enum { MaxDegree = 4 };
+  typedef Eigen::Matrix<Scalar, MaxDegree + 1, 1> Coefficients;
+
+  static Scalar value(const Coefficients& c, const int& degree,
+                      const Scalar& t) {
+    Scalar v = c(degree);
+    for (int k = degree - 1; k >= 0; --k) {
+      v = v * t + c(k);
+    }
+    return v;
+  }
+
+  static Coefficients derivative(const Coefficients& c, const int& degree) {
+    Coefficients dc = Coefficients::Zero();
+    for (int k = 1; k <= degree; ++k) {
+      dc(k - 1) = Scalar(k) * c(k);
+    }
+    return dc;
+  }
+
+  // Roots of c in the open interval (0, 1), in increasing order. Returns the
+  // number of roots written in roots (at most degree).
+  static int roots(const Coefficients& c, int degree, Scalar* roots) {
+    while (degree > 0 && c(degree) == Scalar(0.)) {
+      --degree;
+    }
+    if (degree == 0) {
+      return 0;
+    }
+    if (degree == 1) {
+      const Scalar t = -c(0) / c(1);
+      if (t > Scalar(0.) && t < Scalar(1.)) {
+        roots[0] = t;
+        return 1;
+      }
+      return 0;
+    }
+    if (degree == 2) {
+      const Scalar delta = c(1) * c(1) - 4 * c(2) * c(0);
+      if (delta < Scalar(0.)) {
+        return 0;
+      }
+      // Stable form of the two roots
+      const Scalar q = c(1) < Scalar(0.)
+                           ? Scalar(-0.5) * (c(1) - std::sqrt(delta))
+                           : Scalar(-0.5) * (c(1) + std::sqrt(delta));
+      Scalar t[2] = {q / c(2), q != Scalar(0.) ? c(0) / q : q / c(2)};
+      if (t[1] < t[0]) {
+        std::swap(t[0], t[1]);
+      }
+      int n = 0;
+      for (int i = 0; i < 2; ++i) {
+        if (t[i] > Scalar(0.) && t[i] < Scalar(1.)) {
+          roots[n++] = t[i];
+        }
+      }
+      return n;
+    }
+
+    const Coefficients dc = derivative(c, degree);
+    Scalar bounds[MaxDegree + 1];
+    bounds[0] = Scalar(0.);
+    const int n_critical = PolynomialTpl::roots(dc, degree - 1, bounds + 1);
+    bounds[n_critical + 1] = Scalar(1.);
+
+    int n = 0;
+    for (int i = 0; i <= n_critical; ++i) {
+      Scalar lo = bounds[i], hi = bounds[i + 1];
+      const Scalar f_lo = value(c, degree, lo);
+      const Scalar f_hi = value(c, degree, hi);
+      if (f_hi == Scalar(0.) && i < n_critical) {
+        roots[n++] = hi;  // Multiple root on a critical point
+        continue;
+      }
+      if ((f_lo < Scalar(0.)) == (f_hi < Scalar(0.)) || f_lo == Scalar(0.)) {
+        continue;
+      }
+      // c is monotonic on [lo, hi] and changes of sign
+      Scalar t = Scalar(0.5) * (lo + hi);
+      for (int it = 0; it < 50; ++it) {
+        const Scalar f = value(c, degree, t);
+        if (f == Scalar(0.)) {
+          break;
+        }
+        if ((f < Scalar(0.)) == (f_lo < Scalar(0.))) {
+          lo = t;
+        } else {
+          hi = t;
+        }
+        const Scalar df = value(dc, degree - 1, t);
+        Scalar t_next = t - f / df;
+        if (!(t_next > lo && t_next < hi)) {
+          t_next = Scalar(0.5) * (lo + hi);
+        }
+        const bool converged =
+            std::abs(t_next - t) <
+            Eigen::NumTraits<Scalar>::dummy_precision();
+        t = t_next;
+        if (converged) {
+          break;
+        }
+      }
+      roots[n++] = t;
+    }
+    return n;
+  }
+
+  // Times of the minimum and maximum of c over (0, 1], among its critical
+  // points and the final time. The initial time is left out, the trajectories
+  // start from the current state of the feet that cannot be changed.
+  static void extrema(const Coefficients& c, const int& degree, Scalar& t_min,
+                      Scalar& t_max) {
+    Scalar critical[MaxDegree];
+    const int n_critical = roots(derivative(c, degree), degree - 1, critical);
+
+    t_min = Scalar(1.);
+    t_max = Scalar(1.);
+    Scalar v_min = value(c, degree, Scalar(1.));
+    Scalar v_max = v_min;
+    for (int i = 0; i < n_critical; ++i) {
+      const Scalar v = value(c, degree, critical[i]);
+      if (v < v_min) {
+        v_min = v;
+        t_min = critical[i];
+      }
+      if (v > v_max) {
+        v_max = v;
+        t_max = critical[i];
+      }
+    }
+  }
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
@@ -7,8 +7,17 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/conditional.hpp"
+#include "quadruped-walkgen/contact_mask.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/friction_pyramid.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
+template <typename _Scalar>
+struct ActionDataQuadrupedTpl;
+class HorizonQuadrupedBatch;
+
 template <typename _Scalar>
 class ActionModelQuadrupedTpl
     : public crocoddyl::ActionModelAbstractTpl<_Scalar> {
@@ -17,6 +26,7 @@ class ActionModelQuadrupedTpl
   typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
   typedef crocoddyl::ActionModelAbstractTpl<Scalar> Base;
   typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
+  typedef ConditionalTpl<Scalar> Conditional;
 
   ActionModelQuadrupedTpl(typename Eigen::Matrix<Scalar, 3, 1> offset_CoM =
                               Eigen::Matrix<Scalar, 3, 1>::Zero());
@@ -77,9 +87,37 @@ class ActionModelQuadrupedTpl
                     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
                     const Eigen::Ref<const typename MathBase::MatrixXs>& S);
 
-  // Get A & B matrix
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_A() const;
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_B() const;
+  // Update the reference state only, the footholds and the contact status
+  // are the ones of the last update_model. Only the rows of B of the angular
+  // velocity, which depend on the position and the yaw of the reference, are
+  // rebuilt, and only if they changed.
+  void update_reference(
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref);
+
+  // Update the models of a whole horizon in one call : node k is updated with
+  // the columns 4k to 4k+3 of l_feet (3x4N), and the column k of xref (12xN)
+  // and S (4xN).
+  static void update_models(
+      const std::vector<boost::shared_ptr<ActionModelQuadrupedTpl> >& models,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& S);
+
+  // Contact status of the feet set by update_model (1 : foot in contact)
+  const typename Eigen::Matrix<Scalar, 4, 1>& get_gait() const;
+
+  // Get A & B matrix, built from the compact storage of the model
+  typename Eigen::Matrix<Scalar, 12, 12> get_A() const;
+  typename Eigen::Matrix<Scalar, 12, 12> get_B() const;
+  const typename Eigen::Matrix<Scalar, 12, 1>& get_g() const;
+
+  // References set by update_model for the state and the forces
+  const typename Eigen::Matrix<Scalar, 12, 1>& get_xref() const;
+  const typename Eigen::Matrix<Scalar, 12, 1>& get_uref() const;
+
+  // Incremented by update_model and by the setters, the data use it to know
+  // when the constant derivative blocks have to be rebuilt
+  const std::size_t& get_version() const;
 
  protected:
   using Base::has_control_limits_;  //!< Indicates whether any of the control
@@ -92,6 +130,53 @@ class ActionModelQuadrupedTpl
   using Base::unone_;               //!< Neutral state
 
  private:
+  // Reads the parameters of the nodes and uses the helpers below
+  friend class HorizonQuadrupedBatch;
+
+  // update_model without the checks, c and s are the cos and sin of the yaw
+  // of the reference
+  void update_model_yaw(
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& S, const Scalar& c,
+      const Scalar& s);
+
+  // Rows of B of the angular velocity for the lever arms, the contact status
+  // and the reference xref_, c and s are the cos and sin of its yaw
+  void update_angular_dynamics(const Scalar& c, const Scalar& s);
+
+  typedef void (ActionModelQuadrupedTpl::*Kernel)(
+      ActionDataQuadrupedTpl<Scalar>* d,
+      const Eigen::Ref<const typename MathBase::VectorXs>& x,
+      const Eigen::Ref<const typename MathBase::VectorXs>& u) const;
+
+  // calc and calcDiff for the contact mask Mask, see contact_mask.hpp
+  template <int Mask>
+  void calc_kernel(ActionDataQuadrupedTpl<Scalar>* d,
+                   const Eigen::Ref<const typename MathBase::VectorXs>& x,
+                   const Eigen::Ref<const typename MathBase::VectorXs>& u)
+      const;
+  template <int Mask>
+  void calc_diff_kernel(
+      ActionDataQuadrupedTpl<Scalar>* d,
+      const Eigen::Ref<const typename MathBase::VectorXs>& x,
+      const Eigen::Ref<const typename MathBase::VectorXs>& u) const;
+
+  // Selects the kernels of the contact mask of gait
+  void select_kernels();
+
+  // Rebuilds Fx and Fu if d is outdated with respect to the version of the
+  // model, returns true if it was
+  bool update_dynamics_derivatives(ActionDataQuadrupedTpl<Scalar>* d) const;
+
+  // Rebuilds Lxx for the active shoulder constraints sh_active
+  void update_state_hessian(
+      ActionDataQuadrupedTpl<Scalar>* d,
+      const Eigen::Matrix<Scalar, 4, 1>& sh_active) const;
+
+  // Records the cost terms of the last calc in d, see cost_terms.hpp
+  void record_cost_terms(ActionDataQuadrupedTpl<Scalar>* d) const;
+
   Scalar dt_;
   Scalar mass;
   Scalar mu;
@@ -106,37 +191,35 @@ class ActionModelQuadrupedTpl
   typename Eigen::Matrix<Scalar, 12, 1> force_weights_;
   typename Eigen::Matrix<Scalar, 12, 1> state_weights_;
 
-  typename Eigen::Matrix<Scalar, 12, 12> A;
-  typename Eigen::Matrix<Scalar, 12, 12> B;
+  // A is the identity with dt on the diagonal of its top right 6x6 block, it
+  // is not stored. The first 6 rows of B are 0, only the last 6 are stored.
+  typename Eigen::Matrix<Scalar, 6, 12> B;
   typename Eigen::Matrix<Scalar, 12, 1> g;
-  typename Eigen::Matrix<Scalar, 3, 3> I_inv;
-  typename MathBase::Matrix3s R_tmp;
   typename Eigen::Matrix<Scalar, 3, 3> gI;
+  typename Eigen::Matrix<Scalar, 3, 3> gI_inv;  // Inverse of gI
 
   typename Eigen::Matrix<Scalar, 3, 4> lever_arms;
-  typename MathBase::Vector3s lever_tmp;
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
 
-  typename Eigen::Matrix<Scalar, 24, 1> ub;
-
-  typename Eigen::Matrix<Scalar, 24, 1> Fa_x_u;
-  typename Eigen::Matrix<Scalar, 24, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 24, 24> Arr;
-  typename Eigen::Matrix<Scalar, 6, 1> r;
+  typename FrictionPyramidTpl<Scalar>::MatrixFaces ub;
 
   // Cost relative to the shoulder height
   typename Eigen::Matrix<Scalar, 2, 4> pshoulder_0;
-  typename Eigen::Matrix<Scalar, 3, 4> psh;
-  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
   typename Eigen::Matrix<Scalar, 4, 1> gait;
   typename Eigen::Matrix<Scalar, 3, 1> offset_com;
   Scalar sh_weight;
   Scalar sh_hlim;
+
+  Kernel calc_kernel_;
+  Kernel calc_diff_kernel_;
+
+  std::size_t version_;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -155,7 +238,24 @@ struct ActionDataQuadrupedTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model), version(0) {
+    psh.setZero();
+    sh_ub_max_.setZero();
+    sh_active.setZero();
+  }
+
+  // Quantities computed in calc and reused in calcDiff, kept in the data so
+  // that the nodes of a problem can be evaluated concurrently
+  FrictionPyramidTpl<Scalar> friction;
+
+  // Cost relative to the shoulder height
+  typename Eigen::Matrix<Scalar, 3, 4> psh;
+  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
+
+  // Version of the model the derivative blocks were last built for, and
+  // active shoulder constraints
+  std::size_t version;
+  typename Eigen::Matrix<Scalar, 4, 1> sh_active;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -164,6 +264,8 @@ struct ActionDataQuadrupedTpl
 
 typedef ActionModelQuadrupedTpl<double> ActionModelQuadruped;
 typedef ActionDataQuadrupedTpl<double> ActionDataQuadruped;
+typedef ActionModelQuadrupedTpl<float> ActionModelQuadrupedFloat;
+typedef ActionDataQuadrupedTpl<float> ActionDataQuadrupedFloat;
 typedef crocoddyl::ActionModelAbstractTpl<double> ActionModelAbstract;
 typedef crocoddyl::ActionDataAbstractTpl<double> ActionDataAbstract;
 typedef crocoddyl::StateAbstractTpl<double> StateAbstract;
@@ -174,4 +276,13 @@ typedef crocoddyl::ActionDataUnicycleTpl<double> ActionDataUnicycle;
 
 #include "quadruped.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated for double and float in src/quadruped.cpp, the other
+// translation units do not compile the definitions of quadruped.hxx
+extern template class ActionModelQuadrupedTpl<double>;
+extern template struct ActionDataQuadrupedTpl<double>;
+extern template class ActionModelQuadrupedTpl<float>;
+extern template struct ActionDataQuadrupedTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
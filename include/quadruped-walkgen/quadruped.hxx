@@ -25,14 +25,13 @@ ActionModelQuadrupedTpl<Scalar>::ActionModelQuadrupedTpl(
   g[8] = Scalar(-9.81) * dt_;
   gI.setZero();
   gI.diagonal() << Scalar(3.09249e-2), Scalar(5.106100e-2), Scalar(6.939757e-2);
-  A.setIdentity();
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() * dt_;
+  gI_inv = gI.inverse();
   B.setZero();
   lever_arms.setZero();
-  I_inv.setZero();
+  xref_.setZero();
 
   // Weight vectors initialization
-  force_weights_.setConstant(0.2);
+  force_weights_.setConstant(Scalar(0.2));
   state_weights_ << Scalar(1.), Scalar(1.), Scalar(150.), Scalar(35.),
       Scalar(30.), Scalar(8.), Scalar(20.), Scalar(20.), Scalar(15.),
       Scalar(4.), Scalar(4.), Scalar(8.);
@@ -40,17 +39,7 @@ ActionModelQuadrupedTpl<Scalar>::ActionModelQuadrupedTpl(
 
   // UpperBound vector
   ub.setZero();
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz;
-  }
-
-  // Temporary vector used
-  Fa_x_u.setZero();
-  rub_max_.setZero();
-  Arr.setZero();
-  r.setZero();
-  lever_tmp.setZero();
-  R_tmp.setZero();
+  ub.col(5).setConstant(max_fz);
 
   // Used for shoulder height weight
   pshoulder_0 << Scalar(0.1946), Scalar(0.1946), Scalar(-0.1946),
@@ -58,14 +47,17 @@ ActionModelQuadrupedTpl<Scalar>::ActionModelQuadrupedTpl(
       Scalar(-0.14695);
   sh_hlim = Scalar(0.27);
   sh_weight = Scalar(10.);
-  sh_ub_max_.setZero();
-  psh.setZero();
   gait.setZero();
+  select_kernels();
 
   // Implicit integration
   // V+ = V + dt*B*u   ; P+ = P + dt*V+ != explicit : P+ = P + dt*V
   implicit_integration = true;
   offset_com = offset_CoM;  // x, y, z offset
+
+  // Incremented each time the parameters of the model change, 0 is reserved
+  // for data that have never been synchronised with the model
+  version_ = 1;
 }
 
 template <typename Scalar>
@@ -76,6 +68,7 @@ void ActionModelQuadrupedTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -89,37 +82,54 @@ void ActionModelQuadrupedTpl<Scalar>::calc(
 
   ActionDataQuadrupedTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedTpl<Scalar>*>(data.get());
+  (this->*calc_kernel_)(d, x, u);
+  if (get_log_cost_terms()) {
+    record_cost_terms(d);
+  }
+}
 
+template <typename Scalar>
+template <int Mask>
+void ActionModelQuadrupedTpl<Scalar>::calc_kernel(
+    ActionDataQuadrupedTpl<Scalar>* d,
+    const Eigen::Ref<const typename MathBase::VectorXs>& x,
+    const Eigen::Ref<const typename MathBase::VectorXs>& u) const {
+  // gait(i) is 1 for the feet of the mask, except in the full mask kernel of
+  // a batch scalar where the product cancels the lanes in swing phase
   for (int i = 0; i < 4; i = i + 1) {
-    if (gait(i, 0) != 0) {
+    if (Mask & (1 << i)) {
       // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1) << x[0] - offset_com(0, 0) + pshoulder_0(0, i) -
+      d->psh.block(0, i, 3, 1) << x[0] - offset_com(0, 0) + pshoulder_0(0, i) -
                                    pshoulder_0(1, i) * x[5] - lever_arms(0, i),
           x[1] - offset_com(1, 0) + pshoulder_0(1, i) +
               pshoulder_0(0, i) * x[5] - lever_arms(1, i),
           x[2] - offset_com(2, 0) + pshoulder_0(1, i) * x[3] -
               pshoulder_0(0, i) * x[4];
+      d->psh.block(0, i, 3, 1) *= gait(i, 0);
     } else {
       // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1).setZero();
+      d->psh.block(0, i, 3, 1).setZero();
     }
   }
 
-  // Discrete dynamic : A*x + B*u + g
-  d->xnext << A.diagonal().cwiseProduct(x) + g;
-  d->xnext.template tail<6>() =
-      d->xnext.template tail<6>() + B.block(6, 0, 6, 12) * u;
+  // Discrete dynamic : A*x + B*u + g, the columns of B of the feet in swing
+  // phase are 0 and B(6:9, 3i:3i+3) is dt / mass * Identity (B(0:3, 3i:3i+3)
+  // in the stored rows)
+  d->xnext << x + g;
+  for (int i = 0; i < 4; i = i + 1) {
+    if (Mask & (1 << i)) {
+      d->xnext.template segment<3>(6) +=
+          B(0, 3 * i) * u.template segment<3>(3 * i);
+      d->xnext.template segment<3>(9) += B.template block<3, 3>(3, 3 * i) *
+                                         u.template segment<3>(3 * i);
+    }
+  }
 
-  // Explicit : d->xnext.template head<6>() = d->xnext.template head<6>() +
-  // A.topRightCorner(6,6).diagonal().cwiseProduct(d->xnext.tail(6))   ;
+  // Explicit : P+ = P + dt*V, implicit : P+ = P + dt*V+
   if (implicit_integration) {
-    d->xnext.template head<6>() =
-        d->xnext.template head<6>() +
-        A.topRightCorner(6, 6).diagonal().cwiseProduct(d->xnext.tail(6));
+    d->xnext.template head<6>() += dt_ * d->xnext.template tail<6>();
   } else {
-    d->xnext.template head<6>() =
-        d->xnext.template head<6>() +
-        A.topRightCorner(6, 6).diagonal().cwiseProduct(x.tail(6));
+    d->xnext.template head<6>() += dt_ * x.template tail<6>();
   }
 
   // Residual cost on the state and force norm
@@ -127,28 +137,25 @@ void ActionModelQuadrupedTpl<Scalar>::calc(
   d->r.template tail<12>() = force_weights_.cwiseProduct(u - uref_);
 
   // Friction cone
+  const Scalar friction_cost = d->friction.calc(u, mu, ub);
+
+  // Shoulder height weight, 0 for the feet in swing phase
   for (int i = 0; i < 4; i = i + 1) {
-    Fa_x_u.segment(6 * i, 6) << u(3 * i) - mu * u(3 * i + 2),
-        -u(3 * i) - mu * u(3 * i + 2), u(3 * i + 1) - mu * u(3 * i + 2),
-        -u(3 * i + 1) - mu * u(3 * i + 2), -u(3 * i + 2), u(3 * i + 2);
+    d->sh_ub_max_[i] =
+        (Mask & (1 << i))
+            ? Conditional::max(
+                  d->psh.col(i).squaredNorm() - sh_hlim * sh_hlim, Scalar(0.))
+            : Scalar(0.);
   }
-  rub_max_ = (Fa_x_u - ub).cwiseMax(0.);
-
-  // Shoulder height weight
-  sh_ub_max_ << psh.block(0, 0, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 1, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 2, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 3, 3, 1).squaredNorm() - sh_hlim * sh_hlim;
-  sh_ub_max_ = sh_ub_max_.cwiseMax(Scalar(0.));
 
   // Cost computation
   // d->cost = 0.5 * d->r.transpose() * d->r     + friction_weight_ *
   // Scalar(0.5) * rub_max_.squaredNorm() + sh_weight
   // * Scalar(0.5) * sh_ub_max_.squaredNorm() ;
 
-  d->cost = 0.5 * d->r.transpose() * d->r +
-            friction_weight_ * Scalar(0.5) * rub_max_.squaredNorm() +
-            sh_weight * Scalar(0.5) * sh_ub_max_.sum();
+  d->cost = Scalar(0.5) * d->r.transpose() * d->r +
+            friction_weight_ * friction_cost +
+            sh_weight * Scalar(0.5) * d->sh_ub_max_.sum();
 }
 
 template <typename Scalar>
@@ -156,6 +163,7 @@ void ActionModelQuadrupedTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -169,77 +177,130 @@ void ActionModelQuadrupedTpl<Scalar>::calcDiff(
 
   ActionDataQuadrupedTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedTpl<Scalar>*>(data.get());
+  (this->*calc_diff_kernel_)(d, x, u);
+}
 
-  // Cost derivatives : Lx
-  d->Lx = (state_weights_.array() * d->r.template head<12>().array()).matrix();
+template <typename Scalar>
+template <int Mask>
+void ActionModelQuadrupedTpl<Scalar>::calc_diff_kernel(
+    ActionDataQuadrupedTpl<Scalar>* d,
+    const Eigen::Ref<const typename MathBase::VectorXs>&,
+    const Eigen::Ref<const typename MathBase::VectorXs>&) const {
+  // The dynamics derivatives and the constant part of the hessians only
+  // depend on the parameters of the model, they are rebuilt after a call to
+  // update_model or to a setter. Otherwise only the blocks whose active set
+  // changed since the last call are patched.
+  const bool update_constant = update_dynamics_derivatives(d);
 
-  // Hessian : Lxx
-  d->Lxx.block(0, 0, 6, 6).setZero();
-  d->Lxx.diagonal() =
-      (state_weights_.array() * state_weights_.array()).matrix();
+  // Cost derivatives : Lx, sh_active is 1 if the shoulder is above its limit
+  d->Lx = (state_weights_.array() * d->r.template head<12>().array()).matrix();
+  typename Eigen::Matrix<Scalar, 4, 1> sh_active;
   for (int j = 0; j < 4; j = j + 1) {
-    if (sh_ub_max_[j] > Scalar(0.)) {
-      d->Lx(0, 0) += sh_weight * psh(0, j);
-      d->Lx(1, 0) += sh_weight * psh(1, j);
-      d->Lx(2, 0) += sh_weight * psh(2, j);
-      d->Lx(3, 0) += sh_weight * pshoulder_0(1, j) * psh(2, j);
-      d->Lx(4, 0) += -sh_weight * pshoulder_0(0, j) * psh(2, j);
-      d->Lx(5, 0) += sh_weight * (-pshoulder_0(1, j) * psh(0, j) +
-                                  pshoulder_0(0, j) * psh(1, j));
-
-      d->Lxx(0, 0) += sh_weight;
-      d->Lxx(1, 1) += sh_weight;
-      d->Lxx(2, 2) += sh_weight;
-      d->Lxx(3, 3) += sh_weight * pshoulder_0(1, j) * pshoulder_0(1, j);
-      d->Lxx(3, 3) += sh_weight * pshoulder_0(0, j) * pshoulder_0(0, j);
-      d->Lxx(5, 5) += sh_weight * (pshoulder_0(1, j) * pshoulder_0(1, j) +
-                                   pshoulder_0(0, j) * pshoulder_0(0, j));
-
-      d->Lxx(0, 5) += -sh_weight * pshoulder_0(1, j);
-      d->Lxx(5, 0) += -sh_weight * pshoulder_0(1, j);
-
-      d->Lxx(1, 5) += sh_weight * pshoulder_0(0, j);
-      d->Lxx(5, 1) += sh_weight * pshoulder_0(0, j);
-
-      d->Lxx(2, 3) += sh_weight * pshoulder_0(1, j);
-      d->Lxx(2, 4) += -sh_weight * pshoulder_0(0, j);
-      d->Lxx(3, 2) += sh_weight * pshoulder_0(1, j);
-      d->Lxx(4, 2) += -sh_weight * pshoulder_0(0, j);
-
-      d->Lxx(3, 4) += -sh_weight * pshoulder_0(1, j) * pshoulder_0(0, j);
-      d->Lxx(4, 3) += -sh_weight * pshoulder_0(1, j) * pshoulder_0(0, j);
+    sh_active[j] = Conditional::positive(d->sh_ub_max_[j]);
+    if (!(Mask & (1 << j))) {
+      continue;
     }
+    const Scalar w = sh_weight * sh_active[j];
+    d->Lx(0, 0) += w * d->psh(0, j);
+    d->Lx(1, 0) += w * d->psh(1, j);
+    d->Lx(2, 0) += w * d->psh(2, j);
+    d->Lx(3, 0) += w * pshoulder_0(1, j) * d->psh(2, j);
+    d->Lx(4, 0) += -w * pshoulder_0(0, j) * d->psh(2, j);
+    d->Lx(5, 0) += w * (-pshoulder_0(1, j) * d->psh(0, j) +
+                        pshoulder_0(0, j) * d->psh(1, j));
   }
 
-  // Cost derivative : Lu
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * rub_max_.segment(6 * i, 6);
-    d->Lu.block(i * 3, 0, 3, 1) << r(0) - r(1), r(2) - r(3),
-        -mu * (r(0) + r(1) + r(2) + r(3)) - r(4) + r(5);
+  // Hessian : Lxx, depends on the active shoulder constraints
+  if (update_constant || sh_active != d->sh_active) {
+    update_state_hessian(d, sh_active);
   }
+
+  // Cost derivative : Lu, and the friction cone blocks of Luu
+  d->friction.calcDiff(friction_weight_, mu, d->Lu, d->Luu);
   d->Lu = d->Lu +
           (force_weights_.array() * d->r.template tail<12>().array()).matrix();
 
   // Hessian : Luu
-  // Matrix friction cone hessian (20x12)
-  Arr.diagonal() =
-      ((Fa_x_u - ub).array() >= 0.).matrix().template cast<Scalar>();
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * Arr.diagonal().segment(6 * i, 6);
-    d->Luu.block(3 * i, 3 * i, 3, 3) << r(0) + r(1), 0.0, mu * (r(1) - r(0)),
-        0.0, r(2) + r(3), mu * (r(3) - r(2)), mu * (r(1) - r(0)),
-        mu * (r(3) - r(2)), mu * mu * (r(0) + r(1) + r(2) + r(3)) + r(4) + r(5);
-  }
-  d->Luu.diagonal() =
-      d->Luu.diagonal() +
+  d->Luu.diagonal() +=
       (force_weights_.array() * force_weights_.array()).matrix();
+}
 
-  // Dynamic derivatives
-  d->Fx << A;
-  d->Fu << B;
+template <typename Scalar>
+bool ActionModelQuadrupedTpl<Scalar>::update_dynamics_derivatives(
+    ActionDataQuadrupedTpl<Scalar>* d) const {
+  if (d->version == version_) {
+    return false;
+  }
+  d->Fx.setIdentity();
+  d->Fx.topRightCorner(6, 6).diagonal().setConstant(dt_);
   if (implicit_integration) {
-    d->Fu.block(0, 0, 6, 12) << dt_ * B.block(6, 0, 6, 12);
+    d->Fu.topRows(6) = dt_ * B;
+  } else {
+    d->Fu.topRows(6).setZero();
   }
+  d->Fu.bottomRows(6) = B;
+  d->version = version_;
+  return true;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::update_state_hessian(
+    ActionDataQuadrupedTpl<Scalar>* d,
+    const Eigen::Matrix<Scalar, 4, 1>& sh_active) const {
+  d->Lxx.block(0, 0, 6, 6).setZero();
+  d->Lxx.diagonal() =
+      (state_weights_.array() * state_weights_.array()).matrix();
+  // sh_active[j] is 0 or 1, the terms of an inactive shoulder are cancelled
+  for (int j = 0; j < 4; j = j + 1) {
+    const Scalar w = sh_weight * sh_active[j];
+    d->Lxx(0, 0) += w;
+    d->Lxx(1, 1) += w;
+    d->Lxx(2, 2) += w;
+    d->Lxx(3, 3) += w * pshoulder_0(1, j) * pshoulder_0(1, j);
+    d->Lxx(3, 3) += w * pshoulder_0(0, j) * pshoulder_0(0, j);
+    d->Lxx(5, 5) += w * (pshoulder_0(1, j) * pshoulder_0(1, j) +
+                         pshoulder_0(0, j) * pshoulder_0(0, j));
+
+    d->Lxx(0, 5) += -w * pshoulder_0(1, j);
+    d->Lxx(5, 0) += -w * pshoulder_0(1, j);
+
+    d->Lxx(1, 5) += w * pshoulder_0(0, j);
+    d->Lxx(5, 1) += w * pshoulder_0(0, j);
+
+    d->Lxx(2, 3) += w * pshoulder_0(1, j);
+    d->Lxx(2, 4) += -w * pshoulder_0(0, j);
+    d->Lxx(3, 2) += w * pshoulder_0(1, j);
+    d->Lxx(4, 2) += -w * pshoulder_0(0, j);
+
+    d->Lxx(3, 4) += -w * pshoulder_0(1, j) * pshoulder_0(0, j);
+    d->Lxx(4, 3) += -w * pshoulder_0(1, j) * pshoulder_0(0, j);
+  }
+  d->sh_active = sh_active;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::record_cost_terms(
+    ActionDataQuadrupedTpl<Scalar>* d) const {
+  d->cost_terms.setZero();
+  d->cost_terms[CostTerm::State] =
+      Scalar(0.5) * d->r.template head<12>().squaredNorm();
+  d->cost_terms[CostTerm::Force] =
+      Scalar(0.5) * d->r.template tail<12>().squaredNorm();
+  d->cost_terms[CostTerm::Friction] =
+      friction_weight_ * Scalar(0.5) * d->friction.rub.squaredNorm();
+  d->cost_terms[CostTerm::Shoulder] =
+      sh_weight * Scalar(0.5) * d->sh_ub_max_.sum();
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::select_kernels() {
+  static const Kernel calc_kernels[16] =
+      QUADRUPED_WALKGEN_CONTACT_KERNELS(ActionModelQuadrupedTpl, calc_kernel);
+  static const Kernel calc_diff_kernels[16] = QUADRUPED_WALKGEN_CONTACT_KERNELS(
+      ActionModelQuadrupedTpl, calc_diff_kernel);
+  const int mask = ContactMaskTpl<Scalar>::from_gait(gait);
+  calc_kernel_ = calc_kernels[mask];
+  calc_diff_kernel_ = calc_diff_kernels[mask];
 }
 
 template <typename Scalar>
@@ -266,6 +327,7 @@ void ActionModelQuadrupedTpl<Scalar>::set_force_weights(
                         std::to_string(state_->get_nx()) + ")");
   }
   force_weights_ = weights;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -282,6 +344,7 @@ void ActionModelQuadrupedTpl<Scalar>::set_state_weights(
                         std::to_string(state_->get_nx()) + ")");
   }
   state_weights_ = weights;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -292,6 +355,7 @@ template <typename Scalar>
 void ActionModelQuadrupedTpl<Scalar>::set_friction_weight(
     const Scalar& weight) {
   friction_weight_ = weight;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -301,6 +365,7 @@ const Scalar& ActionModelQuadrupedTpl<Scalar>::get_mu() const {
 template <typename Scalar>
 void ActionModelQuadrupedTpl<Scalar>::set_mu(const Scalar& mu_coeff) {
   mu = mu_coeff;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -311,6 +376,7 @@ template <typename Scalar>
 void ActionModelQuadrupedTpl<Scalar>::set_mass(const Scalar& m) {
   // The model need to be updated after this changed
   mass = m;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -322,7 +388,7 @@ void ActionModelQuadrupedTpl<Scalar>::set_dt(const Scalar& dt) {
   // The model need to be updated after this changed
   dt_ = dt;
   g[8] = Scalar(-9.81) * dt_;
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() * dt_;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -339,6 +405,8 @@ void ActionModelQuadrupedTpl<Scalar>::set_gI(
                  << "gI has wrong dimension : 3x3");
   }
   gI = inertia_matrix;
+  gI_inv = gI.inverse();
+  ++version_;
 }
 
 template <typename Scalar>
@@ -350,6 +418,7 @@ template <typename Scalar>
 void ActionModelQuadrupedTpl<Scalar>::set_min_fz_contact(const Scalar& min_fz) {
   // The model need to be updated after this changed
   min_fz_in_contact = min_fz;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -362,23 +431,55 @@ void ActionModelQuadrupedTpl<Scalar>::set_max_fz_contact(
     const Scalar& max_fz_) {
   // The model need to be updated after this changed
   max_fz = max_fz_;
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz;
-  }
+  ub.col(5).setConstant(max_fz);
+  ++version_;
+}
+
+template <typename Scalar>
+const typename Eigen::Matrix<Scalar, 4, 1>&
+ActionModelQuadrupedTpl<Scalar>::get_gait() const {
+  return gait;
 }
 
 ///////////////////////////
 //// get A & B matrix /////
 ///////////////////////////
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedTpl<Scalar>::get_A() const {
+  typename Eigen::Matrix<Scalar, 12, 12> A;
+  A.setIdentity();
+  A.topRightCorner(6, 6).diagonal().setConstant(dt_);
   return A;
 }
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedTpl<Scalar>::get_B() const {
-  return B;
+  typename Eigen::Matrix<Scalar, 12, 12> B_full;
+  B_full.topRows(6).setZero();
+  B_full.bottomRows(6) = B;
+  return B_full;
+}
+template <typename Scalar>
+const typename Eigen::Matrix<Scalar, 12, 1>&
+ActionModelQuadrupedTpl<Scalar>::get_g() const {
+  return g;
+}
+
+template <typename Scalar>
+const typename Eigen::Matrix<Scalar, 12, 1>&
+ActionModelQuadrupedTpl<Scalar>::get_xref() const {
+  return xref_;
+}
+template <typename Scalar>
+const typename Eigen::Matrix<Scalar, 12, 1>&
+ActionModelQuadrupedTpl<Scalar>::get_uref() const {
+  return uref_;
+}
+
+template <typename Scalar>
+const std::size_t& ActionModelQuadrupedTpl<Scalar>::get_version() const {
+  return version_;
 }
 
 template <typename Scalar>
@@ -389,6 +490,7 @@ template <typename Scalar>
 void ActionModelQuadrupedTpl<Scalar>::set_shoulder_hlim(const Scalar& hlim) {
   // The model need to be updated after this changed
   sh_hlim = hlim;
+  ++version_;
 }
 
 template <typename Scalar>
@@ -400,6 +502,7 @@ void ActionModelQuadrupedTpl<Scalar>::set_shoulder_weight(
     const Scalar& weight) {
   // The model need to be updated after this changed
   sh_weight = weight;
+  ++version_;
 }
 
 // to modify the cost on the command : || fz - m*g/nb contact ||^2
@@ -414,12 +517,13 @@ void ActionModelQuadrupedTpl<Scalar>::set_relative_forces(
   relative_forces = rel_forces;
   uref_.setZero();
   if (relative_forces) {
+    const Scalar fz =
+        (Scalar(9.81) * mass) / Conditional::max(gait.sum(), Scalar(1.));
     for (int i = 0; i < 4; i = i + 1) {
-      if (gait[i] == 1) {
-        uref_[3 * i + 2] = (Scalar(9.81) * mass) / (gait.sum());
-      }
+      uref_[3 * i + 2] = gait[i] * fz;
     }
   }
+  ++version_;
 }
 
 // To set implicit integration
@@ -431,6 +535,7 @@ template <typename Scalar>
 void ActionModelQuadrupedTpl<Scalar>::set_implicit_integration(
     const bool& implicit) {
   implicit_integration = implicit;
+  ++version_;
 }
 
 ////////////////////////
@@ -442,6 +547,9 @@ void ActionModelQuadrupedTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -456,43 +564,113 @@ void ActionModelQuadrupedTpl<Scalar>::update_model(
                  << "S vector has wrong dimension (it should be 4x1)");
   }
 
+  update_model_yaw(l_feet, xref, S, cos(xref(5, 0)), sin(xref(5, 0)));
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::update_models(
+    const std::vector<boost::shared_ptr<ActionModelQuadrupedTpl> >& models,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  const Eigen::Index N = static_cast<Eigen::Index>(models.size());
+  if (l_feet.rows() != 3 || l_feet.cols() != 4 * N) {
+    throw_pretty("Invalid argument: "
+                 << "l_feet matrix has wrong dimension (it should be : 3x" +
+                        std::to_string(4 * N) + ")");
+  }
+  if (xref.rows() != 12 || xref.cols() != N) {
+    throw_pretty("Invalid argument: "
+                 << "xref matrix has wrong dimension (it should be : 12x" +
+                        std::to_string(N) + ")");
+  }
+  if (S.rows() != 4 || S.cols() != N) {
+    throw_pretty("Invalid argument: "
+                 << "S matrix has wrong dimension (it should be : 4x" +
+                        std::to_string(N) + ")");
+  }
+
+  for (Eigen::Index k = 0; k < N; ++k) {
+    models[k]->update_model_yaw(l_feet.middleCols(4 * k, 4), xref.col(k),
+                                S.col(k), cos(xref(5, k)), sin(xref(5, k)));
+  }
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::update_model_yaw(
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S, const Scalar& c,
+    const Scalar& s) {
   xref_ = xref;
   gait = S;
+  select_kernels();
 
   // Set ref u vector according to nb of contact
   uref_.setZero();
   if (relative_forces) {
+    const Scalar fz =
+        (Scalar(9.81) * mass) / Conditional::max(gait.sum(), Scalar(1.));
     for (int i = 0; i < 4; i = i + 1) {
-      if (gait[i] == 1) {
-        uref_[3 * i + 2] = (Scalar(9.81) * mass) / (gait.sum());
-      }
+      uref_[3 * i + 2] = gait[i] * fz;
     }
   }
 
-  R_tmp << cos(xref(5, 0)), -sin(xref(5, 0)), 0, sin(xref(5, 0)),
-      cos(xref(5, 0)), 0, 0, 0, 1.0;
-
-  I_inv = (R_tmp.transpose() * gI * R_tmp).inverse();  // I_inv
   lever_arms.block(0, 0, 2, 4) = l_feet.block(0, 0, 2, 4);
 
+  // S(i) is 0 or 1, the limit of the normal force and the columns of B of a
+  // foot in swing phase are cancelled by the product
   for (int i = 0; i < 4; i = i + 1) {
-    if (S(i, 0) != 0) {
-      // set limit for normal force, (foot in contact with the ground)
-      ub(6 * i + 4) = -min_fz_in_contact;
-
-      // B update
-      B.block(6, 3 * i, 3, 3).diagonal() << dt_ / mass, dt_ / mass, dt_ / mass;
-      lever_tmp = lever_arms.block(0, i, 3, 1) - xref.block(0, 0, 3, 1);
-      R_tmp << 0.0, -lever_tmp[2], lever_tmp[1], lever_tmp[2], 0.0,
-          -lever_tmp[0], -lever_tmp[1], lever_tmp[0], 0.0;
-      B.block(9, 3 * i, 3, 3) << dt_ * I_inv * R_tmp;
-    } else {
-      // set limit for normal force at 0.0
-      ub(6 * i + 4) = Scalar(0.0);
-      B.block(6, 3 * i, 3, 3).setZero();
-      B.block(9, 3 * i, 3, 3).setZero();
-    };
+    ub(i, 4) = -min_fz_in_contact * S(i, 0);
+    B.block(0, 3 * i, 3, 3).diagonal().setConstant(S(i, 0) * dt_ / mass);
   };
+  update_angular_dynamics(c, s);
+  ++version_;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::update_reference(
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref) {
+  using std::cos;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
+  if (static_cast<std::size_t>(xref.size()) != state_->get_nx()) {
+    throw_pretty("Invalid argument: "
+                 << "Weights vector has wrong dimension (it should be " +
+                        std::to_string(state_->get_nx()) + ")");
+  }
+
+  // The cost of the state changes anyway, B only if the position or the yaw
+  // of the reference moved
+  const bool moved = xref.block(0, 0, 3, 1) != xref_.template head<3>() ||
+                     xref(5, 0) != xref_[5];
+  xref_ = xref;
+  if (moved) {
+    update_angular_dynamics(cos(xref_[5]), sin(xref_[5]));
+  }
+  ++version_;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedTpl<Scalar>::update_angular_dynamics(
+    const Scalar& c, const Scalar& s) {
+  // Inertia rotated by the yaw only : (R^T gI R)^-1 = R^T gI^-1 R
+  typename MathBase::Matrix3s R_tmp;
+  R_tmp << c, -s, Scalar(0), s, c, Scalar(0), Scalar(0), Scalar(0), Scalar(1);
+  const typename MathBase::Matrix3s I_inv = R_tmp.transpose() * gI_inv * R_tmp;
+  typename MathBase::Vector3s lever_tmp;
+  for (int i = 0; i < 4; i = i + 1) {
+    if (gait[i] == Scalar(0.)) {
+      B.block(3, 3 * i, 3, 3).setZero();
+      continue;
+    }
+    lever_tmp = lever_arms.block(0, i, 3, 1) - xref_.template head<3>();
+    R_tmp << Scalar(0.0), -lever_tmp[2], lever_tmp[1], lever_tmp[2],
+        Scalar(0.0), -lever_tmp[0], -lever_tmp[1], lever_tmp[0], Scalar(0.0);
+    B.block(3, 3 * i, 3, 3).noalias() = (gait[i] * dt_) * I_inv * R_tmp;
+  }
 }
 }  // namespace quadruped_walkgen
 
@@ -7,8 +7,16 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/conditional.hpp"
+#include "quadruped-walkgen/contact_mask.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/friction_pyramid.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
+template <typename _Scalar>
+struct ActionDataQuadrupedAugmentedTpl;
+
 template <typename _Scalar>
 class ActionModelQuadrupedAugmentedTpl
     : public crocoddyl::ActionModelAbstractTpl<_Scalar> {
@@ -17,6 +25,7 @@ class ActionModelQuadrupedAugmentedTpl
   typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
   typedef crocoddyl::ActionModelAbstractTpl<Scalar> Base;
   typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
+  typedef ConditionalTpl<Scalar> Conditional;
 
   ActionModelQuadrupedAugmentedTpl(
       typename Eigen::Matrix<Scalar, 3, 1> offset_CoM =
@@ -86,6 +95,8 @@ class ActionModelQuadrupedAugmentedTpl
   const bool& get_shoulder_reference_position() const;
   void set_shoulder_reference_position(const bool& reference);
 
+  const typename Eigen::Matrix<Scalar, 3, 1>& get_offset_com() const;
+
   // Update the model depending if the foot in contact with the ground
   // or the new lever arms
   void update_model(const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
@@ -93,9 +104,20 @@ class ActionModelQuadrupedAugmentedTpl
                     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
                     const Eigen::Ref<const typename MathBase::MatrixXs>& S);
 
-  // Get A & B matrix
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_A() const;
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_B() const;
+  // Update the models of a whole horizon in one call : node k is updated with
+  // the columns 4k to 4k+3 of l_feet and l_stop (3x4N), and the column k of
+  // xref (12xN) and S (4xN).
+  static void update_models(
+      const std::vector<boost::shared_ptr<ActionModelQuadrupedAugmentedTpl> >&
+          models,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& S);
+
+  // Get A & B matrix, built from the compact storage of the model
+  typename Eigen::Matrix<Scalar, 12, 12> get_A() const;
+  typename Eigen::Matrix<Scalar, 12, 12> get_B() const;
 
   const bool& get_relative_forces() const;
   void set_relative_forces(const bool& rel_forces);
@@ -111,6 +133,35 @@ class ActionModelQuadrupedAugmentedTpl
   using Base::unone_;               //!< Neutral state
 
  private:
+  // update_model without the checks, c and s are the cos and sin of the yaw
+  // of the reference
+  void update_model_yaw(
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& S, const Scalar& c,
+      const Scalar& s);
+
+  typedef void (ActionModelQuadrupedAugmentedTpl::*Kernel)(
+      ActionDataQuadrupedAugmentedTpl<Scalar>* d,
+      const Eigen::Ref<const typename MathBase::VectorXs>& x,
+      const Eigen::Ref<const typename MathBase::VectorXs>& u) const;
+
+  // calc and calcDiff for the contact mask Mask, see contact_mask.hpp
+  template <int Mask>
+  void calc_kernel(ActionDataQuadrupedAugmentedTpl<Scalar>* d,
+                   const Eigen::Ref<const typename MathBase::VectorXs>& x,
+                   const Eigen::Ref<const typename MathBase::VectorXs>& u)
+      const;
+  template <int Mask>
+  void calc_diff_kernel(
+      ActionDataQuadrupedAugmentedTpl<Scalar>* d,
+      const Eigen::Ref<const typename MathBase::VectorXs>& x,
+      const Eigen::Ref<const typename MathBase::VectorXs>& u) const;
+
+  // Selects the kernels of the contact mask of gait
+  void select_kernels();
+
   Scalar dt_;
   Scalar mass;
   Scalar mu;
@@ -133,16 +184,16 @@ class ActionModelQuadrupedAugmentedTpl
   typename Eigen::Matrix<Scalar, 8, 1> heuristic_weights_;
   typename Eigen::Matrix<Scalar, 8, 1> stop_weights_;
 
-  typename Eigen::Matrix<Scalar, 12, 12> A;
-  typename Eigen::Matrix<Scalar, 12, 12> B;
+  // A is the identity with dt on the diagonal of its top right 6x6 block, it
+  // is not stored. The first 6 rows of B are 0, only the last 6 are stored.
+  typename Eigen::Matrix<Scalar, 6, 12> B;
   typename Eigen::Matrix<Scalar, 12, 1> g;
   typename Eigen::Matrix<Scalar, 3, 3> R;
-  typename MathBase::Matrix3s R_tmp;
   typename Eigen::Matrix<Scalar, 3, 3> gI;
+  typename Eigen::Matrix<Scalar, 3, 3> gI_inv;  // Inverse of gI
 
   typename Eigen::Matrix<Scalar, 3, 4> lever_arms;
-  typename MathBase::Vector3s lever_tmp;
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
 
   // typename Eigen::Matrix<Scalar, 8, 1> pshoulder_;
   typename Eigen::Matrix<Scalar, 2, 4> pshoulder_0;
@@ -155,32 +206,29 @@ class ActionModelQuadrupedAugmentedTpl
   typename Eigen::Matrix<Scalar, 8, 1> pstop_;
   typename Eigen::Matrix<Scalar, 8, 1> pheuristic_;
 
-  typename Eigen::Matrix<Scalar, 24, 1> ub;
+  typename FrictionPyramidTpl<Scalar>::MatrixFaces ub;
 
-  typename Eigen::Matrix<Scalar, 24, 1> Fa_x_u;
   typename Eigen::Matrix<Scalar, 20, 1> rub_;
-  typename Eigen::Matrix<Scalar, 24, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 24, 24> Arr;
-  typename Eigen::Matrix<Scalar, 6, 1> r;
   typename Eigen::Matrix<Scalar, 4, 1> gait;
   typename Eigen::Matrix<Scalar, 8, 1> gait_double;
 
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_x;
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_y;
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_z;
-  typename Eigen::Matrix<Scalar, 3, 1> forces_3d;
 
   // Cost relative to the shoulder height
-  typename Eigen::Matrix<Scalar, 3, 4> psh;
-  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
   typename Eigen::Matrix<Scalar, 4, 1> sh_weight;
   typename Eigen::Matrix<Scalar, 3, 1> offset_com;
   Scalar sh_hlim;
+
+  Kernel calc_kernel_;
+  Kernel calc_diff_kernel_;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedAugmentedTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -199,7 +247,23 @@ struct ActionDataQuadrupedAugmentedTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedAugmentedTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {
+    B.setZero();
+    psh.setZero();
+    sh_ub_max_.setZero();
+  }
+
+  // Last 6 rows of B, that depend on the state (lever arms wrt the CoM), they
+  // are rebuilt in calc from the contact part set by update_model
+  typename Eigen::Matrix<Scalar, 6, 12> B;
+
+  // Quantities computed in calc and reused in calcDiff, kept in the data so
+  // that the nodes of a problem can be evaluated concurrently
+  FrictionPyramidTpl<Scalar> friction;
+
+  // Cost relative to the shoulder height
+  typename Eigen::Matrix<Scalar, 3, 4> psh;
+  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -208,9 +272,21 @@ struct ActionDataQuadrupedAugmentedTpl
 
 typedef ActionModelQuadrupedAugmentedTpl<double> ActionModelQuadrupedAugmented;
 typedef ActionDataQuadrupedAugmentedTpl<double> ActionDataQuadrupedAugmented;
+typedef ActionModelQuadrupedAugmentedTpl<float>
+    ActionModelQuadrupedAugmentedFloat;
+typedef ActionDataQuadrupedAugmentedTpl<float>
+    ActionDataQuadrupedAugmentedFloat;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_augmented.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_augmented.cpp
+extern template class ActionModelQuadrupedAugmentedTpl<double>;
+extern template struct ActionDataQuadrupedAugmentedTpl<double>;
+extern template class ActionModelQuadrupedAugmentedTpl<float>;
+extern template struct ActionDataQuadrupedAugmentedTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
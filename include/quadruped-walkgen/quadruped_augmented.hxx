@@ -25,11 +25,11 @@ ActionModelQuadrupedAugmentedTpl<Scalar>::ActionModelQuadrupedAugmentedTpl(
   g[8] = Scalar(-9.81) * dt_;
   gI.setZero();
   gI.diagonal() << Scalar(0.00578574), Scalar(0.01938108), Scalar(0.02476124);
-  A.setIdentity();
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() * dt_;
+  gI_inv = gI.inverse();
   B.setZero();
   lever_arms.setZero();
   R.setZero();
+  xref_.setZero();
 
   // Weight vectors initialization
   force_weights_.setConstant(Scalar(0.2));
@@ -50,23 +50,15 @@ ActionModelQuadrupedAugmentedTpl<Scalar>::ActionModelQuadrupedAugmentedTpl(
   // pcentrifugal_tmp.setZero();
   // UpperBound vector
   ub.setZero();
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz_in_contact;
-  }
+  ub.col(5).setConstant(max_fz_in_contact);
 
   // Temporary vector used
-  Fa_x_u.setZero();
   rub_.setZero();
-  rub_max_.setZero();
-  Arr.setZero();
-  r.setZero();
-  lever_tmp.setZero();
-  R_tmp.setZero();
   gait.setZero();
+  select_kernels();
   base_vector_x << Scalar(1.), Scalar(0.), Scalar(0.);
   base_vector_y << Scalar(0.), Scalar(1.), Scalar(0.);
   base_vector_z << Scalar(0.), Scalar(0.), Scalar(1.);
-  forces_3d.setZero();
   gait_double.setZero();
 
   // bool to add heuristic for foot position
@@ -81,8 +73,6 @@ ActionModelQuadrupedAugmentedTpl<Scalar>::ActionModelQuadrupedAugmentedTpl(
   //                 Scalar(-0.15005) ;
   sh_hlim = Scalar(0.27);
   sh_weight.setConstant(Scalar(1.));
-  sh_ub_max_.setZero();
-  psh.setZero();
   pheuristic_.setZero();
   offset_com = offset_CoM;  // x, y, z offset
 
@@ -97,6 +87,7 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -110,60 +101,101 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calc(
 
   ActionDataQuadrupedAugmentedTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedAugmentedTpl<Scalar>*>(data.get());
+  (this->*calc_kernel_)(d, x, u);
+
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    d->cost_terms[CostTerm::Heuristic] =
+        Scalar(0.5) * d->r.template segment<8>(12).squaredNorm();
+    d->cost_terms[CostTerm::Force] =
+        Scalar(0.5) * d->r.template tail<12>().squaredNorm();
+    d->cost_terms[CostTerm::Friction] =
+        friction_weight_ * Scalar(0.5) * d->friction.rub.squaredNorm();
+    d->cost_terms[CostTerm::Stop] =
+        Scalar(0.5) *
+        ((stop_weights_.cwiseProduct(x.template tail<8>() - pstop_)).array() *
+         gait_double.array())
+            .matrix()
+            .squaredNorm();
+    d->cost_terms[CostTerm::Shoulder] = d->sh_ub_max_.sum();
+  }
+}
 
+template <typename Scalar>
+template <int Mask>
+void ActionModelQuadrupedAugmentedTpl<Scalar>::calc_kernel(
+    ActionDataQuadrupedAugmentedTpl<Scalar>* d,
+    const Eigen::Ref<const typename MathBase::VectorXs>& x,
+    const Eigen::Ref<const typename MathBase::VectorXs>& u) const {
+  using std::cos;
+  using std::sin;
   //  Update B :
+  // The feet in swing phase are skipped, their columns of B stay 0 and their
+  // shoulder distance is 0. gait(i) is 1 for the others, except in the full
+  // mask kernel of the AD scalar where the products with gait(i) cancel the
+  // feet in swing phase.
+  d->B = B;
   for (int i = 0; i < 4; i = i + 1) {
+    if (!(Mask & (1 << i))) {
+      d->psh.block(0, i, 3, 1).setZero();
+      continue;
+    }
+    typename MathBase::Vector3s lever_tmp;
     lever_tmp.setZero();
-    if (gait(i, 0) != 0) {
-      lever_tmp.head(2) = x.block(12 + 2 * i, 0, 2, 1);
-      lever_tmp += -x.block(0, 0, 3, 1);
-      R_tmp << Scalar(0.0), -lever_tmp[2], lever_tmp[1], lever_tmp[2],
-          Scalar(0.0), -lever_tmp[0], -lever_tmp[1], lever_tmp[0], Scalar(0.0);
-      B.block(9, 3 * i, 3, 3) << dt_ * R * R_tmp;
-
-      // Compute pdistance of the shoulder wrt contact point
-      if (shoulder_reference_position) {
-        // Ref vector as reference for the shoulder trajectory, roll and pitch
-        // at first
-        psh.block(0, i, 3, 1) << xref_(0, 0) - offset_com(0, 0) +
-                                     pshoulder_0(0, i) * cos(xref_(5, 0)) -
-                                     pshoulder_0(1, i) * sin(xref_(5, 0)) -
-                                     x(12 + 2 * i),
-            xref_(1, 0) - offset_com(1, 0) +
-                pshoulder_0(0, i) * sin(xref_(5, 0)) +
-                pshoulder_0(1, i) * cos(xref_(5, 0)) - x(12 + 2 * i + 1),
-            xref_(2, 0) - offset_com(2, 0);
-      } else {
-        // psh.block(0, i, 3, 1) << x(0) + pshoulder_0(0, i) - pshoulder_0(1, i)
-        // * x(5) - x(12 + 2 * i),
-        //                          x(1) + pshoulder_0(1, i) + pshoulder_0(0, i)
-        //                          * x(5) - x(12 + 2 * i + 1), x(2) -
-        //                          offset_com + pshoulder_0(1, i) * x(3) -
-        //                          pshoulder_0(0, i) * x(4);
-        // Correction, no approximation for yaw
-        psh.block(0, i, 3, 1)
-            << x(0) - offset_com(0, 0) + pshoulder_0(0, i) * cos(x(5)) -
-                   pshoulder_0(1, i) * sin(x(5)) - x(12 + 2 * i),
-            x(1) - offset_com(1, 0) + pshoulder_0(0, i) * sin(x(5)) +
-                pshoulder_0(1, i) * cos(x(5)) - x(12 + 2 * i + 1),
-            x(2) - offset_com(2, 0) + pshoulder_0(1, i) * x(3) -
-                pshoulder_0(0, i) * x(4);
-      }
-
+    lever_tmp.head(2) = x.block(12 + 2 * i, 0, 2, 1);
+    lever_tmp += -x.block(0, 0, 3, 1);
+    lever_tmp *= gait(i, 0);
+    typename MathBase::Matrix3s R_tmp;
+    R_tmp << Scalar(0.0), -lever_tmp[2], lever_tmp[1], lever_tmp[2],
+        Scalar(0.0), -lever_tmp[0], -lever_tmp[1], lever_tmp[0], Scalar(0.0);
+    d->B.block(3, 3 * i, 3, 3) << dt_ * R * R_tmp;
+
+    // Compute pdistance of the shoulder wrt contact point
+    if (shoulder_reference_position) {
+      // Ref vector as reference for the shoulder trajectory, roll and pitch
+      // at first
+      d->psh.block(0, i, 3, 1) << xref_(0, 0) - offset_com(0, 0) +
+                                   pshoulder_0(0, i) * cos(xref_(5, 0)) -
+                                   pshoulder_0(1, i) * sin(xref_(5, 0)) -
+                                   x(12 + 2 * i),
+          xref_(1, 0) - offset_com(1, 0) +
+              pshoulder_0(0, i) * sin(xref_(5, 0)) +
+              pshoulder_0(1, i) * cos(xref_(5, 0)) - x(12 + 2 * i + 1),
+          xref_(2, 0) - offset_com(2, 0);
     } else {
-      // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1).setZero();
+      // psh.block(0, i, 3, 1) << x(0) + pshoulder_0(0, i) - pshoulder_0(1, i)
+      // * x(5) - x(12 + 2 * i),
+      //                          x(1) + pshoulder_0(1, i) + pshoulder_0(0, i)
+      //                          * x(5) - x(12 + 2 * i + 1), x(2) -
+      //                          offset_com + pshoulder_0(1, i) * x(3) -
+      //                          pshoulder_0(0, i) * x(4);
+      // Correction, no approximation for yaw
+      d->psh.block(0, i, 3, 1)
+          << x(0) - offset_com(0, 0) + pshoulder_0(0, i) * cos(x(5)) -
+                 pshoulder_0(1, i) * sin(x(5)) - x(12 + 2 * i),
+          x(1) - offset_com(1, 0) + pshoulder_0(0, i) * sin(x(5)) +
+              pshoulder_0(1, i) * cos(x(5)) - x(12 + 2 * i + 1),
+          x(2) - offset_com(2, 0) + pshoulder_0(1, i) * x(3) -
+              pshoulder_0(0, i) * x(4);
     }
+
+    d->psh.block(0, i, 3, 1) *= gait(i, 0);
   };
 
-  // Discrete dynamic : A*x + B*u + g
-  d->xnext.template head<12>() =
-      A.diagonal().cwiseProduct(x.block(0, 0, 12, 1)) + g;
-  d->xnext.template head<6>() =
-      d->xnext.template head<6>() +
-      A.topRightCorner(6, 6).diagonal().cwiseProduct(x.block(6, 0, 6, 1));
-  d->xnext.template segment<6>(6) =
-      d->xnext.template segment<6>(6) + B.block(6, 0, 6, 12) * u;
+  // Discrete dynamic : A*x + B*u + g, B(6:9, 3i:3i+3) is diagonal (B(0:3,
+  // 3i:3i+3) in the stored rows)
+  d->xnext.template head<12>() = x.template head<12>() + g;
+  d->xnext.template head<6>() += dt_ * x.template segment<6>(6);
+  for (int i = 0; i < 4; i = i + 1) {
+    if (Mask & (1 << i)) {
+      d->xnext.template segment<3>(6) +=
+          d->B(0, 3 * i) * u.template segment<3>(3 * i);
+      d->xnext.template segment<3>(9) +=
+          d->B.template block<3, 3>(3, 3 * i) * u.template segment<3>(3 * i);
+    }
+  }
   d->xnext.template tail<8>() = x.tail(8);
 
   // Residual cost on the state and force norm
@@ -175,24 +207,19 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calc(
   d->r.template tail<12>() = force_weights_.cwiseProduct(u - uref_);
 
   // Friction cone
+  const Scalar friction_cost = d->friction.calc(u, mu, ub);
+
+  // Shoulder height weight, 0 for the feet in swing phase
   for (int i = 0; i < 4; i = i + 1) {
-    Fa_x_u.segment(6 * i, 6) << u(3 * i) - mu * u(3 * i + 2),
-        -u(3 * i) - mu * u(3 * i + 2), u(3 * i + 1) - mu * u(3 * i + 2),
-        -u(3 * i + 1) - mu * u(3 * i + 2), -u(3 * i + 2), u(3 * i + 2);
+    d->sh_ub_max_[i] =
+        (Mask & (1 << i))
+            ? Conditional::max(
+                  Scalar(0.5) * sh_weight(i) *
+                      (d->psh.block(0, i, 3, 1).squaredNorm() -
+                       sh_hlim * sh_hlim),
+                  Scalar(0.))
+            : Scalar(0.);
   }
-  rub_max_ = (Fa_x_u - ub).cwiseMax(Scalar(0.));
-
-  // Shoulder height weight
-  sh_ub_max_ << Scalar(0.5) * sh_weight(0) *
-                    (psh.block(0, 0, 3, 1).squaredNorm() - sh_hlim * sh_hlim),
-      Scalar(0.5) * sh_weight(1) *
-          (psh.block(0, 1, 3, 1).squaredNorm() - sh_hlim * sh_hlim),
-      Scalar(0.5) * sh_weight(2) *
-          (psh.block(0, 2, 3, 1).squaredNorm() - sh_hlim * sh_hlim),
-      Scalar(0.5) * sh_weight(3) *
-          (psh.block(0, 3, 3, 1).squaredNorm() - sh_hlim * sh_hlim);
-
-  sh_ub_max_ = sh_ub_max_.cwiseMax(Scalar(0.));
 
   // Cost computation
   // d->cost = Scalar(0.5) * d->r.transpose() * d->r     + friction_weight_ *
@@ -202,13 +229,13 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calc(
   //         ).matrix().squaredNorm()  ;
 
   d->cost =
-      Scalar(0.5) * d->r.transpose() * d->r +
-      friction_weight_ * Scalar(0.5) * rub_max_.squaredNorm() +
+      (Scalar(0.5) * d->r.transpose() * d->r).value() +
+      friction_weight_ * friction_cost +
       Scalar(0.5) * ((stop_weights_.cwiseProduct(x.tail(8) - pstop_)).array() *
                      gait_double.array())
                         .matrix()
                         .squaredNorm() +
-      sh_ub_max_.sum();
+      d->sh_ub_max_.sum();
 }
 
 template <typename Scalar>
@@ -216,6 +243,7 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -229,7 +257,17 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calcDiff(
 
   ActionDataQuadrupedAugmentedTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedAugmentedTpl<Scalar>*>(data.get());
+  (this->*calc_diff_kernel_)(d, x, u);
+}
 
+template <typename Scalar>
+template <int Mask>
+void ActionModelQuadrupedAugmentedTpl<Scalar>::calc_diff_kernel(
+    ActionDataQuadrupedAugmentedTpl<Scalar>* d,
+    const Eigen::Ref<const typename MathBase::VectorXs>& x,
+    const Eigen::Ref<const typename MathBase::VectorXs>& u) const {
+  using std::cos;
+  using std::sin;
   // Cost derivatives : Lx
   d->Lx.setZero();
   d->Lx.template head<12>() =
@@ -241,12 +279,8 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calcDiff(
        gait_double.array() * stop_weights_.array())
           .matrix();
 
-  // Cost derivative : Lu
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * rub_max_.segment(6 * i, 6);
-    d->Lu.block(i * 3, 0, 3, 1) << r(0) - r(1), r(2) - r(3),
-        -mu * (r(0) + r(1) + r(2) + r(3)) - r(4) + r(5);
-  }
+  // Cost derivative : Lu, and the friction cone blocks of Luu
+  d->friction.calcDiff(friction_weight_, mu, d->Lu, d->Luu);
   d->Lu = d->Lu +
           (force_weights_.array() * d->r.template tail<12>().array()).matrix();
 
@@ -264,177 +298,182 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::calcDiff(
       (gait_double.array() * stop_weights_.array() * stop_weights_.array())
           .matrix();
 
-  // Shoulder height derivative cost
+  // Shoulder height derivative cost, w is 0 if the shoulder is below its
+  // limit and for the feet in swing phase
   for (int j = 0; j < 4; j = j + 1) {
-    if (sh_ub_max_[j] > Scalar(0.)) {
-      if (shoulder_reference_position) {
-        d->Lx(12 + 2 * j, 0) += -sh_weight(j) * psh(0, j);
-        d->Lx(12 + 2 * j + 1, 0) += -sh_weight(j) * psh(1, j);
-
-        d->Lxx(12 + 2 * j, 12 + 2 * j) += sh_weight(j);
-        d->Lxx(12 + 2 * j + 1, 12 + 2 * j + 1) += sh_weight(j);
-
-      } else {
-        // Approximation of small even for yaw (wrong)
-        // d->Lx(0, 0) += sh_weight(j) * psh(0, j);
-        // d->Lx(1, 0) += sh_weight(j) * psh(1, j);
-        // d->Lx(2, 0) += sh_weight(j) * psh(2, j);
-        // d->Lx(3, 0) += sh_weight(j) * pshoulder_0(1, j) * psh(2, j);
-        // d->Lx(4, 0) += -sh_weight(j) * pshoulder_0(0, j) * psh(2, j);
-        // d->Lx(5, 0) += sh_weight(j) * (-pshoulder_0(1, j) * psh(0, j) +
-        // pshoulder_0(0, j) * psh(1, j));
-
-        // d->Lx(12 + 2 * j, 0) += -sh_weight(j) * psh(0, j);
-        // d->Lx(12 + 2 * j + 1, 0) += -sh_weight(j) * psh(1, j);
-
-        // d->Lxx(0, 0) += sh_weight(j);
-        // d->Lxx(1, 1) += sh_weight(j);
-        // d->Lxx(2, 2) += sh_weight(j);
-        // d->Lxx(3, 3) += sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(1, j);
-        // d->Lxx(3, 3) += sh_weight(j) * pshoulder_0(0, j) * pshoulder_0(0, j);
-        // d->Lxx(5, 5) += sh_weight(j) * (pshoulder_0(1, j) * pshoulder_0(1, j)
-        // + pshoulder_0(0, j) * pshoulder_0(0, j));
-
-        // d->Lxx(12 + 2 * j, 12 + 2 * j) += sh_weight(j);
-        // d->Lxx(12 + 2 * j + 1, 12 + 2 * j + 1) += sh_weight(j);
-
-        // d->Lxx(0, 5) += -sh_weight(j) * pshoulder_0(1, j);
-        // d->Lxx(5, 0) += -sh_weight(j) * pshoulder_0(1, j);
-
-        // d->Lxx(1, 5) += sh_weight(j) * pshoulder_0(0, j);
-        // d->Lxx(5, 1) += sh_weight(j) * pshoulder_0(0, j);
-
-        // d->Lxx(2, 3) += sh_weight(j) * pshoulder_0(1, j);
-        // d->Lxx(2, 4) += -sh_weight(j) * pshoulder_0(0, j);
-        // d->Lxx(3, 2) += sh_weight(j) * pshoulder_0(1, j);
-        // d->Lxx(4, 2) += -sh_weight(j) * pshoulder_0(0, j);
-
-        // d->Lxx(3, 4) += -sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(0,
-        // j); d->Lxx(4, 3) += -sh_weight(j) * pshoulder_0(1, j) *
-        // pshoulder_0(0, j);
-
-        // d->Lxx(0, 12 + 2 * j) += -sh_weight(j);
-        // d->Lxx(12 + 2 * j, 0) += -sh_weight(j);
-
-        // d->Lxx(5, 12 + 2 * j) += sh_weight(j) * pshoulder_0(1, j);
-        // d->Lxx(12 + 2 * j, 5) += sh_weight(j) * pshoulder_0(1, j);
-
-        // d->Lxx(1, 12 + 2 * j + 1) += -sh_weight(j);
-        // d->Lxx(12 + 2 * j + 1, 1) += -sh_weight(j);
-
-        // d->Lxx(5, 12 + 2 * j + 1) += -sh_weight(j) * pshoulder_0(0, j);
-        // d->Lxx(12 + 2 * j + 1, 5) += -sh_weight(j) * pshoulder_0(0, j);
-        d->Lx(0, 0) += sh_weight(j) * psh(0, j);
-        d->Lx(1, 0) += sh_weight(j) * psh(1, j);
-        d->Lx(2, 0) += sh_weight(j) * psh(2, j);
-        d->Lx(3, 0) += sh_weight(j) * pshoulder_0(1, j) * psh(2, j);
-        d->Lx(4, 0) += -sh_weight(j) * pshoulder_0(0, j) * psh(2, j);
-        d->Lx(5, 0) +=
-            sh_weight(j) *
-            ((-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j)) *
-                 psh(0, j) +
-             (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j)) *
-                 psh(1, j));
-
-        d->Lx(12 + 2 * j, 0) += -sh_weight(j) * psh(0, j);
-        d->Lx(12 + 2 * j + 1, 0) += -sh_weight(j) * psh(1, j);
-
-        d->Lxx(0, 0) += sh_weight(j);
-        d->Lxx(1, 1) += sh_weight(j);
-        d->Lxx(2, 2) += sh_weight(j);
-        d->Lxx(3, 3) += sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(1, j);
-        d->Lxx(3, 3) += sh_weight(j) * pshoulder_0(0, j) * pshoulder_0(0, j);
-        d->Lxx(5, 5) +=
-            sh_weight(j) *
-            ((-cos(x(5)) * pshoulder_0(0, j) + sin(x(5)) * pshoulder_0(1, j)) *
-                 psh(0, j) +
-             (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j)) *
-                 (-sin(x(5)) * pshoulder_0(0, j) -
-                  cos(x(5)) * pshoulder_0(1, j)) +
-             (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j)) *
-                 psh(1, j) +
-             (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j)) *
-                 (cos(x(5)) * pshoulder_0(0, j) -
-                  sin(x(5)) * pshoulder_0(1, j)));
-
-        d->Lxx(12 + 2 * j, 12 + 2 * j) += sh_weight(j);
-        d->Lxx(12 + 2 * j + 1, 12 + 2 * j + 1) += sh_weight(j);
-
-        d->Lxx(0, 5) += sh_weight(j) * (-sin(x(5)) * pshoulder_0(0, j) -
-                                        cos(x(5)) * pshoulder_0(1, j));
-        d->Lxx(5, 0) += sh_weight(j) * (-sin(x(5)) * pshoulder_0(0, j) -
-                                        cos(x(5)) * pshoulder_0(1, j));
-
-        d->Lxx(1, 5) += sh_weight(j) * (cos(x(5)) * pshoulder_0(0, j) -
-                                        sin(x(5)) * pshoulder_0(1, j));
-        d->Lxx(5, 1) += sh_weight(j) * (cos(x(5)) * pshoulder_0(0, j) -
-                                        sin(x(5)) * pshoulder_0(1, j));
-
-        d->Lxx(2, 3) += sh_weight(j) * pshoulder_0(1, j);
-        d->Lxx(2, 4) += -sh_weight(j) * pshoulder_0(0, j);
-        d->Lxx(3, 2) += sh_weight(j) * pshoulder_0(1, j);
-        d->Lxx(4, 2) += -sh_weight(j) * pshoulder_0(0, j);
-
-        d->Lxx(3, 4) += -sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(0, j);
-        d->Lxx(4, 3) += -sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(0, j);
-
-        d->Lxx(0, 12 + 2 * j) += -sh_weight(j);
-        d->Lxx(12 + 2 * j, 0) += -sh_weight(j);
-
-        d->Lxx(5, 12 + 2 * j) +=
-            -sh_weight(j) *
-            (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j));
-        d->Lxx(12 + 2 * j, 5) +=
-            -sh_weight(j) *
-            (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j));
-
-        d->Lxx(1, 12 + 2 * j + 1) += -sh_weight(j);
-        d->Lxx(12 + 2 * j + 1, 1) += -sh_weight(j);
-
-        d->Lxx(5, 12 + 2 * j + 1) +=
-            -sh_weight(j) *
-            (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j));
-        d->Lxx(12 + 2 * j + 1, 5) +=
-            -sh_weight(j) *
-            (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j));
-      }
+    if (!(Mask & (1 << j))) {
+      continue;
+    }
+    const Scalar w = sh_weight(j) * Conditional::positive(d->sh_ub_max_[j]);
+    if (shoulder_reference_position) {
+      d->Lx(12 + 2 * j, 0) += -w * d->psh(0, j);
+      d->Lx(12 + 2 * j + 1, 0) += -w * d->psh(1, j);
+
+      d->Lxx(12 + 2 * j, 12 + 2 * j) += w;
+      d->Lxx(12 + 2 * j + 1, 12 + 2 * j + 1) += w;
+
+    } else {
+      // Approximation of small even for yaw (wrong)
+      // d->Lx(0, 0) += sh_weight(j) * psh(0, j);
+      // d->Lx(1, 0) += sh_weight(j) * psh(1, j);
+      // d->Lx(2, 0) += sh_weight(j) * psh(2, j);
+      // d->Lx(3, 0) += sh_weight(j) * pshoulder_0(1, j) * psh(2, j);
+      // d->Lx(4, 0) += -sh_weight(j) * pshoulder_0(0, j) * psh(2, j);
+      // d->Lx(5, 0) += sh_weight(j) * (-pshoulder_0(1, j) * psh(0, j) +
+      // pshoulder_0(0, j) * psh(1, j));
+
+      // d->Lx(12 + 2 * j, 0) += -sh_weight(j) * psh(0, j);
+      // d->Lx(12 + 2 * j + 1, 0) += -sh_weight(j) * psh(1, j);
+
+      // d->Lxx(0, 0) += sh_weight(j);
+      // d->Lxx(1, 1) += sh_weight(j);
+      // d->Lxx(2, 2) += sh_weight(j);
+      // d->Lxx(3, 3) += sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(1, j);
+      // d->Lxx(3, 3) += sh_weight(j) * pshoulder_0(0, j) * pshoulder_0(0, j);
+      // d->Lxx(5, 5) += sh_weight(j) * (pshoulder_0(1, j) * pshoulder_0(1, j)
+      // + pshoulder_0(0, j) * pshoulder_0(0, j));
+
+      // d->Lxx(12 + 2 * j, 12 + 2 * j) += sh_weight(j);
+      // d->Lxx(12 + 2 * j + 1, 12 + 2 * j + 1) += sh_weight(j);
+
+      // d->Lxx(0, 5) += -sh_weight(j) * pshoulder_0(1, j);
+      // d->Lxx(5, 0) += -sh_weight(j) * pshoulder_0(1, j);
+
+      // d->Lxx(1, 5) += sh_weight(j) * pshoulder_0(0, j);
+      // d->Lxx(5, 1) += sh_weight(j) * pshoulder_0(0, j);
+
+      // d->Lxx(2, 3) += sh_weight(j) * pshoulder_0(1, j);
+      // d->Lxx(2, 4) += -sh_weight(j) * pshoulder_0(0, j);
+      // d->Lxx(3, 2) += sh_weight(j) * pshoulder_0(1, j);
+      // d->Lxx(4, 2) += -sh_weight(j) * pshoulder_0(0, j);
+
+      // d->Lxx(3, 4) += -sh_weight(j) * pshoulder_0(1, j) * pshoulder_0(0,
+      // j); d->Lxx(4, 3) += -sh_weight(j) * pshoulder_0(1, j) *
+      // pshoulder_0(0, j);
+
+      // d->Lxx(0, 12 + 2 * j) += -sh_weight(j);
+      // d->Lxx(12 + 2 * j, 0) += -sh_weight(j);
+
+      // d->Lxx(5, 12 + 2 * j) += sh_weight(j) * pshoulder_0(1, j);
+      // d->Lxx(12 + 2 * j, 5) += sh_weight(j) * pshoulder_0(1, j);
+
+      // d->Lxx(1, 12 + 2 * j + 1) += -sh_weight(j);
+      // d->Lxx(12 + 2 * j + 1, 1) += -sh_weight(j);
+
+      // d->Lxx(5, 12 + 2 * j + 1) += -sh_weight(j) * pshoulder_0(0, j);
+      // d->Lxx(12 + 2 * j + 1, 5) += -sh_weight(j) * pshoulder_0(0, j);
+      d->Lx(0, 0) += w * d->psh(0, j);
+      d->Lx(1, 0) += w * d->psh(1, j);
+      d->Lx(2, 0) += w * d->psh(2, j);
+      d->Lx(3, 0) += w * pshoulder_0(1, j) * d->psh(2, j);
+      d->Lx(4, 0) += -w * pshoulder_0(0, j) * d->psh(2, j);
+      d->Lx(5, 0) +=
+          w *
+          ((-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j)) *
+               d->psh(0, j) +
+           (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j)) *
+               d->psh(1, j));
+
+      d->Lx(12 + 2 * j, 0) += -w * d->psh(0, j);
+      d->Lx(12 + 2 * j + 1, 0) += -w * d->psh(1, j);
+
+      d->Lxx(0, 0) += w;
+      d->Lxx(1, 1) += w;
+      d->Lxx(2, 2) += w;
+      d->Lxx(3, 3) += w * pshoulder_0(1, j) * pshoulder_0(1, j);
+      d->Lxx(3, 3) += w * pshoulder_0(0, j) * pshoulder_0(0, j);
+      d->Lxx(5, 5) +=
+          w *
+          ((-cos(x(5)) * pshoulder_0(0, j) + sin(x(5)) * pshoulder_0(1, j)) *
+               d->psh(0, j) +
+           (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j)) *
+               (-sin(x(5)) * pshoulder_0(0, j) -
+                cos(x(5)) * pshoulder_0(1, j)) +
+           (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j)) *
+               d->psh(1, j) +
+           (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j)) *
+               (cos(x(5)) * pshoulder_0(0, j) -
+                sin(x(5)) * pshoulder_0(1, j)));
+
+      d->Lxx(12 + 2 * j, 12 + 2 * j) += w;
+      d->Lxx(12 + 2 * j + 1, 12 + 2 * j + 1) += w;
+
+      d->Lxx(0, 5) += w * (-sin(x(5)) * pshoulder_0(0, j) -
+                           cos(x(5)) * pshoulder_0(1, j));
+      d->Lxx(5, 0) += w * (-sin(x(5)) * pshoulder_0(0, j) -
+                           cos(x(5)) * pshoulder_0(1, j));
+
+      d->Lxx(1, 5) += w * (cos(x(5)) * pshoulder_0(0, j) -
+                           sin(x(5)) * pshoulder_0(1, j));
+      d->Lxx(5, 1) += w * (cos(x(5)) * pshoulder_0(0, j) -
+                           sin(x(5)) * pshoulder_0(1, j));
+
+      d->Lxx(2, 3) += w * pshoulder_0(1, j);
+      d->Lxx(2, 4) += -w * pshoulder_0(0, j);
+      d->Lxx(3, 2) += w * pshoulder_0(1, j);
+      d->Lxx(4, 2) += -w * pshoulder_0(0, j);
+
+      d->Lxx(3, 4) += -w * pshoulder_0(1, j) * pshoulder_0(0, j);
+      d->Lxx(4, 3) += -w * pshoulder_0(1, j) * pshoulder_0(0, j);
+
+      d->Lxx(0, 12 + 2 * j) += -w;
+      d->Lxx(12 + 2 * j, 0) += -w;
+
+      d->Lxx(5, 12 + 2 * j) +=
+          -w * (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j));
+      d->Lxx(12 + 2 * j, 5) +=
+          -w * (-sin(x(5)) * pshoulder_0(0, j) - cos(x(5)) * pshoulder_0(1, j));
+
+      d->Lxx(1, 12 + 2 * j + 1) += -w;
+      d->Lxx(12 + 2 * j + 1, 1) += -w;
+
+      d->Lxx(5, 12 + 2 * j + 1) +=
+          -w * (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j));
+      d->Lxx(12 + 2 * j + 1, 5) +=
+          -w * (cos(x(5)) * pshoulder_0(0, j) - sin(x(5)) * pshoulder_0(1, j));
     }
   }
 
   // Hessian : Luu
-  // Matrix friction cone hessian (20x12)
-  Arr.diagonal() =
-      ((Fa_x_u - ub).array() >= 0.).matrix().template cast<Scalar>();
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * Arr.diagonal().segment(6 * i, 6);
-    d->Luu.block(3 * i, 3 * i, 3, 3) << r(0) + r(1), 0.0, mu * (r(1) - r(0)),
-        0.0, r(2) + r(3), mu * (r(3) - r(2)), mu * (r(1) - r(0)),
-        mu * (r(3) - r(2)), mu * mu * (r(0) + r(1) + r(2) + r(3)) + r(4) + r(5);
-  }
   d->Luu.diagonal() =
       d->Luu.diagonal() +
       (force_weights_.array() * force_weights_.array()).matrix();
 
   // Dynamic derivatives
   d->Fx.setZero();
-  d->Fx.block(0, 0, 12, 12) << A;
+  d->Fx.template topLeftCorner<12, 12>().setIdentity();
+  d->Fx.template block<6, 6>(0, 6).diagonal().setConstant(dt_);
   d->Fx.block(12, 12, 8, 8) << Eigen::Matrix<Scalar, 8, 8>::Identity();
 
   for (int i = 0; i < 4; i = i + 1) {
-    if (gait(i, 0) != 0) {
-      forces_3d = u.block(3 * i, 0, 3, 1);
-      d->Fx.block(9, 0, 3, 1) += -dt_ * R * (base_vector_x.cross(forces_3d));
-      d->Fx.block(9, 1, 3, 1) += -dt_ * R * (base_vector_y.cross(forces_3d));
-      d->Fx.block(9, 2, 3, 1) += -dt_ * R * (base_vector_z.cross(forces_3d));
-
-      d->Fx.block(9, 12 + 2 * i, 3, 1) +=
-          dt_ * R * (base_vector_x.cross(forces_3d));
-      d->Fx.block(9, 12 + 2 * i + 1, 3, 1) +=
-          dt_ * R * (base_vector_y.cross(forces_3d));
+    if (!(Mask & (1 << i))) {
+      continue;
     }
+    const typename MathBase::Vector3s forces_3d =
+        gait(i, 0) * u.block(3 * i, 0, 3, 1);
+    d->Fx.block(9, 0, 3, 1) += -dt_ * R * (base_vector_x.cross(forces_3d));
+    d->Fx.block(9, 1, 3, 1) += -dt_ * R * (base_vector_y.cross(forces_3d));
+    d->Fx.block(9, 2, 3, 1) += -dt_ * R * (base_vector_z.cross(forces_3d));
+
+    d->Fx.block(9, 12 + 2 * i, 3, 1) +=
+        dt_ * R * (base_vector_x.cross(forces_3d));
+    d->Fx.block(9, 12 + 2 * i + 1, 3, 1) +=
+        dt_ * R * (base_vector_y.cross(forces_3d));
   }
   // d->Fu << Eigen::Matrix<Scalar, 20, 12>::Zero() ;
-  d->Fu.block(0, 0, 12, 12) << B;
+  d->Fu.block(0, 0, 6, 12).setZero();
+  d->Fu.block(6, 0, 6, 12) = d->B;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedAugmentedTpl<Scalar>::select_kernels() {
+  static const Kernel calc_kernels[16] = QUADRUPED_WALKGEN_CONTACT_KERNELS(
+      ActionModelQuadrupedAugmentedTpl, calc_kernel);
+  static const Kernel calc_diff_kernels[16] = QUADRUPED_WALKGEN_CONTACT_KERNELS(
+      ActionModelQuadrupedAugmentedTpl, calc_diff_kernel);
+  const int mask = ContactMaskTpl<Scalar>::from_gait(gait);
+  calc_kernel_ = calc_kernels[mask];
+  calc_diff_kernel_ = calc_diff_kernels[mask];
 }
 
 template <typename Scalar>
@@ -546,7 +585,6 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::set_dt(const Scalar& dt) {
   // The model need to be updated after this changed
   dt_ = dt;
   g[8] = Scalar(-9.81) * dt_;
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() * dt_;
 }
 
 template <typename Scalar>
@@ -563,6 +601,7 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::set_gI(
                  << "gI has wrong dimension : 3x3");
   }
   gI = inertia_matrix;
+  gI_inv = gI.inverse();
 }
 
 template <typename Scalar>
@@ -589,9 +628,7 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::set_max_fz_contact(
     const Scalar& max_fz) {
   // The model need to be updated after this changed
   max_fz_in_contact = max_fz;
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz_in_contact;
-  }
+  ub.col(5).setConstant(max_fz_in_contact);
 }
 
 template <typename Scalar>
@@ -629,6 +666,12 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::set_shoulder_reference_position(
   shoulder_reference_position = reference;
 }
 
+template <typename Scalar>
+const typename Eigen::Matrix<Scalar, 3, 1>&
+ActionModelQuadrupedAugmentedTpl<Scalar>::get_offset_com() const {
+  return offset_com;
+}
+
 template <typename Scalar>
 const Scalar& ActionModelQuadrupedAugmentedTpl<Scalar>::get_T_gait() const {
   // The model need to be updated after this changed
@@ -669,14 +712,20 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::set_shoulder_contact_weight(
 //// get A & B matrix /////
 ///////////////////////////
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedAugmentedTpl<Scalar>::get_A() const {
+  typename Eigen::Matrix<Scalar, 12, 12> A;
+  A.setIdentity();
+  A.topRightCorner(6, 6).diagonal().setConstant(dt_);
   return A;
 }
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedAugmentedTpl<Scalar>::get_B() const {
-  return B;
+  typename Eigen::Matrix<Scalar, 12, 12> B_full;
+  B_full.topRows(6).setZero();
+  B_full.bottomRows(6) = B;
+  return B_full;
 }
 
 // to modify the cost on the command : || fz - m*g/nb contact ||^2
@@ -692,10 +741,10 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::set_relative_forces(
   relative_forces = rel_forces;
   uref_.setZero();
   if (relative_forces) {
+    const Scalar fz =
+        (Scalar(9.81) * mass) / Conditional::max(gait.sum(), Scalar(1.));
     for (int i = 0; i < 4; i = i + 1) {
-      if (gait[i] == 1) {
-        uref_[3 * i + 2] = (Scalar(9.81) * mass) / (gait.sum());
-      }
+      uref_[3 * i + 2] = gait[i] * fz;
     }
   }
 }
@@ -710,6 +759,9 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -723,15 +775,67 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::update_model(
                  << "S vector has wrong dimension (it should be 4x1)");
   }
 
+  update_model_yaw(l_feet, l_stop, xref, S, cos(xref(5, 0)), sin(xref(5, 0)));
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedAugmentedTpl<Scalar>::update_models(
+    const std::vector<boost::shared_ptr<ActionModelQuadrupedAugmentedTpl> >&
+        models,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  const Eigen::Index N = static_cast<Eigen::Index>(models.size());
+  if (l_feet.rows() != 3 || l_feet.cols() != 4 * N) {
+    throw_pretty("Invalid argument: "
+                 << "l_feet matrix has wrong dimension (it should be : 3x" +
+                        std::to_string(4 * N) + ")");
+  }
+  if (l_stop.rows() != 3 || l_stop.cols() != 4 * N) {
+    throw_pretty("Invalid argument: "
+                 << "l_stop matrix has wrong dimension (it should be : 3x" +
+                        std::to_string(4 * N) + ")");
+  }
+  if (xref.rows() != 12 || xref.cols() != N) {
+    throw_pretty("Invalid argument: "
+                 << "xref matrix has wrong dimension (it should be : 12x" +
+                        std::to_string(N) + ")");
+  }
+  if (S.rows() != 4 || S.cols() != N) {
+    throw_pretty("Invalid argument: "
+                 << "S matrix has wrong dimension (it should be : 4x" +
+                        std::to_string(N) + ")");
+  }
+
+  for (Eigen::Index k = 0; k < N; ++k) {
+    models[k]->update_model_yaw(
+        l_feet.middleCols(4 * k, 4), l_stop.middleCols(4 * k, 4), xref.col(k),
+        S.col(k), cos(xref(5, k)), sin(xref(5, k)));
+  }
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedAugmentedTpl<Scalar>::update_model_yaw(
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S, const Scalar& c,
+    const Scalar& s) {
   xref_ = xref;
   gait = S;
+  select_kernels();
 
+  // S is 0 or 1, the number of contacts is kept at 1 at least so that a node
+  // without contact has no reference force
   uref_.setZero();
   if (relative_forces) {
+    const Scalar fz =
+        (Scalar(9.81) * mass) / Conditional::max(gait.sum(), Scalar(1.));
     for (int i = 0; i < 4; i = i + 1) {
-      if (gait[i] == 1) {
-        uref_[3 * i + 2] = (Scalar(9.81) * mass) / (gait.sum());
-      }
+      uref_[3 * i + 2] = gait[i] * fz;
     }
   }
 
@@ -743,8 +847,8 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::update_model(
     pstop_.block(2 * i, 0, 2, 1) = l_stop.block(0, i, 2, 1);
   }
 
-  R_tmp << cos(xref(5, 0)), -sin(xref(5, 0)), Scalar(0), sin(xref(5, 0)),
-      cos(xref(5, 0)), Scalar(0), Scalar(0), Scalar(0), Scalar(1.0);
+  typename MathBase::Matrix3s R_tmp;
+  R_tmp << c, -s, Scalar(0), s, c, Scalar(0), Scalar(0), Scalar(0), Scalar(1);
 
   // Centrifual term
   // pcentrifugal_tmp_1 = xref.block(6, 0, 3, 1);
@@ -760,33 +864,28 @@ void ActionModelQuadrupedAugmentedTpl<Scalar>::update_model(
   //        centrifugal_term * pcentrifugal_tmp.block(0, 0, 2, 1));
   // }
 
-  R = (R_tmp.transpose() * gI * R_tmp).inverse();  // I_inv
+  // Inertia rotated by the yaw only : (R^T gI R)^-1 = R^T gI^-1 R
+  R.noalias() = R_tmp.transpose() * gI_inv * R_tmp;  // I_inv
 
   for (int i = 0; i < 4; i = i + 1) {
     // pshoulder_[2 * i] = pshoulder_tmp(0, i) + xref(0, 0);
     // pshoulder_[2 * i + 1] = pshoulder_tmp(1, i) + xref(1, 0);
 
-    if (S(i, 0) != 0) {
-      // set limit for normal force, (foot in contact with the ground)
-      ub[5 * i + 4] = -min_fz_in_contact;
+    // set limit for normal force, (0.0 if the foot is not in contact with the
+    // ground)
+    ub(i, 4) = -min_fz_in_contact * S(i, 0);
 
-      // B update
-      B.block(6, 3 * i, 3, 3).diagonal() << dt_ / mass, dt_ / mass, dt_ / mass;
+    // B update, the force of a foot in swing phase has no effect
+    B.block(0, 3 * i, 3, 3).diagonal().setConstant(S(i, 0) * dt_ / mass);
 
-      //  Assuption 1 : levers arms not depends on the state, but on the
-      //  predicted position (xfref)
-      //  --> B will be updated with the update_B method for each calc function
+    //  Assuption 1 : levers arms not depends on the state, but on the
+    //  predicted position (xfref)
+    //  --> B will be updated with the update_B method for each calc function
 
-      // lever_tmp = lever_arms.block(0,i,3,1) - xref.block(0,0,3,1) ;
-      // R_tmp << 0.0, -lever_tmp[2], lever_tmp[1],
-      // lever_tmp[2], 0.0, -lever_tmp[0], -lever_tmp[1], lever_tmp[0], 0.0 ;
-      // B.block(9 , 3*i  , 3,3) << dt_ * R* R_tmp;
-    } else {
-      // set limit for normal force at 0.0
-      ub[5 * i + 4] = Scalar(0.0);
-      B.block(6, 3 * i, 3, 3).setZero();
-      B.block(9, 3 * i, 3, 3).setZero();
-    };
+    // lever_tmp = lever_arms.block(0,i,3,1) - xref.block(0,0,3,1) ;
+    // R_tmp << 0.0, -lever_tmp[2], lever_tmp[1],
+    // lever_tmp[2], 0.0, -lever_tmp[0], -lever_tmp[1], lever_tmp[0], 0.0 ;
+    // B.block(9 , 3*i  , 3,3) << dt_ * R* R_tmp;
   };
 }
 }  // namespace quadruped_walkgen
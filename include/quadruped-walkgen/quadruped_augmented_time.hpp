@@ -7,6 +7,9 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/friction_pyramid.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
 template <typename _Scalar>
@@ -104,12 +107,10 @@ class ActionModelQuadrupedAugmentedTimeTpl
                     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
                     const Eigen::Ref<const typename MathBase::MatrixXs>& S);
 
-  // Get A & B matrix
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_A() const;
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_B() const;
-
-  // get cost
-  const typename Eigen::Matrix<Scalar, 7, 1>& get_cost() const;
+  // Get A & B matrix, the time step being the state x(20) they are the
+  // identity and 0 outside of calc
+  typename Eigen::Matrix<Scalar, 12, 12> get_A() const;
+  typename Eigen::Matrix<Scalar, 12, 12> get_B() const;
 
  protected:
   using Base::has_control_limits_;  //!< Indicates whether any of the control
@@ -141,16 +142,11 @@ class ActionModelQuadrupedAugmentedTimeTpl
   typename Eigen::Matrix<Scalar, 8, 1> heuristicWeights;
   typename Eigen::Matrix<Scalar, 8, 1> last_position_weights_;
 
-  typename Eigen::Matrix<Scalar, 12, 12> A;
-  typename Eigen::Matrix<Scalar, 12, 12> B;
-  typename Eigen::Matrix<Scalar, 12, 1> g;
   typename Eigen::Matrix<Scalar, 3, 3> R;
-  typename MathBase::Matrix3s R_tmp;
   typename Eigen::Matrix<Scalar, 3, 3> gI;
 
   typename Eigen::Matrix<Scalar, 3, 4> lever_arms;
-  typename MathBase::Vector3s lever_tmp;
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
 
   typename Eigen::Matrix<Scalar, 8, 1> pshoulder_;
   typename Eigen::Matrix<Scalar, 8, 1> pheuristic_;
@@ -163,40 +159,27 @@ class ActionModelQuadrupedAugmentedTimeTpl
 
   typename Eigen::Matrix<Scalar, 8, 1> pref_;
 
-  typename Eigen::Matrix<Scalar, 24, 1> ub;
+  typename FrictionPyramidTpl<Scalar>::MatrixFaces ub;
 
-  typename Eigen::Matrix<Scalar, 24, 1> Fa_x_u;
-  typename Eigen::Matrix<Scalar, 24, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 24, 24> Arr;
-  typename Eigen::Matrix<Scalar, 6, 1> r;
   typename Eigen::Matrix<Scalar, 4, 1> gait;
   typename Eigen::Matrix<Scalar, 8, 1> gait_double;
 
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_x;
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_y;
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_z;
-  typename Eigen::Matrix<Scalar, 3, 1> forces_3d;
 
   typename Eigen::Matrix<Scalar, 1, 1> dt_min_;
   typename Eigen::Matrix<Scalar, 1, 1> dt_max_;
 
-  typename Eigen::Matrix<Scalar, 2, 1> rub_max_dt;
-  typename Eigen::Matrix<Scalar, 2, 1> rub_max_dt_bool;
-
-  // Log cost
-  bool log_cost;
-  typename Eigen::Matrix<Scalar, 7, 1> cost_;
-
   // Cost relative to the shoulder height
-  typename Eigen::Matrix<Scalar, 3, 4> psh;
-  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
   Scalar sh_weight;
   Scalar sh_hlim;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedAugmentedTimeTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -215,7 +198,28 @@ struct ActionDataQuadrupedAugmentedTimeTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedAugmentedTimeTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {
+    B.setZero();
+    rub_max_dt.setZero();
+    rub_max_dt_bool.setZero();
+    psh.setZero();
+    sh_ub_max_.setZero();
+  }
+
+  // The dynamics depend on the time step x(20) and on the lever arms wrt the
+  // CoM, the last 6 rows of B are rebuilt in calc (the first 6 are 0). A is
+  // the identity with x(20) on the diagonal of its top right 6x6 block.
+  typename Eigen::Matrix<Scalar, 6, 12> B;
+
+  // Quantities computed in calc and reused in calcDiff, kept in the data so
+  // that the nodes of a problem can be evaluated concurrently
+  FrictionPyramidTpl<Scalar> friction;
+  typename Eigen::Matrix<Scalar, 2, 1> rub_max_dt;
+  typename Eigen::Matrix<Scalar, 2, 1> rub_max_dt_bool;
+
+  // Cost relative to the shoulder height
+  typename Eigen::Matrix<Scalar, 3, 4> psh;
+  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -226,9 +230,21 @@ typedef ActionModelQuadrupedAugmentedTimeTpl<double>
     ActionModelQuadrupedAugmentedTime;
 typedef ActionDataQuadrupedAugmentedTimeTpl<double>
     ActionDataQuadrupedAugmentedTime;
+typedef ActionModelQuadrupedAugmentedTimeTpl<float>
+    ActionModelQuadrupedAugmentedTimeFloat;
+typedef ActionDataQuadrupedAugmentedTimeTpl<float>
+    ActionDataQuadrupedAugmentedTimeFloat;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_augmented_time.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_augmented_time.cpp
+extern template class ActionModelQuadrupedAugmentedTimeTpl<double>;
+extern template struct ActionDataQuadrupedAugmentedTimeTpl<double>;
+extern template class ActionModelQuadrupedAugmentedTimeTpl<float>;
+extern template struct ActionDataQuadrupedAugmentedTimeTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
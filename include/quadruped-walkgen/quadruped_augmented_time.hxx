@@ -20,13 +20,11 @@ ActionModelQuadrupedAugmentedTimeTpl<
   uref_.setZero();
 
   // Matrix model initialization
-  g.setZero();
   gI.setZero();
   gI.diagonal() << Scalar(0.00578574), Scalar(0.01938108), Scalar(0.02476124);
-  A.setIdentity();
-  B.setZero();
   lever_arms.setZero();
   R.setZero();
+  xref_.setZero();
 
   // Weight vectors initialization
   force_weights_.setConstant(Scalar(0.2));
@@ -49,22 +47,12 @@ ActionModelQuadrupedAugmentedTimeTpl<
   pcentrifugal_tmp.setZero();
   // UpperBound vector
   ub.setZero();
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz;
-  }
+  ub.col(5).setConstant(max_fz);
 
-  // Temporary vector used
-  Fa_x_u.setZero();
-  rub_max_.setZero();
-  Arr.setZero();
-  r.setZero();
-  lever_tmp.setZero();
-  R_tmp.setZero();
   gait.setZero();
   base_vector_x << Scalar(1.), Scalar(0.), Scalar(0.);
   base_vector_y << Scalar(0.), Scalar(1.), Scalar(0.);
   base_vector_z << Scalar(0.), Scalar(0.), Scalar(1.);
-  forces_3d.setZero();
   gait_double.setZero();
 
   // bool to add heuristic for foot position
@@ -73,14 +61,9 @@ ActionModelQuadrupedAugmentedTimeTpl<
   T_gait = Scalar(0.64);
 
   // dt param
-  rub_max_dt_bool.setZero();
-  rub_max_dt.setZero();
   dt_min_.setConstant(Scalar(0.005));
   dt_max_.setConstant(Scalar(0.1));
   dt_bound_weight = Scalar(0.);
-  // Log cost
-  cost_.setZero();
-  log_cost = false;
 
   // // Used for shoulder height weight
   // pshoulder_0 <<  Scalar(0.1946) ,   Scalar(0.1946) ,   Scalar(-0.1946),
@@ -89,8 +72,6 @@ ActionModelQuadrupedAugmentedTimeTpl<
   //                 Scalar(-0.15005) ;
   sh_hlim = Scalar(0.225);
   sh_weight = Scalar(10.);
-  sh_ub_max_.setZero();
-  psh.setZero();
 }
 
 template <typename Scalar>
@@ -102,6 +83,7 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -116,32 +98,33 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calc(
   ActionDataQuadrupedAugmentedTimeTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedAugmentedTimeTpl<Scalar>*>(data.get());
 
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() *
-                                x.tail(1)[0];
-  g[8] = Scalar(-9.81) * x.tail(1)[0];
-
   //  Update B :
   for (int i = 0; i < 4; i = i + 1) {
-    lever_tmp.setZero();
     if (gait(i, 0) != 0) {
+      typename MathBase::Vector3s lever_tmp;
+      lever_tmp.setZero();
       lever_tmp.head(2) = x.block(12 + 2 * i, 0, 2, 1);
       lever_tmp += -x.block(0, 0, 3, 1);
+      typename MathBase::Matrix3s R_tmp;
       R_tmp << Scalar(0.0), -lever_tmp[2], lever_tmp[1], lever_tmp[2],
           Scalar(0.0), -lever_tmp[0], -lever_tmp[1], lever_tmp[0], Scalar(0.0);
 
-      B.block(9, 3 * i, 3, 3) << x.tail(1)[0] * R * R_tmp;
-      B.block(6, 3 * i, 3, 3).diagonal() << x.tail(1)[0] / mass,
+      d->B.block(3, 3 * i, 3, 3) << x.tail(1)[0] * R * R_tmp;
+      d->B.block(0, 3 * i, 3, 3).diagonal() << x.tail(1)[0] / mass,
           x.tail(1)[0] / mass, x.tail(1)[0] / mass;
 
       // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1) << x(0) + pshoulder_0(0, i) -
+      d->psh.block(0, i, 3, 1) << x(0) + pshoulder_0(0, i) -
                                    pshoulder_0(1, i) * x(5) - x(12 + 2 * i),
           x(1) + pshoulder_0(1, i) + pshoulder_0(0, i) * x(5) -
               x(12 + 2 * i + 1),
           x(2) + pshoulder_0(1, i) * x(3) - pshoulder_0(0, i) * x(4);
     } else {
+      d->B.block(0, 3 * i, 3, 3).setZero();
+      d->B.block(3, 3 * i, 3, 3).setZero();
+
       // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1).setZero();
+      d->psh.block(0, i, 3, 1).setZero();
       // Compute pdistance of the shoulder wrt contact point
       // psh.block(0,i,3,1) << x(0) + pshoulder_0(0,i) - pshoulder_0(1,i)*x(5) -
       // x(12+2*i),
@@ -151,14 +134,11 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calc(
     }
   };
 
-  // Discrete dynamic : A*x + B*u + g
-  d->xnext.template head<12>() =
-      A.diagonal().cwiseProduct(x.block(0, 0, 12, 1)) + g;
-  d->xnext.template head<6>() =
-      d->xnext.template head<6>() +
-      A.topRightCorner(6, 6).diagonal().cwiseProduct(x.block(6, 0, 6, 1));
-  d->xnext.template segment<6>(6) =
-      d->xnext.template segment<6>(6) + B.block(6, 0, 6, 12) * u;
+  // Discrete dynamic : A*x + B*u + g, g is 0 except g(8) = -9.81 * x(20)
+  d->xnext.template head<12>() = x.template head<12>();
+  d->xnext(8) += Scalar(-9.81) * x.tail(1)[0];
+  d->xnext.template head<6>() += x.tail(1)[0] * x.template segment<6>(6);
+  d->xnext.template segment<6>(6) += d->B * u;
   d->xnext.template segment<8>(12) = x.segment(12, 8);
   d->xnext.template tail<1>() = x.tail(1);
 
@@ -172,58 +152,57 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calc(
   d->r.template tail<12>() = force_weights_.cwiseProduct(u - uref_);
 
   // Friction cone
-  for (int i = 0; i < 4; i = i + 1) {
-    Fa_x_u.segment(6 * i, 6) << u(3 * i) - mu * u(3 * i + 2),
-        -u(3 * i) - mu * u(3 * i + 2), u(3 * i + 1) - mu * u(3 * i + 2),
-        -u(3 * i + 1) - mu * u(3 * i + 2), -u(3 * i + 2), u(3 * i + 2);
-  }
-  rub_max_ = (Fa_x_u - ub).cwiseMax(Scalar(0.));
+  const Scalar friction_cost = d->friction.calc(u, mu, ub);
 
-  rub_max_dt << dt_min_ - x.tail(1), x.tail(1) - dt_max_;
-  rub_max_dt_bool =
-      (rub_max_dt.array() >= Scalar(0.)).matrix().template cast<Scalar>();
-  rub_max_dt = rub_max_dt.cwiseMax(Scalar(0.));
+  d->rub_max_dt << dt_min_ - x.tail(1), x.tail(1) - dt_max_;
+  d->rub_max_dt_bool =
+      (d->rub_max_dt.array() >= Scalar(0.)).matrix().template cast<Scalar>();
+  d->rub_max_dt = d->rub_max_dt.cwiseMax(Scalar(0.));
 
   // Shoulder height weight
-  sh_ub_max_ << psh.block(0, 0, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 1, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 2, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 3, 3, 1).squaredNorm() - sh_hlim * sh_hlim;
+  d->sh_ub_max_ << d->psh.block(0, 0, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
+      d->psh.block(0, 1, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
+      d->psh.block(0, 2, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
+      d->psh.block(0, 3, 3, 1).squaredNorm() - sh_hlim * sh_hlim;
 
-  sh_ub_max_ = sh_ub_max_.cwiseMax(Scalar(0.));
+  d->sh_ub_max_ = d->sh_ub_max_.cwiseMax(Scalar(0.));
 
   // Cost computation
   d->cost =
       Scalar(0.5) * d->r.segment(12, 8).transpose() * d->r.segment(12, 8) +
-      friction_weight_ * Scalar(0.5) * rub_max_.squaredNorm() +
+      friction_weight_ * friction_cost +
       Scalar(0.5) *
           ((last_position_weights_.cwiseProduct(x.segment(12, 8) - pref_))
                .array() *
            gait_double.array())
               .matrix()
               .squaredNorm() +
-      dt_bound_weight * Scalar(0.5) * rub_max_dt.squaredNorm() +
+      dt_bound_weight * Scalar(0.5) * d->rub_max_dt.squaredNorm() +
       x(20) * Scalar(0.5) * d->r.head(12).transpose() * d->r.head(12) +
       x(20) * Scalar(0.5) * d->r.tail(12).transpose() * d->r.tail(12) +
-      sh_weight * Scalar(0.5) * sh_ub_max_.sum();
-
-  if (log_cost) {
-    cost_[0] = x(20) * Scalar(0.5) * d->r.head(12).transpose() *
-               d->r.head(12);  // state
-    cost_[1] = Scalar(0.5) * d->r.segment(12, 8).transpose() *
-               d->r.segment(12, 8);  // heuristic
-    cost_[2] = x(20) * Scalar(0.5) * d->r.tail(12).transpose() *
-               d->r.tail(12);  // Force norm
-    cost_[3] = dt_bound_weight * Scalar(0.5) *
-               rub_max_dt.squaredNorm();  // upper/lower bound limit
-    cost_[4] = Scalar(0.5) *
-               ((last_position_weights_.cwiseProduct(x.segment(12, 8) - pref_))
-                    .array() *
-                gait_double.array())
-                   .matrix()
-                   .squaredNorm();  // last position weight
-    cost_[5] = friction_weight_ * Scalar(0.5) *
-               rub_max_.squaredNorm();  // friction weight
+      sh_weight * Scalar(0.5) * d->sh_ub_max_.sum();
+
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        x(20) * Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    d->cost_terms[CostTerm::Heuristic] =
+        Scalar(0.5) * d->r.template segment<8>(12).squaredNorm();
+    d->cost_terms[CostTerm::Force] =
+        x(20) * Scalar(0.5) * d->r.template tail<12>().squaredNorm();
+    d->cost_terms[CostTerm::Friction] = friction_weight_ * friction_cost;
+    d->cost_terms[CostTerm::Stop] =
+        Scalar(0.5) *
+        ((last_position_weights_.cwiseProduct(x.template segment<8>(12) -
+                                              pref_))
+             .array() *
+         gait_double.array())
+            .matrix()
+            .squaredNorm();
+    d->cost_terms[CostTerm::Period] =
+        dt_bound_weight * Scalar(0.5) * d->rub_max_dt.squaredNorm();
+    d->cost_terms[CostTerm::Shoulder] =
+        sh_weight * Scalar(0.5) * d->sh_ub_max_.sum();
   }
 }
 
@@ -232,6 +211,7 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -258,19 +238,15 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
        gait_double.array() * last_position_weights_.array())
           .matrix();
   d->Lx.template tail<1>() << dt_bound_weight *
-                                  (-rub_max_dt[0] + rub_max_dt[1]);
+                                  (-d->rub_max_dt[0] + d->rub_max_dt[1]);
 
   // New cost : c = 0.5||x-x_ref||^2*dt
   d->Lx.template tail<1>() +=
       Scalar(0.5) * d->r.head(12).transpose() * d->r.head(12) +
       Scalar(0.5) * d->r.tail(12).transpose() * d->r.tail(12);
 
-  // Cost derivative : Lu
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * rub_max_.segment(6 * i, 6);
-    d->Lu.block(i * 3, 0, 3, 1) << r(0) - r(1), r(2) - r(3),
-        -mu * (r(0) + r(1) + r(2) + r(3)) - r(4) + r(5);
-  }
+  // Cost derivative : Lu, and the friction cone blocks of Luu
+  d->friction.calcDiff(friction_weight_, mu, d->Lu, d->Luu);
   d->Lu =
       d->Lu +
       x(20) *
@@ -289,8 +265,8 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
        last_position_weights_.array())
           .matrix();
 
-  d->Lxx.diagonal().tail(1) << dt_bound_weight * rub_max_dt_bool[0] +
-                                   dt_bound_weight * rub_max_dt_bool[1];
+  d->Lxx.diagonal().tail(1) << dt_bound_weight * d->rub_max_dt_bool[0] +
+                                   dt_bound_weight * d->rub_max_dt_bool[1];
 
   // New cost : partial derivatives of 20 and state (0--11)
   d->Lxx.col(20).head(12) =
@@ -298,17 +274,17 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
   d->Lxx.row(20).head(12) = d->Lxx.col(20).head(12);
 
   for (int j = 0; j < 4; j = j + 1) {
-    if (sh_ub_max_[j] > Scalar(0.)) {
-      d->Lx(0, 0) += sh_weight * psh(0, j);
-      d->Lx(1, 0) += sh_weight * psh(1, j);
-      d->Lx(2, 0) += sh_weight * psh(2, j);
-      d->Lx(3, 0) += sh_weight * pshoulder_0(1, j) * psh(2, j);
-      d->Lx(4, 0) += -sh_weight * pshoulder_0(0, j) * psh(2, j);
-      d->Lx(5, 0) += sh_weight * (-pshoulder_0(1, j) * psh(0, j) +
-                                  pshoulder_0(0, j) * psh(1, j));
-
-      d->Lx(12 + 2 * j, 0) += -sh_weight * psh(0, j);
-      d->Lx(12 + 2 * j + 1, 0) += -sh_weight * psh(1, j);
+    if (d->sh_ub_max_[j] > Scalar(0.)) {
+      d->Lx(0, 0) += sh_weight * d->psh(0, j);
+      d->Lx(1, 0) += sh_weight * d->psh(1, j);
+      d->Lx(2, 0) += sh_weight * d->psh(2, j);
+      d->Lx(3, 0) += sh_weight * pshoulder_0(1, j) * d->psh(2, j);
+      d->Lx(4, 0) += -sh_weight * pshoulder_0(0, j) * d->psh(2, j);
+      d->Lx(5, 0) += sh_weight * (-pshoulder_0(1, j) * d->psh(0, j) +
+                                  pshoulder_0(0, j) * d->psh(1, j));
+
+      d->Lx(12 + 2 * j, 0) += -sh_weight * d->psh(0, j);
+      d->Lx(12 + 2 * j + 1, 0) += -sh_weight * d->psh(1, j);
 
       d->Lxx(0, 0) += sh_weight;
       d->Lxx(1, 1) += sh_weight;
@@ -350,15 +326,6 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
   }
 
   // Hessian : Luu
-  // Matrix friction cone hessian (20x12)
-  Arr.diagonal() =
-      ((Fa_x_u - ub).array() >= Scalar(0.)).matrix().template cast<Scalar>();
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * Arr.diagonal().segment(6 * i, 6);
-    d->Luu.block(3 * i, 3 * i, 3, 3) << r(0) + r(1), 0.0, mu * (r(1) - r(0)),
-        0.0, r(2) + r(3), mu * (r(3) - r(2)), mu * (r(1) - r(0)),
-        mu * (r(3) - r(2)), mu * mu * (r(0) + r(1) + r(2) + r(3)) + r(4) + r(5);
-  }
   d->Luu.diagonal() =
       d->Luu.diagonal() +
       x(20) * (force_weights_.array() * force_weights_.array()).matrix();
@@ -368,7 +335,8 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
 
   // Dynamic derivatives
   d->Fx.setZero();
-  d->Fx.block(0, 0, 12, 12) << A;
+  d->Fx.template topLeftCorner<12, 12>().setIdentity();
+  d->Fx.template block<6, 6>(0, 6).diagonal().setConstant(x.tail(1)[0]);
   d->Fx.block(12, 12, 8, 8) << Eigen::Matrix<Scalar, 8, 8>::Identity();
   d->Fx.block(20, 20, 1, 1) << Scalar(1);
   d->Fx.block(8, 20, 1, 1) << -Scalar(9.81);
@@ -376,7 +344,7 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
 
   for (int i = 0; i < 4; i = i + 1) {
     if (gait(i, 0) != 0) {
-      forces_3d = u.block(3 * i, 0, 3, 1);
+      const typename MathBase::Vector3s forces_3d = u.block(3 * i, 0, 3, 1);
       d->Fx.block(9, 0, 3, 1) +=
           -x.tail(1)[0] * R * (base_vector_x.cross(forces_3d));
       d->Fx.block(9, 1, 3, 1) +=
@@ -391,16 +359,19 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::calcDiff(
 
       d->Fx.block(6, 20, 3, 1) += (1 / mass) * forces_3d;
 
+      typename MathBase::Vector3s lever_tmp;
       lever_tmp.setZero();
       lever_tmp.head(2) = x.block(12 + 2 * i, 0, 2, 1);
       lever_tmp += -x.block(0, 0, 3, 1);
+      typename MathBase::Matrix3s R_tmp;
       R_tmp << Scalar(0.0), -lever_tmp[2], lever_tmp[1], lever_tmp[2],
           Scalar(0.0), -lever_tmp[0], -lever_tmp[1], lever_tmp[0], Scalar(0.0);
       d->Fx.block(9, 20, 3, 1) += R * R_tmp * forces_3d;
     }
   }
   // d->Fu << Eigen::Matrix<Scalar, 20, 12>::Zero() ;
-  d->Fu.block(0, 0, 12, 12) << B;
+  d->Fu.block(0, 0, 6, 12).setZero();
+  d->Fu.block(6, 0, 6, 12) = d->B;
 }
 
 template <typename Scalar>
@@ -581,9 +552,7 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::set_max_fz_contact(
     const Scalar& max_fz_) {
   // The model need to be updated after this changed
   max_fz = max_fz_;
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz;
-  }
+  ub.col(5).setConstant(max_fz);
 }
 
 template <typename Scalar>
@@ -665,25 +634,18 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::set_dt_bound_weight(
   dt_bound_weight = weight_;
 }
 
-// Log cost
-template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 7, 1>&
-ActionModelQuadrupedAugmentedTimeTpl<Scalar>::get_cost() const {
-  return cost_;
-}
-
 ///////////////////////////
 //// get A & B matrix /////
 ///////////////////////////
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedAugmentedTimeTpl<Scalar>::get_A() const {
-  return A;
+  return Eigen::Matrix<Scalar, 12, 12>::Identity();
 }
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedAugmentedTimeTpl<Scalar>::get_B() const {
-  return B;
+  return Eigen::Matrix<Scalar, 12, 12>::Zero();
 }
 
 // to modify the cost on the command : || fz - m*g/nb contact ||^2
@@ -717,6 +679,9 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -749,6 +714,7 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::update_model(
     pheuristic_.block(2 * i, 0, 2, 1) = l_feet.block(0, i, 2, 1);
   }
 
+  typename MathBase::Matrix3s R_tmp;
   R_tmp << cos(xref(5, 0)), -sin(xref(5, 0)), Scalar(0), sin(xref(5, 0)),
       cos(xref(5, 0)), Scalar(0), Scalar(0), Scalar(0), Scalar(1.0);
 
@@ -773,12 +739,10 @@ void ActionModelQuadrupedAugmentedTimeTpl<Scalar>::update_model(
 
     if (S(i, 0) != 0) {
       // set limit for normal force, (foot in contact with the ground)
-      ub(6 * i + 4) = -min_fz_in_contact;
+      ub(i, 4) = -min_fz_in_contact;
     } else {
       // set limit for normal force at 0.0
-      ub(6 * i + 4) = Scalar(0.0);
-      B.block(6, 3 * i, 3, 3).setZero();
-      B.block(9, 3 * i, 3, 3).setZero();
+      ub(i, 4) = Scalar(0.0);
     };
   };
 }
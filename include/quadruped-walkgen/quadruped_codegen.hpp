@@ -0,0 +1,104 @@
+#ifndef __quadruped_walkgen_quadruped_codegen_hpp__
+#define __quadruped_walkgen_quadruped_codegen_hpp__
+
+#include "crocoddyl/core/codegen/action-base.hpp"
+#include "quadruped-walkgen/quadruped_augmented.hpp"
+#include "quadruped-walkgen/quadruped_nl.hpp"
+
+namespace quadruped_walkgen {
+
+// calc and calcDiff of ActionModelQuadrupedNonLinear generated by CppADCodeGen
+// and compiled at runtime. The arguments of update_model are the parameters of
+// the generated code, so one compiled model serves every node of a horizon,
+// each data keeps the parameters of its node :
+//   p = [l_feet (3x4, column-major), xref (12), S (4)]
+// The other parameters (weights, mu, mass ...) are copied from the model given
+// to the constructor and are constant in the generated code.
+template <typename _Scalar>
+class ActionModelQuadrupedNonLinearCodeGenTpl
+    : public crocoddyl::ActionModelCodeGenTpl<_Scalar> {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef _Scalar Scalar;
+  typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
+  typedef crocoddyl::ActionModelCodeGenTpl<Scalar> Base;
+  typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
+  typedef typename Base::ADScalar ADScalar;
+  typedef typename Base::ADBase ADBase;
+  typedef typename Base::ADVectorXs ADVectorXs;
+  typedef ActionModelQuadrupedNonLinearTpl<Scalar> Model;
+  typedef ActionModelQuadrupedNonLinearTpl<ADScalar> ADModel;
+  typedef Eigen::Matrix<Scalar, 28, 1> VectorP;
+
+  ActionModelQuadrupedNonLinearCodeGenTpl(
+      boost::shared_ptr<Model> model, const std::string& library_name,
+      const std::string& compile_options = "-Ofast -march=native");
+  ~ActionModelQuadrupedNonLinearCodeGenTpl();
+
+  // Set the parameters of the node of data, same arguments as
+  // ActionModelQuadrupedNonLinear::update_model
+  void update_model(const boost::shared_ptr<ActionDataAbstract>& data,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& S);
+
+  // Model on the AD scalar with the parameters of model
+  static boost::shared_ptr<ADModel> cast(const Model& model);
+
+ private:
+  static void record_env(const boost::shared_ptr<ADBase>& admodel,
+                         const Eigen::Ref<const ADVectorXs>& p);
+
+  VectorP p_;
+};
+
+// Same as ActionModelQuadrupedNonLinearCodeGen for the augmented model :
+//   p = [l_feet (3x4), l_stop (3x4), xref (12), S (4)]
+template <typename _Scalar>
+class ActionModelQuadrupedAugmentedCodeGenTpl
+    : public crocoddyl::ActionModelCodeGenTpl<_Scalar> {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef _Scalar Scalar;
+  typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
+  typedef crocoddyl::ActionModelCodeGenTpl<Scalar> Base;
+  typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
+  typedef typename Base::ADScalar ADScalar;
+  typedef typename Base::ADBase ADBase;
+  typedef typename Base::ADVectorXs ADVectorXs;
+  typedef ActionModelQuadrupedAugmentedTpl<Scalar> Model;
+  typedef ActionModelQuadrupedAugmentedTpl<ADScalar> ADModel;
+  typedef Eigen::Matrix<Scalar, 40, 1> VectorP;
+
+  ActionModelQuadrupedAugmentedCodeGenTpl(
+      boost::shared_ptr<Model> model, const std::string& library_name,
+      const std::string& compile_options = "-Ofast -march=native");
+  ~ActionModelQuadrupedAugmentedCodeGenTpl();
+
+  void update_model(const boost::shared_ptr<ActionDataAbstract>& data,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+                    const Eigen::Ref<const typename MathBase::MatrixXs>& S);
+
+  static boost::shared_ptr<ADModel> cast(const Model& model);
+
+ private:
+  static void record_env(const boost::shared_ptr<ADBase>& admodel,
+                         const Eigen::Ref<const ADVectorXs>& p);
+
+  VectorP p_;
+};
+
+typedef ActionModelQuadrupedNonLinearCodeGenTpl<double>
+    ActionModelQuadrupedNonLinearCodeGen;
+typedef ActionModelQuadrupedAugmentedCodeGenTpl<double>
+    ActionModelQuadrupedAugmentedCodeGen;
+
+}  // namespace quadruped_walkgen
+
+#include "quadruped_codegen.hxx"
+
+#endif
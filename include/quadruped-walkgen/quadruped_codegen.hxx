@@ -0,0 +1,168 @@
+#ifndef __quadruped_walkgen_quadruped_codegen_hxx__
+#define __quadruped_walkgen_quadruped_codegen_hxx__
+
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+
+////////////////////////////////
+// Non-linear model ////////////
+////////////////////////////////
+
+template <typename Scalar>
+ActionModelQuadrupedNonLinearCodeGenTpl<Scalar>::
+    ActionModelQuadrupedNonLinearCodeGenTpl(
+        boost::shared_ptr<Model> model, const std::string& library_name,
+        const std::string& compile_options)
+    : Base(cast(*model), model, library_name, VectorP::RowsAtCompileTime,
+           &ActionModelQuadrupedNonLinearCodeGenTpl::record_env,
+           compile_options) {
+  p_.setZero();
+}
+
+template <typename Scalar>
+ActionModelQuadrupedNonLinearCodeGenTpl<
+    Scalar>::~ActionModelQuadrupedNonLinearCodeGenTpl() {}
+
+template <typename Scalar>
+void ActionModelQuadrupedNonLinearCodeGenTpl<Scalar>::update_model(
+    const boost::shared_ptr<ActionDataAbstract>& data,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  if (l_feet.rows() != 3 || l_feet.cols() != 4) {
+    throw_pretty("Invalid argument: "
+                 << "l_feet matrix has wrong dimension (it should be : 3x4)");
+  }
+  if (xref.rows() != 12 || xref.cols() != 1 || S.rows() != 4 ||
+      S.cols() != 1) {
+    throw_pretty("Invalid argument: "
+                 << "xref and S should be 12x1 and 4x1 vectors");
+  }
+  Eigen::Map<Eigen::Matrix<Scalar, 3, 4> >(p_.data()) = l_feet;
+  p_.template segment<12>(12) = xref.col(0);
+  p_.template tail<4>() = S.col(0);
+  Base::update_p(data, p_);
+}
+
+template <typename Scalar>
+boost::shared_ptr<typename ActionModelQuadrupedNonLinearCodeGenTpl<
+    Scalar>::ADModel>
+ActionModelQuadrupedNonLinearCodeGenTpl<Scalar>::cast(const Model& model) {
+  boost::shared_ptr<ADModel> admodel = boost::make_shared<ADModel>(
+      model.get_offset_com().template cast<ADScalar>());
+  admodel->set_force_weights(
+      model.get_force_weights().template cast<ADScalar>());
+  admodel->set_state_weights(
+      model.get_state_weights().template cast<ADScalar>());
+  admodel->set_friction_weight(ADScalar(model.get_friction_weight()));
+  admodel->set_mu(ADScalar(model.get_mu()));
+  admodel->set_mass(ADScalar(model.get_mass()));
+  admodel->set_dt(ADScalar(model.get_dt()));
+  admodel->set_gI(model.get_gI().template cast<ADScalar>());
+  admodel->set_min_fz_contact(ADScalar(model.get_min_fz_contact()));
+  admodel->set_max_fz_contact(ADScalar(model.get_max_fz_contact()));
+  admodel->set_shoulder_hlim(ADScalar(model.get_shoulder_hlim()));
+  admodel->set_shoulder_weight(ADScalar(model.get_shoulder_weight()));
+  admodel->set_relative_forces(model.get_relative_forces());
+  return admodel;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedNonLinearCodeGenTpl<Scalar>::record_env(
+    const boost::shared_ptr<ADBase>& admodel,
+    const Eigen::Ref<const ADVectorXs>& p) {
+  ADModel* m = static_cast<ADModel*>(admodel.get());
+  m->update_model(Eigen::Map<const Eigen::Matrix<ADScalar, 3, 4> >(p.data()),
+                  p.template segment<12>(12), p.template tail<4>());
+}
+
+////////////////////////////////
+// Augmented model /////////////
+////////////////////////////////
+
+template <typename Scalar>
+ActionModelQuadrupedAugmentedCodeGenTpl<Scalar>::
+    ActionModelQuadrupedAugmentedCodeGenTpl(
+        boost::shared_ptr<Model> model, const std::string& library_name,
+        const std::string& compile_options)
+    : Base(cast(*model), model, library_name, VectorP::RowsAtCompileTime,
+           &ActionModelQuadrupedAugmentedCodeGenTpl::record_env,
+           compile_options) {
+  p_.setZero();
+}
+
+template <typename Scalar>
+ActionModelQuadrupedAugmentedCodeGenTpl<
+    Scalar>::~ActionModelQuadrupedAugmentedCodeGenTpl() {}
+
+template <typename Scalar>
+void ActionModelQuadrupedAugmentedCodeGenTpl<Scalar>::update_model(
+    const boost::shared_ptr<ActionDataAbstract>& data,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_stop,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  if (l_feet.rows() != 3 || l_feet.cols() != 4 || l_stop.rows() != 3 ||
+      l_stop.cols() != 4) {
+    throw_pretty("Invalid argument: "
+                 << "l_feet and l_stop should be 3x4 matrices");
+  }
+  if (xref.rows() != 12 || xref.cols() != 1 || S.rows() != 4 ||
+      S.cols() != 1) {
+    throw_pretty("Invalid argument: "
+                 << "xref and S should be 12x1 and 4x1 vectors");
+  }
+  Eigen::Map<Eigen::Matrix<Scalar, 3, 4> >(p_.data()) = l_feet;
+  Eigen::Map<Eigen::Matrix<Scalar, 3, 4> >(p_.data() + 12) = l_stop;
+  p_.template segment<12>(24) = xref.col(0);
+  p_.template tail<4>() = S.col(0);
+  Base::update_p(data, p_);
+}
+
+template <typename Scalar>
+boost::shared_ptr<typename ActionModelQuadrupedAugmentedCodeGenTpl<
+    Scalar>::ADModel>
+ActionModelQuadrupedAugmentedCodeGenTpl<Scalar>::cast(const Model& model) {
+  boost::shared_ptr<ADModel> admodel = boost::make_shared<ADModel>(
+      model.get_offset_com().template cast<ADScalar>());
+  admodel->set_force_weights(
+      model.get_force_weights().template cast<ADScalar>());
+  admodel->set_state_weights(
+      model.get_state_weights().template cast<ADScalar>());
+  admodel->set_heuristic_weights(
+      model.get_heuristic_weights().template cast<ADScalar>());
+  admodel->set_stop_weights(
+      model.get_stop_weights().template cast<ADScalar>());
+  admodel->set_friction_weight(ADScalar(model.get_friction_weight()));
+  admodel->set_mu(ADScalar(model.get_mu()));
+  admodel->set_mass(ADScalar(model.get_mass()));
+  admodel->set_dt(ADScalar(model.get_dt()));
+  admodel->set_gI(model.get_gI().template cast<ADScalar>());
+  admodel->set_min_fz_contact(ADScalar(model.get_min_fz_contact()));
+  admodel->set_max_fz_contact(ADScalar(model.get_max_fz_contact()));
+  admodel->set_symmetry_term(model.get_symmetry_term());
+  admodel->set_centrifugal_term(model.get_centrifugal_term());
+  admodel->set_T_gait(ADScalar(model.get_T_gait()));
+  admodel->set_shoulder_hlim(ADScalar(model.get_shoulder_hlim()));
+  admodel->set_shoulder_contact_weight(
+      model.get_shoulder_contact_weight().template cast<ADScalar>());
+  admodel->set_shoulder_reference_position(
+      model.get_shoulder_reference_position());
+  admodel->set_relative_forces(model.get_relative_forces());
+  return admodel;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedAugmentedCodeGenTpl<Scalar>::record_env(
+    const boost::shared_ptr<ADBase>& admodel,
+    const Eigen::Ref<const ADVectorXs>& p) {
+  ADModel* m = static_cast<ADModel*>(admodel.get());
+  typedef Eigen::Map<const Eigen::Matrix<ADScalar, 3, 4> > MapMatrix34;
+  m->update_model(MapMatrix34(p.data()), MapMatrix34(p.data() + 12),
+                  p.template segment<12>(24), p.template tail<4>());
+}
+
+}  // namespace quadruped_walkgen
+
+#endif
@@ -7,8 +7,16 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/conditional.hpp"
+#include "quadruped-walkgen/contact_mask.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/friction_pyramid.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
+template <typename _Scalar>
+struct ActionDataQuadrupedNonLinearTpl;
+
 template <typename _Scalar>
 class ActionModelQuadrupedNonLinearTpl
     : public crocoddyl::ActionModelAbstractTpl<_Scalar> {
@@ -17,6 +25,7 @@ class ActionModelQuadrupedNonLinearTpl
   typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
   typedef crocoddyl::ActionModelAbstractTpl<Scalar> Base;
   typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
+  typedef ConditionalTpl<Scalar> Conditional;
 
   ActionModelQuadrupedNonLinearTpl(
       typename Eigen::Matrix<Scalar, 3, 1> offset_CoM =
@@ -72,15 +81,27 @@ class ActionModelQuadrupedNonLinearTpl
   const bool& get_implicit_integration() const;
   void set_implicit_integration(const bool& implicit);
 
+  const typename Eigen::Matrix<Scalar, 3, 1>& get_offset_com() const;
+
   // Update the model depending if the foot in contact with the ground
   // or the new lever arms
   void update_model(const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
                     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
                     const Eigen::Ref<const typename MathBase::MatrixXs>& S);
 
-  // Get A & B matrix
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_A() const;
-  const typename Eigen::Matrix<Scalar, 12, 12>& get_B() const;
+  // Update the models of a whole horizon in one call : node k is updated with
+  // the columns 4k to 4k+3 of l_feet (3x4N), and the column k of xref (12xN)
+  // and S (4xN).
+  static void update_models(
+      const std::vector<boost::shared_ptr<ActionModelQuadrupedNonLinearTpl> >&
+          models,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& S);
+
+  // Get A & B matrix, built from the compact storage of the model
+  typename Eigen::Matrix<Scalar, 12, 12> get_A() const;
+  typename Eigen::Matrix<Scalar, 12, 12> get_B() const;
 
  protected:
   using Base::has_control_limits_;  //!< Indicates whether any of the control
@@ -93,6 +114,34 @@ class ActionModelQuadrupedNonLinearTpl
   using Base::unone_;               //!< Neutral state
 
  private:
+  // update_model without the checks, c and s are the cos and sin of the yaw
+  // of the reference
+  void update_model_yaw(
+      const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+      const Eigen::Ref<const typename MathBase::MatrixXs>& S, const Scalar& c,
+      const Scalar& s);
+
+  typedef void (ActionModelQuadrupedNonLinearTpl::*Kernel)(
+      ActionDataQuadrupedNonLinearTpl<Scalar>* d,
+      const Eigen::Ref<const typename MathBase::VectorXs>& x,
+      const Eigen::Ref<const typename MathBase::VectorXs>& u) const;
+
+  // calc and calcDiff for the contact mask Mask, see contact_mask.hpp
+  template <int Mask>
+  void calc_kernel(ActionDataQuadrupedNonLinearTpl<Scalar>* d,
+                   const Eigen::Ref<const typename MathBase::VectorXs>& x,
+                   const Eigen::Ref<const typename MathBase::VectorXs>& u)
+      const;
+  template <int Mask>
+  void calc_diff_kernel(
+      ActionDataQuadrupedNonLinearTpl<Scalar>* d,
+      const Eigen::Ref<const typename MathBase::VectorXs>& x,
+      const Eigen::Ref<const typename MathBase::VectorXs>& u) const;
+
+  // Selects the kernels of the contact mask of gait
+  void select_kernels();
+
   Scalar dt_;
   Scalar mass;
   Scalar mu;
@@ -107,42 +156,39 @@ class ActionModelQuadrupedNonLinearTpl
   typename Eigen::Matrix<Scalar, 12, 1> force_weights_;
   typename Eigen::Matrix<Scalar, 12, 1> state_weights_;
 
-  typename Eigen::Matrix<Scalar, 12, 12> A;
-  typename Eigen::Matrix<Scalar, 12, 12> B;
+  // A is the identity with dt on the diagonal of its top right 6x6 block, it
+  // is not stored. The first 6 rows of B are 0, only the last 6 are stored.
+  typename Eigen::Matrix<Scalar, 6, 12> B;
   typename Eigen::Matrix<Scalar, 12, 1> g;
   typename Eigen::Matrix<Scalar, 3, 3> I_inv;
-  typename MathBase::Matrix3s R_tmp;
   typename Eigen::Matrix<Scalar, 3, 3> gI;
+  typename Eigen::Matrix<Scalar, 3, 3> gI_inv;  // Inverse of gI
 
   typename Eigen::Matrix<Scalar, 3, 4> lever_arms;
-  typename MathBase::Vector3s lever_tmp;
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
 
-  typename Eigen::Matrix<Scalar, 24, 1> ub;
+  typename FrictionPyramidTpl<Scalar>::MatrixFaces ub;
 
-  typename Eigen::Matrix<Scalar, 24, 1> Fa_x_u;
-  typename Eigen::Matrix<Scalar, 24, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 24, 24> Arr;
-  typename Eigen::Matrix<Scalar, 6, 1> r;
   typename Eigen::Matrix<Scalar, 4, 1> gait;
 
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_x;
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_y;
   typename Eigen::Matrix<Scalar, 3, 1> base_vector_z;
-  typename Eigen::Matrix<Scalar, 3, 1> forces_3d;
 
   // Cost relative to the shoulder height
   typename Eigen::Matrix<Scalar, 2, 4> pshoulder_0;
-  typename Eigen::Matrix<Scalar, 3, 4> psh;
-  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
   typename Eigen::Matrix<Scalar, 3, 1> offset_com;
   Scalar sh_weight;
   Scalar sh_hlim;
+
+  Kernel calc_kernel_;
+  Kernel calc_diff_kernel_;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedNonLinearTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -161,7 +207,23 @@ struct ActionDataQuadrupedNonLinearTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedNonLinearTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {
+    B.setZero();
+    psh.setZero();
+    sh_ub_max_.setZero();
+  }
+
+  // Last 6 rows of B, that depend on the state (lever arms wrt the CoM), they
+  // are rebuilt in calc from the contact part set by update_model
+  typename Eigen::Matrix<Scalar, 6, 12> B;
+
+  // Quantities computed in calc and reused in calcDiff, kept in the data so
+  // that the nodes of a problem can be evaluated concurrently
+  FrictionPyramidTpl<Scalar> friction;
+
+  // Cost relative to the shoulder height
+  typename Eigen::Matrix<Scalar, 3, 4> psh;
+  typename Eigen::Matrix<Scalar, 4, 1> sh_ub_max_;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -170,9 +232,21 @@ struct ActionDataQuadrupedNonLinearTpl
 
 typedef ActionModelQuadrupedNonLinearTpl<double> ActionModelQuadrupedNonLinear;
 typedef ActionDataQuadrupedNonLinearTpl<double> ActionDataQuadrupedNonLinear;
+typedef ActionModelQuadrupedNonLinearTpl<float>
+    ActionModelQuadrupedNonLinearFloat;
+typedef ActionDataQuadrupedNonLinearTpl<float>
+    ActionDataQuadrupedNonLinearFloat;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_nl.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_nl.cpp
+extern template class ActionModelQuadrupedNonLinearTpl<double>;
+extern template struct ActionDataQuadrupedNonLinearTpl<double>;
+extern template class ActionModelQuadrupedNonLinearTpl<float>;
+extern template struct ActionDataQuadrupedNonLinearTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
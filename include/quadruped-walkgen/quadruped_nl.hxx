@@ -25,14 +25,14 @@ ActionModelQuadrupedNonLinearTpl<Scalar>::ActionModelQuadrupedNonLinearTpl(
   g[8] = Scalar(-9.81) * dt_;
   gI.setZero();
   gI.diagonal() << Scalar(3.09249e-2), Scalar(5.106100e-2), Scalar(6.939757e-2);
-  A.setIdentity();
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() * dt_;
+  gI_inv = gI.inverse();
   B.setZero();
   lever_arms.setZero();
   I_inv.setZero();
+  xref_.setZero();
 
   // Weight vectors initialization
-  force_weights_.setConstant(0.2);
+  force_weights_.setConstant(Scalar(0.2));
   state_weights_ << Scalar(1.), Scalar(1.), Scalar(150.), Scalar(35.),
       Scalar(30.), Scalar(8.), Scalar(20.), Scalar(20.), Scalar(15.),
       Scalar(4.), Scalar(4.), Scalar(8.);
@@ -40,22 +40,13 @@ ActionModelQuadrupedNonLinearTpl<Scalar>::ActionModelQuadrupedNonLinearTpl(
 
   // UpperBound vector
   ub.setZero();
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz;
-  }
+  ub.col(5).setConstant(max_fz);
 
-  // Temporary vector used
-  Fa_x_u.setZero();
-  rub_max_.setZero();
-  Arr.setZero();
-  r.setZero();
-  lever_tmp.setZero();
-  R_tmp.setZero();
   gait.setZero();
+  select_kernels();
   base_vector_x << Scalar(1.), Scalar(0.), Scalar(0.);
   base_vector_y << Scalar(0.), Scalar(1.), Scalar(0.);
   base_vector_z << Scalar(0.), Scalar(0.), Scalar(1.);
-  forces_3d.setZero();
 
   // Used for shoulder height weight
   pshoulder_0 << Scalar(0.1946), Scalar(0.1946), Scalar(-0.1946),
@@ -63,8 +54,6 @@ ActionModelQuadrupedNonLinearTpl<Scalar>::ActionModelQuadrupedNonLinearTpl(
       Scalar(-0.14695);
   sh_hlim = Scalar(0.27);
   sh_weight = Scalar(10.);
-  sh_ub_max_.setZero();
-  psh.setZero();
 
   // Implicit integration
   // V+ = V + dt*B*u   ; P+ = P + dt*V+ != explicit : P+ = P + dt*V
@@ -80,6 +69,7 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -93,63 +83,94 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::calc(
 
   ActionDataQuadrupedNonLinearTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedNonLinearTpl<Scalar>*>(data.get());
+  (this->*calc_kernel_)(d, x, u);
+
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    d->cost_terms[CostTerm::Force] =
+        Scalar(0.5) * d->r.template tail<12>().squaredNorm();
+    d->cost_terms[CostTerm::Friction] =
+        friction_weight_ * Scalar(0.5) * d->friction.rub.squaredNorm();
+    d->cost_terms[CostTerm::Shoulder] =
+        sh_weight * Scalar(0.5) * d->sh_ub_max_.sum();
+  }
+}
 
+template <typename Scalar>
+template <int Mask>
+void ActionModelQuadrupedNonLinearTpl<Scalar>::calc_kernel(
+    ActionDataQuadrupedNonLinearTpl<Scalar>* d,
+    const Eigen::Ref<const typename MathBase::VectorXs>& x,
+    const Eigen::Ref<const typename MathBase::VectorXs>& u) const {
   //  Update B :
+  // The feet in swing phase are skipped, their columns of B stay 0 and their
+  // shoulder distance is 0. gait(i) is 1 for the others, except in the full
+  // mask kernel of the AD scalar where the products with gait(i) cancel the
+  // feet in swing phase.
+  d->B = B;
   for (int i = 0; i < 4; i = i + 1) {
-    if (gait(i, 0) != 0) {
-      lever_tmp = lever_arms.block(0, i, 3, 1) - x.block(0, 0, 3, 1);
-      R_tmp << 0.0, -lever_tmp[2], lever_tmp[1], lever_tmp[2], 0.0,
-          -lever_tmp[0], -lever_tmp[1], lever_tmp[0], 0.0;
-      B.block(9, 3 * i, 3, 3) << dt_ * I_inv * R_tmp;
+    if (Mask & (1 << i)) {
+      const typename MathBase::Vector3s lever_tmp =
+          gait(i, 0) * (lever_arms.block(0, i, 3, 1) - x.block(0, 0, 3, 1));
+      typename MathBase::Matrix3s R_tmp;
+      R_tmp << Scalar(0.0), -lever_tmp[2], lever_tmp[1], lever_tmp[2],
+          Scalar(0.0), -lever_tmp[0], -lever_tmp[1], lever_tmp[0], Scalar(0.0);
+      d->B.block(3, 3 * i, 3, 3) << dt_ * I_inv * R_tmp;
 
       // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1) << x[0] - offset_com(0, 0) + pshoulder_0(0, i) -
-                                   pshoulder_0(1, i) * x[5] - lever_arms(0, i),
+      d->psh.block(0, i, 3, 1) << x[0] - offset_com(0, 0) +
+                                      pshoulder_0(0, i) -
+                                      pshoulder_0(1, i) * x[5] -
+                                      lever_arms(0, i),
           x[1] - offset_com(1, 0) + pshoulder_0(1, i) +
               pshoulder_0(0, i) * x[5] - lever_arms(1, i),
           x[2] - offset_com(2, 0) + pshoulder_0(1, i) * x[3] -
               pshoulder_0(0, i) * x[4];
+      d->psh.block(0, i, 3, 1) *= gait(i, 0);
     } else {
-      // Compute pdistance of the shoulder wrt contact point
-      psh.block(0, i, 3, 1).setZero();
+      d->psh.block(0, i, 3, 1).setZero();
     }
   };
 
-  // Discrete dynamic : A*x + B*u + g
-  d->xnext << A.diagonal().cwiseProduct(x) + g;
-  d->xnext.template head<6>() =
-      d->xnext.template head<6>() +
-      A.topRightCorner(6, 6).diagonal().cwiseProduct(x.tail(6));
-  d->xnext.template tail<6>() =
-      d->xnext.template tail<6>() + B.block(6, 0, 6, 12) * u;
+  // Discrete dynamic : A*x + B*u + g, B(6:9, 3i:3i+3) is diagonal (B(0:3,
+  // 3i:3i+3) in the stored rows)
+  d->xnext << x + g;
+  d->xnext.template head<6>() += dt_ * x.template tail<6>();
+  for (int i = 0; i < 4; i = i + 1) {
+    if (Mask & (1 << i)) {
+      d->xnext.template segment<3>(6) +=
+          d->B(0, 3 * i) * u.template segment<3>(3 * i);
+      d->xnext.template segment<3>(9) +=
+          d->B.template block<3, 3>(3, 3 * i) * u.template segment<3>(3 * i);
+    }
+  }
 
   // Residual cost on the state and force norm
   d->r.template head<12>() = state_weights_.cwiseProduct(x - xref_);
   d->r.template tail<12>() = force_weights_.cwiseProduct(u - uref_);
 
   // Friction cone + shoulder height
+  const Scalar friction_cost = d->friction.calc(u, mu, ub);
+
+  // Shoulder height weight, 0 for the feet in swing phase
   for (int i = 0; i < 4; i = i + 1) {
-    Fa_x_u.segment(6 * i, 6) << u(3 * i) - mu * u(3 * i + 2),
-        -u(3 * i) - mu * u(3 * i + 2), u(3 * i + 1) - mu * u(3 * i + 2),
-        -u(3 * i + 1) - mu * u(3 * i + 2), -u(3 * i + 2), u(3 * i + 2);
+    d->sh_ub_max_[i] =
+        (Mask & (1 << i))
+            ? Conditional::max(
+                  d->psh.block(0, i, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
+                  Scalar(0.))
+            : Scalar(0.);
   }
-  rub_max_ = (Fa_x_u - ub).cwiseMax(Scalar(0.));
-
-  // Shoulder height weight
-  sh_ub_max_ << psh.block(0, 0, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 1, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 2, 3, 1).squaredNorm() - sh_hlim * sh_hlim,
-      psh.block(0, 3, 3, 1).squaredNorm() - sh_hlim * sh_hlim;
-
-  sh_ub_max_ = sh_ub_max_.cwiseMax(Scalar(0.));
 
   // Cost computation
   // d->cost = 0.5 * d->r.transpose() * d->r     + friction_weight_ *
   // Scalar(0.5) * rub_max_.squaredNorm() + sh_weight
   // * Scalar(0.5) * sh_ub_max_.squaredNorm() ;
-  d->cost = 0.5 * d->r.transpose() * d->r +
-            friction_weight_ * Scalar(0.5) * rub_max_.squaredNorm() +
-            sh_weight * Scalar(0.5) * sh_ub_max_.sum();
+  d->cost = (Scalar(0.5) * d->r.transpose() * d->r).value() +
+            friction_weight_ * friction_cost +
+            sh_weight * Scalar(0.5) * d->sh_ub_max_.sum();
 }
 
 template <typename Scalar>
@@ -157,6 +178,7 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -170,7 +192,15 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::calcDiff(
 
   ActionDataQuadrupedNonLinearTpl<Scalar>* d =
       static_cast<ActionDataQuadrupedNonLinearTpl<Scalar>*>(data.get());
+  (this->*calc_diff_kernel_)(d, x, u);
+}
 
+template <typename Scalar>
+template <int Mask>
+void ActionModelQuadrupedNonLinearTpl<Scalar>::calc_diff_kernel(
+    ActionDataQuadrupedNonLinearTpl<Scalar>* d,
+    const Eigen::Ref<const typename MathBase::VectorXs>&,
+    const Eigen::Ref<const typename MathBase::VectorXs>& u) const {
   // Cost derivatives : Lx
 
   d->Lx = (state_weights_.array() * d->r.template head<12>().array()).matrix();
@@ -180,79 +210,81 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::calcDiff(
   d->Lxx.diagonal() =
       (state_weights_.array() * state_weights_.array()).matrix();
 
-  // Shoulder height derivative cost
+  // Shoulder height derivative cost, w is 0 if the shoulder is below its
+  // limit and for the feet in swing phase
   for (int j = 0; j < 4; j = j + 1) {
-    if (sh_ub_max_[j] > Scalar(0.)) {
-      d->Lx(0, 0) += sh_weight * psh(0, j);
-      d->Lx(1, 0) += sh_weight * psh(1, j);
-      d->Lx(2, 0) += sh_weight * psh(2, j);
-      d->Lx(3, 0) += sh_weight * pshoulder_0(1, j) * psh(2, j);
-      d->Lx(4, 0) += -sh_weight * pshoulder_0(0, j) * psh(2, j);
-      d->Lx(5, 0) += sh_weight * (-pshoulder_0(1, j) * psh(0, j) +
-                                  pshoulder_0(0, j) * psh(1, j));
-
-      d->Lxx(0, 0) += sh_weight;
-      d->Lxx(1, 1) += sh_weight;
-      d->Lxx(2, 2) += sh_weight;
-      d->Lxx(3, 3) += sh_weight * pshoulder_0(1, j) * pshoulder_0(1, j);
-      d->Lxx(3, 3) += sh_weight * pshoulder_0(0, j) * pshoulder_0(0, j);
-      d->Lxx(5, 5) += sh_weight * (pshoulder_0(1, j) * pshoulder_0(1, j) +
-                                   pshoulder_0(0, j) * pshoulder_0(0, j));
-
-      d->Lxx(0, 5) += -sh_weight * pshoulder_0(1, j);
-      d->Lxx(5, 0) += -sh_weight * pshoulder_0(1, j);
-
-      d->Lxx(1, 5) += sh_weight * pshoulder_0(0, j);
-      d->Lxx(5, 1) += sh_weight * pshoulder_0(0, j);
-
-      d->Lxx(2, 3) += sh_weight * pshoulder_0(1, j);
-      d->Lxx(2, 4) += -sh_weight * pshoulder_0(0, j);
-      d->Lxx(3, 2) += sh_weight * pshoulder_0(1, j);
-      d->Lxx(4, 2) += -sh_weight * pshoulder_0(0, j);
-
-      d->Lxx(3, 4) += -sh_weight * pshoulder_0(1, j) * pshoulder_0(0, j);
-      d->Lxx(4, 3) += -sh_weight * pshoulder_0(1, j) * pshoulder_0(0, j);
+    if (!(Mask & (1 << j))) {
+      continue;
     }
+    const Scalar w = sh_weight * Conditional::positive(d->sh_ub_max_[j]);
+    d->Lx(0, 0) += w * d->psh(0, j);
+    d->Lx(1, 0) += w * d->psh(1, j);
+    d->Lx(2, 0) += w * d->psh(2, j);
+    d->Lx(3, 0) += w * pshoulder_0(1, j) * d->psh(2, j);
+    d->Lx(4, 0) += -w * pshoulder_0(0, j) * d->psh(2, j);
+    d->Lx(5, 0) += w * (-pshoulder_0(1, j) * d->psh(0, j) +
+                        pshoulder_0(0, j) * d->psh(1, j));
+
+    d->Lxx(0, 0) += w;
+    d->Lxx(1, 1) += w;
+    d->Lxx(2, 2) += w;
+    d->Lxx(3, 3) += w * pshoulder_0(1, j) * pshoulder_0(1, j);
+    d->Lxx(3, 3) += w * pshoulder_0(0, j) * pshoulder_0(0, j);
+    d->Lxx(5, 5) += w * (pshoulder_0(1, j) * pshoulder_0(1, j) +
+                         pshoulder_0(0, j) * pshoulder_0(0, j));
+
+    d->Lxx(0, 5) += -w * pshoulder_0(1, j);
+    d->Lxx(5, 0) += -w * pshoulder_0(1, j);
+
+    d->Lxx(1, 5) += w * pshoulder_0(0, j);
+    d->Lxx(5, 1) += w * pshoulder_0(0, j);
+
+    d->Lxx(2, 3) += w * pshoulder_0(1, j);
+    d->Lxx(2, 4) += -w * pshoulder_0(0, j);
+    d->Lxx(3, 2) += w * pshoulder_0(1, j);
+    d->Lxx(4, 2) += -w * pshoulder_0(0, j);
+
+    d->Lxx(3, 4) += -w * pshoulder_0(1, j) * pshoulder_0(0, j);
+    d->Lxx(4, 3) += -w * pshoulder_0(1, j) * pshoulder_0(0, j);
   }
 
-  // Cost derivative : Lu
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * rub_max_.segment(6 * i, 6);
-    d->Lu.block(i * 3, 0, 3, 1) << r(0) - r(1), r(2) - r(3),
-        -mu * (r(0) + r(1) + r(2) + r(3)) - r(4) + r(5);
-  }
+  // Cost derivative : Lu, and the friction cone blocks of Luu
+  d->friction.calcDiff(friction_weight_, mu, d->Lu, d->Luu);
   d->Lu = d->Lu +
           (force_weights_.array() * d->r.template tail<12>().array()).matrix();
 
   // Hessian : Luu
-  // Matrix friction cone hessian (20x12)
-  Arr.diagonal() =
-      ((Fa_x_u - ub).array() >= 0.).matrix().template cast<Scalar>();
-  for (int i = 0; i < 4; i = i + 1) {
-    r = friction_weight_ * Arr.diagonal().segment(6 * i, 6);
-    d->Luu.block(3 * i, 3 * i, 3, 3) << r(0) + r(1), 0.0, mu * (r(1) - r(0)),
-        0.0, r(2) + r(3), mu * (r(3) - r(2)), mu * (r(1) - r(0)),
-        mu * (r(3) - r(2)), mu * mu * (r(0) + r(1) + r(2) + r(3)) + r(4) + r(5);
-  }
   d->Luu.diagonal() =
       d->Luu.diagonal() +
       (force_weights_.array() * force_weights_.array()).matrix();
 
   // Dynamic derivatives
-  d->Fx << A;
+  d->Fx.setIdentity();
+  d->Fx.topRightCorner(6, 6).diagonal().setConstant(dt_);
 
   for (int i = 0; i < 4; i = i + 1) {
-    if (gait(i, 0) != 0) {
-      forces_3d = u.block(3 * i, 0, 3, 1);
-      d->Fx.block(9, 0, 3, 1) +=
-          -dt_ * I_inv * (base_vector_x.cross(forces_3d));
-      d->Fx.block(9, 1, 3, 1) +=
-          -dt_ * I_inv * (base_vector_y.cross(forces_3d));
-      d->Fx.block(9, 2, 3, 1) +=
-          -dt_ * I_inv * (base_vector_z.cross(forces_3d));
+    if (!(Mask & (1 << i))) {
+      continue;
     }
+    const typename MathBase::Vector3s forces_3d =
+        gait(i, 0) * u.block(3 * i, 0, 3, 1);
+    d->Fx.block(9, 0, 3, 1) += -dt_ * I_inv * (base_vector_x.cross(forces_3d));
+    d->Fx.block(9, 1, 3, 1) += -dt_ * I_inv * (base_vector_y.cross(forces_3d));
+    d->Fx.block(9, 2, 3, 1) += -dt_ * I_inv * (base_vector_z.cross(forces_3d));
   }
-  d->Fu << B;
+  d->Fu.topRows(6).setZero();
+  d->Fu.bottomRows(6) = d->B;
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedNonLinearTpl<Scalar>::select_kernels() {
+  static const Kernel calc_kernels[16] = QUADRUPED_WALKGEN_CONTACT_KERNELS(
+      ActionModelQuadrupedNonLinearTpl, calc_kernel);
+  static const Kernel calc_diff_kernels[16] = QUADRUPED_WALKGEN_CONTACT_KERNELS(
+      ActionModelQuadrupedNonLinearTpl, calc_diff_kernel);
+  const int mask = ContactMaskTpl<Scalar>::from_gait(gait);
+  calc_kernel_ = calc_kernels[mask];
+  calc_diff_kernel_ = calc_diff_kernels[mask];
 }
 
 template <typename Scalar>
@@ -336,7 +368,6 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::set_dt(const Scalar& dt) {
   // The model need to be updated after this changed
   dt_ = dt;
   g[8] = Scalar(-9.81) * dt_;
-  A.topRightCorner(6, 6) << Eigen::Matrix<Scalar, 6, 6>::Identity() * dt_;
 }
 
 template <typename Scalar>
@@ -353,6 +384,7 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::set_gI(
                  << "gI has wrong dimension : 3x3");
   }
   gI = inertia_matrix;
+  gI_inv = gI.inverse();
 }
 
 template <typename Scalar>
@@ -379,9 +411,7 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::set_max_fz_contact(
     const Scalar& max_fz_) {
   // The model need to be updated after this changed
   max_fz = max_fz_;
-  for (int i = 0; i < 4; i = i + 1) {
-    ub(6 * i + 5) = max_fz;
-  }
+  ub.col(5).setConstant(max_fz);
 }
 
 template <typename Scalar>
@@ -408,18 +438,30 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::set_shoulder_weight(
   sh_weight = weight;
 }
 
+template <typename Scalar>
+const typename Eigen::Matrix<Scalar, 3, 1>&
+ActionModelQuadrupedNonLinearTpl<Scalar>::get_offset_com() const {
+  return offset_com;
+}
+
 ///////////////////////////
 //// get A & B matrix /////
 ///////////////////////////
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedNonLinearTpl<Scalar>::get_A() const {
+  typename Eigen::Matrix<Scalar, 12, 12> A;
+  A.setIdentity();
+  A.topRightCorner(6, 6).diagonal().setConstant(dt_);
   return A;
 }
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 12, 12>&
+typename Eigen::Matrix<Scalar, 12, 12>
 ActionModelQuadrupedNonLinearTpl<Scalar>::get_B() const {
-  return B;
+  typename Eigen::Matrix<Scalar, 12, 12> B_full;
+  B_full.topRows(6).setZero();
+  B_full.bottomRows(6) = B;
+  return B_full;
 }
 
 // to modify the cost on the command : || fz - m*g/nb contact ||^2
@@ -435,10 +477,10 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::set_relative_forces(
   relative_forces = rel_forces;
   uref_.setZero();
   if (relative_forces) {
+    const Scalar fz =
+        (Scalar(9.81) * mass) / Conditional::max(gait.sum(), Scalar(1.));
     for (int i = 0; i < 4; i = i + 1) {
-      if (gait[i] == 1) {
-        uref_[3 * i + 2] = (Scalar(9.81) * mass) / (gait.sum());
-      }
+      uref_[3 * i + 2] = gait[i] * fz;
     }
   }
 }
@@ -452,6 +494,9 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -466,47 +511,85 @@ void ActionModelQuadrupedNonLinearTpl<Scalar>::update_model(
                  << "S vector has wrong dimension (it should be 4x1)");
   }
 
+  update_model_yaw(l_feet, xref, S, cos(xref(5, 0)), sin(xref(5, 0)));
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedNonLinearTpl<Scalar>::update_models(
+    const std::vector<boost::shared_ptr<ActionModelQuadrupedNonLinearTpl> >&
+        models,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  const Eigen::Index N = static_cast<Eigen::Index>(models.size());
+  if (l_feet.rows() != 3 || l_feet.cols() != 4 * N) {
+    throw_pretty("Invalid argument: "
+                 << "l_feet matrix has wrong dimension (it should be : 3x" +
+                        std::to_string(4 * N) + ")");
+  }
+  if (xref.rows() != 12 || xref.cols() != N) {
+    throw_pretty("Invalid argument: "
+                 << "xref matrix has wrong dimension (it should be : 12x" +
+                        std::to_string(N) + ")");
+  }
+  if (S.rows() != 4 || S.cols() != N) {
+    throw_pretty("Invalid argument: "
+                 << "S matrix has wrong dimension (it should be : 4x" +
+                        std::to_string(N) + ")");
+  }
+
+  for (Eigen::Index k = 0; k < N; ++k) {
+    models[k]->update_model_yaw(l_feet.middleCols(4 * k, 4), xref.col(k),
+                                S.col(k), cos(xref(5, k)), sin(xref(5, k)));
+  }
+}
+
+template <typename Scalar>
+void ActionModelQuadrupedNonLinearTpl<Scalar>::update_model_yaw(
+    const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
+    const Eigen::Ref<const typename MathBase::MatrixXs>& S, const Scalar& c,
+    const Scalar& s) {
   xref_ = xref;
   gait = S;
+  select_kernels();
 
   // Set ref u vector according to nb of contact
+  // S is 0 or 1, the number of contacts is kept at 1 at least so that a node
+  // without contact has no reference force
   uref_.setZero();
   if (relative_forces) {
+    const Scalar fz =
+        (Scalar(9.81) * mass) / Conditional::max(gait.sum(), Scalar(1.));
     for (int i = 0; i < 4; i = i + 1) {
-      if (gait[i] == 1) {
-        uref_[3 * i + 2] = (Scalar(9.81) * mass) / (gait.sum());
-      }
+      uref_[3 * i + 2] = gait[i] * fz;
     }
   }
 
-  R_tmp << cos(xref(5, 0)), -sin(xref(5, 0)), 0, sin(xref(5, 0)),
-      cos(xref(5, 0)), 0, 0, 0, 1.0;
-
-  I_inv = (R_tmp.transpose() * gI * R_tmp).inverse();  // I_inv
+  // Inertia rotated by the yaw only : (R^T gI R)^-1 = R^T gI^-1 R
+  typename MathBase::Matrix3s R_tmp;
+  R_tmp << c, -s, Scalar(0), s, c, Scalar(0), Scalar(0), Scalar(0), Scalar(1);
+  I_inv.noalias() = R_tmp.transpose() * gI_inv * R_tmp;
   lever_arms.block(0, 0, 2, 4) = l_feet.block(0, 0, 2, 4);
 
   for (int i = 0; i < 4; i = i + 1) {
-    if (S(i, 0) != 0) {
-      // set limit for normal force, (foot in contact with the ground)
-      ub(6 * i + 4) = -min_fz_in_contact;
+    // set limit for normal force, (0.0 if the foot is not in contact with the
+    // ground)
+    ub(i, 4) = -min_fz_in_contact * S(i, 0);
 
-      // B update
-      B.block(6, 3 * i, 3, 3).diagonal() << dt_ / mass, dt_ / mass, dt_ / mass;
+    // B update, the force of a foot in swing phase has no effect
+    B.block(0, 3 * i, 3, 3).diagonal().setConstant(S(i, 0) * dt_ / mass);
 
-      //  Assuption 1 : levers arms not depends on the state, but on the
-      //  predicted position (xfref)
-      //  --> B will be updated with the update_B method for each calc function
+    //  Assuption 1 : levers arms not depends on the state, but on the
+    //  predicted position (xfref)
+    //  --> B will be updated with the update_B method for each calc function
 
-      // lever_tmp = lever_arms.block(0,i,3,1) - xref.block(0,0,3,1) ;
-      // R_tmp << 0.0, -lever_tmp[2], lever_tmp[1],
-      // lever_tmp[2], 0.0, -lever_tmp[0], -lever_tmp[1], lever_tmp[0], 0.0 ;
-      // B.block(9 , 3*i  , 3,3) << dt_ * R* R_tmp;
-    } else {
-      // set limit for normal force at 0.0
-      ub(6 * i + 4) = 0.0;
-      B.block(6, 3 * i, 3, 3).setZero();
-      B.block(9, 3 * i, 3, 3).setZero();
-    };
+    // lever_tmp = lever_arms.block(0,i,3,1) - xref.block(0,0,3,1) ;
+    // R_tmp << 0.0, -lever_tmp[2], lever_tmp[1],
+    // lever_tmp[2], 0.0, -lever_tmp[0], -lever_tmp[1], lever_tmp[0], 0.0 ;
+    // B.block(9 , 3*i  , 3,3) << dt_ * R* R_tmp;
   };
 }
 }  // namespace quadruped_walkgen
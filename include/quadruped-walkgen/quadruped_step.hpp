@@ -7,16 +7,39 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/polynomial.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
-template <typename _Scalar>
+template <typename _Scalar, int _NSampling>
+struct ActionDataQuadrupedStepTpl;
+
+// NSampling is the number of points sampling the polynomial trajectories of
+// the feet. With Eigen::Dynamic it is chosen at runtime with
+// set_sample_feet_traj, otherwise the sampled costs are fixed-size arrays and
+// their loops are unrolled by the compiler.
+template <typename _Scalar, int _NSampling = Eigen::Dynamic>
 class ActionModelQuadrupedStepTpl
     : public crocoddyl::ActionModelAbstractTpl<_Scalar> {
  public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   typedef _Scalar Scalar;
   typedef crocoddyl::ActionDataAbstractTpl<Scalar> ActionDataAbstract;
   typedef crocoddyl::ActionModelAbstractTpl<Scalar> Base;
   typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
+  typedef ActionDataQuadrupedStepTpl<Scalar, _NSampling> Data;
+  enum {
+    NSampling = _NSampling,
+    // Samples strictly inside the trajectory : [1/N, 2/N, ... , (N-1)/N]
+    NSamples = _NSampling == Eigen::Dynamic ? Eigen::Dynamic : _NSampling - 1
+  };
+  typedef Eigen::Array<Scalar, NSamples, 1> ArraySamples;
+  typedef Eigen::Array<Scalar, NSamples, 3> ArraySamples3;
+  typedef Eigen::Array<Scalar, NSamples, 4> ArraySamples4;
+  typedef PolynomialTpl<Scalar> Polynomial;
+  typedef Eigen::Matrix<Scalar, Polynomial::MaxDegree + 1, 8> PolynomialFeet;
 
   ActionModelQuadrupedStepTpl();
   ~ActionModelQuadrupedStepTpl();
@@ -80,6 +103,9 @@ class ActionModelQuadrupedStepTpl
   const Scalar& get_vel_weight() const;
   void set_vel_weight(const Scalar& weight_);
 
+  const int& get_sample_feet_traj() const;
+  // Only the dynamic model can change its number of samples, a fixed-size
+  // model throws if n_sample differs from NSampling
   void set_sample_feet_traj(const int& n_sample);
 
   const bool& get_jerk_activated() const;
@@ -88,6 +114,12 @@ class ActionModelQuadrupedStepTpl
   const Scalar& get_jerk_weight() const;
   void set_jerk_weight(const Scalar& weight_);
 
+  // Penalise the acceleration and velocity of the feet at the extrema of their
+  // polynomial trajectories, found analytically, instead of on N_sampling
+  // points
+  const bool& get_extremum_cost() const;
+  void set_extremum_cost(const bool& extremum_cost);
+
  protected:
   using Base::has_control_limits_;  //!< Indicates whether any of the control
                                     //!< limits
@@ -99,6 +131,32 @@ class ActionModelQuadrupedStepTpl
   using Base::unone_;               //!< Neutral state
 
  private:
+  // Coefficients of the sampled polynomials, depending only on N_sampling
+  void compute_sampling_coefficients();
+
+  // Derivatives of the costs on the sampled trajectory of one foot, gx, gy
+  // are the sums of the gradients along the x and y world axes and hx, hy the
+  // sums of the Gauss-Newton hessians
+  void add_foot_derivatives(Data* d, const int& foot, const Scalar& gx,
+                            const Scalar& gy, const Scalar& hx,
+                            const Scalar& hy) const;
+
+  // Residuals of the extrema of the polynomials p_world * poly_D + poly of
+  // the moving feet, for both signs, and the derivatives alpha of these
+  // residuals with respect to p_world
+  void calc_extremum_residuals(const Eigen::Matrix<Scalar, 2, 4>& p_world,
+                               const PolynomialFeet& poly,
+                               const typename Polynomial::Coefficients& poly_D,
+                               const int& degree,
+                               const Eigen::Matrix<Scalar, 2, 1>& lim,
+                               Eigen::Matrix<Scalar, 2, 8>& rb,
+                               Eigen::Matrix<Scalar, 2, 8>& alpha) const;
+  static void sum_extremum_derivatives(const Scalar& weight,
+                                       const Eigen::Matrix<Scalar, 2, 8>& rb,
+                                       const Eigen::Matrix<Scalar, 2, 8>& alpha,
+                                       const int& foot, Scalar& gx, Scalar& gy,
+                                       Scalar& hx, Scalar& hy);
+
   Scalar T_gait;
   bool centrifugal_term;
   bool symmetry_term;
@@ -110,7 +168,7 @@ class ActionModelQuadrupedStepTpl
 
   typename Eigen::Matrix<Scalar, 8, 8> B;
 
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
   typename Eigen::Matrix<Scalar, 8, 1> pheuristic_;
 
   // typename Eigen::Matrix<Scalar, 2, 4> pshoulder_0;
@@ -127,60 +185,54 @@ class ActionModelQuadrupedStepTpl
   typename Eigen::Matrix<Scalar, 2, 1>
       acc_lim_;  // Maximum acceleration allowed on x and y axis
   typename Eigen::Matrix<Scalar, 4, 1> S_;  // Containing the moving feet
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> delta_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> gamma_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> alpha_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> beta_x_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> beta_y_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> tmp_ones_;
+  ArraySamples4 delta_;
+  ArraySamples3 gamma_;
+  ArraySamples alpha_;
+  ArraySamples4 beta_x_;
+  ArraySamples4 beta_y_;
   typename Eigen::Array<Scalar, 3, 4> position_;
 
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rb_accx_max_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rb_accy_max_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>
-      rb_accx_max_bool_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>
-      rb_accy_max_bool_;
-
   // Cost on the velocity of the feet :
   bool is_vel_activated_;  // Boolean to activate the cost on the velocity of
                            // the feet
   Scalar vel_weight_;      // Weight on the velocity cost
   typename Eigen::Matrix<Scalar, 2, 1>
       vel_lim_;  // Maximum velocity allowed on x and y axis
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> gamma_v;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> alpha_v;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> beta_x_v;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> beta_y_v;
-
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rb_velx_max_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rb_vely_max_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>
-      rb_velx_max_bool_;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>
-      rb_vely_max_bool_;
+  ArraySamples4 gamma_v;
+  ArraySamples alpha_v;
+  ArraySamples4 beta_x_v;
+  ArraySamples4 beta_y_v;
 
   // Cost on the jerk of the feet
   bool is_jerk_activated_;
   Scalar jerk_weight_;
   Scalar alpha_j;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> beta_j;
+  typename Eigen::Array<Scalar, 2, 4> beta_j;
   typename Eigen::Array<Scalar, 3, 4> jerk_;
 
-  typename Eigen::Matrix<Scalar, 2, 4> rb_jerk_;
+  // Cost on the extrema of the feet trajectories. The columns 2*i and 2*i+1
+  // hold the polynomials of the foot i along x and y
+  bool extremum_cost_;
+  PolynomialFeet acc_poly_;
+  PolynomialFeet vel_poly_;
+  typename Polynomial::Coefficients acc_poly_D_;
+  typename Polynomial::Coefficients vel_poly_D_;
 
   typename Eigen::Matrix<Scalar, 3, 3> oRh_;
   typename Eigen::Matrix<Scalar, 3, 1> oTh_;
 };
 
-template <typename _Scalar>
+template <typename _Scalar, int _NSampling = Eigen::Dynamic>
 struct ActionDataQuadrupedStepTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
   typedef crocoddyl::MathBaseTpl<Scalar> MathBase;
   typedef crocoddyl::ActionDataAbstractTpl<Scalar> Base;
+  typedef ActionModelQuadrupedStepTpl<Scalar, _NSampling> Model;
+  typedef Eigen::Array<Scalar, Model::NSamples, 8> ArraySamples8;
   using Base::cost;
   using Base::Fu;
   using Base::Fx;
@@ -192,9 +244,49 @@ struct ActionDataQuadrupedStepTpl
   using Base::r;
   using Base::xnext;
 
-  template <template <typename Scalar> class Model>
-  explicit ActionDataQuadrupedStepTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+  explicit ActionDataQuadrupedStepTpl(Model* const model)
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(
+            static_cast<crocoddyl::ActionModelAbstractTpl<Scalar>*>(model)) {
+    resize(model->get_sample_feet_traj());
+    rb_jerk_.setZero();
+    rb_acc_ext_.setZero();
+    alpha_acc_ext_.setZero();
+    rb_vel_ext_.setZero();
+    alpha_vel_ext_.setZero();
+  }
+
+  // Allocate the residuals for N_sampling points along the feet trajectories
+  void resize(const int& N_sampling) {
+    rb_accx_max_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_accy_max_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_accx_max_bool_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_accy_max_bool_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_velx_max_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_vely_max_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_velx_max_bool_ = ArraySamples8::Zero(N_sampling - 1, 8);
+    rb_vely_max_bool_ = ArraySamples8::Zero(N_sampling - 1, 8);
+  }
+
+  // Residuals of the feet trajectories computed in calc and reused in
+  // calcDiff, kept in the data so that the nodes of a problem can be evaluated
+  // concurrently
+  ArraySamples8 rb_accx_max_;
+  ArraySamples8 rb_accy_max_;
+  ArraySamples8 rb_accx_max_bool_;
+  ArraySamples8 rb_accy_max_bool_;
+  ArraySamples8 rb_velx_max_;
+  ArraySamples8 rb_vely_max_;
+  ArraySamples8 rb_velx_max_bool_;
+  ArraySamples8 rb_vely_max_bool_;
+  typename Eigen::Matrix<Scalar, 2, 4> rb_jerk_;
+
+  // Residuals of the extremum cost, rows x, y and columns 2*i (maximum) and
+  // 2*i+1 (minimum) for the foot i, and their derivatives with respect to the
+  // position of the foot
+  typename Eigen::Matrix<Scalar, 2, 8> rb_acc_ext_;
+  typename Eigen::Matrix<Scalar, 2, 8> alpha_acc_ext_;
+  typename Eigen::Matrix<Scalar, 2, 8> rb_vel_ext_;
+  typename Eigen::Matrix<Scalar, 2, 8> alpha_vel_ext_;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -203,9 +295,29 @@ struct ActionDataQuadrupedStepTpl
 
 typedef ActionModelQuadrupedStepTpl<double> ActionModelQuadrupedStep;
 typedef ActionDataQuadrupedStepTpl<double> ActionDataQuadrupedStep;
+typedef ActionModelQuadrupedStepTpl<float> ActionModelQuadrupedStepFloat;
+typedef ActionDataQuadrupedStepTpl<float> ActionDataQuadrupedStepFloat;
+
+// Fixed-size models for the usual numbers of samples
+typedef ActionModelQuadrupedStepTpl<double, 5> ActionModelQuadrupedStep5;
+typedef ActionDataQuadrupedStepTpl<double, 5> ActionDataQuadrupedStep5;
+typedef ActionModelQuadrupedStepTpl<double, 10> ActionModelQuadrupedStep10;
+typedef ActionDataQuadrupedStepTpl<double, 10> ActionDataQuadrupedStep10;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_step.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_step.cpp
+extern template class ActionModelQuadrupedStepTpl<double>;
+extern template struct ActionDataQuadrupedStepTpl<double>;
+extern template class ActionModelQuadrupedStepTpl<double, 5>;
+extern template struct ActionDataQuadrupedStepTpl<double, 5>;
+extern template class ActionModelQuadrupedStepTpl<double, 10>;
+extern template struct ActionDataQuadrupedStepTpl<double, 10>;
+extern template class ActionModelQuadrupedStepTpl<float>;
+extern template struct ActionDataQuadrupedStepTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
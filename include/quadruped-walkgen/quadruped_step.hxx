@@ -4,11 +4,12 @@
 #include "crocoddyl/core/utils/exception.hpp"
 
 namespace quadruped_walkgen {
-template <typename Scalar>
-ActionModelQuadrupedStepTpl<Scalar>::ActionModelQuadrupedStepTpl()
+template <typename Scalar, int _NSampling>
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::ActionModelQuadrupedStepTpl()
     : crocoddyl::ActionModelAbstractTpl<Scalar>(
           boost::make_shared<crocoddyl::StateVectorTpl<Scalar> >(20), 8, 28) {
   B.setZero();
+  xref_.setZero();
   state_weights_ << Scalar(1.), Scalar(1.), Scalar(150.), Scalar(35.),
       Scalar(30.), Scalar(8.), Scalar(20.), Scalar(20.), Scalar(15.),
       Scalar(4.), Scalar(4.), Scalar(8.);
@@ -23,18 +24,9 @@ ActionModelQuadrupedStepTpl<Scalar>::ActionModelQuadrupedStepTpl()
   step_weights_.setConstant(Scalar(1));
   heuristic_weights_.setConstant(Scalar(1));
 
-  // Compute heuristic inside
-  // pshoulder_0 << Scalar(0.1946), Scalar(0.1946), Scalar(-0.1946),
-  // Scalar(-0.1946), Scalar(0.15005), Scalar(-0.15005),
-  //     Scalar(0.15005), Scalar(-0.15005);
-  // pshoulder_tmp.setZero();
-  // pcentrifugal_tmp_1.setZero();
-  // pcentrifugal_tmp_2.setZero();
-  // pcentrifugal_tmp.setZero();
-
-  N_sampling = 5;  // Number of point to sample the polynomial curve of the feet
-                   // trajectory
-  S_.setZero();    // Usefull to compute only the trajectory for moving feet
+  // Number of point to sample the polynomial curve of the feet trajectory
+  N_sampling = NSampling == Eigen::Dynamic ? 5 : int(NSampling);
+  S_.setZero();  // Usefull to compute only the trajectory for moving feet
   position_.setZero();  // Xk+1 = Xk + Uk, Xk does not correspond to the current
                         // position of the flying feet, Delta_x is not
                         // straightforward
@@ -44,91 +36,38 @@ ActionModelQuadrupedStepTpl<Scalar>::ActionModelQuadrupedStepTpl()
   acc_weight_ = Scalar(1.);
   acc_lim_.setConstant(Scalar(50.));
 
-  delta_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);
-  gamma_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 3);
-  for (int k = 1; k < N_sampling; k++) {
-    delta_(k - 1, 0) =
-        (float)k / (float)N_sampling;  // [1/N, 2/N, ... , (N-1)/N]
-  }
-  delta_.col(1) << delta_.col(0).pow(2);
-  delta_.col(2) << delta_.col(0).pow(3);
-  delta_.col(3) << delta_.col(0).pow(4);  // Only used for speed cost
-  gamma_.col(0) =
-      60 * delta_.col(0) - 180 * delta_.col(1) + 120 * delta_.col(2);
-  gamma_.col(1) = -36 * delta_.col(0) + 96 * delta_.col(1) - 60 * delta_.col(2);
-  gamma_.col(2) = -9 * delta_.col(0) + 18 * delta_.col(1) - 10 * delta_.col(2);
-
-  alpha_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 1);  // Common for 4 feet
-  beta_x_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on a0_x, v0_x of feet
-  beta_y_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on a0_y, v0_y of feet
-  tmp_ones_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Ones(
-      N_sampling - 1, 1);
-
-  rb_accx_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_accy_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_accx_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-  rb_accy_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-
   // Cost on the velocity of the feet :
   is_vel_activated_ = true;
   vel_weight_ = Scalar(1.);
   vel_lim_.setConstant(Scalar(3.));
 
-  gamma_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);
-  gamma_v.col(0) = 30 * delta_.col(1) - 60 * delta_.col(2) + 30 * delta_.col(3);
-  gamma_v.col(1) = delta_.col(0);
-  gamma_v.col(2) =
-      -18 * delta_.col(1) + 32 * delta_.col(2) - 15 * delta_.col(3);
-  gamma_v.col(3) =
-      -4.5 * delta_.col(1) + 6 * delta_.col(2) - 2.5 * delta_.col(3);
-
-  alpha_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 1);  // Common for 4 feet
-  beta_x_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on a0_x, v0_x of feet
-  beta_y_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on a0_y, v0_y of feet
-
-  rb_velx_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_vely_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_velx_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-  rb_vely_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
+  compute_sampling_coefficients();
+
+  // Polynomials of the acceleration and velocity of the feet along the swing
+  // phase, for the extremum cost
+  extremum_cost_ = false;
+  acc_poly_.setZero();
+  vel_poly_.setZero();
+  acc_poly_D_.setZero();
+  vel_poly_D_.setZero();
 
   // Cost on the jerk at t=0
   is_jerk_activated_ = true;
   jerk_weight_ = Scalar(1.);
   alpha_j = Scalar(0.);  // Common for 4 feet
-  beta_j = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      2, 4);  // Depends on a0_x, v0_x of feet
-  rb_jerk_.setZero();
+  beta_j.setZero();      // Depends on a0_x, v0_x of feet
 }
 
-template <typename Scalar>
-ActionModelQuadrupedStepTpl<Scalar>::~ActionModelQuadrupedStepTpl() {}
+template <typename Scalar, int _NSampling>
+ActionModelQuadrupedStepTpl<Scalar,
+                            _NSampling>::~ActionModelQuadrupedStepTpl() {}
 
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::calc(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -140,11 +79,15 @@ void ActionModelQuadrupedStepTpl<Scalar>::calc(
                         std::to_string(nu_) + ")");
   }
 
-  ActionDataQuadrupedStepTpl<Scalar>* d =
-      static_cast<ActionDataQuadrupedStepTpl<Scalar>*>(data.get());
+  Data* d = static_cast<Data*>(data.get());
+
+  // The number of samples can be changed after the creation of the data
+  if (d->rb_accx_max_.rows() != N_sampling - 1) {
+    d->resize(N_sampling);
+  }
 
   d->xnext.template head<12>() = x.head(12);
-  d->xnext.template tail<8>() = x.tail(8) + B * u;
+  d->xnext.template tail<8>() = x.template tail<8>() + B * u.template head<8>();
 
   // Residual cost on the state and force norm
   d->r.template head<12>() = state_weights_.cwiseProduct(x.head(12) - xref_);
@@ -154,198 +97,147 @@ void ActionModelQuadrupedStepTpl<Scalar>::calc(
 
   d->cost = Scalar(0.5) * d->r.transpose() * d->r;
 
+  // Position of the moving feet at the end of the flying phase, expressed in
+  // world frame
+  typename Eigen::Matrix<Scalar, 2, 4> p_world;
+  for (int i = 0; i < 4; i++) {
+    const Scalar px = x(12 + 2 * i) + u(2 * i);
+    const Scalar py = x(12 + 2 * i + 1) + u(2 * i + 1);
+    p_world(0, i) =
+        oRh_(0, 0) * px + oRh_(0, 1) * py + oTh_(0) - position_(0, i);
+    p_world(1, i) =
+        oRh_(1, 0) * px + oRh_(1, 1) * py + oTh_(1) - position_(1, i);
+  }
+
   // Weight on the feet acceleration :
-  if (is_acc_activated_) {
+  if (is_acc_activated_ && extremum_cost_) {
+    calc_extremum_residuals(p_world, acc_poly_, acc_poly_D_, 3, acc_lim_,
+                            d->rb_acc_ext_, d->alpha_acc_ext_);
+    d->cost += Scalar(0.5) * acc_weight_ * d->rb_acc_ext_.squaredNorm();
+  } else if (is_acc_activated_) {
     for (int i = 0; i < 4; i++) {
       if (S_(i) == Scalar(1.)) {
-        // position_ expressed in base frame
-        // rb_accx_max_.col(2*i) = (x(12+ 2*i) + u(2*i) - position_(0,i))*alpha_
-        // + beta_x_.col(i) - acc_lim_(0)*tmp_ones_; rb_accx_max_.col(2*i+1) =
-        // -( x(12+ 2*i) + u(2*i) - position_(0,i) )*alpha_ - beta_x_.col(i) -
-        // acc_lim_(0)*tmp_ones_;
-
-        // rb_accy_max_.col(2*i) = ( x(12+ 2*i+1) + u(2*i+1) - position_(1,i)
-        // )*alpha_ + beta_y_.col(i) - acc_lim_(1)*tmp_ones_;
-        // rb_accy_max_.col(2*i+1) = -( x(12+ 2*i+1) + u(2*i+1) - position_(1,i)
-        // )*alpha_ - beta_y_.col(i) - acc_lim_(1)*tmp_ones_;
-
-        // position_ expressed in world frame
-        rb_accx_max_.col(2 * i) =
-            (oRh_(0, 0) * (x(12 + 2 * i) + u(2 * i)) +
-             oRh_(0, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(0) -
-             position_(0, i)) *
-                alpha_ +
-            beta_x_.col(i) - acc_lim_(0) * tmp_ones_;
-        rb_accx_max_.col(2 * i + 1) =
-            -(oRh_(0, 0) * (x(12 + 2 * i) + u(2 * i)) +
-              oRh_(0, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(0) -
-              position_(0, i)) *
-                alpha_ +
-            beta_x_.col(i) - acc_lim_(0) * tmp_ones_;
-        ;
-
-        rb_accy_max_.col(2 * i) =
-            (oRh_(1, 0) * (x(12 + 2 * i) + u(2 * i)) +
-             oRh_(1, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(1) -
-             position_(1, i)) *
-                alpha_ +
-            beta_y_.col(i) - acc_lim_(1) * tmp_ones_;
-        rb_accy_max_.col(2 * i + 1) =
-            -(oRh_(1, 0) * (x(12 + 2 * i) + u(2 * i)) +
-              oRh_(1, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(1) -
-              position_(1, i)) *
-                alpha_ -
-            beta_y_.col(i) - acc_lim_(1) * tmp_ones_;
+        d->rb_accx_max_.col(2 * i) =
+            p_world(0, i) * alpha_ + beta_x_.col(i) - acc_lim_(0);
+        d->rb_accx_max_.col(2 * i + 1) =
+            -p_world(0, i) * alpha_ + beta_x_.col(i) - acc_lim_(0);
+        d->rb_accy_max_.col(2 * i) =
+            p_world(1, i) * alpha_ + beta_y_.col(i) - acc_lim_(1);
+        d->rb_accy_max_.col(2 * i + 1) =
+            -p_world(1, i) * alpha_ - beta_y_.col(i) - acc_lim_(1);
       } else {
-        rb_accx_max_.col(2 * i).setZero();
-        rb_accx_max_.col(2 * i + 1).setZero();
-        rb_accy_max_.col(2 * i).setZero();
-        rb_accy_max_.col(2 * i + 1).setZero();
+        d->rb_accx_max_.col(2 * i).setZero();
+        d->rb_accx_max_.col(2 * i + 1).setZero();
+        d->rb_accy_max_.col(2 * i).setZero();
+        d->rb_accy_max_.col(2 * i + 1).setZero();
       }
     }
-    rb_accx_max_bool_ =
-        (rb_accx_max_ > Scalar(0.))
+    d->rb_accx_max_bool_ =
+        (d->rb_accx_max_ > Scalar(0.))
             .template cast<Scalar>();  // Usefull to compute the derivatives
-    rb_accy_max_bool_ =
-        (rb_accy_max_ > Scalar(0.))
+    d->rb_accy_max_bool_ =
+        (d->rb_accy_max_ > Scalar(0.))
             .template cast<Scalar>();  // Usefull to compute the derivatives
 
-    rb_accx_max_ = rb_accx_max_.cwiseMax(Scalar(0.));
-    rb_accy_max_ = rb_accy_max_.cwiseMax(Scalar(0.));
-
-    for (int foot = 0; foot < 4; foot++) {
-      if (S_(foot) == Scalar(1.)) {
-        for (int i = 0; i < (N_sampling - 1); i++) {
-          if (rb_accx_max_bool_(i, 2 * foot)) {
-            d->cost +=
-                Scalar(0.5) * acc_weight_ * pow(rb_accx_max_(i, 2 * foot), 2);
-          }
-          if (rb_accx_max_bool_(i, 2 * foot + 1)) {
-            d->cost += Scalar(0.5) * acc_weight_ *
-                       pow(rb_accx_max_(i, 2 * foot + 1), 2);
-          }
-          if (rb_accy_max_bool_(i, 2 * foot)) {
-            d->cost +=
-                Scalar(0.5) * acc_weight_ * pow(rb_accy_max_(i, 2 * foot), 2);
-          }
-          if (rb_accy_max_bool_(i, 2 * foot + 1)) {
-            d->cost += Scalar(0.5) * acc_weight_ *
-                       pow(rb_accy_max_(i, 2 * foot + 1), 2);
-          }
-        }
-      }
-    }
+    d->rb_accx_max_ = d->rb_accx_max_.cwiseMax(Scalar(0.));
+    d->rb_accy_max_ = d->rb_accy_max_.cwiseMax(Scalar(0.));
+
+    // The residuals of the feet in contact are null
+    d->cost += Scalar(0.5) * acc_weight_ *
+               (d->rb_accx_max_.square().sum() +
+                d->rb_accy_max_.square().sum());
   }
 
   // Weight on the feet velocity
-  if (is_vel_activated_) {
+  if (is_vel_activated_ && extremum_cost_) {
+    calc_extremum_residuals(p_world, vel_poly_, vel_poly_D_, 4, vel_lim_,
+                            d->rb_vel_ext_, d->alpha_vel_ext_);
+    d->cost += Scalar(0.5) * vel_weight_ * d->rb_vel_ext_.squaredNorm();
+  } else if (is_vel_activated_) {
     for (int i = 0; i < 4; i++) {
       if (S_(i) == Scalar(1.)) {
-        // position_ expressed in local frame
-        // rb_velx_max_.col(2*i) = (x(12+ 2*i) + u(2*i) -
-        // position_(0,i))*alpha_v + beta_x_v.col(i) - vel_lim_(0)*tmp_ones_;
-        // rb_velx_max_.col(2*i+1) = -( x(12+ 2*i) + u(2*i) - position_(0,i)
-        // )*alpha_v - beta_x_v.col(i) - vel_lim_(0)*tmp_ones_;
-
-        // rb_vely_max_.col(2*i) = ( x(12+ 2*i+1) + u(2*i+1) - position_(1,i)
-        // )*alpha_v + beta_y_v.col(i) - vel_lim_(1)*tmp_ones_;
-        // rb_vely_max_.col(2*i+1) = -( x(12+ 2*i+1) + u(2*i+1) - position_(1,i)
-        // )*alpha_v - beta_y_v.col(i) - vel_lim_(1)*tmp_ones_;
-
-        // position_ expressed in world frame
-        rb_velx_max_.col(2 * i) =
-            (oRh_(0, 0) * (x(12 + 2 * i) + u(2 * i)) +
-             oRh_(0, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(0) -
-             position_(0, i)) *
-                alpha_v +
-            beta_x_v.col(i) - vel_lim_(0) * tmp_ones_;
-        rb_velx_max_.col(2 * i + 1) =
-            -(oRh_(0, 0) * (x(12 + 2 * i) + u(2 * i)) +
-              oRh_(0, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(0) -
-              position_(0, i)) *
-                alpha_v -
-            beta_x_v.col(i) - vel_lim_(0) * tmp_ones_;
-
-        rb_vely_max_.col(2 * i) =
-            (oRh_(1, 0) * (x(12 + 2 * i) + u(2 * i)) +
-             oRh_(1, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(1) -
-             position_(1, i)) *
-                alpha_v +
-            beta_y_v.col(i) - vel_lim_(1) * tmp_ones_;
-        rb_vely_max_.col(2 * i + 1) =
-            -(oRh_(1, 0) * (x(12 + 2 * i) + u(2 * i)) +
-              oRh_(1, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) + oTh_(1) -
-              position_(1, i)) *
-                alpha_v -
-            beta_y_v.col(i) - vel_lim_(1) * tmp_ones_;
+        d->rb_velx_max_.col(2 * i) =
+            p_world(0, i) * alpha_v + beta_x_v.col(i) - vel_lim_(0);
+        d->rb_velx_max_.col(2 * i + 1) =
+            -p_world(0, i) * alpha_v - beta_x_v.col(i) - vel_lim_(0);
+        d->rb_vely_max_.col(2 * i) =
+            p_world(1, i) * alpha_v + beta_y_v.col(i) - vel_lim_(1);
+        d->rb_vely_max_.col(2 * i + 1) =
+            -p_world(1, i) * alpha_v - beta_y_v.col(i) - vel_lim_(1);
       } else {
-        rb_velx_max_.col(2 * i).setZero();
-        rb_velx_max_.col(2 * i + 1).setZero();
-        rb_vely_max_.col(2 * i).setZero();
-        rb_vely_max_.col(2 * i + 1).setZero();
+        d->rb_velx_max_.col(2 * i).setZero();
+        d->rb_velx_max_.col(2 * i + 1).setZero();
+        d->rb_vely_max_.col(2 * i).setZero();
+        d->rb_vely_max_.col(2 * i + 1).setZero();
       }
     }
-    rb_velx_max_bool_ =
-        (rb_velx_max_ > Scalar(0.))
+    d->rb_velx_max_bool_ =
+        (d->rb_velx_max_ > Scalar(0.))
             .template cast<Scalar>();  // Usefull to compute the derivatives
-    rb_vely_max_bool_ =
-        (rb_vely_max_ > Scalar(0.))
+    d->rb_vely_max_bool_ =
+        (d->rb_vely_max_ > Scalar(0.))
             .template cast<Scalar>();  // Usefull to compute the derivatives
 
-    rb_velx_max_ = rb_velx_max_.cwiseMax(Scalar(0.));
-    rb_vely_max_ = rb_vely_max_.cwiseMax(Scalar(0.));
-
-    for (int foot = 0; foot < 4; foot++) {
-      if (S_(foot) == Scalar(1.)) {
-        for (int i = 0; i < (N_sampling - 1); i++) {
-          if (rb_velx_max_bool_(i, 2 * foot)) {
-            d->cost +=
-                Scalar(0.5) * vel_weight_ * pow(rb_velx_max_(i, 2 * foot), 2);
-          }
-          if (rb_velx_max_bool_(i, 2 * foot + 1)) {
-            d->cost += Scalar(0.5) * vel_weight_ *
-                       pow(rb_velx_max_(i, 2 * foot + 1), 2);
-          }
-          if (rb_vely_max_bool_(i, 2 * foot)) {
-            d->cost +=
-                Scalar(0.5) * vel_weight_ * pow(rb_vely_max_(i, 2 * foot), 2);
-          }
-          if (rb_vely_max_bool_(i, 2 * foot + 1)) {
-            d->cost += Scalar(0.5) * vel_weight_ *
-                       pow(rb_vely_max_(i, 2 * foot + 1), 2);
-          }
-        }
-      }
-    }
+    d->rb_velx_max_ = d->rb_velx_max_.cwiseMax(Scalar(0.));
+    d->rb_vely_max_ = d->rb_vely_max_.cwiseMax(Scalar(0.));
+
+    d->cost += Scalar(0.5) * vel_weight_ *
+               (d->rb_velx_max_.square().sum() +
+                d->rb_vely_max_.square().sum());
   }
 
-  // Weight on the feet velocity
+  // Weight on the feet jerk
   if (is_jerk_activated_) {
     for (int i = 0; i < 4; i++) {
       if (S_(i) == Scalar(1.)) {
-        rb_jerk_(0, i) = (oRh_(0, 0) * (x(12 + 2 * i) + u(2 * i)) +
-                          oRh_(0, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) +
-                          oTh_(0) - position_(0, i)) *
-                             alpha_j +
-                         beta_j(0, i) - jerk_(0, i);
-        rb_jerk_(1, i) = (oRh_(1, 0) * (x(12 + 2 * i) + u(2 * i)) +
-                          oRh_(1, 1) * (x(12 + 2 * i + 1) + u(2 * i + 1)) +
-                          oTh_(1) - position_(1, i)) *
-                             alpha_j +
-                         beta_j(1, i) - jerk_(1, i);
-        d->cost += Scalar(0.5) * jerk_weight_ * rb_jerk_.col(i).squaredNorm();
+        d->rb_jerk_.col(i) = p_world.col(i) * alpha_j +
+                             beta_j.col(i).matrix() -
+                             jerk_.col(i).head(2).matrix();
+        d->cost +=
+            Scalar(0.5) * jerk_weight_ * d->rb_jerk_.col(i).squaredNorm();
       } else {
-        rb_jerk_.col(i).setZero();
+        d->rb_jerk_.col(i).setZero();
       }
     }
   }
+
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    d->cost_terms[CostTerm::Heuristic] =
+        Scalar(0.5) * d->r.template segment<8>(12).squaredNorm();
+    d->cost_terms[CostTerm::Step] =
+        Scalar(0.5) * d->r.template tail<8>().squaredNorm();
+    if (is_acc_activated_ && extremum_cost_) {
+      d->cost_terms[CostTerm::Acceleration] =
+          Scalar(0.5) * acc_weight_ * d->rb_acc_ext_.squaredNorm();
+    } else if (is_acc_activated_) {
+      d->cost_terms[CostTerm::Acceleration] =
+          Scalar(0.5) * acc_weight_ *
+          (d->rb_accx_max_.square().sum() + d->rb_accy_max_.square().sum());
+    }
+    if (is_vel_activated_ && extremum_cost_) {
+      d->cost_terms[CostTerm::Velocity] =
+          Scalar(0.5) * vel_weight_ * d->rb_vel_ext_.squaredNorm();
+    } else if (is_vel_activated_) {
+      d->cost_terms[CostTerm::Velocity] =
+          Scalar(0.5) * vel_weight_ *
+          (d->rb_velx_max_.square().sum() + d->rb_vely_max_.square().sum());
+    }
+    if (is_jerk_activated_) {
+      d->cost_terms[CostTerm::Jerk] =
+          Scalar(0.5) * jerk_weight_ * d->rb_jerk_.squaredNorm();
+    }
+  }
 }
 
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::calcDiff(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -357,9 +249,11 @@ void ActionModelQuadrupedStepTpl<Scalar>::calcDiff(
                         std::to_string(nu_) + ")");
   }
 
-  ActionDataQuadrupedStepTpl<Scalar>* d =
-      static_cast<ActionDataQuadrupedStepTpl<Scalar>*>(data.get());
+  Data* d = static_cast<Data*>(data.get());
 
+  // The feet terms are added to the Hessians, with off-diagonal blocks when
+  // oRh has a yaw
+  d->Lxx.setZero();
   d->Lxu.setZero();
   d->Luu.setZero();
 
@@ -380,540 +274,149 @@ void ActionModelQuadrupedStepTpl<Scalar>::calcDiff(
 
   d->Luu.diagonal() = (step_weights_.array() * step_weights_.array()).matrix();
 
-  if (is_acc_activated_) {
-    for (int foot = 0; foot < 4; foot++) {
-      if (S_[foot] == Scalar(1)) {
-        for (int i = 0; i < (N_sampling - 1); i++) {
-          // Position_ expressed in local frame
-          // if (rb_accx_max_bool_(i,2*foot)){
-
-          //   d->Lu(2*foot) += acc_weight_ * alpha_(i) *
-          //   rb_accx_max_(i,2*foot); d->Luu(2*foot,2*foot) += acc_weight_ *
-          //   pow(alpha_(i),2);
-
-          //   d->Lx(12+2*foot) += acc_weight_ * alpha_(i) *
-          //   rb_accx_max_(i,2*foot); d->Lxu(12+2*foot,2*foot) += acc_weight_ *
-          //   pow(alpha_(i),2); d->Lxx(12+2*foot,12+2*foot) += acc_weight_ *
-          //   pow(alpha_(i),2);
-          // }
-          // if (rb_accx_max_bool_(i,2*foot+1)){
-          //   d->Lu(2*foot) += - acc_weight_ * alpha_(i) *
-          //   rb_accx_max_(i,2*foot+1); d->Luu(2*foot,2*foot) += acc_weight_ *
-          //   pow(alpha_(i),2);
-
-          //   d->Lx(12+2*foot) += - acc_weight_ * alpha_(i) *
-          //   rb_accx_max_(i,2*foot+1); d->Lxu(12+2*foot,2*foot) += acc_weight_
-          //   * pow(alpha_(i),2); d->Lxx(12+2*foot,12+2*foot) += acc_weight_ *
-          //   pow(alpha_(i),2);
-          // }
-          // if (rb_accy_max_bool_(i,2*foot)){
-          //   d->Lu(2*foot+1) += acc_weight_ * alpha_(i) *
-          //   rb_accy_max_(i,2*foot); d->Luu(2*foot+1,2*foot+1) += acc_weight_
-          //   * pow(alpha_(i),2);
-
-          //   d->Lx(12+2*foot+1) += acc_weight_ * alpha_(i) *
-          //   rb_accy_max_(i,2*foot); d->Lxu(12+2*foot+1,2*foot+1) +=
-          //   acc_weight_ * pow(alpha_(i),2); d->Lxx(12+2*foot+1,12+2*foot+1)
-          //   += acc_weight_ * pow(alpha_(i),2);
-          // }
-          // if (rb_accy_max_bool_(i,2*foot+1)){
-          //   d->Lu(2*foot+1) += - acc_weight_ * alpha_(i) *
-          //   rb_accy_max_(i,2*foot+1); d->Luu(2*foot+1,2*foot+1) +=
-          //   acc_weight_ * pow(alpha_(i),2);
-
-          //   d->Lx(12+2*foot+1) += - acc_weight_ * alpha_(i) *
-          //   rb_accy_max_(i,2*foot+1); d->Lxu(12+2*foot+1,2*foot+1) +=
-          //   acc_weight_ * pow(alpha_(i),2); d->Lxx(12+2*foot+1,12+2*foot+1)
-          //   += acc_weight_ * pow(alpha_(i),2);
-          // }
-
-          // Position_ expressed in world frame
-          if (rb_accx_max_bool_(i, 2 * foot)) {
-            d->Lu(2 * foot) += acc_weight_ * oRh_(0, 0) * alpha_(i) *
-                               rb_accx_max_(i, 2 * foot);
-            d->Lu(2 * foot + 1) += acc_weight_ * oRh_(0, 1) * alpha_(i) *
-                                   rb_accx_max_(i, 2 * foot);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                acc_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-
-            d->Lx(12 + 2 * foot) += acc_weight_ * oRh_(0, 0) * alpha_(i) *
-                                    rb_accx_max_(i, 2 * foot);
-            d->Lx(12 + 2 * foot + 1) += acc_weight_ * oRh_(0, 1) * alpha_(i) *
-                                        rb_accx_max_(i, 2 * foot);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                acc_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(0, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(0, 1), 2);
-          }
-          if (rb_accx_max_bool_(i, 2 * foot + 1)) {
-            d->Lu(2 * foot) += -acc_weight_ * oRh_(0, 0) * alpha_(i) *
-                               rb_accx_max_(i, 2 * foot + 1);
-            d->Lu(2 * foot + 1) += -acc_weight_ * oRh_(0, 1) * alpha_(i) *
-                                   rb_accx_max_(i, 2 * foot + 1);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                acc_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-
-            d->Lx(12 + 2 * foot) += -acc_weight_ * oRh_(0, 0) * alpha_(i) *
-                                    rb_accx_max_(i, 2 * foot + 1);
-            d->Lx(12 + 2 * foot + 1) += -acc_weight_ * oRh_(0, 1) * alpha_(i) *
-                                        rb_accx_max_(i, 2 * foot + 1);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                acc_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                acc_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(0, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(0, 1), 2);
-          }
-          if (rb_accy_max_bool_(i, 2 * foot)) {
-            d->Lu(2 * foot) += acc_weight_ * oRh_(1, 0) * alpha_(i) *
-                               rb_accy_max_(i, 2 * foot);
-            d->Lu(2 * foot + 1) += acc_weight_ * oRh_(1, 1) * alpha_(i) *
-                                   rb_accy_max_(i, 2 * foot);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                acc_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-
-            d->Lx(12 + 2 * foot) += acc_weight_ * oRh_(1, 0) * alpha_(i) *
-                                    rb_accy_max_(i, 2 * foot);
-            d->Lx(12 + 2 * foot + 1) += acc_weight_ * oRh_(1, 1) * alpha_(i) *
-                                        rb_accy_max_(i, 2 * foot);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                acc_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(1, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(1, 1), 2);
-          }
-          if (rb_accy_max_bool_(i, 2 * foot + 1)) {
-            d->Lu(2 * foot) += -acc_weight_ * oRh_(1, 0) * alpha_(i) *
-                               rb_accy_max_(i, 2 * foot + 1);
-            d->Lu(2 * foot + 1) += -acc_weight_ * oRh_(1, 1) * alpha_(i) *
-                                   rb_accy_max_(i, 2 * foot + 1);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                acc_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-
-            d->Lx(12 + 2 * foot) += -acc_weight_ * oRh_(1, 0) * alpha_(i) *
-                                    rb_accy_max_(i, 2 * foot + 1);
-            d->Lx(12 + 2 * foot + 1) += -acc_weight_ * oRh_(1, 1) * alpha_(i) *
-                                        rb_accy_max_(i, 2 * foot + 1);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                acc_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                acc_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                acc_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(1, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                acc_weight_ * pow(alpha_(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                acc_weight_ * pow(alpha_(i), 2) * pow(oRh_(1, 1), 2);
-          }
-        }
+  // The residuals of one foot along the x (resp. y) world axis all derive
+  // from the same row of oRh, so they are summed over the samples before
+  // being projected on the derivatives of the foot
+  for (int foot = 0; foot < 4; foot++) {
+    if (S_[foot] == Scalar(1)) {
+      Scalar gx(0.), gy(0.), hx(0.), hy(0.);
+      if (is_acc_activated_ && extremum_cost_) {
+        sum_extremum_derivatives(acc_weight_, d->rb_acc_ext_,
+                                 d->alpha_acc_ext_, foot, gx, gy, hx, hy);
+      } else if (is_acc_activated_) {
+        gx += acc_weight_ * (alpha_ * (d->rb_accx_max_.col(2 * foot) -
+                                       d->rb_accx_max_.col(2 * foot + 1)))
+                                .sum();
+        gy += acc_weight_ * (alpha_ * (d->rb_accy_max_.col(2 * foot) -
+                                       d->rb_accy_max_.col(2 * foot + 1)))
+                                .sum();
+        hx += acc_weight_ *
+              (alpha_.square() * (d->rb_accx_max_bool_.col(2 * foot) +
+                                  d->rb_accx_max_bool_.col(2 * foot + 1)))
+                  .sum();
+        hy += acc_weight_ *
+              (alpha_.square() * (d->rb_accy_max_bool_.col(2 * foot) +
+                                  d->rb_accy_max_bool_.col(2 * foot + 1)))
+                  .sum();
+      }
+      if (is_vel_activated_ && extremum_cost_) {
+        sum_extremum_derivatives(vel_weight_, d->rb_vel_ext_,
+                                 d->alpha_vel_ext_, foot, gx, gy, hx, hy);
+      } else if (is_vel_activated_) {
+        gx += vel_weight_ * (alpha_v * (d->rb_velx_max_.col(2 * foot) -
+                                        d->rb_velx_max_.col(2 * foot + 1)))
+                                .sum();
+        gy += vel_weight_ * (alpha_v * (d->rb_vely_max_.col(2 * foot) -
+                                        d->rb_vely_max_.col(2 * foot + 1)))
+                                .sum();
+        hx += vel_weight_ *
+              (alpha_v.square() * (d->rb_velx_max_bool_.col(2 * foot) +
+                                   d->rb_velx_max_bool_.col(2 * foot + 1)))
+                  .sum();
+        hy += vel_weight_ *
+              (alpha_v.square() * (d->rb_vely_max_bool_.col(2 * foot) +
+                                   d->rb_vely_max_bool_.col(2 * foot + 1)))
+                  .sum();
+      }
+      if (is_jerk_activated_) {
+        gx += jerk_weight_ * alpha_j * d->rb_jerk_(0, foot);
+        gy += jerk_weight_ * alpha_j * d->rb_jerk_(1, foot);
+        hx += jerk_weight_ * alpha_j * alpha_j;
+        hy += jerk_weight_ * alpha_j * alpha_j;
       }
+      add_foot_derivatives(d, foot, gx, gy, hx, hy);
     }
   }
 
-  if (is_vel_activated_) {
-    for (int foot = 0; foot < 4; foot++) {
-      if (S_[foot] == Scalar(1)) {
-        for (int i = 0; i < (N_sampling - 1); i++) {
-          // position_ in base frame
-          // if (rb_velx_max_bool_(i,2*foot)){
-
-          //   d->Lu(2*foot) += vel_weight_ * alpha_v(i) *
-          //   rb_velx_max_(i,2*foot); d->Luu(2*foot,2*foot) += vel_weight_ *
-          //   pow(alpha_v(i),2);
-
-          //   d->Lx(12+2*foot) += vel_weight_ * alpha_v(i) *
-          //   rb_velx_max_(i,2*foot); d->Lxu(12+2*foot,2*foot) += vel_weight_ *
-          //   pow(alpha_v(i),2); d->Lxx(12+2*foot,12+2*foot) += vel_weight_ *
-          //   pow(alpha_v(i),2);
-          // }
-          // if (rb_velx_max_bool_(i,2*foot+1)){
-          //   d->Lu(2*foot) += - vel_weight_ * alpha_v(i) *
-          //   rb_velx_max_(i,2*foot+1); d->Luu(2*foot,2*foot) += vel_weight_ *
-          //   pow(alpha_v(i),2);
-
-          //   d->Lx(12+2*foot) += - vel_weight_ * alpha_v(i) *
-          //   rb_velx_max_(i,2*foot+1); d->Lxu(12+2*foot,2*foot) += vel_weight_
-          //   * pow(alpha_v(i),2); d->Lxx(12+2*foot,12+2*foot) += vel_weight_ *
-          //   pow(alpha_v(i),2);
-          // }
-          // if (rb_vely_max_bool_(i,2*foot)){
-          //   d->Lu(2*foot+1) += vel_weight_ * alpha_v(i) *
-          //   rb_vely_max_(i,2*foot); d->Luu(2*foot+1,2*foot+1) += vel_weight_
-          //   * pow(alpha_v(i),2);
-
-          //   d->Lx(12+2*foot+1) += vel_weight_ * alpha_v(i) *
-          //   rb_vely_max_(i,2*foot); d->Lxu(12+2*foot+1,2*foot+1) +=
-          //   vel_weight_ * pow(alpha_v(i),2); d->Lxx(12+2*foot+1,12+2*foot+1)
-          //   += vel_weight_ * pow(alpha_v(i),2);
-          // }
-          // if (rb_vely_max_bool_(i,2*foot+1)){
-          //   d->Lu(2*foot+1) += - vel_weight_ * alpha_v(i) *
-          //   rb_vely_max_(i,2*foot+1); d->Luu(2*foot+1,2*foot+1) +=
-          //   vel_weight_ * pow(alpha_v(i),2);
-
-          //   d->Lx(12+2*foot+1) += - vel_weight_ * alpha_v(i) *
-          //   rb_vely_max_(i,2*foot+1); d->Lxu(12+2*foot+1,2*foot+1) +=
-          //   vel_weight_ * pow(alpha_v(i),2); d->Lxx(12+2*foot+1,12+2*foot+1)
-          //   += vel_weight_ * pow(alpha_v(i),2);
-          // }
-
-          // position_ in world frame
-          if (rb_velx_max_bool_(i, 2 * foot)) {
-            d->Lu(2 * foot) += vel_weight_ * oRh_(0, 0) * alpha_v(i) *
-                               rb_velx_max_(i, 2 * foot);
-            d->Lu(2 * foot + 1) += vel_weight_ * oRh_(0, 1) * alpha_v(i) *
-                                   rb_velx_max_(i, 2 * foot);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                vel_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-
-            d->Lx(12 + 2 * foot) += vel_weight_ * oRh_(0, 0) * alpha_v(i) *
-                                    rb_velx_max_(i, 2 * foot);
-            d->Lx(12 + 2 * foot + 1) += vel_weight_ * oRh_(0, 1) * alpha_v(i) *
-                                        rb_velx_max_(i, 2 * foot);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                vel_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(0, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(0, 1), 2);
-          }
-          if (rb_velx_max_bool_(i, 2 * foot + 1)) {
-            d->Lu(2 * foot) += -vel_weight_ * oRh_(0, 0) * alpha_v(i) *
-                               rb_velx_max_(i, 2 * foot + 1);
-            d->Lu(2 * foot + 1) += -vel_weight_ * oRh_(0, 1) * alpha_v(i) *
-                                   rb_velx_max_(i, 2 * foot + 1);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                vel_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-
-            d->Lx(12 + 2 * foot) += -vel_weight_ * oRh_(0, 0) * alpha_v(i) *
-                                    rb_velx_max_(i, 2 * foot + 1);
-            d->Lx(12 + 2 * foot + 1) += -vel_weight_ * oRh_(0, 1) * alpha_v(i) *
-                                        rb_velx_max_(i, 2 * foot + 1);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                vel_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                vel_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_v(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(0, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(0, 0) * oRh_(0, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(0, 1), 2);
-          }
-          if (rb_vely_max_bool_(i, 2 * foot)) {
-            d->Lu(2 * foot) += vel_weight_ * oRh_(1, 0) * alpha_v(i) *
-                               rb_vely_max_(i, 2 * foot);
-            d->Lu(2 * foot + 1) += vel_weight_ * oRh_(1, 1) * alpha_v(i) *
-                                   rb_vely_max_(i, 2 * foot);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                vel_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-
-            d->Lx(12 + 2 * foot) += vel_weight_ * oRh_(1, 0) * alpha_v(i) *
-                                    rb_vely_max_(i, 2 * foot);
-            d->Lx(12 + 2 * foot + 1) += vel_weight_ * oRh_(1, 1) * alpha_v(i) *
-                                        rb_vely_max_(i, 2 * foot);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                vel_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(1, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(1, 1), 2);
-          }
-          if (rb_vely_max_bool_(i, 2 * foot + 1)) {
-            d->Lu(2 * foot) += -vel_weight_ * oRh_(1, 0) * alpha_v(i) *
-                               rb_vely_max_(i, 2 * foot + 1);
-            d->Lu(2 * foot + 1) += -vel_weight_ * oRh_(1, 1) * alpha_v(i) *
-                                   rb_vely_max_(i, 2 * foot + 1);
-
-            d->Luu(2 * foot, 2 * foot) +=
-                vel_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Luu(2 * foot, 2 * foot + 1) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-            d->Luu(2 * foot + 1, 2 * foot) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-
-            d->Lx(12 + 2 * foot) += -vel_weight_ * oRh_(1, 0) * alpha_v(i) *
-                                    rb_vely_max_(i, 2 * foot + 1);
-            d->Lx(12 + 2 * foot + 1) += -vel_weight_ * oRh_(1, 1) * alpha_v(i) *
-                                        rb_vely_max_(i, 2 * foot + 1);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-                vel_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-                vel_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_v(i), 2);
-
-            d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-            d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-                vel_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_v(i), 2);
-
-            d->Lxu(12 + 2 * foot, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(1, 0), 2);
-            d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-                vel_weight_ * pow(alpha_v(i), 2) * oRh_(1, 0) * oRh_(1, 1);
-            d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-                vel_weight_ * pow(alpha_v(i), 2) * pow(oRh_(1, 1), 2);
-          }
+  // Dynamic derivatives
+  d->Fx.setIdentity();
+  d->Fu.block(12, 0, 8, 8) = B;
+}
+
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::add_foot_derivatives(
+    Data* d, const int& foot, const Scalar& gx, const Scalar& gy,
+    const Scalar& hx, const Scalar& hy) const {
+  // The position of the foot in world frame is oRh * (x + u), the x, y
+  // components only depend on the top left block of oRh
+  const typename Eigen::Matrix<Scalar, 2, 2> R =
+      oRh_.template topLeftCorner<2, 2>();
+  const typename Eigen::Matrix<Scalar, 2, 1> g =
+      R.transpose() * typename Eigen::Matrix<Scalar, 2, 1>(gx, gy);
+  const typename Eigen::Matrix<Scalar, 2, 2> H =
+      R.transpose() *
+      typename Eigen::Matrix<Scalar, 2, 1>(hx, hy).asDiagonal() * R;
+
+  d->Lu.template segment<2>(2 * foot) += g;
+  d->Lx.template segment<2>(12 + 2 * foot) += g;
+  d->Luu.template block<2, 2>(2 * foot, 2 * foot) += H;
+  d->Lxx.template block<2, 2>(12 + 2 * foot, 12 + 2 * foot) += H;
+  d->Lxu.template block<2, 2>(12 + 2 * foot, 2 * foot) += H;
+}
+
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::calc_extremum_residuals(
+    const Eigen::Matrix<Scalar, 2, 4>& p_world, const PolynomialFeet& poly,
+    const typename Polynomial::Coefficients& poly_D, const int& degree,
+    const Eigen::Matrix<Scalar, 2, 1>& lim, Eigen::Matrix<Scalar, 2, 8>& rb,
+    Eigen::Matrix<Scalar, 2, 8>& alpha) const {
+  rb.setZero();
+  alpha.setZero();
+  for (int foot = 0; foot < 4; foot++) {
+    if (S_(foot) == Scalar(1.)) {
+      for (int k = 0; k < 2; k++) {
+        const typename Polynomial::Coefficients c =
+            p_world(k, foot) * poly_D + poly.col(2 * foot + k);
+        Scalar t_min, t_max;
+        Polynomial::extrema(c, degree, t_min, t_max);
+
+        // Only the extrema are penalised, the derivatives of their value
+        // with respect to their time are null
+        const Scalar r_max = Polynomial::value(c, degree, t_max) - lim(k);
+        const Scalar r_min = -Polynomial::value(c, degree, t_min) - lim(k);
+        if (r_max > Scalar(0.)) {
+          rb(k, 2 * foot) = r_max;
+          alpha(k, 2 * foot) = Polynomial::value(poly_D, degree, t_max);
+        }
+        if (r_min > Scalar(0.)) {
+          rb(k, 2 * foot + 1) = r_min;
+          alpha(k, 2 * foot + 1) = -Polynomial::value(poly_D, degree, t_min);
         }
       }
     }
   }
+}
 
-  if (is_jerk_activated_) {
-    for (int foot = 0; foot < 4; foot++) {
-      if (S_[foot] == Scalar(1)) {
-        // derivatives relative to jerk on x axis
-        d->Lu(2 * foot) +=
-            jerk_weight_ * oRh_(0, 0) * alpha_j * rb_jerk_(0, foot);
-        d->Lu(2 * foot + 1) +=
-            jerk_weight_ * oRh_(0, 1) * alpha_j * rb_jerk_(0, foot);
-
-        d->Luu(2 * foot, 2 * foot) +=
-            jerk_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_j, 2);
-        d->Luu(2 * foot + 1, 2 * foot + 1) +=
-            jerk_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_j, 2);
-
-        d->Luu(2 * foot, 2 * foot + 1) +=
-            jerk_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_j, 2);
-        d->Luu(2 * foot + 1, 2 * foot) +=
-            jerk_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_j, 2);
-
-        d->Lx(12 + 2 * foot) +=
-            jerk_weight_ * oRh_(0, 0) * alpha_j * rb_jerk_(0, foot);
-        d->Lx(12 + 2 * foot + 1) +=
-            jerk_weight_ * oRh_(0, 1) * alpha_j * rb_jerk_(0, foot);
-
-        d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-            jerk_weight_ * pow(oRh_(0, 0), 2) * pow(alpha_j, 2);
-        d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-            jerk_weight_ * pow(oRh_(0, 1), 2) * pow(alpha_j, 2);
-
-        d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-            jerk_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_j, 2);
-        d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-            jerk_weight_ * oRh_(0, 0) * oRh_(0, 1) * pow(alpha_j, 2);
-
-        d->Lxu(12 + 2 * foot, 2 * foot) +=
-            jerk_weight_ * pow(alpha_j, 2) * pow(oRh_(0, 0), 2);
-        d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-            jerk_weight_ * pow(alpha_j, 2) * oRh_(0, 0) * oRh_(0, 1);
-        d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-            jerk_weight_ * pow(alpha_j, 2) * oRh_(0, 0) * oRh_(0, 1);
-        d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-            jerk_weight_ * pow(alpha_j, 2) * pow(oRh_(0, 1), 2);
-
-        // derivatives relative to jerk on y axis
-        d->Lu(2 * foot) +=
-            jerk_weight_ * oRh_(1, 0) * alpha_j * rb_jerk_(1, foot);
-        d->Lu(2 * foot + 1) +=
-            jerk_weight_ * oRh_(1, 1) * alpha_j * rb_jerk_(1, foot);
-
-        d->Luu(2 * foot, 2 * foot) +=
-            jerk_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_j, 2);
-        d->Luu(2 * foot + 1, 2 * foot + 1) +=
-            jerk_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_j, 2);
-
-        d->Luu(2 * foot, 2 * foot + 1) +=
-            jerk_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_j, 2);
-        d->Luu(2 * foot + 1, 2 * foot) +=
-            jerk_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_j, 2);
-
-        d->Lx(12 + 2 * foot) +=
-            jerk_weight_ * oRh_(1, 0) * alpha_j * rb_jerk_(1, foot);
-        d->Lx(12 + 2 * foot + 1) +=
-            jerk_weight_ * oRh_(1, 1) * alpha_j * rb_jerk_(1, foot);
-
-        d->Lxx(12 + 2 * foot, 12 + 2 * foot) +=
-            jerk_weight_ * pow(oRh_(1, 0), 2) * pow(alpha_j, 2);
-        d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot + 1) +=
-            jerk_weight_ * pow(oRh_(1, 1), 2) * pow(alpha_j, 2);
-
-        d->Lxx(12 + 2 * foot, 12 + 2 * foot + 1) +=
-            jerk_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_j, 2);
-        d->Lxx(12 + 2 * foot + 1, 12 + 2 * foot) +=
-            jerk_weight_ * oRh_(1, 0) * oRh_(1, 1) * pow(alpha_j, 2);
-
-        d->Lxu(12 + 2 * foot, 2 * foot) +=
-            jerk_weight_ * pow(alpha_j, 2) * pow(oRh_(1, 0), 2);
-        d->Lxu(12 + 2 * foot, 2 * foot + 1) +=
-            jerk_weight_ * pow(alpha_j, 2) * oRh_(1, 0) * oRh_(1, 1);
-        d->Lxu(12 + 2 * foot + 1, 2 * foot) +=
-            jerk_weight_ * pow(alpha_j, 2) * oRh_(1, 0) * oRh_(1, 1);
-        d->Lxu(12 + 2 * foot + 1, 2 * foot + 1) +=
-            jerk_weight_ * pow(alpha_j, 2) * pow(oRh_(1, 1), 2);
-      }
-    }
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::sum_extremum_derivatives(
+    const Scalar& weight, const Eigen::Matrix<Scalar, 2, 8>& rb,
+    const Eigen::Matrix<Scalar, 2, 8>& alpha, const int& foot, Scalar& gx,
+    Scalar& gy, Scalar& hx, Scalar& hy) {
+  for (int j = 2 * foot; j < 2 * foot + 2; j++) {
+    gx += weight * alpha(0, j) * rb(0, j);
+    gy += weight * alpha(1, j) * rb(1, j);
+    hx += weight * alpha(0, j) * alpha(0, j);
+    hy += weight * alpha(1, j) * alpha(1, j);
   }
-
-  // Dynamic derivatives
-  d->Fx.setIdentity();
-  d->Fu.block(12, 0, 8, 8) = B;
 }
 
-template <typename Scalar>
+template <typename Scalar, int _NSampling>
 boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >
-ActionModelQuadrupedStepTpl<Scalar>::createData() {
-  return boost::make_shared<ActionDataQuadrupedStepTpl<Scalar> >(this);
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::createData() {
+  return boost::make_shared<Data>(this);
 }
 
 ////////////////////////////////
 // get & set parameters ////////
 ////////////////////////////////
 
-template <typename Scalar>
+template <typename Scalar, int _NSampling>
 const typename Eigen::Matrix<Scalar, 12, 1>&
-ActionModelQuadrupedStepTpl<Scalar>::get_state_weights() const {
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_state_weights() const {
   return state_weights_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_state_weights(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_state_weights(
     const typename MathBase::VectorXs& weights) {
   if (static_cast<std::size_t>(weights.size()) != 12) {
     throw_pretty("Invalid argument: "
@@ -922,13 +425,13 @@ void ActionModelQuadrupedStepTpl<Scalar>::set_state_weights(
   state_weights_ = weights;
 }
 
-template <typename Scalar>
+template <typename Scalar, int _NSampling>
 const typename Eigen::Matrix<Scalar, 8, 1>&
-ActionModelQuadrupedStepTpl<Scalar>::get_step_weights() const {
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_step_weights() const {
   return step_weights_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_step_weights(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_step_weights(
     const typename MathBase::VectorXs& weights) {
   if (static_cast<std::size_t>(weights.size()) != 8) {
     throw_pretty("Invalid argument: "
@@ -937,13 +440,13 @@ void ActionModelQuadrupedStepTpl<Scalar>::set_step_weights(
   step_weights_ = weights;
 }
 
-template <typename Scalar>
+template <typename Scalar, int _NSampling>
 const typename Eigen::Matrix<Scalar, 8, 1>&
-ActionModelQuadrupedStepTpl<Scalar>::get_heuristic_weights() const {
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_heuristic_weights() const {
   return heuristic_weights_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_heuristic_weights(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_heuristic_weights(
     const typename MathBase::VectorXs& weights) {
   if (static_cast<std::size_t>(weights.size()) != 8) {
     throw_pretty("Invalid argument: "
@@ -952,56 +455,61 @@ void ActionModelQuadrupedStepTpl<Scalar>::set_heuristic_weights(
   heuristic_weights_ = weights;
 }
 
-template <typename Scalar>
-const bool& ActionModelQuadrupedStepTpl<Scalar>::get_symmetry_term() const {
+template <typename Scalar, int _NSampling>
+const bool&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_symmetry_term() const {
   return symmetry_term;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_symmetry_term(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_symmetry_term(
     const bool& sym_term) {
   // The model need to be updated after this changed
   symmetry_term = sym_term;
 }
 
-template <typename Scalar>
-const bool& ActionModelQuadrupedStepTpl<Scalar>::get_centrifugal_term() const {
+template <typename Scalar, int _NSampling>
+const bool&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_centrifugal_term() const {
   return centrifugal_term;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_centrifugal_term(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_centrifugal_term(
     const bool& cent_term) {
   // The model need to be updated after this changed
   centrifugal_term = cent_term;
 }
 
-template <typename Scalar>
-const Scalar& ActionModelQuadrupedStepTpl<Scalar>::get_T_gait() const {
+template <typename Scalar, int _NSampling>
+const Scalar&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_T_gait() const {
   // The model need to be updated after this changed
   return T_gait;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_T_gait(const Scalar& T_gait_) {
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_T_gait(
+    const Scalar& T_gait_) {
   // The model need to be updated after this changed
   T_gait = T_gait_;
 }
 
-template <typename Scalar>
-const bool& ActionModelQuadrupedStepTpl<Scalar>::get_acc_activated() const {
+template <typename Scalar, int _NSampling>
+const bool&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_acc_activated() const {
   return is_acc_activated_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_acc_activated(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_acc_activated(
     const bool& is_activated) {
   is_acc_activated_ = is_activated;
 }
 
-template <typename Scalar>
+template <typename Scalar, int _NSampling>
 const typename Eigen::Matrix<Scalar, 2, 1>&
-ActionModelQuadrupedStepTpl<Scalar>::get_acc_lim() const {
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_acc_lim() const {
   return acc_lim_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_acc_lim(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_acc_lim(
     const typename MathBase::VectorXs& acceleration_lim_) {
   if (static_cast<std::size_t>(acceleration_lim_.size()) != 2) {
     throw_pretty("Invalid argument: "
@@ -1011,33 +519,35 @@ void ActionModelQuadrupedStepTpl<Scalar>::set_acc_lim(
   acc_lim_ = acceleration_lim_;
 }
 
-template <typename Scalar>
-const Scalar& ActionModelQuadrupedStepTpl<Scalar>::get_acc_weight() const {
+template <typename Scalar, int _NSampling>
+const Scalar&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_acc_weight() const {
   return acc_weight_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_acc_weight(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_acc_weight(
     const Scalar& weight_) {
   acc_weight_ = weight_;
 }
 
-template <typename Scalar>
-const bool& ActionModelQuadrupedStepTpl<Scalar>::get_vel_activated() const {
+template <typename Scalar, int _NSampling>
+const bool&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_vel_activated() const {
   return is_vel_activated_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_vel_activated(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_vel_activated(
     const bool& is_activated) {
   is_vel_activated_ = is_activated;
 }
 
-template <typename Scalar>
+template <typename Scalar, int _NSampling>
 const typename Eigen::Matrix<Scalar, 2, 1>&
-ActionModelQuadrupedStepTpl<Scalar>::get_vel_lim() const {
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_vel_lim() const {
   return vel_lim_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_vel_lim(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_vel_lim(
     const typename MathBase::VectorXs& velocity_lim_) {
   if (static_cast<std::size_t>(velocity_lim_.size()) != 2) {
     throw_pretty("Invalid argument: "
@@ -1047,114 +557,104 @@ void ActionModelQuadrupedStepTpl<Scalar>::set_vel_lim(
   vel_lim_ = velocity_lim_;
 }
 
-template <typename Scalar>
-const Scalar& ActionModelQuadrupedStepTpl<Scalar>::get_vel_weight() const {
+template <typename Scalar, int _NSampling>
+const Scalar&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_vel_weight() const {
   return vel_weight_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_vel_weight(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_vel_weight(
     const Scalar& weight_) {
   vel_weight_ = weight_;
 }
 
-template <typename Scalar>
-const Scalar& ActionModelQuadrupedStepTpl<Scalar>::get_jerk_weight() const {
+template <typename Scalar, int _NSampling>
+const Scalar&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_jerk_weight() const {
   return jerk_weight_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_jerk_weight(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_jerk_weight(
     const Scalar& weight_) {
   jerk_weight_ = weight_;
 }
 
-template <typename Scalar>
-const bool& ActionModelQuadrupedStepTpl<Scalar>::get_jerk_activated() const {
+template <typename Scalar, int _NSampling>
+const bool&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_jerk_activated() const {
   return is_jerk_activated_;
 }
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_jerk_activated(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_jerk_activated(
     const bool& is_activated) {
   is_jerk_activated_ = is_activated;
 }
 
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::set_sample_feet_traj(
+template <typename Scalar, int _NSampling>
+const bool&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_extremum_cost() const {
+  return extremum_cost_;
+}
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_extremum_cost(
+    const bool& extremum_cost) {
+  extremum_cost_ = extremum_cost;
+}
+
+template <typename Scalar, int _NSampling>
+const int&
+ActionModelQuadrupedStepTpl<Scalar, _NSampling>::get_sample_feet_traj() const {
+  return N_sampling;
+}
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::set_sample_feet_traj(
     const int& n_sample) {
+  if (NSampling != Eigen::Dynamic && n_sample != NSampling) {
+    throw_pretty("Invalid argument: "
+                 << "the number of samples of this model is fixed to " +
+                        std::to_string(NSampling));
+  }
   N_sampling = n_sample;
+  compute_sampling_coefficients();
+}
 
-  // Acceleration cost
-  delta_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);
-  gamma_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 3);
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar,
+                                 _NSampling>::compute_sampling_coefficients() {
+  delta_ = ArraySamples4::Zero(N_sampling - 1, 4);
+  gamma_ = ArraySamples3::Zero(N_sampling - 1, 3);
   for (int k = 1; k < N_sampling; k++) {
     delta_(k - 1, 0) =
         (float)k / (float)N_sampling;  // [1/N, 2/N, ... , (N-1)/N]
   }
-  delta_.col(1) << delta_.col(0).pow(2);
-  delta_.col(2) << delta_.col(0).pow(3);
-  delta_.col(3) << delta_.col(0).pow(4);
+  delta_.col(1) = delta_.col(0) * delta_.col(0);
+  delta_.col(2) = delta_.col(1) * delta_.col(0);
+  delta_.col(3) = delta_.col(2) * delta_.col(0);  // Only used for speed cost
 
   gamma_.col(0) =
       60 * delta_.col(0) - 180 * delta_.col(1) + 120 * delta_.col(2);
   gamma_.col(1) = -36 * delta_.col(0) + 96 * delta_.col(1) - 60 * delta_.col(2);
   gamma_.col(2) = -9 * delta_.col(0) + 18 * delta_.col(1) - 10 * delta_.col(2);
 
-  alpha_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 1);  // Common for 4 feet
-  beta_x_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on ao,vo of feet
-  beta_y_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on ao,vo of feet
-  tmp_ones_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Ones(
-      N_sampling - 1, 1);
-
-  rb_accx_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_accy_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_accx_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-  rb_accy_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-
-  // Velocity cost
-  gamma_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);
+  alpha_ = ArraySamples::Zero(N_sampling - 1);      // Common for 4 feet
+  beta_x_ = ArraySamples4::Zero(N_sampling - 1, 4);  // Depends on a0_x, v0_x
+  beta_y_ = ArraySamples4::Zero(N_sampling - 1, 4);  // Depends on a0_y, v0_y
+
+  gamma_v = ArraySamples4::Zero(N_sampling - 1, 4);
   gamma_v.col(0) = 30 * delta_.col(1) - 60 * delta_.col(2) + 30 * delta_.col(3);
   gamma_v.col(1) = delta_.col(0);
   gamma_v.col(2) =
       -18 * delta_.col(1) + 32 * delta_.col(2) - 15 * delta_.col(3);
-  gamma_v.col(3) =
-      -4.5 * delta_.col(1) + 6 * delta_.col(2) - 2.5 * delta_.col(3);
-
-  alpha_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 1);  // Common for 4 feet
-  beta_x_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on a0_x, v0_x of feet
-  beta_y_v = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 4);  // Depends on a0_y, v0_y of feet
-
-  rb_velx_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_vely_max_ = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
-      N_sampling - 1, 8);
-  rb_velx_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-  rb_vely_max_bool_ =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(N_sampling - 1,
-                                                                 8);
-}
+  gamma_v.col(3) = Scalar(-4.5) * delta_.col(1) + 6 * delta_.col(2) -
+                   Scalar(2.5) * delta_.col(3);
 
-////////////////////////
-// Update current model
-////////////////////////
+  alpha_v = ArraySamples::Zero(N_sampling - 1);       // Common for 4 feet
+  beta_x_v = ArraySamples4::Zero(N_sampling - 1, 4);  // Depends on a0_x, v0_x
+  beta_y_v = ArraySamples4::Zero(N_sampling - 1, 4);  // Depends on a0_y, v0_y
+}
 
-template <typename Scalar>
-void ActionModelQuadrupedStepTpl<Scalar>::update_model(
+template <typename Scalar, int _NSampling>
+void ActionModelQuadrupedStepTpl<Scalar, _NSampling>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::VectorXs>& S,
@@ -1165,6 +665,10 @@ void ActionModelQuadrupedStepTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& oRh,
     const Eigen::Ref<const typename MathBase::MatrixXs>& oTh,
     const Scalar& delta_T) {
+  using std::cos;
+  using std::pow;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -1196,7 +700,7 @@ void ActionModelQuadrupedStepTpl<Scalar>::update_model(
   // Centrifual term
   pcentrifugal_tmp_1 = xref.block(6, 0, 3, 1);
   pcentrifugal_tmp_2 = xref.block(9, 0, 3, 1);
-  pcentrifugal_tmp = 0.5 * std::sqrt(xref(2, 0) / 9.81) *
+  pcentrifugal_tmp = Scalar(0.5) * std::sqrt(xref(2, 0) / Scalar(9.81)) *
   pcentrifugal_tmp_1.cross(pcentrifugal_tmp_2);
 
   for (int i = 0; i < 4; i = i + 1) {
@@ -1230,41 +734,61 @@ void ActionModelQuadrupedStepTpl<Scalar>::update_model(
     B.block(6, 6, 2, 2).setIdentity();
   }
 
-  alpha_ = (1 / pow(delta_T, 2)) * gamma_.col(0);
-  alpha_j = (60 / pow(delta_T, 3));
+  alpha_ = (Scalar(1) / pow(delta_T, Scalar(2))) * gamma_.col(0);
+  alpha_j = (Scalar(60) / pow(delta_T, Scalar(3)));
   alpha_v = (1 / delta_T) * gamma_v.col(0);
 
+  // Coefficients in t = [0, 1] of the quintic swing trajectory, the part
+  // proportional to the distance to the target and the part depending on the
+  // initial velocity and acceleration of each foot
+  acc_poly_D_ << Scalar(0.), Scalar(60.), Scalar(-180.), Scalar(120.),
+      Scalar(0.);
+  acc_poly_D_ /= delta_T * delta_T;
+  vel_poly_D_ << Scalar(0.), Scalar(0.), Scalar(30.), Scalar(-60.),
+      Scalar(30.);
+  vel_poly_D_ /= delta_T;
+  for (int i = 0; i < 4; i++) {
+    for (int k = 0; k < 2; k++) {
+      const Scalar v0 = velocity(k, i);
+      const Scalar a0 = acceleration(k, i);
+      acc_poly_.col(2 * i + k) << a0, -36 * v0 / delta_T - 9 * a0,
+          96 * v0 / delta_T + 18 * a0, -60 * v0 / delta_T - 10 * a0,
+          Scalar(0.);
+      vel_poly_.col(2 * i + k) << v0, a0 * delta_T,
+          -18 * v0 - Scalar(4.5) * a0 * delta_T, 32 * v0 + 6 * a0 * delta_T,
+          -15 * v0 - Scalar(2.5) * a0 * delta_T;
+    }
+  }
+
   for (int i = 0; i < 4; i++) {
     if (S[i] == Scalar(1) && is_acc_activated_) {
-      beta_x_.col(i) = acceleration(0, i) * tmp_ones_ +
-                       (velocity(0, i) / delta_T) * gamma_.col(1) +
-                       acceleration(0, i) * gamma_.col(2);
-      beta_y_.col(i) = acceleration(1, i) * tmp_ones_ +
-                       (velocity(1, i) / delta_T) * gamma_.col(1) +
-                       acceleration(1, i) * gamma_.col(2);
+      beta_x_.col(i) = (velocity(0, i) / delta_T) * gamma_.col(1) +
+                       acceleration(0, i) * gamma_.col(2) + acceleration(0, i);
+      beta_y_.col(i) = (velocity(1, i) / delta_T) * gamma_.col(1) +
+                       acceleration(1, i) * gamma_.col(2) + acceleration(1, i);
     } else {
       beta_x_.col(i).setZero();
       beta_y_.col(i).setZero();
     }
 
     if (S[i] == Scalar(1) && is_vel_activated_) {
-      beta_x_v.col(i) = velocity(0, i) * tmp_ones_ +
-                        (acceleration(0, i) * delta_T) * gamma_v.col(1) +
+      beta_x_v.col(i) = (acceleration(0, i) * delta_T) * gamma_v.col(1) +
                         velocity(0, i) * gamma_.col(2) +
-                        (acceleration(0, i) * delta_T) * gamma_v.col(3);
-      beta_y_v.col(i) = velocity(1, i) * tmp_ones_ +
-                        (acceleration(1, i) * delta_T) * gamma_v.col(1) +
+                        (acceleration(0, i) * delta_T) * gamma_v.col(3) +
+                        velocity(0, i);
+      beta_y_v.col(i) = (acceleration(1, i) * delta_T) * gamma_v.col(1) +
                         velocity(1, i) * gamma_.col(2) +
-                        (acceleration(1, i) * delta_T) * gamma_v.col(3);
+                        (acceleration(1, i) * delta_T) * gamma_v.col(3) +
+                        velocity(1, i);
     } else {
       beta_x_v.col(i).setZero();
       beta_y_v.col(i).setZero();
     }
 
     if (S[i] == Scalar(1) && is_jerk_activated_) {
-      beta_j(0, i) = -(36 * velocity(0, i)) / pow(delta_T, 2) -
+      beta_j(0, i) = -(36 * velocity(0, i)) / pow(delta_T, Scalar(2)) -
                      (9 * acceleration(0, i)) / delta_T;
-      beta_j(1, i) = -(36 * velocity(1, i)) / pow(delta_T, 2) -
+      beta_j(1, i) = -(36 * velocity(1, i)) / pow(delta_T, Scalar(2)) -
                      (9 * acceleration(1, i)) / delta_T;
     } else {
       beta_j.col(i).setZero();
@@ -7,6 +7,8 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
 template <typename _Scalar>
@@ -110,7 +112,7 @@ class ActionModelQuadrupedStepPeriodTpl
 
   typename Eigen::Matrix<Scalar, 8, 4> B;
 
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
 
   typename Eigen::Matrix<Scalar, 8, 1> pshoulder_;
   typename Eigen::Matrix<Scalar, 2, 4> pshoulder_0;
@@ -123,14 +125,12 @@ class ActionModelQuadrupedStepPeriodTpl
   typename Eigen::Matrix<Scalar, 1, 1> dt_ref_;
   typename Eigen::Matrix<Scalar, 1, 1> dt_min_;
   typename Eigen::Matrix<Scalar, 1, 1> dt_max_;
-
-  typename Eigen::Matrix<Scalar, 4, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 4, 1> rub_max_bool;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedStepPeriodTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -149,7 +149,15 @@ struct ActionDataQuadrupedStepPeriodTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedStepPeriodTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {
+    rub_max_.setZero();
+    rub_max_bool.setZero();
+  }
+
+  // Bounds on the period and on the feet speed computed in calc and reused in
+  // calcDiff
+  typename Eigen::Matrix<Scalar, 4, 1> rub_max_;
+  typename Eigen::Matrix<Scalar, 4, 1> rub_max_bool;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -159,9 +167,21 @@ struct ActionDataQuadrupedStepPeriodTpl
 typedef ActionModelQuadrupedStepPeriodTpl<double>
     ActionModelQuadrupedStepPeriod;
 typedef ActionDataQuadrupedStepPeriodTpl<double> ActionDataQuadrupedStepPeriod;
+typedef ActionModelQuadrupedStepPeriodTpl<float>
+    ActionModelQuadrupedStepPeriodFloat;
+typedef ActionDataQuadrupedStepPeriodTpl<float>
+    ActionDataQuadrupedStepPeriodFloat;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_step_period.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_step_period.cpp
+extern template class ActionModelQuadrupedStepPeriodTpl<double>;
+extern template struct ActionDataQuadrupedStepPeriodTpl<double>;
+extern template class ActionModelQuadrupedStepPeriodTpl<float>;
+extern template struct ActionDataQuadrupedStepPeriodTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
@@ -9,9 +9,8 @@ ActionModelQuadrupedStepPeriodTpl<Scalar>::ActionModelQuadrupedStepPeriodTpl()
     : crocoddyl::ActionModelAbstractTpl<Scalar>(
           boost::make_shared<crocoddyl::StateVectorTpl<Scalar> >(21), 5, 26) {
   B.setZero();
+  xref_.setZero();
   dt_ref_.setConstant(Scalar(0.02));
-  rub_max_.setZero();
-  rub_max_bool.setZero();
   dt_min_.setConstant(Scalar(0.005));
   dt_max_.setConstant(Scalar(0.1));
   dt_weight_ = Scalar(1);
@@ -53,6 +52,7 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -68,7 +68,8 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calc(
       static_cast<ActionDataQuadrupedStepPeriodTpl<Scalar>*>(data.get());
 
   d->xnext.template head<12>() = x.head(12);
-  d->xnext.template segment<8>(12) = x.segment(12, 8) + B * u.head(4);
+  d->xnext.template segment<8>(12) =
+      x.template segment<8>(12) + B * u.template head<4>();
   d->xnext.template tail<1>() = u.tail(1);
 
   // Residual cost on the state and force norm
@@ -79,20 +80,37 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calc(
   d->r.template segment<4>(21) = step_weights_.cwiseProduct(u.head(4));
   d->r.template tail<1>() = dt_weight_ * (u.tail(1) - dt_ref_);
 
-  rub_max_ << dt_min_ - x.tail(1), x.tail(1) - dt_max_,
+  d->rub_max_ << dt_min_ - x.tail(1), x.tail(1) - dt_max_,
       u[0] * u[0] + u[1] * u[1] - beta_lim * x[20] * x[20],
       u[2] * u[2] + u[3] * u[3] - beta_lim * x[20] * x[20];
 
-  rub_max_bool =
-      (rub_max_.array() >= Scalar(0.)).matrix().template cast<Scalar>();
-  rub_max_ = rub_max_.cwiseMax(Scalar(0.));
+  d->rub_max_bool =
+      (d->rub_max_.array() >= Scalar(0.)).matrix().template cast<Scalar>();
+  d->rub_max_ = d->rub_max_.cwiseMax(Scalar(0.));
 
   // d->cost = Scalar(0.5) * d->r.transpose() * d->r   + dt_bound_weight *
   // Scalar(0.5) * rub_max_.head(2).squaredNorm()
   // + speed_weight * Scalar(0.5) * rub_max_.tail(2).squaredNorm();
   d->cost = Scalar(0.5) * d->r.transpose() * d->r +
-            dt_bound_weight * Scalar(0.5) * rub_max_.head(2).squaredNorm() +
-            speed_weight * Scalar(0.5) * rub_max_.tail(2).sum();
+            dt_bound_weight * Scalar(0.5) * d->rub_max_.head(2).squaredNorm() +
+            speed_weight * Scalar(0.5) * d->rub_max_.tail(2).sum();
+
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    // Feet around the shoulders
+    d->cost_terms[CostTerm::Heuristic] =
+        Scalar(0.5) * d->r.template segment<8>(12).squaredNorm();
+    d->cost_terms[CostTerm::Step] =
+        Scalar(0.5) * d->r.template segment<4>(21).squaredNorm();
+    d->cost_terms[CostTerm::Period] =
+        Scalar(0.5) * (d->r(20) * d->r(20) + d->r(25) * d->r(25)) +
+        dt_bound_weight * Scalar(0.5) *
+            d->rub_max_.template head<2>().squaredNorm();
+    d->cost_terms[CostTerm::Velocity] =
+        speed_weight * Scalar(0.5) * d->rub_max_.template tail<2>().sum();
+  }
 }
 
 template <typename Scalar>
@@ -100,6 +118,7 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -120,11 +139,10 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calcDiff(
   d->Lx.template segment<8>(12) =
       (shoulder_weights_.array() * d->r.template segment<8>(12).array())
           .matrix();
-  d->Lx.template tail<1>() << dt_bound_weight * (-rub_max_[0] + rub_max_[1]) -
-                                  beta_lim * speed_weight * x(20) *
-                                      rub_max_bool[2] -
-                                  beta_lim * speed_weight * x(20) *
-                                      rub_max_bool[3];
+  d->Lx.template tail<1>()
+      << dt_bound_weight * (-d->rub_max_[0] + d->rub_max_[1]) -
+             beta_lim * speed_weight * x(20) * d->rub_max_bool[2] -
+             beta_lim * speed_weight * x(20) * d->rub_max_bool[3];
   d->Lx.template tail<1>() += dt_weight_ * d->r.template segment<1>(20);
 
   // cost period <--> distance
@@ -134,10 +152,10 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calcDiff(
   //          speed_weight*Scalar(2)*u[3]*rub_max_[3] ,
   //          - speed_weight*Scalar(2)*beta_lim*u[4]*(rub_max_[2] +
   //          rub_max_[3]);
-  d->Lu << speed_weight * u[0] * rub_max_bool[2],
-      speed_weight * u[1] * rub_max_bool[2],
-      speed_weight * u[2] * rub_max_bool[3],
-      speed_weight * u[3] * rub_max_bool[3], Scalar(0.);
+  d->Lu << speed_weight * u[0] * d->rub_max_bool[2],
+      speed_weight * u[1] * d->rub_max_bool[2],
+      speed_weight * u[2] * d->rub_max_bool[3],
+      speed_weight * u[3] * d->rub_max_bool[3], Scalar(0.);
 
   d->Lu.template head<4>() +=
       (step_weights_.array() * d->r.template segment<4>(21).array()).matrix();
@@ -149,15 +167,15 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::calcDiff(
   d->Lxx.diagonal().segment(12, 8) =
       (shoulder_weights_.array() * shoulder_weights_.array()).matrix();
   d->Lxx.diagonal().tail(1) << dt_weight_ * dt_weight_ +
-                                   dt_bound_weight * rub_max_bool[0] +
-                                   dt_bound_weight * rub_max_bool[1];
+                                   dt_bound_weight * d->rub_max_bool[0] +
+                                   dt_bound_weight * d->rub_max_bool[1];
 
-  d->Lxx(20, 20) += -beta_lim * speed_weight * rub_max_bool[2] -
-                    beta_lim * speed_weight * rub_max_bool[3];
+  d->Lxx(20, 20) += -beta_lim * speed_weight * d->rub_max_bool[2] -
+                    beta_lim * speed_weight * d->rub_max_bool[3];
 
-  d->Luu.diagonal() << speed_weight * rub_max_bool[2],
-      speed_weight * rub_max_bool[2], speed_weight * rub_max_bool[3],
-      speed_weight * rub_max_bool[3], Scalar(0.);
+  d->Luu.diagonal() << speed_weight * d->rub_max_bool[2],
+      speed_weight * d->rub_max_bool[2], speed_weight * d->rub_max_bool[3],
+      speed_weight * d->rub_max_bool[3], Scalar(0.);
 
   d->Luu.diagonal().head(4) +=
       (step_weights_.array() * step_weights_.array()).matrix();
@@ -413,6 +431,9 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::MatrixXs>& S) {
+  using std::cos;
+  using std::sin;
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -435,14 +456,14 @@ void ActionModelQuadrupedStepPeriodTpl<Scalar>::update_model(
   // Centrifual term
   pcentrifugal_tmp_1 = xref.block(6, 0, 3, 1);
   pcentrifugal_tmp_2 = xref.block(9, 0, 3, 1);
-  pcentrifugal_tmp = 0.5 * std::sqrt(xref(2, 0) / 9.81) *
+  pcentrifugal_tmp = Scalar(0.5) * std::sqrt(xref(2, 0) / Scalar(9.81)) *
                      pcentrifugal_tmp_1.cross(pcentrifugal_tmp_2);
 
   for (int i = 0; i < 4; i = i + 1) {
     pshoulder_tmp.block(0, i, 2, 1) =
         R_tmp.block(0, 0, 2, 2) *
         (pshoulder_0.block(0, i, 2, 1) +
-         symmetry_term * 0.25 * T_gait * xref.block(6, 0, 2, 1) +
+         symmetry_term * Scalar(0.25) * T_gait * xref.block(6, 0, 2, 1) +
          centrifugal_term * pcentrifugal_tmp.block(0, 0, 2, 1));
     pshoulder_[2 * i] = pshoulder_tmp(0, i) + xref(0, 0);
     pshoulder_[2 * i + 1] = pshoulder_tmp(1, i) + xref(1, 0);
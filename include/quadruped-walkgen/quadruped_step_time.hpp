@@ -7,6 +7,8 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
 template <typename _Scalar>
@@ -69,8 +71,8 @@ class ActionModelQuadrupedStepTimeTpl
   const bool& get_first_step() const;
   void set_first_step(const bool& first);
 
-  // get cost
-  const typename Eigen::Matrix<Scalar, 7, 1>& get_cost() const;
+  // Number of samples along the flying phase for the feet speed cost
+  const int& get_nb_alpha() const;
 
  protected:
   using Base::has_control_limits_;  //!< Indicates whether any of the control
@@ -113,12 +115,6 @@ class ActionModelQuadrupedStepTimeTpl
   typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> b_coeff_x2;
   typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> b_coeff_y2;
 
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rub_max_first_x;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rub_max_first_y;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rub_max_first_2;
-  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>
-      rub_max_first_bool;
-
   // typename  Eigen::Array<Scalar, 3, 12 > b_coeff2 ;
   typename Eigen::Matrix<Scalar, 3, 4> lfeet;
   // typename Eigen::Array<Scalar, 3, 4 > rub_max_first ;
@@ -127,8 +123,8 @@ class ActionModelQuadrupedStepTimeTpl
 
   typename Eigen::Matrix<Scalar, 8, 8> B;
 
-  typename MathBase::MatrixXs xref_;
-  typename MathBase::VectorXs S_;  // Containing the flying feet
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
+  typename Eigen::Matrix<Scalar, 4, 1> S_;  // Containing the flying feet
   typename Eigen::Matrix<Scalar, 8, 1> pheuristic_;
 
   // Compute heuristic inside update Model
@@ -137,18 +133,12 @@ class ActionModelQuadrupedStepTimeTpl
   // typename Eigen::Matrix<Scalar, 3 , 1 > pcentrifugal_tmp;
   // typename Eigen::Matrix<Scalar, 3 , 1 > pcentrifugal_tmp_1;
   // typename Eigen::Matrix<Scalar, 3 , 1 > pcentrifugal_tmp_2;
-
-  typename Eigen::Matrix<Scalar, 4, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 4, 1> rub_max_bool;
-
-  // Log cost
-  bool log_cost;
-  typename Eigen::Matrix<Scalar, 7, 1> cost_;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedStepTimeTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -167,7 +157,29 @@ struct ActionDataQuadrupedStepTimeTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedStepTimeTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {
+    const int nb_alpha = model->get_nb_alpha();
+    rub_max_first_x =
+        Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha, 4);
+    rub_max_first_y =
+        Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha, 4);
+    rub_max_first_2 =
+        Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha, 4);
+    rub_max_first_bool =
+        Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha, 4);
+    rub_max_.setZero();
+    rub_max_bool.setZero();
+  }
+
+  // Feet speed samples computed in calc and reused in calcDiff, kept in the
+  // data so that the nodes of a problem can be evaluated concurrently
+  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rub_max_first_x;
+  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rub_max_first_y;
+  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> rub_max_first_2;
+  typename Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+      rub_max_first_bool;
+  typename Eigen::Matrix<Scalar, 4, 1> rub_max_;
+  typename Eigen::Matrix<Scalar, 4, 1> rub_max_bool;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -176,9 +188,20 @@ struct ActionDataQuadrupedStepTimeTpl
 
 typedef ActionModelQuadrupedStepTimeTpl<double> ActionModelQuadrupedStepTime;
 typedef ActionDataQuadrupedStepTimeTpl<double> ActionDataQuadrupedStepTime;
+typedef ActionModelQuadrupedStepTimeTpl<float>
+    ActionModelQuadrupedStepTimeFloat;
+typedef ActionDataQuadrupedStepTimeTpl<float> ActionDataQuadrupedStepTimeFloat;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_step_time.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_step_time.cpp
+extern template class ActionModelQuadrupedStepTimeTpl<double>;
+extern template struct ActionDataQuadrupedStepTimeTpl<double>;
+extern template class ActionModelQuadrupedStepTimeTpl<float>;
+extern template struct ActionDataQuadrupedStepTimeTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
@@ -9,8 +9,8 @@ ActionModelQuadrupedStepTimeTpl<Scalar>::ActionModelQuadrupedStepTimeTpl()
     : crocoddyl::ActionModelAbstractTpl<Scalar>(
           boost::make_shared<crocoddyl::StateVectorTpl<Scalar> >(21), 8, 29) {
   B.setZero();  // x_next = x + B * u
-  rub_max_.setZero();
-  rub_max_bool.setZero();
+  xref_.setZero();
+  S_.setZero();
 
   state_weights_ << Scalar(1.), Scalar(1.), Scalar(150.), Scalar(35.),
       Scalar(30.), Scalar(8.), Scalar(20.), Scalar(20.), Scalar(15.),
@@ -39,10 +39,6 @@ ActionModelQuadrupedStepTimeTpl<Scalar>::ActionModelQuadrupedStepTimeTpl()
                     225);  // apparent speed used in the cost function
   speed_weight = Scalar(10.);
 
-  // Logging cost
-  cost_.setZero();
-  log_cost = true;
-
   // indicates whether it t the 1st step, otherwise the cost function is much
   // simpler (acc, speed = 0)
   first_step = false;
@@ -71,15 +67,6 @@ ActionModelQuadrupedStepTimeTpl<Scalar>::ActionModelQuadrupedStepTimeTpl()
   b_coeff_y2 =
       Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha_, 4);
 
-  rub_max_first_x =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha_, 4);
-  rub_max_first_y =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha_, 4);
-  rub_max_first_2 =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha_, 4);
-  rub_max_first_bool =
-      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_alpha_, 4);
-
   alpha.setLinSpaced(nb_alpha_, Scalar(0.0), Scalar(1.0));
   alpha2.col(0) << alpha;
   alpha2.col(1) << alpha.pow(2);
@@ -104,6 +91,7 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -120,7 +108,8 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calc(
 
   // Update position of the feet
   d->xnext.template head<12>() = x.head(12);
-  d->xnext.template segment<8>(12) = x.segment(12, 8) + B * u;
+  d->xnext.template segment<8>(12) =
+      x.template segment<8>(12) + B * u.template head<8>();
   d->xnext.template tail<1>() = x.tail(1);
 
   // Residual cost on the state and force norm
@@ -136,56 +125,58 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calc(
   if (first_step) {
     for (int i = 0; i < 4; i++) {
       if (S_[i] == Scalar(1)) {
-        rub_max_first_x.col(i) = x(20) * b_coeff_x0.col(i) +
-                                 x(20) * x(20) * b_coeff_x1.col(i) +
-                                 u(2 * i) * b_coeff_x2.col(i);
-        rub_max_first_y.col(i) = x(20) * b_coeff_y0.col(i) +
-                                 x(20) * x(20) * b_coeff_y1.col(i) +
-                                 u(2 * i + 1) * b_coeff_y2.col(i);
-
-        rub_max_first_2.col(i) =
-            rub_max_first_x.col(i).pow(2) + rub_max_first_y.col(i).pow(2) -
-            x(20) * x(20) * vlim * vlim * nb_nodes * nb_nodes;
+        d->rub_max_first_x.col(i) = x(20) * b_coeff_x0.col(i) +
+                                    x(20) * x(20) * b_coeff_x1.col(i) +
+                                    u(2 * i) * b_coeff_x2.col(i);
+        d->rub_max_first_y.col(i) = x(20) * b_coeff_y0.col(i) +
+                                    x(20) * x(20) * b_coeff_y1.col(i) +
+                                    u(2 * i + 1) * b_coeff_y2.col(i);
+
+        d->rub_max_first_2.col(i) = d->rub_max_first_x.col(i).pow(2) +
+                                    d->rub_max_first_y.col(i).pow(2) -
+                                    x(20) * x(20) * vlim * vlim * nb_nodes *
+                                        nb_nodes;
       } else {
-        rub_max_first_2.col(i).setZero();
+        d->rub_max_first_2.col(i).setZero();
       }
     }
 
-    rub_max_first_bool =
-        (rub_max_first_2 > Scalar(0.))
+    d->rub_max_first_bool =
+        (d->rub_max_first_2 > Scalar(0.))
             .template cast<Scalar>();  // Usefull to compute the derivatives
-    rub_max_first_2 = rub_max_first_2.cwiseMax(Scalar(0.));  // Remove <0 terms
+    d->rub_max_first_2 =
+        d->rub_max_first_2.cwiseMax(Scalar(0.));  // Remove <0 terms
 
     for (int i = 0; i < nb_alpha_; i++) {
-      d->cost += speed_weight * Scalar(0.5) * rub_max_first_2.row(i).sum();
+      d->cost += speed_weight * Scalar(0.5) * d->rub_max_first_2.row(i).sum();
     }
   } else {
-    rub_max_ << u[0] * u[0] + u[1] * u[1] - beta_lim * x[20] * x[20],
+    d->rub_max_ << u[0] * u[0] + u[1] * u[1] - beta_lim * x[20] * x[20],
         u[2] * u[2] + u[3] * u[3] - beta_lim * x[20] * x[20];
 
-    rub_max_bool =
-        (rub_max_.array() >= Scalar(0.)).matrix().template cast<Scalar>();
-    rub_max_ = rub_max_.cwiseMax(Scalar(0.));
+    d->rub_max_bool =
+        (d->rub_max_.array() >= Scalar(0.)).matrix().template cast<Scalar>();
+    d->rub_max_ = d->rub_max_.cwiseMax(Scalar(0.));
 
-    d->cost += speed_weight * Scalar(0.5) * rub_max_.sum();
+    d->cost += speed_weight * Scalar(0.5) * d->rub_max_.sum();
   }
 
-  if (log_cost) {
-    cost_[3] = 0;
-    // Length to be consistent with others models
-    cost_[0] =
-        Scalar(0.5) * d->r.head(12).transpose() * d->r.head(12);  // State cost
-    cost_[1] = Scalar(0.5) * d->r.segment(12, 8).transpose() *
-               d->r.segment(12, 8);  // heuristic cost
-    cost_[2] = Scalar(0.5) * d->r.tail(4).transpose() *
-               d->r.tail(4);  // Delta feet cost
-
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    d->cost_terms[CostTerm::Heuristic] =
+        Scalar(0.5) * d->r.template segment<8>(12).squaredNorm();
+    d->cost_terms[CostTerm::Step] =
+        Scalar(0.5) * d->r.tail(d->r.size() - 20).squaredNorm();
     if (first_step) {
-      for (int i = 0; i < 3; i++) {
-        cost_[3] += speed_weight * Scalar(0.5) * rub_max_first_2.row(i).sum();
+      for (int i = 0; i < nb_alpha_; i++) {
+        d->cost_terms[CostTerm::Velocity] +=
+            speed_weight * Scalar(0.5) * d->rub_max_first_2.row(i).sum();
       }
     } else {
-      cost_[3] = speed_weight * Scalar(0.5) * rub_max_.sum();
+      d->cost_terms[CostTerm::Velocity] =
+          speed_weight * Scalar(0.5) * d->rub_max_.sum();
     }
   }
 }
@@ -195,6 +186,7 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -225,21 +217,21 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calcDiff(
     for (int foot = 0; foot < 4; foot++) {
       if (S_[foot] == Scalar(1)) {
         for (int i = 0; i < nb_alpha_; i++) {
-          if (rub_max_first_bool(i, foot)) {
+          if (d->rub_max_first_bool(i, foot)) {
             d->Lx(20) +=
                 speed_weight *
                     (b_coeff_x0(i, foot) +
                      Scalar(2) * x(20) * b_coeff_x1(i, foot)) *
-                    rub_max_first_x(i, foot) +
+                    d->rub_max_first_x(i, foot) +
                 speed_weight *
                     (b_coeff_y0(i, foot) +
                      Scalar(2) * x(20) * b_coeff_y1(i, foot)) *
-                    rub_max_first_y(i, foot) -
+                    d->rub_max_first_y(i, foot) -
                 speed_weight * x(20) * vlim * vlim * nb_nodes * nb_nodes;
-            d->Lu(2 * foot) +=
-                speed_weight * b_coeff_x2(i, foot) * rub_max_first_x(i, foot);
-            d->Lu(2 * foot + 1) +=
-                speed_weight * b_coeff_y2(i, foot) * rub_max_first_y(i, foot);
+            d->Lu(2 * foot) += speed_weight * b_coeff_x2(i, foot) *
+                               d->rub_max_first_x(i, foot);
+            d->Lu(2 * foot + 1) += speed_weight * b_coeff_y2(i, foot) *
+                                   d->rub_max_first_y(i, foot);
 
             d->Luu(2 * foot, 2 * foot) +=
                 speed_weight * b_coeff_x2(i, foot) * b_coeff_x2(i, foot);
@@ -258,15 +250,15 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calcDiff(
                 speed_weight *
                     std::pow(b_coeff_x0(i, foot) +
                                  Scalar(2) * x(20) * b_coeff_x1(i, foot),
-                             2) +
+                             Scalar(2)) +
                 speed_weight * Scalar(2) * b_coeff_x1(i, foot) *
-                    rub_max_first_x(i, foot) +
+                    d->rub_max_first_x(i, foot) +
                 speed_weight *
                     std::pow(b_coeff_y0(i, foot) +
                                  Scalar(2) * x(20) * b_coeff_x1(i, foot),
-                             2) +
+                             Scalar(2)) +
                 speed_weight * Scalar(2) * b_coeff_y1(i, foot) *
-                    rub_max_first_y(i, foot) -
+                    d->rub_max_first_y(i, foot) -
                 speed_weight * vlim * vlim * nb_nodes * nb_nodes;
           }
         }
@@ -277,20 +269,20 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::calcDiff(
 
   else {
     d->Lx.template tail<1>()
-        << -beta_lim * speed_weight * x(20) * rub_max_bool[0] -
-               beta_lim * speed_weight * x(20) * rub_max_bool[1];
+        << -beta_lim * speed_weight * x(20) * d->rub_max_bool[0] -
+               beta_lim * speed_weight * x(20) * d->rub_max_bool[1];
 
-    d->Lu << speed_weight * u[0] * rub_max_bool[0],
-        speed_weight * u[1] * rub_max_bool[0],
-        speed_weight * u[2] * rub_max_bool[1],
-        speed_weight * u[3] * rub_max_bool[1];
+    d->Lu << speed_weight * u[0] * d->rub_max_bool[0],
+        speed_weight * u[1] * d->rub_max_bool[0],
+        speed_weight * u[2] * d->rub_max_bool[1],
+        speed_weight * u[3] * d->rub_max_bool[1];
 
-    d->Lxx(20, 20) = -beta_lim * speed_weight * rub_max_bool[0] -
-                     beta_lim * speed_weight * rub_max_bool[1];
+    d->Lxx(20, 20) = -beta_lim * speed_weight * d->rub_max_bool[0] -
+                     beta_lim * speed_weight * d->rub_max_bool[1];
 
-    d->Luu.diagonal() << speed_weight * rub_max_bool[0],
-        speed_weight * rub_max_bool[0], speed_weight * rub_max_bool[1],
-        speed_weight * rub_max_bool[1];
+    d->Luu.diagonal() << speed_weight * d->rub_max_bool[0],
+        speed_weight * d->rub_max_bool[0], speed_weight * d->rub_max_bool[1],
+        speed_weight * d->rub_max_bool[1];
   }
 
   d->Lu += (step_weights_.array() * d->r.template tail<4>().array()).matrix();
@@ -435,13 +427,9 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::set_vlim(const Scalar& vlim_) {
   ;
 }
 
-///////////////
-// Log cost  //
-///////////////
 template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 7, 1>&
-ActionModelQuadrupedStepTimeTpl<Scalar>::get_cost() const {
-  return cost_;
+const int& ActionModelQuadrupedStepTimeTpl<Scalar>::get_nb_alpha() const {
+  return nb_alpha_;
 }
 
 // indicates whether it t the 1st step, otherwise the cost function is much
@@ -468,6 +456,7 @@ void ActionModelQuadrupedStepTimeTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& acceleration,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::VectorXs>& S) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
@@ -7,6 +7,8 @@
 #include "crocoddyl/core/states/euclidean.hpp"
 #include "crocoddyl/core/utils/timer.hpp"
 #include "crocoddyl/multibody/friction-cone.hpp"
+#include "quadruped-walkgen/cost_terms.hpp"
+#include "quadruped-walkgen/timing_probes.hpp"
 
 namespace quadruped_walkgen {
 template <typename _Scalar>
@@ -67,9 +69,6 @@ class ActionModelQuadrupedTimeTpl
   const Scalar& get_dt_bound_weight_cmd() const;
   void set_dt_bound_weight_cmd(const Scalar& weight_);
 
-  // get cost
-  const typename Eigen::Matrix<Scalar, 7, 1>& get_cost() const;
-
  protected:
   using Base::has_control_limits_;  //!< Indicates whether any of the control
                                     //!< limits
@@ -87,16 +86,12 @@ class ActionModelQuadrupedTimeTpl
   bool centrifugal_term;
   bool symmetry_term;
 
-  // Log cost
-  bool log_cost;
-  typename Eigen::Matrix<Scalar, 7, 1> cost_;
-
   typename Eigen::Matrix<Scalar, 12, 1> state_weights_;
   typename Eigen::Matrix<Scalar, 8, 1> heuristic_weights_;
 
   typename MathBase::Matrix3s R_tmp;
 
-  typename MathBase::MatrixXs xref_;
+  typename Eigen::Matrix<Scalar, 12, 1> xref_;
   typename Eigen::Matrix<Scalar, 8, 1> pheuristic_;
   typename Eigen::Matrix<Scalar, 8, 1> gait_double_;
   // typename Eigen::Matrix<Scalar, 2 , 4 > pshoulder_0;
@@ -109,14 +104,12 @@ class ActionModelQuadrupedTimeTpl
   typename Eigen::Matrix<Scalar, 1, 1> dt_ref_;
   typename Eigen::Matrix<Scalar, 1, 1> dt_min_;
   typename Eigen::Matrix<Scalar, 1, 1> dt_max_;
-
-  typename Eigen::Matrix<Scalar, 2, 1> rub_max_;
-  typename Eigen::Matrix<Scalar, 2, 1> rub_max_bool;
 };
 
 template <typename _Scalar>
 struct ActionDataQuadrupedTimeTpl
-    : public crocoddyl::ActionDataAbstractTpl<_Scalar> {
+    : public crocoddyl::ActionDataAbstractTpl<_Scalar>,
+      public CostTermsDataTpl<_Scalar> {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef _Scalar Scalar;
@@ -135,7 +128,14 @@ struct ActionDataQuadrupedTimeTpl
 
   template <template <typename Scalar> class Model>
   explicit ActionDataQuadrupedTimeTpl(Model<Scalar>* const model)
-      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {}
+      : crocoddyl::ActionDataAbstractTpl<Scalar>(model) {
+    rub_max_.setZero();
+    rub_max_bool.setZero();
+  }
+
+  // Bounds on the time step computed in calc and reused in calcDiff
+  typename Eigen::Matrix<Scalar, 2, 1> rub_max_;
+  typename Eigen::Matrix<Scalar, 2, 1> rub_max_bool;
 };
 
 /* --- Details -------------------------------------------------------------- */
@@ -144,9 +144,19 @@ struct ActionDataQuadrupedTimeTpl
 
 typedef ActionModelQuadrupedTimeTpl<double> ActionModelQuadrupedTime;
 typedef ActionDataQuadrupedTimeTpl<double> ActionDataQuadrupedTime;
+typedef ActionModelQuadrupedTimeTpl<float> ActionModelQuadrupedTimeFloat;
+typedef ActionDataQuadrupedTimeTpl<float> ActionDataQuadrupedTimeFloat;
 
 }  // namespace quadruped_walkgen
 
 #include "quadruped_time.hxx"
 
+namespace quadruped_walkgen {
+// Instantiated in src/quadruped_time.cpp
+extern template class ActionModelQuadrupedTimeTpl<double>;
+extern template struct ActionDataQuadrupedTimeTpl<double>;
+extern template class ActionModelQuadrupedTimeTpl<float>;
+extern template struct ActionDataQuadrupedTimeTpl<float>;
+}  // namespace quadruped_walkgen
+
 #endif
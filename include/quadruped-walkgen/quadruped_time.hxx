@@ -18,6 +18,7 @@ ActionModelQuadrupedTimeTpl<Scalar>::ActionModelQuadrupedTimeTpl()
   dt_weight_cmd = Scalar(0.);
 
   pheuristic_.setZero();
+  xref_.setZero();
   gait_double_.setZero();
 
   // Shoulder heuristic position
@@ -39,15 +40,10 @@ ActionModelQuadrupedTimeTpl<Scalar>::ActionModelQuadrupedTimeTpl()
   // R_tmp.setZero() ;
 
   // Cost relative to the command
-  rub_max_.setZero();
-  rub_max_bool.setZero();
   dt_ref_.setConstant(Scalar(0.02));
   dt_min_.setConstant(Scalar(0.005));
   dt_max_.setConstant(Scalar(0.1));
 
-  // Log cost
-  cost_.setZero();
-  log_cost = true;
 }
 
 template <typename Scalar>
@@ -58,6 +54,7 @@ void ActionModelQuadrupedTimeTpl<Scalar>::calc(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), Calc);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -89,27 +86,23 @@ void ActionModelQuadrupedTimeTpl<Scalar>::calc(
   d->r.template tail<1>() << dt_weight_cmd * (u.cwiseAbs() - dt_ref_);
 
   // Penalisation if dt out of lower/upper bound
-  rub_max_ << dt_min_ - u.cwiseAbs(), u.cwiseAbs() - dt_max_;
-  rub_max_bool =
-      (rub_max_.array() >= Scalar(0.)).matrix().template cast<Scalar>();
-  rub_max_ = rub_max_.cwiseMax(Scalar(0.));
+  d->rub_max_ << dt_min_ - u.cwiseAbs(), u.cwiseAbs() - dt_max_;
+  d->rub_max_bool =
+      (d->rub_max_.array() >= Scalar(0.)).matrix().template cast<Scalar>();
+  d->rub_max_ = d->rub_max_.cwiseMax(Scalar(0.));
 
   d->cost = Scalar(0.5) * d->r.transpose() * d->r +
-            dt_bound_weight_cmd * Scalar(0.5) * rub_max_.squaredNorm();
-
-  if (log_cost) {
-    // Length of the cost similar to the Augmented cost...
-    cost_[0] =
-        Scalar(0.5) * d->r.head(12).transpose() * d->r.head(12);  // state
-    cost_[1] = Scalar(0.5) * d->r.segment(12, 8).transpose() *
-               d->r.segment(12, 8);  // feet placement
-    cost_[2] = Scalar(0.5) * d->r.tail(1).transpose() *
-               d->r.tail(1);  // 0.5*\delta*|| U - dt_ref ||^2
-    cost_[3] = dt_bound_weight_cmd * Scalar(0.5) *
-               rub_max_.squaredNorm();  // u/l bound weight
-    cost_[4] = Scalar(0);
-    cost_[5] = Scalar(0);
-    cost_[6] = Scalar(0);
+            dt_bound_weight_cmd * Scalar(0.5) * d->rub_max_.squaredNorm();
+
+  if (get_log_cost_terms()) {
+    d->cost_terms.setZero();
+    d->cost_terms[CostTerm::State] =
+        Scalar(0.5) * d->r.template head<12>().squaredNorm();
+    d->cost_terms[CostTerm::Heuristic] =
+        Scalar(0.5) * d->r.template segment<8>(12).squaredNorm();
+    d->cost_terms[CostTerm::Period] =
+        Scalar(0.5) * d->r.template tail<1>().squaredNorm() +
+        dt_bound_weight_cmd * Scalar(0.5) * d->rub_max_.squaredNorm();
   }
 }
 
@@ -118,6 +111,7 @@ void ActionModelQuadrupedTimeTpl<Scalar>::calcDiff(
     const boost::shared_ptr<crocoddyl::ActionDataAbstractTpl<Scalar> >& data,
     const Eigen::Ref<const typename MathBase::VectorXs>& x,
     const Eigen::Ref<const typename MathBase::VectorXs>& u) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(data.get(), CalcDiff);
   if (static_cast<std::size_t>(x.size()) != state_->get_nx()) {
     throw_pretty("Invalid argument: "
                  << "x has wrong dimension (it should be " +
@@ -139,9 +133,10 @@ void ActionModelQuadrupedTimeTpl<Scalar>::calcDiff(
       (heuristic_weights_.array() * d->r.template segment<8>(12).array())
           .matrix();  // * gait_double in d->r
 
-  d->Lu << dt_bound_weight_cmd * std::copysign(1., u(0)) *
-               (-rub_max_[0] + rub_max_[1]);
-  d->Lu += dt_weight_cmd * std::copysign(1., u(0)) * d->r.template tail<1>();
+  d->Lu << dt_bound_weight_cmd * std::copysign(Scalar(1), u(0)) *
+               (-d->rub_max_[0] + d->rub_max_[1]);
+  d->Lu += dt_weight_cmd * std::copysign(Scalar(1), u(0)) *
+           d->r.template tail<1>();
 
   // Hessian : Lxx
   d->Lxx.diagonal().head(12) =
@@ -152,13 +147,13 @@ void ActionModelQuadrupedTimeTpl<Scalar>::calcDiff(
           .matrix();
 
   d->Luu.diagonal() << dt_weight_cmd * dt_weight_cmd +
-                           dt_bound_weight_cmd * rub_max_bool[0] +
-                           dt_bound_weight_cmd * rub_max_bool[1];
+                           dt_bound_weight_cmd * d->rub_max_bool[0] +
+                           dt_bound_weight_cmd * d->rub_max_bool[1];
 
   // Dynamic derivatives
   d->Fx.setIdentity();
   d->Fx(20, 20) = Scalar(0.);
-  d->Fu.block(20, 0, 1, 1) << std::copysign(1., u(0));
+  d->Fu.block(20, 0, 1, 1) << std::copysign(Scalar(1), u(0));
 }
 
 template <typename Scalar>
@@ -294,15 +289,6 @@ void ActionModelQuadrupedTimeTpl<Scalar>::set_dt_weight_cmd(
   dt_weight_cmd = weight_;
 }
 
-///////////////////////
-// Logging cost      //
-///////////////////////
-template <typename Scalar>
-const typename Eigen::Matrix<Scalar, 7, 1>&
-ActionModelQuadrupedTimeTpl<Scalar>::get_cost() const {
-  return cost_;
-}
-
 ////////////////////////
 // Update current model
 ////////////////////////
@@ -312,6 +298,7 @@ void ActionModelQuadrupedTimeTpl<Scalar>::update_model(
     const Eigen::Ref<const typename MathBase::MatrixXs>& l_feet,
     const Eigen::Ref<const typename MathBase::MatrixXs>& xref,
     const Eigen::Ref<const typename MathBase::VectorXs>& S) {
+  QUADRUPED_WALKGEN_TIMING_PROBE(this, UpdateModel);
   if (static_cast<std::size_t>(l_feet.size()) != 12) {
     throw_pretty("Invalid argument: "
                  << "l_feet matrix has wrong dimension (it should be : 3x4)");
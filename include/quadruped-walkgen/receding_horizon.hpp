@@ -0,0 +1,106 @@
+#ifndef __quadruped_walkgen_receding_horizon_hpp__
+#define __quadruped_walkgen_receding_horizon_hpp__
+
+#include <vector>
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "quadruped-walkgen/quadruped.hpp"
+
+namespace quadruped_walkgen {
+
+// Receding horizon of ActionModelQuadruped for the MPC.
+// The running models and the warm start are kept as a ring buffer : at each
+// control cycle shift() moves the first node to the end of the horizon
+// (with its data, through ShootingProblem::circularAppend), then update()
+// only calls update_model on the nodes whose footholds or contact status
+// differ from the ones already applied to their model. When the gait simply
+// rolled by one node, only the appended node and the terminal node are
+// updated. A reference state that moves, as in most control cycles, still
+// changes every node : the other nodes then only get update_reference, which
+// rebuilds the part of the dynamics depending on the reference position and
+// yaw.
+class RecedingHorizonQuadruped {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<double, 3, 4> Matrix34;
+  typedef Eigen::Matrix<double, 12, 1> Vector12;
+  typedef Eigen::Matrix<double, 4, 1> Vector4;
+
+  // Parameters given to update_model for one model
+  struct Node {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    boost::shared_ptr<ActionModelQuadruped> model;
+    Matrix34 l_feet;
+    Vector12 xref;
+    Vector4 gait;
+    bool valid;  // false until the first update_model
+  };
+  typedef std::vector<Node, Eigen::aligned_allocator<Node> > StdVecNode;
+
+  RecedingHorizonQuadruped(const Eigen::Ref<const Eigen::VectorXd>& x0,
+                           const std::size_t N = 16);
+  ~RecedingHorizonQuadruped();
+
+  // Move the first node to the end of the horizon, and shift the warm start
+  // by one node (the last state and control are duplicated)
+  void shift();
+
+  // Update the models from the gait and footsteps matrices, in the same
+  // format as in the benchmarks :
+  //   gait   : nx5, [nb of nodes, S1, S2, S3, S4] for each phase
+  //   fsteps : nx13, [nb of nodes, x1, y1, z1, ... x4, y4, z4]
+  //   xref   : 12x(N+1), the first column is the current state
+  // The phases are read until the first row with 0 nodes.
+  // Returns the number of calls to update_model, terminal node included, the
+  // nodes whose reference only changed are not counted.
+  std::size_t update(const Eigen::Ref<const Eigen::MatrixXd>& gait,
+                     const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+                     const Eigen::Ref<const Eigen::MatrixXd>& xref);
+
+  // Update node k (k = N for the terminal node) if the parameters changed,
+  // with update_reference if only xref changed. Returns true if update_model
+  // was called.
+  bool update_node(const std::size_t k,
+                   const Eigen::Ref<const Eigen::MatrixXd>& l_feet,
+                   const Eigen::Ref<const Eigen::MatrixXd>& xref,
+                   const Eigen::Ref<const Eigen::MatrixXd>& S);
+
+  // Force the update of all the nodes at the next call to update, needed
+  // when a parameter used by update_model (mass, gI, dt ...) is changed
+  void invalidate();
+
+  // Store the last solution as warm start for the next shift
+  void set_warm_start(const std::vector<Eigen::VectorXd>& xs,
+                      const std::vector<Eigen::VectorXd>& us);
+
+  void set_x0(const Eigen::Ref<const Eigen::VectorXd>& x0);
+
+  const boost::shared_ptr<crocoddyl::ShootingProblem>& get_problem() const;
+  const std::vector<Eigen::VectorXd>& get_xs() const;
+  const std::vector<Eigen::VectorXd>& get_us() const;
+  std::size_t get_N() const;
+
+  // Model of node k in the horizon (k = N for the terminal node)
+  const boost::shared_ptr<ActionModelQuadruped>& get_model(
+      const std::size_t k) const;
+
+ protected:
+  // Node k in the horizon order
+  Node& node(const std::size_t k);
+  const Node& node(const std::size_t k) const;
+
+  std::size_t N_;     // Number of running nodes
+  std::size_t head_;  // Index in nodes_ of the first running node
+  StdVecNode nodes_;  // Running nodes, ring buffer starting at head_
+  Node terminal_;
+
+  boost::shared_ptr<crocoddyl::ShootingProblem> problem_;
+  std::vector<Eigen::VectorXd> xs_;
+  std::vector<Eigen::VectorXd> us_;
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef __quadruped_walkgen_solver_deadline_hpp__
+#define __quadruped_walkgen_solver_deadline_hpp__
+
+#include <chrono>
+#include <vector>
+
+#include "crocoddyl/core/solvers/ddp.hpp"
+#include "quadruped-walkgen/solver_quadruped_ddp.hpp"
+
+namespace quadruped_walkgen {
+
+// DDP solver stopped by a wall-clock budget instead of an iteration count.
+// Solver is crocoddyl::SolverDDP, for the problems of any of the walkgen
+// models, or SolverQuadrupedDDP for the linear model. The iterations are
+// the ones of SolverDDP::solve; before each of them but the first, the
+// duration of the next iteration is predicted from the previous ones and the
+// solve stops if it would end after the budget. The first iteration is
+// always run, since it computes the cost of the warm start and the gains for
+// the new problem : a solve started with less than one iteration of budget
+// overruns it by that iteration. The callbacks are called after each
+// iteration, as in SolverDDP::solve; their duration is counted in the one of
+// the next iteration.
+//
+// Each accepted step of the forward pass is a rollout of the models, so the
+// iterates are feasible; the one of lowest cost is kept and, when the solve
+// stops, it is the candidate of the solver (get_xs, get_us, get_cost). The
+// warm start counts as an iterate when it is given as feasible. The gains
+// are the ones of the last backward pass.
+//
+// The duration of an iteration is estimated by a peak detector : it follows
+// the increases at once and decreases by the factor decay after each
+// iteration. It is kept from one solve to the next, so that the second
+// iteration of a solve is predicted from the previous solves as well as from
+// the first iteration. The estimate is multiplied by margin before being
+// compared to the remaining budget.
+template <class Solver>
+class SolverDeadline : public Solver {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef std::chrono::steady_clock Clock;
+
+  explicit SolverDeadline(
+      boost::shared_ptr<crocoddyl::ShootingProblem> problem);
+  virtual ~SolverDeadline();
+
+  // Iterate until convergence, maxiter or the budget, returns true if the
+  // stopping criteria is reached
+  virtual bool solve(
+      const std::vector<Eigen::VectorXd>& init_xs = crocoddyl::DEFAULT_VECTOR,
+      const std::vector<Eigen::VectorXd>& init_us = crocoddyl::DEFAULT_VECTOR,
+      const std::size_t maxiter = 100, const bool is_feasible = false,
+      const double reginit = 1e-9);
+
+  // Budget of a solve, from the call to solve [ms], infinite by default
+  const double& get_budget() const;
+  void set_budget(const double& budget);
+
+  // Safety factor on the predicted duration of an iteration (>= 1)
+  const double& get_margin() const;
+  void set_margin(const double& margin);
+
+  // Decrease of the estimated duration of an iteration, in [0, 1]
+  const double& get_decay() const;
+  void set_decay(const double& decay);
+
+  // Estimated duration of an iteration [ms]
+  double get_iteration_time() const;
+
+  // Duration of the last solve [ms]
+  double get_elapsed() const;
+
+  // True if the last solve was stopped by the budget
+  bool get_deadline_reached() const;
+
+  // Number of iterations that led to the returned iterate, 0 for the warm
+  // start
+  std::size_t get_best_iter() const;
+
+  // Forget the estimated duration of an iteration
+  void reset_iteration_time();
+
+ protected:
+  using Solver::alphas_;
+  using Solver::callbacks_;
+  using Solver::cost_;
+  using Solver::cost_try_;
+  using Solver::d_;
+  using Solver::dV_;
+  using Solver::dVexp_;
+  using Solver::is_feasible_;
+  using Solver::iter_;
+  using Solver::problem_;
+  using Solver::reg_max_;
+  using Solver::steplength_;
+  using Solver::stop_;
+  using Solver::th_acceptstep_;
+  using Solver::th_grad_;
+  using Solver::th_stepdec_;
+  using Solver::th_stepinc_;
+  using Solver::th_stop_;
+  using Solver::ureg_;
+  using Solver::was_feasible_;
+  using Solver::xreg_;
+  using Solver::xs_;
+  using Solver::xs_try_;
+  using Solver::us_;
+  using Solver::us_try_;
+
+  // Keep the candidate of the solver, found after iter iterations, if its
+  // cost is the lowest so far
+  void keep_best(const std::size_t iter);
+
+  // Candidate of the solver back to the best iterate
+  void restore_best();
+
+  double budget_;
+  double margin_;
+  double decay_;
+  Clock::duration iteration_time_;
+  Clock::duration elapsed_;
+  bool deadline_reached_;
+
+  std::vector<Eigen::VectorXd> best_xs_;
+  std::vector<Eigen::VectorXd> best_us_;
+  double best_cost_;
+  std::size_t best_iter_;
+  bool has_best_;
+};
+
+typedef SolverDeadline<crocoddyl::SolverDDP> SolverDeadlineDDP;
+typedef SolverDeadline<SolverQuadrupedDDP> SolverDeadlineQuadrupedDDP;
+
+}  // namespace quadruped_walkgen
+
+#include "solver_deadline.hxx"
+
+namespace quadruped_walkgen {
+// Instantiated in src/solver_deadline.cpp
+extern template class SolverDeadline<crocoddyl::SolverDDP>;
+extern template class SolverDeadline<SolverQuadrupedDDP>;
+}  // namespace quadruped_walkgen
+
+#endif
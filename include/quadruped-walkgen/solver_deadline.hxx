@@ -0,0 +1,238 @@
+#ifndef __quadruped_walkgen_solver_deadline_hxx__
+#define __quadruped_walkgen_solver_deadline_hxx__
+
+#include <limits>
+
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+
+template <class Solver>
+SolverDeadline<Solver>::SolverDeadline(
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem)
+    : Solver(problem),
+      budget_(std::numeric_limits<double>::infinity()),
+      margin_(1.2),
+      decay_(0.95),
+      iteration_time_(Clock::duration::zero()),
+      elapsed_(Clock::duration::zero()),
+      deadline_reached_(false),
+      best_xs_(xs_),
+      best_us_(us_),
+      best_cost_(std::numeric_limits<double>::infinity()),
+      best_iter_(0),
+      has_best_(false) {}
+
+template <class Solver>
+SolverDeadline<Solver>::~SolverDeadline() {}
+
+template <class Solver>
+bool SolverDeadline<Solver>::solve(
+    const std::vector<Eigen::VectorXd>& init_xs,
+    const std::vector<Eigen::VectorXd>& init_us, const std::size_t maxiter,
+    const bool is_feasible, const double reginit) {
+  const Clock::time_point start = Clock::now();
+  const Clock::time_point deadline =
+      budget_ < std::numeric_limits<double>::infinity()
+          ? start + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double, std::milli>(budget_))
+          : Clock::time_point::max();
+  deadline_reached_ = false;
+  has_best_ = false;
+  best_cost_ = std::numeric_limits<double>::infinity();
+  best_iter_ = 0;
+
+  xs_try_[0] = problem_->get_x0();
+  this->setCandidate(init_xs, init_us, is_feasible);
+  xreg_ = reginit;
+  ureg_ = reginit;
+  was_feasible_ = false;
+  bool recalcDiff = true;
+  bool converged = false;
+  Clock::time_point now = start;
+  for (iter_ = 0; iter_ < maxiter; ++iter_) {
+    if (iter_ > 0) {
+      const Clock::duration predicted =
+          std::chrono::duration_cast<Clock::duration>(margin_ *
+                                                      iteration_time_);
+      if (Clock::now() + predicted > deadline) {
+        deadline_reached_ = true;
+        break;
+      }
+    }
+
+    bool failed = false;
+    while (true) {
+      try {
+        this->computeDirection(recalcDiff);
+      } catch (std::exception&) {
+        recalcDiff = false;
+        this->increaseRegularization();
+        if (xreg_ == reg_max_) {
+          failed = true;
+          break;
+        }
+        continue;
+      }
+      break;
+    }
+    if (failed) {
+      break;
+    }
+    // The cost of the candidate is known once its derivatives are computed
+    if (iter_ == 0 && is_feasible_) {
+      keep_best(0);
+    }
+
+    this->expectedImprovement();
+    for (std::vector<double>::const_iterator it = alphas_.begin();
+         it != alphas_.end(); ++it) {
+      steplength_ = *it;
+      try {
+        dV_ = this->tryStep(steplength_);
+      } catch (std::exception&) {
+        continue;
+      }
+      dVexp_ = steplength_ * (d_[0] + 0.5 * steplength_ * d_[1]);
+      if (dVexp_ >= 0) {
+        if (d_[0] < th_grad_ || !is_feasible_ ||
+            dV_ > th_acceptstep_ * dVexp_) {
+          was_feasible_ = is_feasible_;
+          this->setCandidate(xs_try_, us_try_, true);
+          cost_ = cost_try_;
+          recalcDiff = true;
+          keep_best(iter_ + 1);
+          break;
+        }
+      }
+    }
+
+    // Peak of the durations of the iterations
+    const Clock::time_point end = Clock::now();
+    const Clock::duration duration = end - now;
+    now = end;
+    iteration_time_ =
+        std::chrono::duration_cast<Clock::duration>(decay_ * iteration_time_);
+    if (duration > iteration_time_) {
+      iteration_time_ = duration;
+    }
+
+    if (steplength_ > th_stepdec_) {
+      this->decreaseRegularization();
+    }
+    if (steplength_ <= th_stepinc_) {
+      this->increaseRegularization();
+      if (xreg_ == reg_max_) {
+        break;
+      }
+    }
+    stop_ = this->stoppingCriteria();
+    for (std::size_t c = 0; c < callbacks_.size(); ++c) {
+      (*callbacks_[c])(*this);
+    }
+    if (was_feasible_ && stop_ < th_stop_) {
+      converged = true;
+      break;
+    }
+  }
+
+  restore_best();
+  elapsed_ = Clock::now() - start;
+  return converged;
+}
+
+template <class Solver>
+void SolverDeadline<Solver>::keep_best(const std::size_t iter) {
+  if (has_best_ && cost_ >= best_cost_) {
+    return;
+  }
+  for (std::size_t t = 0; t < xs_.size(); ++t) {
+    best_xs_[t] = xs_[t];
+  }
+  for (std::size_t t = 0; t < us_.size(); ++t) {
+    best_us_[t] = us_[t];
+  }
+  best_cost_ = cost_;
+  best_iter_ = iter;
+  has_best_ = true;
+}
+
+template <class Solver>
+void SolverDeadline<Solver>::restore_best() {
+  if (!has_best_ || best_cost_ >= cost_) {
+    return;
+  }
+  this->setCandidate(best_xs_, best_us_, true);
+  cost_ = best_cost_;
+}
+
+template <class Solver>
+const double& SolverDeadline<Solver>::get_budget() const {
+  return budget_;
+}
+
+template <class Solver>
+void SolverDeadline<Solver>::set_budget(const double& budget) {
+  if (budget <= 0.) {
+    throw_pretty("Invalid argument: "
+                 << "the budget should be positive");
+  }
+  budget_ = budget;
+}
+
+template <class Solver>
+const double& SolverDeadline<Solver>::get_margin() const {
+  return margin_;
+}
+
+template <class Solver>
+void SolverDeadline<Solver>::set_margin(const double& margin) {
+  if (margin < 1.) {
+    throw_pretty("Invalid argument: "
+                 << "the margin should be greater or equal to 1");
+  }
+  margin_ = margin;
+}
+
+template <class Solver>
+const double& SolverDeadline<Solver>::get_decay() const {
+  return decay_;
+}
+
+template <class Solver>
+void SolverDeadline<Solver>::set_decay(const double& decay) {
+  if (decay < 0. || decay > 1.) {
+    throw_pretty("Invalid argument: "
+                 << "the decay should be in [0, 1]");
+  }
+  decay_ = decay;
+}
+
+template <class Solver>
+double SolverDeadline<Solver>::get_iteration_time() const {
+  return std::chrono::duration<double, std::milli>(iteration_time_).count();
+}
+
+template <class Solver>
+double SolverDeadline<Solver>::get_elapsed() const {
+  return std::chrono::duration<double, std::milli>(elapsed_).count();
+}
+
+template <class Solver>
+bool SolverDeadline<Solver>::get_deadline_reached() const {
+  return deadline_reached_;
+}
+
+template <class Solver>
+std::size_t SolverDeadline<Solver>::get_best_iter() const {
+  return best_iter_;
+}
+
+template <class Solver>
+void SolverDeadline<Solver>::reset_iteration_time() {
+  iteration_time_ = Clock::duration::zero();
+}
+
+}  // namespace quadruped_walkgen
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __quadruped_walkgen_solver_quadruped_ddp_hpp__
+#define __quadruped_walkgen_solver_quadruped_ddp_hpp__
+
+#include "crocoddyl/core/solvers/ddp.hpp"
+#include "quadruped-walkgen/quadruped.hpp"
+
+namespace quadruped_walkgen {
+
+// DDP solver specialised for problems built with ActionModelQuadruped.
+// Only the backward pass differs from crocoddyl::SolverDDP : it uses 12x12
+// fixed-size matrices and the structure of the linear model,
+//   Fx = [[I, dt*I], [0, I]],
+//   Fu without the columns of the feet in swing phase,
+//   Lxu = 0.
+// The gains, the value function and the Q-function derivatives are written
+// in the members of SolverDDP, so get_K, get_k, get_Vxx ... are unchanged.
+//
+// The dynamics of the model are linear and its cost is quadratic for a given
+// active set of the friction pyramids and shoulder constraints, so the
+// gains of a backward pass stay exact as long as the models and the active
+// sets are unchanged. solve_x0 uses it between two updates of the models,
+// when only the measured state changed.
+class SolverQuadrupedDDP : public crocoddyl::SolverDDP {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<double, 12, 12> Matrix12;
+  typedef Eigen::Matrix<double, 12, 12, Eigen::RowMajor> Matrix12RowMajor;
+  typedef Eigen::Matrix<double, 12, 1> Vector12;
+  typedef Eigen::Matrix<double, 3, 12> Matrix3x12;
+
+  explicit SolverQuadrupedDDP(
+      boost::shared_ptr<crocoddyl::ShootingProblem> problem);
+  virtual ~SolverQuadrupedDDP();
+
+  virtual void backwardPass();
+
+  // Solve after a change of the initial state only. If the models are the
+  // ones of the last backward pass (same nodes, same versions) and the last
+  // step was a full one, the controls are rolled out from x0 with the gains
+  // of this backward pass, u = us - K (x - xs), without calcDiff nor
+  // backward pass. If an active set flips along the rollout, or the models
+  // changed, solve is called with maxiter, warm started from the last
+  // solution. Returns true if the backward pass was reused. In this case
+  // stop, d, dV and dVexp are set to NaN, they would need a calcDiff and a
+  // backward pass at the new trajectory.
+  bool solve_x0(const Eigen::Ref<const Eigen::VectorXd>& x0,
+                const std::size_t maxiter = 1);
+
+ protected:
+  // Running model of node t, throws if it is not an ActionModelQuadruped
+  const ActionModelQuadruped& get_quadruped_model(const std::size_t t) const;
+
+  // Models and active sets of a node at the last backward pass
+  struct ActiveSet {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    const ActionModelQuadruped* model;  // NULL if not an ActionModelQuadruped
+    std::size_t version;
+    FrictionPyramidTpl<double>::MatrixFaces friction;
+    Eigen::Matrix<double, 4, 1> shoulder;
+  };
+  typedef std::vector<ActiveSet, Eigen::aligned_allocator<ActiveSet> >
+      StdVecActiveSet;
+
+  // Store the active set of the data d of the model m (NULL if it is not an
+  // ActionModelQuadruped)
+  void store_active_set(const ActionModelQuadruped* m,
+                        const crocoddyl::ActionDataAbstract* d,
+                        ActiveSet& active_set) const;
+
+  // True if the model m is the one of active_set, with the same version,
+  // and if the last calc of d gave the same active set
+  bool same_active_set(const ActionModelQuadruped* m,
+                       const crocoddyl::ActionDataAbstract* d,
+                       const ActiveSet& active_set) const;
+
+  Matrix12 FxTVxx_;                  // Fx^T * Vxx'
+  Matrix3x12 FuTVxx_[4];             // Fu_i^T * Vxx' for each foot
+  Eigen::LLT<Matrix12> Quu_llt_12_;  // Cholesky decomposition of Quu
+
+  StdVecActiveSet active_sets_;  // Running nodes, then the terminal node
+  bool has_active_sets_;         // False until the first backward pass
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
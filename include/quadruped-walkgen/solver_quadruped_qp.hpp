@@ -0,0 +1,154 @@
+#ifndef __quadruped_walkgen_solver_quadruped_qp_hpp__
+#define __quadruped_walkgen_solver_quadruped_qp_hpp__
+
+#include <vector>
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+#include "quadruped-walkgen/quadruped.hpp"
+
+namespace quadruped_walkgen {
+
+// Condensed QP solver for problems built with ActionModelQuadruped.
+// The states are eliminated with the linear dynamics xnext = A x + B u + g
+// of each model, the remaining QP over the forces of the whole horizon is
+//   min 0.5 U^T H U + q^T U
+//   s.t. |fx| <= mu fz, |fy| <= mu fz, min_fz <= fz <= max_fz  (contact)
+//        f = 0                                                (swing)
+// and is solved with ADMM, warm-started from the previous solve.
+// The dynamics, the Hessian and the Cholesky factorisation of the ADMM
+// system are kept between two solves, and rebuilt only when a model (or its
+// version : update_model, setters of the weights, mu, gait ...), rho or
+// sigma changed. The gradient depends on x0 and is rebuilt at every solve.
+// The friction cone is a hard constraint, so the friction weight of the
+// models is not used, nor is the shoulder height cost.
+class SolverQuadrupedQP {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<double, 12, 12> Matrix12;
+  typedef Eigen::Matrix<double, 12, 1> Vector12;
+  typedef Eigen::Matrix<double, 5, 3> Matrix53;
+  typedef std::vector<Matrix12, Eigen::aligned_allocator<Matrix12> >
+      StdVecMatrix12;
+  typedef std::vector<Vector12, Eigen::aligned_allocator<Vector12> >
+      StdVecVector12;
+
+  explicit SolverQuadrupedQP(
+      boost::shared_ptr<crocoddyl::ShootingProblem> problem);
+  ~SolverQuadrupedQP();
+
+  // Build the condensed QP from the current models and solve it, returns
+  // true if the ADMM residuals reached the tolerances within maxiter
+  bool solve(const std::size_t maxiter = 200);
+
+  // Build the condensed gradient from the models, and the condensed Hessian
+  // if a model changed since the last call
+  void condense();
+
+  // Run ADMM on the last condensed QP
+  bool solveQP(const std::size_t maxiter);
+
+  const std::vector<Eigen::VectorXd>& get_xs() const;
+  const std::vector<Eigen::VectorXd>& get_us() const;
+  const boost::shared_ptr<crocoddyl::ShootingProblem>& get_problem() const;
+  const Eigen::MatrixXd& get_H() const;
+  const Eigen::VectorXd& get_q() const;
+  std::size_t get_iter() const;
+  double get_primal_residual() const;
+  double get_dual_residual() const;
+
+  const double& get_rho() const;
+  void set_rho(const double& rho);
+  const double& get_sigma() const;
+  void set_sigma(const double& sigma);
+  const double& get_alpha() const;
+  void set_alpha(const double& alpha);
+  const double& get_eps_abs() const;
+  void set_eps_abs(const double& eps);
+  const double& get_eps_rel() const;
+  void set_eps_rel(const double& eps);
+
+  // Forget the previous solution, the next solve starts from zero forces
+  void reset();
+
+  // Shift the warm start by one node, after the models of the problem were
+  // shifted by one node (as done by RecedingHorizonQuadruped::shift). The
+  // forces and dual variables of the last node are duplicated.
+  void shift();
+
+ protected:
+  // Running model of node t, throws if it is not an ActionModelQuadruped
+  const ActionModelQuadruped& get_quadruped_model(const std::size_t t) const;
+
+  // Constraint matrix of a foot : rows [fx - mu fz, fx + mu fz, fy - mu fz,
+  // fy + mu fz, fz]
+  Matrix53 friction_cone(const double mu) const;
+
+  // C * U and C^T * Y with C block diagonal (one Matrix53 per foot)
+  void multiplyC(const Eigen::VectorXd& U, Eigen::VectorXd& CU) const;
+  void multiplyCt(const Eigen::VectorXd& Y, Eigen::VectorXd& CtY) const;
+
+  // Dynamics, bounds and Hessian of the models
+  void condenseHessian();
+
+  // Penalties of the constraints and Cholesky factorisation of the ADMM
+  // system
+  void factorise();
+
+  // Store the models and versions of the nodes, returns true if one of them
+  // changed since the last call
+  bool update_versions();
+
+  boost::shared_ptr<crocoddyl::ShootingProblem> problem_;
+  std::size_t T_;  // Number of running nodes
+  std::size_t n_;  // Number of variables (12 * T)
+  std::size_t m_;  // Number of constraints (20 * T)
+
+  // Dynamics of each node, with the implicit integration folded in B and g
+  StdVecMatrix12 A_;
+  StdVecMatrix12 B_;
+  StdVecVector12 g_;
+  StdVecMatrix12 G_;  // Effect of one force on the following states
+
+  // Condensed QP
+  Eigen::MatrixXd H_;
+  Eigen::VectorXd q_;
+  Eigen::VectorXd lb_;
+  Eigen::VectorXd ub_;
+  Eigen::VectorXd rho_vec_;  // Penalty of each constraint (larger if lb = ub)
+  std::vector<double> mu_;
+  StdVecVector12 xfree_;   // States with zero forces
+  StdVecVector12 lambda_;  // Adjoint used for the gradient
+  // Models and versions of the running nodes then of the terminal node, as
+  // used by the last condensed Hessian
+  std::vector<const ActionModelQuadruped*> models_;
+  std::vector<std::size_t> versions_;
+
+  // ADMM
+  Eigen::MatrixXd K_;
+  Eigen::LLT<Eigen::MatrixXd> K_llt_;
+  bool factorised_;  // False if H, rho or sigma changed since K_llt_
+  Eigen::VectorXd U_;
+  Eigen::VectorXd U_tilde_;
+  Eigen::VectorXd W_;
+  Eigen::VectorXd W_tilde_;
+  Eigen::VectorXd Y_;
+  Eigen::VectorXd rhs_;
+  Eigen::VectorXd CU_;
+  Eigen::VectorXd CtY_;
+  double rho_;
+  double sigma_;
+  double alpha_;
+  double eps_abs_;
+  double eps_rel_;
+  std::size_t iter_;
+  double r_prim_;
+  double r_dual_;
+
+  std::vector<Eigen::VectorXd> xs_;
+  std::vector<Eigen::VectorXd> us_;
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
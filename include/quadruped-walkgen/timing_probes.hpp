@@ -0,0 +1,330 @@
+#ifndef __quadruped_walkgen_timing_probes_hpp__
+#define __quadruped_walkgen_timing_probes_hpp__
+
+#include <atomic>
+#include <boost/core/demangle.hpp>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "crocoddyl/core/optctrl/shooting.hpp"
+
+namespace quadruped_walkgen {
+
+// Phases of the control cycle timed by the probes. UpdateModel is keyed by
+// the model of the node, the other phases by its data.
+struct TimingPhase {
+  enum Index { UpdateModel = 0, Calc, CalcDiff, BackwardPass, Size };
+};
+
+// Histogram of latencies in nanoseconds, with the log-linear buckets of the
+// HDR histograms : the values below 8 ns have their own bucket, then each
+// power of two is split in 8 buckets, so the relative error of the
+// percentiles is below 12.5 %. The values above 2^36 ns (68 s) are counted
+// in the last bucket. record does not allocate.
+class AtomicLatencyHistogram;
+
+class LatencyHistogram {
+ public:
+  enum { SubBits = 3, SubBuckets = 1 << SubBits, MaxBits = 36 };
+  enum { Size = (MaxBits - SubBits + 2) * SubBuckets };
+
+  LatencyHistogram() { reset(); }
+
+  void record(const std::uint64_t ns) {
+    ++counts_[bucket(ns)];
+    ++count_;
+    sum_ += ns;
+    if (ns > max_) {
+      max_ = ns;
+    }
+  }
+
+  void merge(const LatencyHistogram& other) {
+    for (int b = 0; b < Size; ++b) {
+      counts_[b] += other.counts_[b];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    if (other.max_ > max_) {
+      max_ = other.max_;
+    }
+  }
+
+  void reset() {
+    for (int b = 0; b < Size; ++b) {
+      counts_[b] = 0;
+    }
+    count_ = 0;
+    sum_ = 0;
+    max_ = 0;
+  }
+
+  std::uint64_t get_count() const { return count_; }
+  std::uint64_t get_max() const { return max_; }
+  double get_mean() const {
+    return count_ == 0
+               ? 0.
+               : static_cast<double>(sum_) / static_cast<double>(count_);
+  }
+
+  // Upper bound of the bucket holding the p-th percentile, 0 < p <= 100
+  std::uint64_t get_percentile(const double p) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(
+        p / 100. * static_cast<double>(count_) + 0.5);
+    if (rank < 1) {
+      rank = 1;
+    }
+    std::uint64_t n = 0;
+    for (int b = 0; b < Size; ++b) {
+      n += counts_[b];
+      if (n >= rank) {
+        const std::uint64_t upper = upper_bound(b);
+        return upper < max_ ? upper : max_;
+      }
+    }
+    return max_;
+  }
+
+  static int bucket(const std::uint64_t ns) {
+    if (ns < SubBuckets) {
+      return static_cast<int>(ns);
+    }
+    int m = 63 - __builtin_clzll(ns);  // ns in [2^m, 2^(m+1))
+    if (m > MaxBits) {
+      return Size - 1;
+    }
+    const int sub = static_cast<int>(ns >> (m - SubBits)) & (SubBuckets - 1);
+    return (m - SubBits + 1) * SubBuckets + sub;
+  }
+
+  static std::uint64_t upper_bound(const int b) {
+    if (b < SubBuckets) {
+      return static_cast<std::uint64_t>(b);
+    }
+    const int shift = b / SubBuckets - 1;
+    const std::uint64_t lower =
+        static_cast<std::uint64_t>(SubBuckets + b % SubBuckets) << shift;
+    return lower + (std::uint64_t(1) << shift) - 1;
+  }
+
+ private:
+  friend class AtomicLatencyHistogram;
+
+  std::uint64_t counts_[Size];
+  std::uint64_t count_;
+  std::uint64_t sum_;
+  std::uint64_t max_;
+};
+
+// Runtime switch of the probes, shared by all the models and disabled by
+// default. The probes are only compiled with QUADRUPED_WALKGEN_WITH_TIMING_
+// PROBES (cmake option BUILD_WITH_TIMING_PROBES), otherwise they are empty
+// and the switch has no effect.
+inline std::atomic<bool>& timings_switch() {
+  static std::atomic<bool> enabled(false);
+  return enabled;
+}
+
+inline bool get_record_timings() {
+  return timings_switch().load(std::memory_order_relaxed);
+}
+
+inline void set_record_timings(const bool enabled) {
+  timings_switch().store(enabled, std::memory_order_relaxed);
+}
+
+// The records are kept by node position and model type. The position of the
+// model and data objects is given by register_timings, which has to be
+// called after building a problem and after moving its nodes
+// (RecedingHorizonQuadruped calls it at every shift, SolverQuadrupedDDP,
+// HorizonQuadrupedBatch and GaitProblemBuilder when they are built). The
+// objects are keyed by address, so a problem has to be unregistered with
+// unregister_timings before its nodes are destroyed or replaced, otherwise a
+// new object allocated at the same address would be recorded at the old
+// position. The classes above unregister their problem when they are
+// destroyed, the next register_timings attributes the nodes again if the
+// problem is still used. A record then reads the position of its object in a table of atomics and
+// increments atomic counters: it neither locks nor allocates, and the
+// histograms can be read from another thread while the probes record.
+
+// Give the position node of the model and data objects of a node, its
+// histograms are keyed by the type of the model. Allocates the histograms
+// of a new (type, node) pair and the entries of new objects, the objects
+// already known are only moved.
+void register_timing_node(const void* model, const void* data,
+                          const std::type_info& type, const std::size_t node);
+
+template <typename Scalar>
+void register_timings(const crocoddyl::ShootingProblemTpl<Scalar>& problem) {
+#ifdef QUADRUPED_WALKGEN_WITH_TIMING_PROBES
+  const std::size_t T = problem.get_T();
+  for (std::size_t t = 0; t < T; ++t) {
+    const crocoddyl::ActionModelAbstractTpl<Scalar>& model =
+        *problem.get_runningModels()[t];
+    register_timing_node(&model, problem.get_runningDatas()[t].get(),
+                         typeid(model), t);
+  }
+  const crocoddyl::ActionModelAbstractTpl<Scalar>& model =
+      *problem.get_terminalModel();
+  register_timing_node(&model, problem.get_terminalData().get(),
+                       typeid(model), T);
+#else
+  (void)problem;
+#endif
+}
+
+// Forget the model and data objects of a node, their records are then
+// dropped until they are registered again
+void unregister_timing_node(const void* model, const void* data);
+
+template <typename Scalar>
+void unregister_timings(
+    const crocoddyl::ShootingProblemTpl<Scalar>& problem) {
+#ifdef QUADRUPED_WALKGEN_WITH_TIMING_PROBES
+  const std::size_t T = problem.get_T();
+  for (std::size_t t = 0; t < T; ++t) {
+    unregister_timing_node(problem.get_runningModels()[t].get(),
+                           problem.get_runningDatas()[t].get());
+  }
+  unregister_timing_node(problem.get_terminalModel().get(),
+                         problem.get_terminalData().get());
+#else
+  (void)problem;
+#endif
+}
+
+// Record ns in the histogram of the node holding the object (model for
+// UpdateModel, data for the other phases). The records of objects that were
+// never registered are only counted by get_dropped_timings.
+void record_timing(const void* object, const TimingPhase::Index phase,
+                   const std::uint64_t ns);
+
+// Histogram of a phase of the node at position node with a model of type
+// type, empty if nothing was recorded
+LatencyHistogram get_timing(const std::type_info& type, const std::size_t node,
+                            const TimingPhase::Index phase);
+
+// Number of records of objects that were not registered, or that did not fit
+// in the table of objects (16384 objects, a warning is printed when it is
+// full)
+std::uint64_t get_dropped_timings();
+
+// Empty the histograms. The positions of the objects are kept.
+void reset_timings();
+
+// Scoped probe, records the time spent between its construction and its
+// destruction when the switch is enabled
+class TimingProbe {
+ public:
+  TimingProbe(const void* object, const TimingPhase::Index phase)
+      : object_(get_record_timings() ? object : NULL), phase_(phase) {
+    if (object_ != NULL) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+  ~TimingProbe() {
+    if (object_ != NULL) {
+      record_timing(object_, phase_,
+                    static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start_)
+                            .count()));
+    }
+  }
+
+ private:
+  TimingProbe(const TimingProbe&);
+  TimingProbe& operator=(const TimingProbe&);
+
+  const void* object_;
+  TimingPhase::Index phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#ifdef QUADRUPED_WALKGEN_WITH_TIMING_PROBES
+#define QUADRUPED_WALKGEN_TIMING_PROBE(object, phase)          \
+  ::quadruped_walkgen::TimingProbe quadruped_walkgen_timing_probe_( \
+      object, ::quadruped_walkgen::TimingPhase::phase)
+#else
+#define QUADRUPED_WALKGEN_TIMING_PROBE(object, phase)
+#endif
+
+// Latencies of a phase of a node of a problem
+struct NodeTiming {
+  std::string model;  // type of the model of the node
+  std::size_t node;   // index of the node, T for the terminal node
+  TimingPhase::Index phase;
+  LatencyHistogram histogram;
+};
+
+inline const char* timing_phase_name(const TimingPhase::Index phase) {
+  switch (phase) {
+    case TimingPhase::UpdateModel:
+      return "update_model";
+    case TimingPhase::Calc:
+      return "calc";
+    case TimingPhase::CalcDiff:
+      return "calcDiff";
+    case TimingPhase::BackwardPass:
+      return "backwardPass";
+    default:
+      return "unknown";
+  }
+}
+
+// Latencies recorded at the positions of the nodes of a problem, by node
+// then phase, for the type of the model each node currently holds. The phases
+// without record are skipped.
+template <typename Scalar>
+std::vector<NodeTiming> get_timings(
+    const crocoddyl::ShootingProblemTpl<Scalar>& problem) {
+  typedef crocoddyl::ActionModelAbstractTpl<Scalar> ActionModelAbstract;
+  const std::size_t T = problem.get_T();
+
+  std::vector<NodeTiming> timings;
+  for (std::size_t t = 0; t <= T; ++t) {
+    const ActionModelAbstract* model =
+        t < T ? problem.get_runningModels()[t].get()
+              : problem.get_terminalModel().get();
+    for (int i = 0; i < TimingPhase::Size; ++i) {
+      const TimingPhase::Index phase = static_cast<TimingPhase::Index>(i);
+      NodeTiming timing;
+      timing.histogram = get_timing(typeid(*model), t, phase);
+      if (timing.histogram.get_count() == 0) {
+        continue;
+      }
+      timing.model = boost::core::demangle(typeid(*model).name());
+      timing.node = t;
+      timing.phase = phase;
+      timings.push_back(timing);
+    }
+  }
+  return timings;
+}
+
+// Table of the latencies of the nodes of a problem, in microseconds
+template <typename Scalar>
+void dump_timings(const crocoddyl::ShootingProblemTpl<Scalar>& problem,
+                  std::ostream& os) {
+  const std::vector<NodeTiming> timings = get_timings(problem);
+  os << "node phase count mean p50 p90 p99 max [us] model" << std::endl;
+  for (std::size_t i = 0; i < timings.size(); ++i) {
+    const LatencyHistogram& h = timings[i].histogram;
+    os << timings[i].node << " " << timing_phase_name(timings[i].phase)
+       << " " << h.get_count() << " " << 1e-3 * h.get_mean() << " "
+       << 1e-3 * h.get_percentile(50.) << " " << 1e-3 * h.get_percentile(90.)
+       << " " << 1e-3 * h.get_percentile(99.) << " " << 1e-3 * h.get_max()
+       << " " << timings[i].model << std::endl;
+  }
+}
+
+}  // namespace quadruped_walkgen
+
+#endif
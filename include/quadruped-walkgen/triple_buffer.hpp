@@ -0,0 +1,58 @@
+#ifndef __quadruped_walkgen_triple_buffer_hpp__
+#define __quadruped_walkgen_triple_buffer_hpp__
+
+#include <atomic>
+
+namespace quadruped_walkgen {
+
+// Latest value shared by one writer thread and one reader thread, without
+// lock : the writer fills its back buffer and publishes it, the reader takes
+// the last published buffer. Both sides are wait-free, the writer never
+// waits for the reader and the reader always gets a complete value.
+// The three buffers are copies of the initial value, so a value of the same
+// size can be copied into them without allocation.
+template <typename T>
+class TripleBuffer {
+ public:
+  explicit TripleBuffer(const T& value) : back_(0), middle_(1), front_(2) {
+    buffers_[0] = value;
+    buffers_[1] = value;
+    buffers_[2] = value;
+  }
+
+  // Writer : buffer to fill, then publish it
+  T& get_back() { return buffers_[back_]; }
+  void publish() {
+    back_ = middle_.exchange(back_ | Fresh, std::memory_order_acq_rel) & Index;
+  }
+
+  // Reader : take the last published buffer if there is a new one, returns
+  // true if get_front changed
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & Fresh) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & Index;
+    return true;
+  }
+  const T& get_front() const { return buffers_[front_]; }
+
+ private:
+  TripleBuffer(const TripleBuffer&);
+  TripleBuffer& operator=(const TripleBuffer&);
+
+  // The middle buffer is marked fresh when it was published and not read
+  enum { Index = 3, Fresh = 4 };
+#if ATOMIC_INT_LOCK_FREE != 2
+#error "TripleBuffer needs lock-free atomic integers"
+#endif
+
+  T buffers_[3];
+  unsigned int back_;                 // Owned by the writer
+  std::atomic<unsigned int> middle_;  // Index, and Fresh if published
+  unsigned int front_;                // Owned by the reader
+};
+
+}  // namespace quadruped_walkgen
+
+#endif
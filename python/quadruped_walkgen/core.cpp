@@ -21,6 +21,17 @@ void exposeCore() {
   exposeActionQuadrupedStepTime();
   exposeActionQuadrupedTime();
   exposeActionQuadrupedStepPeriod();
+  exposeSolverQuadrupedDDP();
+  exposeSolverQuadrupedQP();
+  exposeSolverDeadline();
+  exposeRecedingHorizonQuadruped();
+  exposeMpcPipelineQuadruped();
+  exposeGainInterpolator();
+  exposeGaitProblemBuilder();
+  exposeHorizonQuadrupedBatch();
+  exposeCostTerms();
+  exposeTimingProbes();
+  exposeFloat();
 }
 
 }  // namespace python
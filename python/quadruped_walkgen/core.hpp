@@ -25,6 +25,17 @@ void exposeActionQuadrupedAugmentedTime();
 void exposeActionQuadrupedStepTime();
 void exposeActionQuadrupedTime();
 void exposeActionQuadrupedStepPeriod();
+void exposeSolverQuadrupedDDP();
+void exposeSolverQuadrupedQP();
+void exposeSolverDeadline();
+void exposeRecedingHorizonQuadruped();
+void exposeMpcPipelineQuadruped();
+void exposeGainInterpolator();
+void exposeGaitProblemBuilder();
+void exposeHorizonQuadrupedBatch();
+void exposeCostTerms();
+void exposeTimingProbes();
+void exposeFloat();
 
 void exposeCore();
 
@@ -0,0 +1,46 @@
+#include <quadruped-walkgen/cost_terms.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+Eigen::MatrixXd getCostTerms(const crocoddyl::ShootingProblem& problem) {
+  return get_cost_terms(problem);
+}
+
+void exposeCostTerms() {
+  bp::enum_<CostTerm::Index>("CostTerm")
+      .value("State", CostTerm::State)
+      .value("Force", CostTerm::Force)
+      .value("Friction", CostTerm::Friction)
+      .value("Shoulder", CostTerm::Shoulder)
+      .value("Heuristic", CostTerm::Heuristic)
+      .value("Stop", CostTerm::Stop)
+      .value("Step", CostTerm::Step)
+      .value("Period", CostTerm::Period)
+      .value("Acceleration", CostTerm::Acceleration)
+      .value("Velocity", CostTerm::Velocity)
+      .value("Jerk", CostTerm::Jerk)
+      .value("Size", CostTerm::Size);
+
+  bp::def("setLogCostTerms", &set_log_cost_terms, bp::args("enabled"),
+          "Enable or disable the recording of the cost terms by calc, for "
+          "all the models.\n\n"
+          ":param enabled: disabled by default");
+  bp::def("getLogCostTerms", &get_log_cost_terms,
+          "Return true if the cost terms are recorded by calc.");
+  bp::def("getCostTerms", &getCostTerms, bp::args("problem"),
+          "Return the cost terms recorded by the last calc of the nodes of a "
+          "problem.\n\n"
+          "Row k holds the terms of node k, the terminal node is the last "
+          "row, and column j\n"
+          "the term CostTerm(j). The terms of a node sum to its cost, the "
+          "rows of the nodes\n"
+          "that do not record their terms are 0.\n"
+          ":param problem: shooting problem\n"
+          ":return: (T+1) x CostTerm.Size array");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
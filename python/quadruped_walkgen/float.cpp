@@ -0,0 +1,111 @@
+#include "action-base.hpp"
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+typedef crocoddyl::ActionDataAbstractTpl<float> ActionDataAbstractFloat;
+
+// Single precision model, standalone class : the crocoddyl base classes and
+// solvers are only exposed in double precision
+template <typename Model>
+void exposeActionModelFloat(const char* name) {
+  bp::class_<Model, boost::noncopyable>(
+      name,
+      "Single precision variant of the quadruped action model of the same "
+      "name.\n\n"
+      "It can be evaluated on its own, with float32 arrays, to check the "
+      "accuracy\n"
+      "of the float instantiation. It cannot be used in a ShootingProblem.",
+      bp::init<>(bp::args("self"), "Initialize the quadruped action model."))
+      .def("calc", &Model::calc, bp::args("self", "data", "x", "u"),
+           "Compute the next state and cost value.\n\n"
+           ":param data: action data\n"
+           ":param x: time-discrete state vector (float32)\n"
+           ":param u: time-discrete control input (float32)")
+      .def("calcDiff", &Model::calcDiff, bp::args("self", "data", "x", "u"),
+           "Compute the derivatives of the dynamics and cost functions.\n\n"
+           "It assumes that calc has been run first.\n"
+           ":param data: action data\n"
+           ":param x: time-discrete state vector (float32)\n"
+           ":param u: time-discrete control input (float32)")
+      .def("createData", &Model::createData, bp::args("self"),
+           "Create the action data.")
+      .def("updateModel", &Model::update_model,
+           "Update the model, same arguments as the double precision model "
+           "(float32).")
+      .add_property("nu", bp::make_function(
+                              &Model::get_nu,
+                              bp::return_value_policy<bp::return_by_value>()),
+                    "dimension of control vector");
+}
+
+void exposeFloat() {
+  bp::register_ptr_to_python<boost::shared_ptr<ActionDataAbstractFloat> >();
+
+  bp::class_<ActionDataAbstractFloat, boost::noncopyable>(
+      "ActionDataAbstractFloat",
+      "Single precision action data, created by the float models.",
+      bp::no_init)
+      .add_property(
+          "cost",
+          bp::make_getter(&ActionDataAbstractFloat::cost,
+                          bp::return_value_policy<bp::return_by_value>()),
+          "cost value")
+      .add_property("xnext",
+                    bp::make_getter(&ActionDataAbstractFloat::xnext,
+                                    bp::return_internal_reference<>()),
+                    "next state")
+      .add_property("r",
+                    bp::make_getter(&ActionDataAbstractFloat::r,
+                                    bp::return_internal_reference<>()),
+                    "cost residual")
+      .add_property("Fx",
+                    bp::make_getter(&ActionDataAbstractFloat::Fx,
+                                    bp::return_internal_reference<>()),
+                    "Jacobian of the dynamics")
+      .add_property("Fu",
+                    bp::make_getter(&ActionDataAbstractFloat::Fu,
+                                    bp::return_internal_reference<>()),
+                    "Jacobian of the dynamics")
+      .add_property("Lx",
+                    bp::make_getter(&ActionDataAbstractFloat::Lx,
+                                    bp::return_internal_reference<>()),
+                    "Jacobian of the cost")
+      .add_property("Lu",
+                    bp::make_getter(&ActionDataAbstractFloat::Lu,
+                                    bp::return_internal_reference<>()),
+                    "Jacobian of the cost")
+      .add_property("Lxx",
+                    bp::make_getter(&ActionDataAbstractFloat::Lxx,
+                                    bp::return_internal_reference<>()),
+                    "Hessian of the cost")
+      .add_property("Lxu",
+                    bp::make_getter(&ActionDataAbstractFloat::Lxu,
+                                    bp::return_internal_reference<>()),
+                    "Hessian of the cost")
+      .add_property("Luu",
+                    bp::make_getter(&ActionDataAbstractFloat::Luu,
+                                    bp::return_internal_reference<>()),
+                    "Hessian of the cost");
+
+  exposeActionModelFloat<ActionModelQuadrupedFloat>(
+      "ActionModelQuadrupedFloat");
+  exposeActionModelFloat<ActionModelQuadrupedNonLinearFloat>(
+      "ActionModelQuadrupedNonLinearFloat");
+  exposeActionModelFloat<ActionModelQuadrupedAugmentedFloat>(
+      "ActionModelQuadrupedAugmentedFloat");
+  exposeActionModelFloat<ActionModelQuadrupedAugmentedTimeFloat>(
+      "ActionModelQuadrupedAugmentedTimeFloat");
+  exposeActionModelFloat<ActionModelQuadrupedStepFloat>(
+      "ActionModelQuadrupedStepFloat");
+  exposeActionModelFloat<ActionModelQuadrupedStepPeriodFloat>(
+      "ActionModelQuadrupedStepPeriodFloat");
+  exposeActionModelFloat<ActionModelQuadrupedStepTimeFloat>(
+      "ActionModelQuadrupedStepTimeFloat");
+  exposeActionModelFloat<ActionModelQuadrupedTimeFloat>(
+      "ActionModelQuadrupedTimeFloat");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -0,0 +1,79 @@
+#include <quadruped-walkgen/gain_interpolator.hpp>
+
+#include "core.hpp"
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+namespace {
+
+GainInterpolator::Vector12 compute(GainInterpolator& interpolator,
+                                   const Eigen::VectorXd& x, const double t) {
+  if (x.size() != 12) {
+    throw_pretty("Invalid argument: "
+                 << "x has wrong dimension (it should be 12)");
+  }
+  return interpolator.compute(x, t);
+}
+
+}  // namespace
+
+void exposeGainInterpolator() {
+  void (GainInterpolator::*set_solution)(
+      const std::vector<Eigen::VectorXd>&, const std::vector<Eigen::VectorXd>&,
+      const std::vector<crocoddyl::SolverDDP::MatrixXdRowMajor>&) =
+      &GainInterpolator::set_solution;
+  void (GainInterpolator::*set_mpc_solution)(const MpcSolution&) =
+      &GainInterpolator::set_solution;
+
+  bp::class_<GainInterpolator, boost::noncopyable>(
+      "GainInterpolator",
+      "Feedback controller of the low-level loop between two solves of the "
+      "MPC.\n\n"
+      "At time t since the first node, u = us(t) - K(t) (x - xs(t)), with "
+      "the trajectories\n"
+      "interpolated linearly within the node of duration dt. The solution "
+      "is copied in\n"
+      "fixed-size storage, setSolution and compute do not allocate.",
+      bp::init<bp::optional<std::size_t, double> >(
+          bp::args("self", "N", "dt"),
+          "Initialize the storage of the solution.\n\n"
+          ":param N: number of nodes of the solution (default 16)\n"
+          ":param dt: duration of a node [s] (default 0.02)"))
+      .def("setSolution", set_solution, bp::args("self", "xs", "us", "K"),
+           "Copy a solution of the DDP.\n\n"
+           ":param xs: N+1 states, 12x1\n"
+           ":param us: N controls, 12x1\n"
+           ":param K: N feedback gains, 12x12")
+      .def("setSolution", set_mpc_solution, bp::args("self", "solution"),
+           "Copy a solution of MpcPipelineQuadruped.")
+      .def("compute", &compute, bp::args("self", "x", "t"),
+           "Control for the state x at time t since the first node.\n\n"
+           ":param x: measured state, 12x1\n"
+           ":param t: time since the first node [s]\n"
+           ":return: control, 12x1")
+      .add_property("xref",
+                    bp::make_function(
+                        &GainInterpolator::get_xref,
+                        bp::return_value_policy<bp::copy_const_reference>()),
+                    "interpolated reference state of the last compute")
+      .add_property(
+          "interpolate",
+          bp::make_function(&GainInterpolator::get_interpolate,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&GainInterpolator::set_interpolate),
+          "interpolate the controls and gains between the nodes, otherwise "
+          "they are held on the node")
+      .add_property("cycle", &GainInterpolator::get_cycle,
+                    "cycle of the last MpcSolution")
+      .add_property("N", &GainInterpolator::get_N, "number of nodes")
+      .add_property(
+          "dt",
+          bp::make_function(&GainInterpolator::get_dt,
+                            bp::return_value_policy<bp::return_by_value>()),
+          "duration of a node [s]");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -0,0 +1,60 @@
+#include <quadruped-walkgen/gait_problem_builder.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+void exposeGaitProblemBuilder() {
+  void (GaitProblemBuilder::*update_fsteps)(
+      const Eigen::Ref<const Eigen::MatrixXd>&,
+      const Eigen::Ref<const Eigen::MatrixXd>&) = &GaitProblemBuilder::update;
+  void (GaitProblemBuilder::*update_gait)(
+      const Eigen::Ref<const Eigen::MatrixXd>&,
+      const Eigen::Ref<const Eigen::MatrixXd>&,
+      const Eigen::Ref<const Eigen::MatrixXd>&) = &GaitProblemBuilder::update;
+
+  bp::class_<GaitProblemBuilder, boost::noncopyable>(
+      "GaitProblemBuilder",
+      "Update all the ActionModelQuadruped of a shooting problem from the "
+      "footsteps\n"
+      "of the gait, in one call.",
+      bp::init<boost::shared_ptr<crocoddyl::ShootingProblem> >(
+          bp::args("self", "problem"),
+          "Initialize the builder.\n\n"
+          ":param problem: shooting problem built with ActionModelQuadruped, "
+          "terminal model included"))
+      .def("update", update_fsteps, bp::args("self", "fsteps", "xref"),
+           "Decode the gait matrix from fsteps and update the models.\n\n"
+           ":param fsteps: nx13, [nb of nodes, x1, y1, z1, ... x4, y4, z4] "
+           "for each phase,\n"
+           "               NaN for the feet in swing phase\n"
+           ":param xref: 12x(N+1), the first column is the current state")
+      .def("update", update_gait, bp::args("self", "gait", "fsteps", "xref"),
+           "Update the models from a given gait matrix.\n\n"
+           ":param gait: nx5, [nb of nodes, S1, S2, S3, S4] for each phase\n"
+           ":param fsteps: nx13, [nb of nodes, x1, y1, z1, ... x4, y4, z4] "
+           "for each phase\n"
+           ":param xref: 12x(N+1), the first column is the current state")
+      .def("gaitFromFsteps", &GaitProblemBuilder::gait_from_fsteps,
+           bp::args("fsteps"),
+           "Gait matrix of the footsteps.\n\n"
+           "A foot is in contact if its x position is neither NaN nor 0.")
+      .staticmethod("gaitFromFsteps")
+      .add_property("problem",
+                    bp::make_function(
+                        &GaitProblemBuilder::get_problem,
+                        bp::return_value_policy<bp::return_by_value>()),
+                    "shooting problem")
+      .add_property("gait",
+                    bp::make_function(&GaitProblemBuilder::get_gait,
+                                      bp::return_internal_reference<>()),
+                    "last gait matrix")
+      .add_property("fsteps",
+                    bp::make_function(&GaitProblemBuilder::get_fsteps,
+                                      bp::return_internal_reference<>()),
+                    "last fsteps matrix, with NaN replaced by 0");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
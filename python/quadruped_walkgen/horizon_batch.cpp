@@ -0,0 +1,39 @@
+#include <quadruped-walkgen/horizon_batch.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+void exposeHorizonQuadrupedBatch() {
+  bp::class_<HorizonQuadrupedBatch, boost::noncopyable>(
+      "HorizonQuadrupedBatch",
+      "calc and calcDiff of a shooting problem built with "
+      "ActionModelQuadruped,\n"
+      "with the nodes of the horizon evaluated in one pass.",
+      bp::init<boost::shared_ptr<crocoddyl::ShootingProblem> >(
+          bp::args("self", "problem"),
+          "Initialize the batch.\n\n"
+          ":param problem: shooting problem whose running models are "
+          "ActionModelQuadruped"))
+      .def("calc", &HorizonQuadrupedBatch::calc, bp::args("self", "xs", "us"),
+           "Same as ShootingProblem.calc, the results are written in the "
+           "data of the problem.\n\n"
+           ":param xs: list of the N+1 states\n"
+           ":param us: list of the N controls\n"
+           ":return: total cost")
+      .def("calcDiff", &HorizonQuadrupedBatch::calcDiff,
+           bp::args("self", "xs", "us"),
+           "Same as ShootingProblem.calcDiff, calc has to be called first "
+           "with the same xs and us.\n\n"
+           ":param xs: list of the N+1 states\n"
+           ":param us: list of the N controls")
+      .add_property("problem",
+                    bp::make_function(
+                        &HorizonQuadrupedBatch::get_problem,
+                        bp::return_value_policy<bp::return_by_value>()),
+                    "shooting problem");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -0,0 +1,109 @@
+#include <quadruped-walkgen/mpc_pipeline.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+namespace {
+
+// The GIL is released while the planner thread waits for the worker, so
+// that a Python control thread can keep reading the solutions
+class ReleaseGIL {
+ public:
+  ReleaseGIL() : state_(PyEval_SaveThread()) {}
+  ~ReleaseGIL() { PyEval_RestoreThread(state_); }
+
+ private:
+  PyThreadState* state_;
+};
+
+void start(MpcPipelineQuadruped& pipeline, const Eigen::VectorXd& x0,
+           const std::size_t maxiter) {
+  ReleaseGIL release;
+  pipeline.start(x0, maxiter);
+}
+
+void wait(MpcPipelineQuadruped& pipeline) {
+  ReleaseGIL release;
+  pipeline.wait();
+}
+
+}  // namespace
+
+void exposeMpcPipelineQuadruped() {
+  bp::class_<MpcSolution>(
+      "MpcSolution",
+      "Solution of a cycle of the MPC, u(x) = us[k] - K[k] (x - xs[k]).",
+      bp::no_init)
+      .def_readonly("cycle", &MpcSolution::cycle,
+                    "cycle of the solve, 0 before the first solution")
+      .add_property("xs",
+                    bp::make_getter(&MpcSolution::xs,
+                                    bp::return_value_policy<
+                                        bp::return_by_value>()),
+                    "state trajectory")
+      .add_property("us",
+                    bp::make_getter(&MpcSolution::us,
+                                    bp::return_value_policy<
+                                        bp::return_by_value>()),
+                    "control trajectory")
+      .add_property("K",
+                    bp::make_getter(&MpcSolution::K,
+                                    bp::return_value_policy<
+                                        bp::return_by_value>()),
+                    "feedback gains")
+      .def_readonly("cost", &MpcSolution::cost, "cost of the solution")
+      .def_readonly("iter", &MpcSolution::iter, "iterations of the solver")
+      .def_readonly("converged", &MpcSolution::converged,
+                    "True if the solver converged");
+
+  bp::class_<MpcPipelineQuadruped, boost::noncopyable>(
+      "MpcPipelineQuadruped",
+      "Double-buffered MPC of the quadruped.\n\n"
+      "Two receding horizons are used in turn : while a worker thread "
+      "solves the horizon\n"
+      "of the current cycle, prepare updates the models of the other one "
+      "for the next\n"
+      "cycle. The solutions are published without lock and read with "
+      "read.",
+      bp::init<Eigen::VectorXd, bp::optional<std::size_t> >(
+          bp::args("self", "x0", "N"),
+          "Initialize the horizons and start the worker thread.\n\n"
+          ":param x0: initial state, 12x1\n"
+          ":param N: number of running nodes (default 16)"))
+      .def("prepare", &MpcPipelineQuadruped::prepare,
+           bp::args("self", "gait", "fsteps", "xref"),
+           "Update the idle horizon for the next cycle.\n\n"
+           ":param gait: nx5, [nb of nodes, S1, S2, S3, S4] for each phase\n"
+           ":param fsteps: nx13, [nb of nodes, x1, y1, z1, ... x4, y4, z4]\n"
+           ":param xref: 12x(N+1), the first column is ignored\n"
+           ":return: number of calls to updateModel, terminal node included")
+      .def("start", &start,
+           (bp::arg("self"), bp::arg("x0"), bp::arg("maxiter") = 1),
+           "Wait for the running solve, then solve the prepared horizon in "
+           "the worker.\n\n"
+           ":param x0: measured state, 12x1\n"
+           ":param maxiter: maximum number of iterations (default 1)")
+      .def("wait", &wait, bp::args("self"),
+           "Wait for the running solve, its errors are raised here.")
+      .def("read", &MpcPipelineQuadruped::read,
+           bp::return_value_policy<bp::copy_const_reference>(),
+           bp::args("self"), "Last published solution.")
+      .def("horizon", &MpcPipelineQuadruped::get_horizon,
+           bp::return_internal_reference<>(), bp::args("self", "i"),
+           "Horizon of buffer i (0 or 1), while the worker is idle.")
+      .def("solver", &MpcPipelineQuadruped::get_solver,
+           bp::return_internal_reference<>(), bp::args("self", "i"),
+           "Solver of buffer i (0 or 1), while the worker is idle.")
+      .add_property("busy", &MpcPipelineQuadruped::is_busy,
+                    "True while the worker is solving")
+      .add_property("budget", &MpcPipelineQuadruped::get_budget,
+                    bp::make_function(&MpcPipelineQuadruped::set_budget),
+                    "budget of each solve [ms]")
+      .add_property("N", &MpcPipelineQuadruped::get_N,
+                    "number of running nodes");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -1,11 +1,16 @@
 
 #include "action-base.hpp"
 #include "core.hpp"
+#include "vector-converter.hpp"
 
 namespace quadruped_walkgen {
 namespace python {
 
 void exposeActionQuadruped() {
+  // Python list of models for updateModels
+  list_to_vector()
+      .from_python<std::vector<boost::shared_ptr<ActionModelQuadruped> > >();
+
   bp::class_<ActionModelQuadruped, bp::bases<ActionModelAbstract>>(
       "ActionModelQuadruped",
       "Quadruped action model.\n\n"
@@ -64,6 +69,27 @@ void exposeActionQuadruped() {
            ":param S : 4x1, Vector representing the foot in contact with the "
            "ground."
            "                S = [1 0 0 1] --> Foot 1 and 4 in contact.")
+      .def("updateReference", &ActionModelQuadruped::update_reference,
+           bp::args("self", "xref"),
+           "Update the reference state only.\n\n"
+           "The footholds and the contact status are the ones of the last "
+           "updateModel,\n"
+           "only the part of B depending on the reference position and yaw "
+           "is rebuilt.\n"
+           ":param xref : 12x1, Vector representing the reference state.")
+      .def("updateModels", &ActionModelQuadruped::update_models,
+           bp::args("models", "l_feet", "xref", "S"),
+           "Update the models of a whole horizon in one call.\n\n"
+           "Node k is updated with the columns 4k to 4k+3 of the footholds "
+           "and the\n"
+           "column k of the references and contact status. The arrays are "
+           "not copied\n"
+           "if they are Fortran-ordered (np.asfortranarray) float64 arrays.\n"
+           ":param models : list of N ActionModelQuadruped\n"
+           ":param l_feet : 3x4N, position of the feet of each node\n"
+           ":param xref : 12xN, reference state of each node\n"
+           ":param S : 4xN, feet in contact with the ground for each node")
+      .staticmethod("updateModels")
       .add_property("forceWeights",
                     bp::make_function(&ActionModelQuadruped::get_force_weights,
                                       bp::return_internal_reference<>()),
@@ -131,9 +157,7 @@ void exposeActionQuadruped() {
           bp::make_function(&ActionModelQuadruped::set_gI),
           "Inertia matrix of the robot in body frame (found in urdf) \n "
           "Warning : The model needs to be updated")
-      .add_property("A",
-                    bp::make_function(&ActionModelQuadruped::get_A,
-                                      bp::return_internal_reference<>()),
+      .add_property("A", bp::make_function(&ActionModelQuadruped::get_A),
                     "get A matrix")
       .add_property(
           "relative_forces",
@@ -147,9 +171,7 @@ void exposeActionQuadruped() {
                             bp::return_value_policy<bp::return_by_value>()),
           bp::make_function(&ActionModelQuadruped::set_implicit_integration),
           "Bool : to set implicit integration : P+ = P + dt*V+")
-      .add_property("B",
-                    bp::make_function(&ActionModelQuadruped::get_B,
-                                      bp::return_internal_reference<>()),
+      .add_property("B", bp::make_function(&ActionModelQuadruped::get_B),
                     "get B matrix");
 
   bp::register_ptr_to_python<boost::shared_ptr<ActionDataQuadruped>>();
@@ -1,11 +1,16 @@
 
 #include "action-base.hpp"
 #include "core.hpp"
+#include "vector-converter.hpp"
 
 namespace quadruped_walkgen {
 namespace python {
 
 void exposeActionQuadrupedAugmented() {
+  // Python list of models for updateModels
+  list_to_vector().from_python<
+      std::vector<boost::shared_ptr<ActionModelQuadrupedAugmented> > >();
+
   bp::class_<ActionModelQuadrupedAugmented, bp::bases<ActionModelAbstract>>(
       "ActionModelQuadrupedAugmented",
       "Quadruped action model, non linear.\n\n"
@@ -66,6 +71,20 @@ void exposeActionQuadrupedAugmented() {
            ":param S : 4x1, Vector representing the foot in contact with the "
            "ground."
            "                S = [1 0 0 1] --> Foot 1 and 4 in contact.")
+      .def("updateModels", &ActionModelQuadrupedAugmented::update_models,
+           bp::args("models", "l_feet", "l_stop", "xref", "S"),
+           "Update the models of a whole horizon in one call.\n\n"
+           "Node k is updated with the columns 4k to 4k+3 of the footholds "
+           "and the\n"
+           "column k of the references and contact status. The arrays are "
+           "not copied\n"
+           "if they are Fortran-ordered (np.asfortranarray) float64 arrays.\n"
+           ":param models : list of N ActionModelQuadrupedAugmented\n"
+           ":param l_feet : 3x4N, position of the feet of each node\n"
+           ":param l_stop : 3x4N, same layout as l_feet\n"
+           ":param xref : 12xN, reference state of each node\n"
+           ":param S : 4xN, feet in contact with the ground for each node")
+      .staticmethod("updateModels")
       .add_property(
           "forceWeights",
           bp::make_function(&ActionModelQuadrupedAugmented::get_force_weights,
@@ -137,14 +156,12 @@ void exposeActionQuadrupedAugmented() {
           bp::make_function(&ActionModelQuadrupedAugmented::set_gI),
           "Inertia matrix of the robot in body frame (found in urdf) \n "
           "Warning : The model needs to be updated")
-      .add_property("A",
-                    bp::make_function(&ActionModelQuadrupedAugmented::get_A,
-                                      bp::return_internal_reference<>()),
-                    "get A matrix")
-      .add_property("B",
-                    bp::make_function(&ActionModelQuadrupedAugmented::get_B,
-                                      bp::return_internal_reference<>()),
-                    "get B matrix")
+      .add_property(
+          "A", bp::make_function(&ActionModelQuadrupedAugmented::get_A),
+          "get A matrix")
+      .add_property(
+          "B", bp::make_function(&ActionModelQuadrupedAugmented::get_B),
+          "get B matrix")
       .add_property(
           "shoulder_hlim",
           bp::make_function(&ActionModelQuadrupedAugmented::get_shoulder_hlim,
@@ -149,19 +149,12 @@ void exposeActionQuadrupedAugmentedTime() {
           bp::make_function(&ActionModelQuadrupedAugmentedTime::set_gI),
           "Inertia matrix of the robot in body frame (found in urdf) \n "
           "Warning : The model needs to be updated")
-      .add_property("A",
-                    bp::make_function(&ActionModelQuadrupedAugmentedTime::get_A,
-                                      bp::return_internal_reference<>()),
-                    "get A matrix")
-      .add_property("B",
-                    bp::make_function(&ActionModelQuadrupedAugmentedTime::get_B,
-                                      bp::return_internal_reference<>()),
-                    "get B matrix")
-      .add_property(
-          "Cost",
-          bp::make_function(&ActionModelQuadrupedAugmentedTime::get_cost,
-                            bp::return_internal_reference<>()),
-          "get log cost")
+      .add_property(
+          "A", bp::make_function(&ActionModelQuadrupedAugmentedTime::get_A),
+          "get A matrix")
+      .add_property(
+          "B", bp::make_function(&ActionModelQuadrupedAugmentedTime::get_B),
+          "get B matrix")
       .add_property("shoulder_hlim",
                     bp::make_function(
                         &ActionModelQuadrupedAugmentedTime::get_shoulder_hlim,
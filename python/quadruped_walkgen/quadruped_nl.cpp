@@ -1,11 +1,16 @@
 
 #include "action-base.hpp"
 #include "core.hpp"
+#include "vector-converter.hpp"
 
 namespace quadruped_walkgen {
 namespace python {
 
 void exposeActionQuadrupedNonLinear() {
+  // Python list of models for updateModels
+  list_to_vector().from_python<
+      std::vector<boost::shared_ptr<ActionModelQuadrupedNonLinear> > >();
+
   bp::class_<ActionModelQuadrupedNonLinear, bp::bases<ActionModelAbstract>>(
       "ActionModelQuadrupedNonLinear",
       "Quadruped action model, non linear.\n\n"
@@ -66,6 +71,19 @@ void exposeActionQuadrupedNonLinear() {
            ":param S : 4x1, Vector representing the foot in contact with the "
            "ground."
            "                S = [1 0 0 1] --> Foot 1 and 4 in contact.")
+      .def("updateModels", &ActionModelQuadrupedNonLinear::update_models,
+           bp::args("models", "l_feet", "xref", "S"),
+           "Update the models of a whole horizon in one call.\n\n"
+           "Node k is updated with the columns 4k to 4k+3 of the footholds "
+           "and the\n"
+           "column k of the references and contact status. The arrays are "
+           "not copied\n"
+           "if they are Fortran-ordered (np.asfortranarray) float64 arrays.\n"
+           ":param models : list of N ActionModelQuadrupedNonLinear\n"
+           ":param l_feet : 3x4N, position of the feet of each node\n"
+           ":param xref : 12xN, reference state of each node\n"
+           ":param S : 4xN, feet in contact with the ground for each node")
+      .staticmethod("updateModels")
       .add_property(
           "forceWeights",
           bp::make_function(&ActionModelQuadrupedNonLinear::get_force_weights,
@@ -144,14 +162,12 @@ void exposeActionQuadrupedNonLinear() {
           bp::make_function(
               &ActionModelQuadrupedNonLinear::set_relative_forces),
           "relative norm ")
-      .add_property("A",
-                    bp::make_function(&ActionModelQuadrupedNonLinear::get_A,
-                                      bp::return_internal_reference<>()),
-                    "get A matrix")
-      .add_property("B",
-                    bp::make_function(&ActionModelQuadrupedNonLinear::get_B,
-                                      bp::return_internal_reference<>()),
-                    "get B matrix");
+      .add_property(
+          "A", bp::make_function(&ActionModelQuadrupedNonLinear::get_A),
+          "get A matrix")
+      .add_property(
+          "B", bp::make_function(&ActionModelQuadrupedNonLinear::get_B),
+          "get B matrix");
 
   bp::register_ptr_to_python<boost::shared_ptr<ActionDataQuadrupedNonLinear>>();
 
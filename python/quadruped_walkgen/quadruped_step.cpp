@@ -157,7 +157,14 @@ void exposeActionQuadrupedStep() {
           bp::make_function(&ActionModelQuadrupedStep::get_jerk_activated,
                             bp::return_value_policy<bp::return_by_value>()),
           bp::make_function(&ActionModelQuadrupedStep::set_jerk_activated),
-          "Boolean whereas the cost on the jerk is activated");
+          "Boolean whereas the cost on the jerk is activated")
+      .add_property(
+          "extremum_cost",
+          bp::make_function(&ActionModelQuadrupedStep::get_extremum_cost,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&ActionModelQuadrupedStep::set_extremum_cost),
+          "Boolean whereas the acceleration and velocity costs are computed on "
+          "the extrema of the feet trajectories instead of sampled points");
 
   bp::register_ptr_to_python<boost::shared_ptr<ActionDataQuadrupedStep> >();
 
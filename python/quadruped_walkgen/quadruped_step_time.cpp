@@ -126,11 +126,7 @@ void exposeActionQuadrupedStepTime() {
                             bp::return_value_policy<bp::return_by_value>()),
           bp::make_function(&ActionModelQuadrupedStepTime::set_first_step),
           "bool thats indicates xhether it is the first step foot, otherwise "
-          "function cost is much simpler")
-      .add_property("Cost",
-                    bp::make_function(&ActionModelQuadrupedStepTime::get_cost,
-                                      bp::return_internal_reference<>()),
-                    "get log cost");
+          "function cost is much simpler");
 
   bp::register_ptr_to_python<boost::shared_ptr<ActionDataQuadrupedStepTime> >();
 
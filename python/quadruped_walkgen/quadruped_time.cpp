@@ -125,11 +125,7 @@ void exposeActionQuadrupedTime() {
           bp::make_function(&ActionModelQuadrupedTime::get_dt_bound_weight_cmd,
                             bp::return_value_policy<bp::return_by_value>()),
           bp::make_function(&ActionModelQuadrupedTime::set_dt_bound_weight_cmd),
-          "Penalisation weight for upper/lower bound of the integration time")
-      .add_property("Cost",
-                    bp::make_function(&ActionModelQuadrupedTime::get_cost,
-                                      bp::return_internal_reference<>()),
-                    "Access to the cost, Array ");
+          "Penalisation weight for upper/lower bound of the integration time");
 
   bp::register_ptr_to_python<boost::shared_ptr<ActionDataQuadrupedTime> >();
 
@@ -0,0 +1,80 @@
+#include <quadruped-walkgen/receding_horizon.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+void exposeRecedingHorizonQuadruped() {
+  bp::class_<RecedingHorizonQuadruped, boost::noncopyable>(
+      "RecedingHorizonQuadruped",
+      "Receding horizon of ActionModelQuadruped for the MPC.\n\n"
+      "The running models and the warm start are kept as a ring buffer. "
+      "At each control\n"
+      "cycle, shift() moves the first node to the end of the horizon, then "
+      "update() only\n"
+      "calls updateModel on the nodes whose footholds, reference state or "
+      "contact status\n"
+      "changed.",
+      bp::init<Eigen::VectorXd, bp::optional<std::size_t> >(
+          bp::args("self", "x0", "N"),
+          "Initialize the horizon and its shooting problem.\n\n"
+          ":param x0: initial state, 12x1\n"
+          ":param N: number of running nodes (default 16)"))
+      .def("shift", &RecedingHorizonQuadruped::shift, bp::args("self"),
+           "Move the first node to the end of the horizon and shift the warm "
+           "start by one node.")
+      .def("update", &RecedingHorizonQuadruped::update,
+           bp::args("self", "gait", "fsteps", "xref"),
+           "Update the models whose parameters changed.\n\n"
+           ":param gait: nx5, [nb of nodes, S1, S2, S3, S4] for each phase\n"
+           ":param fsteps: nx13, [nb of nodes, x1, y1, z1, ... x4, y4, z4]\n"
+           ":param xref: 12x(N+1), the first column is the current state\n"
+           ":return: number of calls to updateModel, terminal node included, "
+           "the nodes\n"
+           "whose reference only changed get updateReference and are not "
+           "counted")
+      .def("updateNode", &RecedingHorizonQuadruped::update_node,
+           bp::args("self", "k", "l_feet", "xref", "S"),
+           "Update node k (k = N for the terminal node) if its parameters "
+           "changed,\n"
+           "with updateReference if only xref changed.\n\n"
+           ":param l_feet: 3x4, position of the feet\n"
+           ":param xref: 12x1, reference state\n"
+           ":param S: 4x1, contact status of the feet\n"
+           ":return: True if updateModel was called")
+      .def("invalidate", &RecedingHorizonQuadruped::invalidate,
+           bp::args("self"),
+           "Force the update of all the nodes at the next call to update.\n"
+           "Needed when a parameter used by updateModel (mass, gI, dt ...) "
+           "is changed.")
+      .def("setWarmStart", &RecedingHorizonQuadruped::set_warm_start,
+           bp::args("self", "xs", "us"),
+           "Store the last solution as warm start for the next shift.")
+      .def("model", &RecedingHorizonQuadruped::get_model,
+           bp::return_value_policy<bp::return_by_value>(),
+           bp::args("self", "k"),
+           "Model of node k in the horizon (k = N for the terminal node).")
+      .def("setX0", &RecedingHorizonQuadruped::set_x0, bp::args("self", "x0"),
+           "Set the initial state of the problem and of the warm start.")
+      .add_property("problem",
+                    bp::make_function(
+                        &RecedingHorizonQuadruped::get_problem,
+                        bp::return_value_policy<bp::return_by_value>()),
+                    "shooting problem, with the models in horizon order")
+      .add_property("xs",
+                    bp::make_function(
+                        &RecedingHorizonQuadruped::get_xs,
+                        bp::return_value_policy<bp::copy_const_reference>()),
+                    "warm start of the states")
+      .add_property("us",
+                    bp::make_function(
+                        &RecedingHorizonQuadruped::get_us,
+                        bp::return_value_policy<bp::copy_const_reference>()),
+                    "warm start of the controls")
+      .add_property("N", &RecedingHorizonQuadruped::get_N,
+                    "number of running nodes");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
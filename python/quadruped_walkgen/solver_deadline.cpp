@@ -0,0 +1,69 @@
+#include <quadruped-walkgen/solver_deadline.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+template <class Solver>
+void exposeSolverDeadlineTpl(const char* name, const char* base) {
+  typedef SolverDeadline<Solver> Deadline;
+  const std::string doc =
+      std::string("DDP solver stopped by a wall-clock budget.\n\n") +
+      "It runs the iterations of " + base +
+      ".solve (inherited, virtual), but before each of\n"
+      "them but the first, the duration of the next iteration is predicted "
+      "and the solve\n"
+      "stops if it would end after the budget. The first iteration is "
+      "always run, it\n"
+      "computes the gains of the new problem, so a budget shorter than one "
+      "iteration is\n"
+      "overrun by it. The iterate of lowest cost is returned in xs, us and "
+      "cost.";
+  bp::class_<Deadline, bp::bases<Solver>, boost::noncopyable>(
+      name, doc.c_str(),
+      bp::init<boost::shared_ptr<crocoddyl::ShootingProblem> >(
+          bp::args("self", "problem"),
+          "Initialize the deadline-driven solver, the budget is infinite.\n\n"
+          ":param problem: shooting problem"))
+      .def("resetIterationTime", &Deadline::reset_iteration_time,
+           bp::args("self"),
+           "Forget the estimated duration of an iteration.")
+      .add_property(
+          "budget",
+          bp::make_function(&Deadline::get_budget,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&Deadline::set_budget),
+          "budget of a solve, from the call to solve [ms]")
+      .add_property(
+          "margin",
+          bp::make_function(&Deadline::get_margin,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&Deadline::set_margin),
+          "safety factor on the predicted duration of an iteration (>= 1)")
+      .add_property(
+          "decay",
+          bp::make_function(&Deadline::get_decay,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&Deadline::set_decay),
+          "decrease of the estimated duration of an iteration, in [0, 1]")
+      .add_property("iteration_time", &Deadline::get_iteration_time,
+                    "estimated duration of an iteration [ms]")
+      .add_property("elapsed", &Deadline::get_elapsed,
+                    "duration of the last solve [ms]")
+      .add_property("deadline_reached", &Deadline::get_deadline_reached,
+                    "True if the last solve was stopped by the budget")
+      .add_property("best_iter", &Deadline::get_best_iter,
+                    "number of iterations that led to the returned iterate, "
+                    "0 for the warm start");
+}
+
+void exposeSolverDeadline() {
+  exposeSolverDeadlineTpl<crocoddyl::SolverDDP>("SolverDeadlineDDP",
+                                                "crocoddyl.SolverDDP");
+  exposeSolverDeadlineTpl<SolverQuadrupedDDP>("SolverDeadlineQuadrupedDDP",
+                                              "SolverQuadrupedDDP");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -0,0 +1,50 @@
+#include <quadruped-walkgen/solver_quadruped_ddp.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+void exposeSolverQuadrupedDDP() {
+  // The base class is registered by the crocoddyl module, which has to be
+  // imported before this one.
+  bp::class_<SolverQuadrupedDDP, bp::bases<crocoddyl::SolverDDP>,
+             boost::noncopyable>(
+      "SolverQuadrupedDDP",
+      "DDP solver specialised for the quadruped action model.\n\n"
+      "It follows the same algorithm as crocoddyl.SolverDDP, but the "
+      "backward pass\n"
+      "uses fixed-size matrices and the structure of ActionModelQuadruped :\n"
+      "Fx = [[I, dt*I], [0, I]], Fu without the columns of the feet in "
+      "swing phase,\n"
+      "and Lxu = 0. Every running model of the problem has to be an "
+      "ActionModelQuadruped.",
+      bp::init<boost::shared_ptr<crocoddyl::ShootingProblem> >(
+          bp::args("self", "problem"),
+          "Initialize the quadruped DDP solver.\n\n"
+          ":param problem: shooting problem built with ActionModelQuadruped"))
+      .def("backwardPass", &SolverQuadrupedDDP::backwardPass,
+           bp::args("self"),
+           "Run the structured backward pass.\n\n"
+           "It computes the feedforward and feedback gains from the "
+           "derivatives\n"
+           "of the problem, which are assumed to be computed.")
+      .def("solveX0", &SolverQuadrupedDDP::solve_x0,
+           (bp::arg("self"), bp::arg("x0"), bp::arg("maxiter") = 1),
+           "Solve the problem again for a new initial state only.\n\n"
+           "If the models did not change since the last backward pass, which "
+           "ended with a\n"
+           "full step, only a rollout with the stored gains is done. It falls "
+           "back to solve,\n"
+           "warm-started with the last solution, when an active set of the "
+           "constraints flips.\n"
+           "When the backward pass is reused, stop, d, dV and dVexp are set to "
+           "NaN.\n"
+           ":param x0: new initial state\n"
+           ":param maxiter: maximum number of iterations of the fallback "
+           "(default 1)\n"
+           ":return: True if the last backward pass was reused");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
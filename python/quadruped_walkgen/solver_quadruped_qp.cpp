@@ -0,0 +1,113 @@
+#include <quadruped-walkgen/solver_quadruped_qp.hpp>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+void exposeSolverQuadrupedQP() {
+  bp::class_<SolverQuadrupedQP, boost::noncopyable>(
+      "SolverQuadrupedQP",
+      "Condensed QP solver for the quadruped action model.\n\n"
+      "The states are eliminated with the linear dynamics of each model, "
+      "and the QP over\n"
+      "the forces of the whole horizon is solved with ADMM, warm-started "
+      "from the\n"
+      "previous solve. The Hessian and its factorisation are kept until a "
+      "model, rho or sigma\n"
+      "changes. The friction cone and the normal force limits are "
+      "hard constraints,\n"
+      "so the friction weight and the shoulder cost of the models are not "
+      "used.\n"
+      "Every model of the problem, terminal included, has to be an "
+      "ActionModelQuadruped.",
+      bp::init<boost::shared_ptr<crocoddyl::ShootingProblem> >(
+          bp::args("self", "problem"),
+          "Initialize the condensed QP solver.\n\n"
+          ":param problem: shooting problem built with ActionModelQuadruped"))
+      .def("solve", &SolverQuadrupedQP::solve,
+           (bp::arg("self"), bp::arg("maxiter") = 200),
+           "Condense the problem and solve the QP.\n\n"
+           ":param maxiter: maximum number of ADMM iterations\n"
+           ":return: True if the residuals reached the tolerances")
+      .def("condense", &SolverQuadrupedQP::condense, bp::args("self"),
+           "Build the condensed gradient from the models, and the condensed "
+           "Hessian if a\n"
+           "model changed since the last call.")
+      .def("solveQP", &SolverQuadrupedQP::solveQP,
+           bp::args("self", "maxiter"),
+           "Run ADMM on the last condensed QP.\n\n"
+           ":param maxiter: maximum number of ADMM iterations\n"
+           ":return: True if the residuals reached the tolerances")
+      .def("reset", &SolverQuadrupedQP::reset, bp::args("self"),
+           "Forget the previous solution, the next solve starts from zero "
+           "forces.")
+      .def("shift", &SolverQuadrupedQP::shift, bp::args("self"),
+           "Shift the warm start by one node.\n\n"
+           "To be called after the models of the problem were shifted by one "
+           "node, as done by\n"
+           "RecedingHorizonQuadruped.shift. The last node is duplicated.")
+      .add_property("xs",
+                    bp::make_function(
+                        &SolverQuadrupedQP::get_xs,
+                        bp::return_value_policy<bp::copy_const_reference>()),
+                    "state trajectory, same layout as SolverDDP.xs")
+      .add_property("us",
+                    bp::make_function(
+                        &SolverQuadrupedQP::get_us,
+                        bp::return_value_policy<bp::copy_const_reference>()),
+                    "control trajectory, same layout as SolverDDP.us")
+      .add_property("problem",
+                    bp::make_function(
+                        &SolverQuadrupedQP::get_problem,
+                        bp::return_value_policy<bp::return_by_value>()),
+                    "shooting problem")
+      .add_property("H",
+                    bp::make_function(&SolverQuadrupedQP::get_H,
+                                      bp::return_internal_reference<>()),
+                    "condensed Hessian")
+      .add_property("q",
+                    bp::make_function(&SolverQuadrupedQP::get_q,
+                                      bp::return_internal_reference<>()),
+                    "condensed gradient")
+      .add_property("iter", &SolverQuadrupedQP::get_iter,
+                    "number of ADMM iterations of the last solve")
+      .add_property("primal_residual",
+                    &SolverQuadrupedQP::get_primal_residual,
+                    "primal residual of the last solve")
+      .add_property("dual_residual", &SolverQuadrupedQP::get_dual_residual,
+                    "dual residual of the last solve")
+      .add_property(
+          "rho",
+          bp::make_function(&SolverQuadrupedQP::get_rho,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&SolverQuadrupedQP::set_rho),
+          "ADMM penalty of the inequality constraints")
+      .add_property(
+          "sigma",
+          bp::make_function(&SolverQuadrupedQP::get_sigma,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&SolverQuadrupedQP::set_sigma),
+          "ADMM proximal weight on the forces")
+      .add_property(
+          "alpha",
+          bp::make_function(&SolverQuadrupedQP::get_alpha,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&SolverQuadrupedQP::set_alpha),
+          "ADMM relaxation parameter, in ]0, 2[")
+      .add_property(
+          "eps_abs",
+          bp::make_function(&SolverQuadrupedQP::get_eps_abs,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&SolverQuadrupedQP::set_eps_abs),
+          "absolute tolerance on the residuals")
+      .add_property(
+          "eps_rel",
+          bp::make_function(&SolverQuadrupedQP::get_eps_rel,
+                            bp::return_value_policy<bp::return_by_value>()),
+          bp::make_function(&SolverQuadrupedQP::set_eps_rel),
+          "relative tolerance on the residuals");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -0,0 +1,93 @@
+#include <quadruped-walkgen/timing_probes.hpp>
+
+#include <sstream>
+
+#include "core.hpp"
+
+namespace quadruped_walkgen {
+namespace python {
+
+bp::list getTimings(const crocoddyl::ShootingProblem& problem) {
+  const std::vector<NodeTiming> timings = get_timings(problem);
+  bp::list l;
+  for (std::size_t i = 0; i < timings.size(); ++i) {
+    const LatencyHistogram& h = timings[i].histogram;
+    bp::dict timing;
+    timing["model"] = timings[i].model;
+    timing["node"] = timings[i].node;
+    timing["phase"] = timings[i].phase;
+    timing["count"] = h.get_count();
+    timing["mean"] = 1e-3 * h.get_mean();
+    timing["p50"] = 1e-3 * h.get_percentile(50.);
+    timing["p90"] = 1e-3 * h.get_percentile(90.);
+    timing["p99"] = 1e-3 * h.get_percentile(99.);
+    timing["max"] = 1e-3 * h.get_max();
+    l.append(timing);
+  }
+  return l;
+}
+
+std::string dumpTimings(const crocoddyl::ShootingProblem& problem) {
+  std::ostringstream os;
+  dump_timings(problem, os);
+  return os.str();
+}
+
+void exposeTimingProbes() {
+  bp::enum_<TimingPhase::Index>("TimingPhase")
+      .value("UpdateModel", TimingPhase::UpdateModel)
+      .value("Calc", TimingPhase::Calc)
+      .value("CalcDiff", TimingPhase::CalcDiff)
+      .value("BackwardPass", TimingPhase::BackwardPass);
+
+  bp::def("setRecordTimings", &set_record_timings, bp::args("enabled"),
+          "Enable or disable the timing probes of calc, calcDiff, "
+          "update_model and of the\n"
+          "backward pass of SolverQuadrupedDDP.\n\n"
+          "The probes are only compiled with the cmake option "
+          "BUILD_WITH_TIMING_PROBES.\n"
+          ":param enabled: disabled by default");
+  bp::def("getRecordTimings", &get_record_timings,
+          "Return true if the timing probes are enabled.");
+  bp::def("registerTimings", &register_timings<double>, bp::args("problem"),
+          "Give the positions of the models and data of a problem to the "
+          "timing probes.\n\n"
+          "Has to be called after building a problem and after moving its "
+          "nodes, it is done by\n"
+          "RecedingHorizonQuadruped, SolverQuadrupedDDP, HorizonQuadrupedBatch "
+          "and GaitProblemBuilder.\n"
+          ":param problem: shooting problem");
+  bp::def("unregisterTimings", &unregister_timings<double>,
+          bp::args("problem"),
+          "Forget the models and data of a problem in the timing probes.\n\n"
+          "Has to be called before the nodes of a registered problem are "
+          "destroyed or replaced,\n"
+          "otherwise new objects at the same addresses would be recorded at "
+          "the old positions.\n"
+          ":param problem: shooting problem");
+  bp::def("getDroppedTimings", &get_dropped_timings,
+          "Return the number of records of objects that were not "
+          "registered.");
+  bp::def("resetTimings", &reset_timings,
+          "Empty the latency histograms.");
+  bp::def("getTimings", &getTimings, bp::args("problem"),
+          "Return the latencies recorded for the nodes of a problem.\n\n"
+          "One dict per node and phase with records, with the type of the "
+          "model, the index of\n"
+          "the node (T for the terminal node), the TimingPhase, the number "
+          "of records and the\n"
+          "mean, p50, p90, p99 and max latencies in microseconds.\n"
+          "The records are kept by node position and type of model, the "
+          "positions are the ones\n"
+          "given by the last registerTimings.\n"
+          ":param problem: shooting problem\n"
+          ":return: list of dict");
+  bp::def("dumpTimings", &dumpTimings, bp::args("problem"),
+          "Return the table of the latencies recorded for the nodes of a "
+          "problem.\n\n"
+          ":param problem: shooting problem\n"
+          ":return: one line per node and phase, in microseconds");
+}
+
+}  // namespace python
+}  // namespace quadruped_walkgen
@@ -0,0 +1,104 @@
+#include <quadruped-walkgen/gain_interpolator.hpp>
+
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+
+GainInterpolator::GainInterpolator(const std::size_t N, const double dt)
+    : N_(N), dt_(dt), interpolate_(true), cycle_(0) {
+  if (N_ == 0) {
+    throw_pretty("Invalid argument: "
+                 << "the horizon should have at least one node");
+  }
+  if (dt_ <= 0.) {
+    throw_pretty("Invalid argument: "
+                 << "dt should be positive");
+  }
+  xs_.resize(N_ + 1, Vector12::Zero());
+  us_.resize(N_, Vector12::Zero());
+  K_.resize(N_, Matrix12::Zero());
+  xref_.setZero();
+  dx_.setZero();
+  u_.setZero();
+}
+
+GainInterpolator::~GainInterpolator() {}
+
+void GainInterpolator::set_solution(
+    const std::vector<Eigen::VectorXd>& xs,
+    const std::vector<Eigen::VectorXd>& us,
+    const std::vector<crocoddyl::SolverDDP::MatrixXdRowMajor>& K) {
+  if (xs.size() != N_ + 1 || us.size() != N_ || K.size() != N_) {
+    throw_pretty("Invalid argument: "
+                 << "xs, us and K should have " + std::to_string(N_ + 1) +
+                        ", " + std::to_string(N_) + " and " +
+                        std::to_string(N_) + " elements");
+  }
+  // Every element is checked before the copy, so that a bad element leaves
+  // the previous solution untouched
+  bool valid = xs[N_].size() == 12;
+  for (std::size_t k = 0; valid && k < N_; ++k) {
+    valid = xs[k].size() == 12 && us[k].size() == 12 && K[k].rows() == 12 &&
+            K[k].cols() == 12;
+  }
+  if (!valid) {
+    throw_pretty("Invalid argument: "
+                 << "the states, controls and gains should be 12x1, 12x1 "
+                    "and 12x12");
+  }
+  for (std::size_t k = 0; k < N_; ++k) {
+    xs_[k] = xs[k];
+    us_[k] = us[k];
+    K_[k] = K[k];
+  }
+  xs_[N_] = xs[N_];
+  cycle_ = 0;
+}
+
+void GainInterpolator::set_solution(const MpcSolution& solution) {
+  set_solution(solution.xs, solution.us, solution.K);
+  cycle_ = solution.cycle;
+}
+
+const GainInterpolator::Vector12& GainInterpolator::compute(
+    const Eigen::Ref<const Vector12>& x, const double t) {
+  // Node k and position a in [0, 1] within the node
+  const double s = t > 0. ? t / dt_ : 0.;
+  std::size_t k = N_ - 1;
+  double a = 1.;
+  if (s < static_cast<double>(N_)) {
+    k = static_cast<std::size_t>(s);
+    a = s - static_cast<double>(k);
+  }
+
+  xref_ = (1. - a) * xs_[k] + a * xs_[k + 1];
+  dx_ = x - xref_;
+  const std::size_t k1 = k + 1 < N_ ? k + 1 : k;
+  if (interpolate_ && k1 != k) {
+    u_ = (1. - a) * us_[k] + a * us_[k1];
+    u_.noalias() -= (1. - a) * (K_[k] * dx_);
+    u_.noalias() -= a * (K_[k1] * dx_);
+  } else {
+    u_ = us_[k];
+    u_.noalias() -= K_[k] * dx_;
+  }
+  return u_;
+}
+
+const GainInterpolator::Vector12& GainInterpolator::get_xref() const {
+  return xref_;
+}
+
+const bool& GainInterpolator::get_interpolate() const { return interpolate_; }
+
+void GainInterpolator::set_interpolate(const bool& interpolate) {
+  interpolate_ = interpolate;
+}
+
+std::size_t GainInterpolator::get_cycle() const { return cycle_; }
+
+std::size_t GainInterpolator::get_N() const { return N_; }
+
+const double& GainInterpolator::get_dt() const { return dt_; }
+
+}  // namespace quadruped_walkgen
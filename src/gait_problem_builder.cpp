@@ -0,0 +1,121 @@
+#include <quadruped-walkgen/gait_problem_builder.hpp>
+
+#include <cmath>
+
+#include "crocoddyl/core/utils/exception.hpp"
+#include "quadruped-walkgen/multithreading.hpp"
+
+namespace quadruped_walkgen {
+
+GaitProblemBuilder::GaitProblemBuilder(
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem)
+    : problem_(problem),
+      gait_(Eigen::MatrixXd::Zero(6, 5)),
+      fsteps_(Eigen::MatrixXd::Zero(6, 13)) {
+  for (std::size_t k = 0; k <= problem_->get_T(); ++k) {
+    get_quadruped_model(k);
+  }
+  l_feet_.setZero();
+  set_default_nthreads(*problem_);
+  register_timings(*problem_);
+}
+
+GaitProblemBuilder::~GaitProblemBuilder() {
+  // The nodes may be destroyed with the problem, their addresses reused
+  unregister_timings(*problem_);
+}
+
+ActionModelQuadruped& GaitProblemBuilder::get_quadruped_model(
+    const std::size_t k) const {
+  ActionModelQuadruped* model = dynamic_cast<ActionModelQuadruped*>(
+      k == problem_->get_T() ? problem_->get_terminalModel().get()
+                             : problem_->get_runningModels()[k].get());
+  if (model == NULL) {
+    throw_pretty("Invalid argument: "
+                 << "the model " + std::to_string(k) +
+                        " is not an ActionModelQuadruped");
+  }
+  return *model;
+}
+
+Eigen::MatrixXd GaitProblemBuilder::gait_from_fsteps(
+    const Eigen::Ref<const Eigen::MatrixXd>& fsteps) {
+  if (fsteps.cols() != 13) {
+    throw_pretty("Invalid argument: "
+                 << "fsteps should have 13 columns");
+  }
+  Eigen::MatrixXd gait = Eigen::MatrixXd::Zero(fsteps.rows(), 5);
+  for (int j = 0; j < fsteps.rows() && fsteps(j, 0) != 0.; ++j) {
+    gait(j, 0) = fsteps(j, 0);
+    for (int i = 0; i < 4; i = i + 1) {
+      const double x = fsteps(j, 1 + 3 * i);
+      gait(j, 1 + i) = (std::isnan(x) || x == 0.) ? 0. : 1.;
+    }
+  }
+  return gait;
+}
+
+void GaitProblemBuilder::update(
+    const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+    const Eigen::Ref<const Eigen::MatrixXd>& xref) {
+  update(gait_from_fsteps(fsteps), fsteps, xref);
+}
+
+void GaitProblemBuilder::update(
+    const Eigen::Ref<const Eigen::MatrixXd>& gait,
+    const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+    const Eigen::Ref<const Eigen::MatrixXd>& xref) {
+  const std::size_t T = problem_->get_T();
+  if (gait.cols() != 5 || fsteps.cols() != 13 ||
+      fsteps.rows() != gait.rows()) {
+    throw_pretty("Invalid argument: "
+                 << "gait and fsteps should be nx5 and nx13 matrices");
+  }
+  if (xref.rows() != 12 || static_cast<std::size_t>(xref.cols()) != T + 1) {
+    throw_pretty("Invalid argument: "
+                 << "xref has wrong dimension (it should be 12x" +
+                        std::to_string(T + 1) + ")");
+  }
+  gait_ = gait;
+  fsteps_ = fsteps.unaryExpr(
+      [](const double x) { return std::isnan(x) ? 0. : x; });
+
+  // Iterate over all the phases of the gait matrix
+  // The first column of xref correspond to the current state = x0
+  int j = 0;
+  std::size_t k = 0;
+  for (; j < gait_.rows() && gait_(j, 0) > 0.; ++j) {
+    for (int i = 0; i < 4; i = i + 1) {
+      l_feet_.col(i) = fsteps_.block(j, 1 + 3 * i, 1, 3).transpose();
+    }
+    const std::size_t k_end = std::min(T, k + std::size_t(gait_(j, 0)));
+    for (; k < k_end; ++k) {
+      get_quadruped_model(k).update_model(
+          l_feet_, xref.col(k + 1), gait_.block(j, 1, 1, 4).transpose());
+    }
+  }
+  if (j == 0) {
+    throw_pretty("Invalid argument: "
+                 << "the gait matrix should have at least one phase");
+  }
+
+  // Terminal node, with the last phase
+  for (int i = 0; i < 4; i = i + 1) {
+    l_feet_.col(i) = fsteps_.block(j - 1, 1 + 3 * i, 1, 3).transpose();
+  }
+  get_quadruped_model(T).update_model(
+      l_feet_, xref.col(T), gait_.block(j - 1, 1, 1, 4).transpose());
+}
+
+const boost::shared_ptr<crocoddyl::ShootingProblem>&
+GaitProblemBuilder::get_problem() const {
+  return problem_;
+}
+
+const Eigen::MatrixXd& GaitProblemBuilder::get_gait() const { return gait_; }
+
+const Eigen::MatrixXd& GaitProblemBuilder::get_fsteps() const {
+  return fsteps_;
+}
+
+}  // namespace quadruped_walkgen
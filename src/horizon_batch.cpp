@@ -0,0 +1,262 @@
+#include <quadruped-walkgen/horizon_batch.hpp>
+
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+
+HorizonQuadrupedBatch::HorizonQuadrupedBatch(
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem)
+    : problem_(problem) {
+  const std::size_t T = problem_->get_T();
+  models_.assign(T, NULL);
+  datas_.assign(T, NULL);
+  versions_.assign(T, 0);
+  update_nodes();
+  register_timings(*problem_);
+
+  const Eigen::Index N = static_cast<Eigen::Index>(T);
+  xref_.setZero(12, N);
+  uref_.setZero(12, N);
+  state_weights_.setZero(12, N);
+  force_weights_.setZero(12, N);
+  force_weights2_.setZero(12, N);
+  dt_.setZero(N);
+  g_.setZero(12, N);
+  B_.setZero(6, 12 * N);
+  implicit_.setConstant(N, false);
+  friction_weight_.setZero(N);
+  sh_weight_.setZero(N);
+  sh_hlim2_.setZero(N);
+  offset_com_.setZero(3, N);
+  pshoulder_.setZero(8, N);
+  lever_arms_.setZero(8, N);
+  contact_.setConstant(4, N, false);
+  mu_.setZero(N);
+  ub_.setZero(4, 6 * N);
+
+  X_.setZero(12, N);
+  U_.setZero(12, N);
+  r_.setZero(24, N);
+  Lx_.setZero(12, N);
+  Lu_.setZero(12, N);
+}
+
+HorizonQuadrupedBatch::~HorizonQuadrupedBatch() {
+  // The nodes may be destroyed with the problem, their addresses reused
+  unregister_timings(*problem_);
+}
+
+bool HorizonQuadrupedBatch::update_nodes() {
+  const std::size_t T = models_.size();
+  if (problem_->get_T() != T) {
+    throw_pretty("Invalid argument: "
+                 << "the problem should keep " + std::to_string(T) +
+                        " running nodes");
+  }
+  bool changed = false;
+  for (std::size_t k = 0; k < T; ++k) {
+    crocoddyl::ActionModelAbstract* model =
+        problem_->get_runningModels()[k].get();
+    crocoddyl::ActionDataAbstract* data =
+        problem_->get_runningDatas()[k].get();
+    if (model == models_[k] && data == datas_[k]) {
+      continue;
+    }
+#ifdef QUADRUPED_WALKGEN_WITH_TIMING_PROBES
+    if (models_[k] != NULL) {
+      unregister_timing_node(models_[k], datas_[k]);
+    }
+    register_timing_node(model, data, typeid(*model), k);
+#endif
+    models_[k] = dynamic_cast<ActionModelQuadruped*>(model);
+    datas_[k] = dynamic_cast<ActionDataQuadruped*>(data);
+    if (models_[k] == NULL || datas_[k] == NULL) {
+      throw_pretty("Invalid argument: "
+                   << "the running model " + std::to_string(k) +
+                          " is not an ActionModelQuadruped");
+    }
+    versions_[k] = 0;
+    changed = true;
+  }
+  return changed;
+}
+
+void HorizonQuadrupedBatch::check_inputs(
+    const std::vector<Eigen::VectorXd>& xs,
+    const std::vector<Eigen::VectorXd>& us) const {
+  const std::size_t T = models_.size();
+  if (xs.size() != T + 1) {
+    throw_pretty("Invalid argument: "
+                 << "xs has wrong dimension (it should be " +
+                        std::to_string(T + 1) + ")");
+  }
+  if (us.size() != T) {
+    throw_pretty("Invalid argument: "
+                 << "us has wrong dimension (it should be " +
+                        std::to_string(T) + ")");
+  }
+  for (std::size_t k = 0; k < T; ++k) {
+    if (xs[k].size() != 12 || us[k].size() != 12) {
+      throw_pretty("Invalid argument: "
+                   << "x and u of node " + std::to_string(k) +
+                          " should be 12-vectors");
+    }
+  }
+}
+
+void HorizonQuadrupedBatch::update_node(const std::size_t k) {
+  const ActionModelQuadruped& m = *models_[k];
+  const Eigen::Index n = static_cast<Eigen::Index>(k);
+  xref_.col(n) = m.xref_;
+  uref_.col(n) = m.uref_;
+  state_weights_.col(n) = m.state_weights_;
+  force_weights_.col(n) = m.force_weights_;
+  force_weights2_.col(n) = m.force_weights_.cwiseAbs2();
+  dt_(n) = m.dt_;
+  g_.col(n) = m.g;
+  B_.middleCols<12>(12 * n) = m.B;
+  implicit_(n) = m.implicit_integration;
+  friction_weight_(n) = m.friction_weight_;
+  sh_weight_(n) = m.sh_weight;
+  sh_hlim2_(n) = m.sh_hlim * m.sh_hlim;
+  offset_com_.col(n) = m.offset_com;
+  for (int i = 0; i < 4; i = i + 1) {
+    pshoulder_.block<2, 1>(2 * i, n) = m.pshoulder_0.col(i);
+    lever_arms_.block<2, 1>(2 * i, n) = m.lever_arms.col(i).head(2);
+    contact_(i, n) = m.gait(i) != 0.;
+  }
+  mu_(n) = m.mu;
+  ub_.middleCols<6>(6 * n) = m.ub;
+  versions_[k] = m.version_;
+}
+
+double HorizonQuadrupedBatch::calc(const std::vector<Eigen::VectorXd>& xs,
+                                   const std::vector<Eigen::VectorXd>& us) {
+  update_nodes();
+  check_inputs(xs, us);
+  const std::size_t T = models_.size();
+  for (std::size_t k = 0; k < T; ++k) {
+    if (versions_[k] != models_[k]->version_) {
+      update_node(k);
+    }
+    X_.col(k) = xs[k];
+    U_.col(k) = us[k];
+  }
+
+  // Residual cost on the state and force norm
+  r_.topRows<12>() = state_weights_.cwiseProduct(X_ - xref_);
+  r_.bottomRows<12>() = force_weights_.cwiseProduct(U_ - uref_);
+
+  double cost = 0.;
+  for (std::size_t k = 0; k < T; ++k) {
+    ActionDataQuadruped* d = datas_[k];
+    const Eigen::Matrix<double, 12, 1> x = X_.col(k);
+    const Eigen::Matrix<double, 12, 1> u = U_.col(k);
+
+    for (int i = 0; i < 4; i = i + 1) {
+      if (contact_(i, k)) {
+        // Compute pdistance of the shoulder wrt contact point
+        const double px = pshoulder_(2 * i, k);
+        const double py = pshoulder_(2 * i + 1, k);
+        d->psh.col(i) << x[0] - offset_com_(0, k) + px - py * x[5] -
+                             lever_arms_(2 * i, k),
+            x[1] - offset_com_(1, k) + py + px * x[5] -
+                lever_arms_(2 * i + 1, k),
+            x[2] - offset_com_(2, k) + py * x[3] - px * x[4];
+      } else {
+        d->psh.col(i).setZero();
+      }
+    }
+
+    // Discrete dynamic : A*x + B*u + g
+    d->xnext = x + g_.col(k);
+    d->xnext.tail<6>() += B_.middleCols<12>(12 * k) * u;
+    if (implicit_(k)) {
+      d->xnext.head<6>() += dt_(k) * d->xnext.tail<6>();
+    } else {
+      d->xnext.head<6>() += dt_(k) * x.tail<6>();
+    }
+
+    d->r = r_.col(k);
+
+    // Friction cone
+    const double friction_cost =
+        d->friction.calc(u, mu_(k), ub_.middleCols<6>(6 * k));
+
+    // Shoulder height weight
+    d->sh_ub_max_ =
+        (d->psh.colwise().squaredNorm().transpose().array() - sh_hlim2_(k))
+            .cwiseMax(0.)
+            .matrix();
+
+    d->cost = 0.5 * d->r.squaredNorm() + friction_weight_(k) * friction_cost +
+              sh_weight_(k) * 0.5 * d->sh_ub_max_.sum();
+    if (get_log_cost_terms()) {
+      models_[k]->record_cost_terms(d);
+    }
+    cost += d->cost;
+  }
+
+  const boost::shared_ptr<crocoddyl::ActionDataAbstract>& terminal_data =
+      problem_->get_terminalData();
+  problem_->get_terminalModel()->calc(terminal_data, xs.back());
+  return cost + terminal_data->cost;
+}
+
+void HorizonQuadrupedBatch::calcDiff(const std::vector<Eigen::VectorXd>& xs,
+                                     const std::vector<Eigen::VectorXd>& us) {
+  if (update_nodes()) {
+    throw_pretty("Invalid argument: "
+                 << "calc should be called again after a change of the nodes "
+                    "of the problem");
+  }
+  check_inputs(xs, us);
+  const std::size_t T = models_.size();
+
+  // Cost derivatives : Lx, and Lu without the friction cone
+  Lx_ = state_weights_.cwiseProduct(r_.topRows<12>());
+  Lu_ = force_weights_.cwiseProduct(r_.bottomRows<12>());
+
+  for (std::size_t k = 0; k < T; ++k) {
+    ActionDataQuadruped* d = datas_[k];
+    const bool update_constant = models_[k]->update_dynamics_derivatives(d);
+
+    // Shoulder height terms of Lx
+    d->Lx = Lx_.col(k);
+    const double w = sh_weight_(k);
+    for (int j = 0; j < 4; j = j + 1) {
+      if (d->sh_ub_max_[j] > 0.) {
+        const double px = pshoulder_(2 * j, k);
+        const double py = pshoulder_(2 * j + 1, k);
+        d->Lx(0) += w * d->psh(0, j);
+        d->Lx(1) += w * d->psh(1, j);
+        d->Lx(2) += w * d->psh(2, j);
+        d->Lx(3) += w * py * d->psh(2, j);
+        d->Lx(4) += -w * px * d->psh(2, j);
+        d->Lx(5) += w * (-py * d->psh(0, j) + px * d->psh(1, j));
+      }
+    }
+
+    // Hessian : Lxx, depends on the active shoulder constraints
+    const Eigen::Matrix<double, 4, 1> sh_active =
+        (d->sh_ub_max_.array() > 0.).matrix().cast<double>();
+    if (update_constant || sh_active != d->sh_active) {
+      models_[k]->update_state_hessian(d, sh_active);
+    }
+
+    // Cost derivative : Lu and Luu
+    d->friction.calcDiff(friction_weight_(k), mu_(k), d->Lu, d->Luu);
+    d->Lu += Lu_.col(k);
+    d->Luu.diagonal() += force_weights2_.col(k);
+  }
+
+  problem_->get_terminalModel()->calcDiff(problem_->get_terminalData(),
+                                          xs.back());
+}
+
+const boost::shared_ptr<crocoddyl::ShootingProblem>&
+HorizonQuadrupedBatch::get_problem() const {
+  return problem_;
+}
+
+}  // namespace quadruped_walkgen
@@ -0,0 +1,219 @@
+#include <quadruped-walkgen/mpc_pipeline.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+
+namespace {
+
+MpcSolution initial_solution(const Eigen::VectorXd& x0, const std::size_t N) {
+  MpcSolution solution;
+  solution.cycle = 0;
+  solution.xs.resize(N + 1, x0);
+  solution.us.resize(N, Eigen::VectorXd::Zero(12));
+  solution.K.resize(N, crocoddyl::SolverDDP::MatrixXdRowMajor::Zero(12, 12));
+  solution.cost = 0.;
+  solution.iter = 0;
+  solution.converged = false;
+  return solution;
+}
+
+}  // namespace
+
+MpcPipelineQuadruped::MpcPipelineQuadruped(
+    const Eigen::Ref<const Eigen::VectorXd>& x0, const std::size_t N)
+    : N_(N),
+      idle_(0),
+      cycle_(0),
+      maxiter_(1),
+      solved_(2),
+      solution_(initial_solution(x0, N)),
+      job_(2),
+      busy_(false),
+      stop_(false) {
+  for (std::size_t i = 0; i < 2; ++i) {
+    buffers_[i].horizon =
+        boost::make_shared<RecedingHorizonQuadruped>(x0, N_);
+    buffers_[i].solver = boost::make_shared<SolverDeadlineQuadrupedDDP>(
+        buffers_[i].horizon->get_problem());
+    buffers_[i].cycle = 0;
+  }
+  xs_warm_.resize(N_ + 1, x0);
+  us_warm_.resize(N_, Eigen::VectorXd::Zero(12));
+  worker_ = std::thread(&MpcPipelineQuadruped::run, this);
+}
+
+MpcPipelineQuadruped::~MpcPipelineQuadruped() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+  worker_.join();
+}
+
+std::size_t MpcPipelineQuadruped::prepare(
+    const Eigen::Ref<const Eigen::MatrixXd>& gait,
+    const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+    const Eigen::Ref<const Eigen::MatrixXd>& xref) {
+  // The idle horizon is behind by the cycles solved by the other one
+  Buffer& buffer = buffers_[idle_];
+  ++cycle_;
+  if (buffer.cycle > 0) {
+    for (std::size_t c = buffer.cycle; c < cycle_ && c < buffer.cycle + N_;
+         ++c) {
+      buffer.horizon->shift();
+    }
+  }
+  buffer.cycle = cycle_;
+  return buffer.horizon->update(gait, fsteps, xref);
+}
+
+void MpcPipelineQuadruped::start(const Eigen::Ref<const Eigen::VectorXd>& x0,
+                                 const std::size_t maxiter) {
+  if (static_cast<std::size_t>(x0.size()) != 12) {
+    throw_pretty("Invalid argument: "
+                 << "x0 has wrong dimension (it should be 12)");
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  wait(lock);
+  Buffer& buffer = buffers_[idle_];
+  if (buffer.cycle != cycle_) {
+    throw_pretty("Invalid argument: "
+                 << "prepare should be called before each start");
+  }
+
+  // Warm start from the last solution, shifted to the prepared cycle
+  if (solved_ < 2) {
+    const Buffer& last = buffers_[solved_];
+    const std::size_t shift = buffer.cycle - last.cycle;
+    const std::vector<Eigen::VectorXd>& xs = last.horizon->get_xs();
+    const std::vector<Eigen::VectorXd>& us = last.horizon->get_us();
+    for (std::size_t k = 0; k <= N_; ++k) {
+      xs_warm_[k] = xs[std::min(k + shift, N_)];
+    }
+    for (std::size_t k = 0; k < N_; ++k) {
+      us_warm_[k] = us[std::min(k + shift, N_ - 1)];
+    }
+    buffer.horizon->set_warm_start(xs_warm_, us_warm_);
+  }
+  buffer.horizon->set_x0(x0);
+
+  maxiter_ = maxiter;
+  job_ = idle_;
+  busy_ = true;
+  solved_ = idle_;
+  idle_ = 1 - idle_;
+  lock.unlock();
+  condition_.notify_all();
+}
+
+void MpcPipelineQuadruped::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  wait(lock);
+}
+
+void MpcPipelineQuadruped::wait(std::unique_lock<std::mutex>& lock) {
+  while (busy_) {
+    condition_.wait(lock);
+  }
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = std::exception_ptr();
+    std::rethrow_exception(error);
+  }
+}
+
+bool MpcPipelineQuadruped::is_busy() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return busy_;
+}
+
+const MpcSolution& MpcPipelineQuadruped::read() {
+  solution_.update();
+  return solution_.get_front();
+}
+
+void MpcPipelineQuadruped::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    while (!stop_ && job_ == 2) {
+      condition_.wait(lock);
+    }
+    if (stop_) {
+      return;
+    }
+    Buffer& buffer = buffers_[job_];
+    job_ = 2;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      solve(buffer);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    error_ = error;
+    busy_ = false;
+    condition_.notify_all();
+  }
+}
+
+void MpcPipelineQuadruped::solve(Buffer& buffer) {
+  SolverDeadlineQuadrupedDDP& solver = *buffer.solver;
+  const bool converged = solver.solve(buffer.horizon->get_xs(),
+                                      buffer.horizon->get_us(), maxiter_);
+  buffer.horizon->set_warm_start(solver.get_xs(), solver.get_us());
+
+  // Copied in the buffers of the same size, without allocation
+  MpcSolution& solution = solution_.get_back();
+  solution.cycle = buffer.cycle;
+  for (std::size_t k = 0; k <= N_; ++k) {
+    solution.xs[k] = solver.get_xs()[k];
+  }
+  for (std::size_t k = 0; k < N_; ++k) {
+    solution.us[k] = solver.get_us()[k];
+    solution.K[k] = solver.get_K()[k];
+  }
+  solution.cost = solver.get_cost();
+  solution.iter = solver.get_iter();
+  solution.converged = converged;
+  solution_.publish();
+}
+
+double MpcPipelineQuadruped::get_budget() const {
+  return buffers_[0].solver->get_budget();
+}
+
+void MpcPipelineQuadruped::set_budget(const double& budget) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  wait(lock);
+  buffers_[0].solver->set_budget(budget);
+  buffers_[1].solver->set_budget(budget);
+}
+
+std::size_t MpcPipelineQuadruped::get_N() const { return N_; }
+
+const RecedingHorizonQuadruped& MpcPipelineQuadruped::get_horizon(
+    const std::size_t i) const {
+  if (i > 1) {
+    throw_pretty("Invalid argument: "
+                 << "i should be 0 or 1");
+  }
+  return *buffers_[i].horizon;
+}
+
+const SolverDeadlineQuadrupedDDP& MpcPipelineQuadruped::get_solver(
+    const std::size_t i) const {
+  if (i > 1) {
+    throw_pretty("Invalid argument: "
+                 << "i should be 0 or 1");
+  }
+  return *buffers_[i].solver;
+}
+
+}  // namespace quadruped_walkgen
@@ -1 +1,10 @@
 #include <quadruped-walkgen/quadruped.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedTpl<double>;
+template struct ActionDataQuadrupedTpl<double>;
+template class ActionModelQuadrupedTpl<float>;
+template struct ActionDataQuadrupedTpl<float>;
+
+}  // namespace quadruped_walkgen
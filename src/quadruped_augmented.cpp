@@ -1 +1,10 @@
 #include <quadruped-walkgen/quadruped_augmented.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedAugmentedTpl<double>;
+template struct ActionDataQuadrupedAugmentedTpl<double>;
+template class ActionModelQuadrupedAugmentedTpl<float>;
+template struct ActionDataQuadrupedAugmentedTpl<float>;
+
+}  // namespace quadruped_walkgen
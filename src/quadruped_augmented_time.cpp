@@ -1 +1,10 @@
 #include <quadruped-walkgen/quadruped_augmented_time.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedAugmentedTimeTpl<double>;
+template struct ActionDataQuadrupedAugmentedTimeTpl<double>;
+template class ActionModelQuadrupedAugmentedTimeTpl<float>;
+template struct ActionDataQuadrupedAugmentedTimeTpl<float>;
+
+}  // namespace quadruped_walkgen
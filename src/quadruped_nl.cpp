@@ -1 +1,10 @@
 #include <quadruped-walkgen/quadruped_nl.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedNonLinearTpl<double>;
+template struct ActionDataQuadrupedNonLinearTpl<double>;
+template class ActionModelQuadrupedNonLinearTpl<float>;
+template struct ActionDataQuadrupedNonLinearTpl<float>;
+
+}  // namespace quadruped_walkgen
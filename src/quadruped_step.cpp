@@ -1 +1,14 @@
 #include <quadruped-walkgen/quadruped_step.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedStepTpl<double>;
+template struct ActionDataQuadrupedStepTpl<double>;
+template class ActionModelQuadrupedStepTpl<double, 5>;
+template struct ActionDataQuadrupedStepTpl<double, 5>;
+template class ActionModelQuadrupedStepTpl<double, 10>;
+template struct ActionDataQuadrupedStepTpl<double, 10>;
+template class ActionModelQuadrupedStepTpl<float>;
+template struct ActionDataQuadrupedStepTpl<float>;
+
+}  // namespace quadruped_walkgen
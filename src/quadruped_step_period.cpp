@@ -0,0 +1,10 @@
+#include <quadruped-walkgen/quadruped_step_period.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedStepPeriodTpl<double>;
+template struct ActionDataQuadrupedStepPeriodTpl<double>;
+template class ActionModelQuadrupedStepPeriodTpl<float>;
+template struct ActionDataQuadrupedStepPeriodTpl<float>;
+
+}  // namespace quadruped_walkgen
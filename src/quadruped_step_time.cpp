@@ -1 +1,10 @@
 #include <quadruped-walkgen/quadruped_step_time.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedStepTimeTpl<double>;
+template struct ActionDataQuadrupedStepTimeTpl<double>;
+template class ActionModelQuadrupedStepTimeTpl<float>;
+template struct ActionDataQuadrupedStepTimeTpl<float>;
+
+}  // namespace quadruped_walkgen
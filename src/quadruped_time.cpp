@@ -1 +1,10 @@
 #include <quadruped-walkgen/quadruped_time.hpp>
+
+namespace quadruped_walkgen {
+
+template class ActionModelQuadrupedTimeTpl<double>;
+template struct ActionDataQuadrupedTimeTpl<double>;
+template class ActionModelQuadrupedTimeTpl<float>;
+template struct ActionDataQuadrupedTimeTpl<float>;
+
+}  // namespace quadruped_walkgen
@@ -0,0 +1,211 @@
+#include <quadruped-walkgen/receding_horizon.hpp>
+
+#include "crocoddyl/core/utils/exception.hpp"
+#include "quadruped-walkgen/multithreading.hpp"
+
+namespace quadruped_walkgen {
+
+RecedingHorizonQuadruped::RecedingHorizonQuadruped(
+    const Eigen::Ref<const Eigen::VectorXd>& x0, const std::size_t N)
+    : N_(N), head_(0) {
+  if (static_cast<std::size_t>(x0.size()) != 12) {
+    throw_pretty("Invalid argument: "
+                 << "x0 has wrong dimension (it should be 12)");
+  }
+  if (N_ == 0) {
+    throw_pretty("Invalid argument: "
+                 << "the horizon should have at least one node");
+  }
+
+  std::vector<boost::shared_ptr<crocoddyl::ActionModelAbstract> >
+      running_models;
+  nodes_.resize(N_);
+  for (std::size_t k = 0; k < N_; ++k) {
+    nodes_[k].model = boost::make_shared<ActionModelQuadruped>();
+    nodes_[k].valid = false;
+    running_models.push_back(nodes_[k].model);
+  }
+  terminal_.model = boost::make_shared<ActionModelQuadruped>();
+  terminal_.model->set_force_weights(Eigen::Matrix<double, 12, 1>::Zero());
+  terminal_.model->set_friction_weight(0);
+  terminal_.valid = false;
+
+  problem_ = boost::make_shared<crocoddyl::ShootingProblem>(
+      x0, running_models, terminal_.model);
+  set_default_nthreads(*problem_);
+  register_timings(*problem_);
+  xs_.resize(N_ + 1, x0);
+  us_.resize(N_, Eigen::VectorXd::Zero(12));
+}
+
+RecedingHorizonQuadruped::~RecedingHorizonQuadruped() {
+  // The nodes may be destroyed with the problem, their addresses reused
+  unregister_timings(*problem_);
+}
+
+RecedingHorizonQuadruped::Node& RecedingHorizonQuadruped::node(
+    const std::size_t k) {
+  return k == N_ ? terminal_ : nodes_[(head_ + k) % N_];
+}
+
+const RecedingHorizonQuadruped::Node& RecedingHorizonQuadruped::node(
+    const std::size_t k) const {
+  return k == N_ ? terminal_ : nodes_[(head_ + k) % N_];
+}
+
+void RecedingHorizonQuadruped::shift() {
+  // The data follows its model, so the caches of the data stay consistent
+  const Node& first = node(0);
+  problem_->circularAppend(first.model, problem_->get_runningDatas()[0]);
+  head_ = (head_ + 1) % N_;
+  // The timings are kept by position, every object moved by one node
+  register_timings(*problem_);
+
+  for (std::size_t k = 0; k < N_; ++k) {
+    xs_[k].swap(xs_[k + 1]);
+  }
+  xs_[N_] = xs_[N_ - 1];
+  for (std::size_t k = 0; k + 1 < N_; ++k) {
+    us_[k].swap(us_[k + 1]);
+  }
+  if (N_ > 1) {
+    us_[N_ - 1] = us_[N_ - 2];
+  }
+}
+
+std::size_t RecedingHorizonQuadruped::update(
+    const Eigen::Ref<const Eigen::MatrixXd>& gait,
+    const Eigen::Ref<const Eigen::MatrixXd>& fsteps,
+    const Eigen::Ref<const Eigen::MatrixXd>& xref) {
+  if (gait.cols() != 5 || fsteps.cols() != 13 ||
+      fsteps.rows() != gait.rows()) {
+    throw_pretty("Invalid argument: "
+                 << "gait and fsteps should be nx5 and nx13 matrices");
+  }
+  if (xref.rows() != 12 || static_cast<std::size_t>(xref.cols()) != N_ + 1) {
+    throw_pretty("Invalid argument: "
+                 << "xref has wrong dimension (it should be 12x" +
+                        std::to_string(N_ + 1) + ")");
+  }
+
+  // Iterate over all the phases of the gait matrix
+  // The first column of xref correspond to the current state = x0
+  std::size_t n_updated = 0;
+  Matrix34 l_feet;
+  Vector4 S;
+  int j = 0;
+  std::size_t k = 0;
+  for (; j < gait.rows() && gait(j, 0) > 0.; ++j) {
+    for (int i = 0; i < 4; i = i + 1) {
+      l_feet.col(i) = fsteps.block(j, 1 + 3 * i, 1, 3).transpose();
+    }
+    S = gait.block(j, 1, 1, 4).transpose();
+    const std::size_t k_end = std::min(N_, k + std::size_t(gait(j, 0)));
+    for (; k < k_end; ++k) {
+      n_updated += update_node(k, l_feet, xref.col(k + 1), S);
+    }
+  }
+  if (j == 0) {
+    throw_pretty("Invalid argument: "
+                 << "the gait matrix should have at least one phase");
+  }
+
+  // Terminal node, with the last phase
+  for (int i = 0; i < 4; i = i + 1) {
+    l_feet.col(i) = fsteps.block(j - 1, 1 + 3 * i, 1, 3).transpose();
+  }
+  S = gait.block(j - 1, 1, 1, 4).transpose();
+  n_updated += update_node(N_, l_feet, xref.col(N_), S);
+  return n_updated;
+}
+
+bool RecedingHorizonQuadruped::update_node(
+    const std::size_t k, const Eigen::Ref<const Eigen::MatrixXd>& l_feet,
+    const Eigen::Ref<const Eigen::MatrixXd>& xref,
+    const Eigen::Ref<const Eigen::MatrixXd>& S) {
+  if (k > N_) {
+    throw_pretty("Invalid argument: "
+                 << "k should be lower than " + std::to_string(N_ + 1));
+  }
+  if (l_feet.rows() != 3 || l_feet.cols() != 4 || xref.rows() != 12 ||
+      xref.cols() != 1 || S.rows() != 4 || S.cols() != 1) {
+    throw_pretty("Invalid argument: "
+                 << "l_feet, xref and S should be 3x4, 12x1 and 4x1");
+  }
+
+  // With a moving reference, xref changes on every node at each cycle, only
+  // the reference of the model is updated if the footholds and the contact
+  // status are the same
+  Node& n = node(k);
+  if (n.valid && n.l_feet == l_feet && n.gait == S) {
+    if (n.xref != xref) {
+      n.model->update_reference(xref);
+      n.xref = xref;
+    }
+    return false;
+  }
+  n.model->update_model(l_feet, xref, S);
+  n.l_feet = l_feet;
+  n.xref = xref;
+  n.gait = S;
+  n.valid = true;
+  return true;
+}
+
+void RecedingHorizonQuadruped::invalidate() {
+  for (std::size_t k = 0; k < N_; ++k) {
+    nodes_[k].valid = false;
+  }
+  terminal_.valid = false;
+}
+
+void RecedingHorizonQuadruped::set_warm_start(
+    const std::vector<Eigen::VectorXd>& xs,
+    const std::vector<Eigen::VectorXd>& us) {
+  if (xs.size() != N_ + 1 || us.size() != N_) {
+    throw_pretty("Invalid argument: "
+                 << "xs and us should have " + std::to_string(N_ + 1) +
+                        " and " + std::to_string(N_) + " elements");
+  }
+  for (std::size_t k = 0; k < N_; ++k) {
+    xs_[k] = xs[k];
+    us_[k] = us[k];
+  }
+  xs_[N_] = xs[N_];
+}
+
+void RecedingHorizonQuadruped::set_x0(
+    const Eigen::Ref<const Eigen::VectorXd>& x0) {
+  if (static_cast<std::size_t>(x0.size()) != 12) {
+    throw_pretty("Invalid argument: "
+                 << "x0 has wrong dimension (it should be 12)");
+  }
+  problem_->set_x0(x0);
+  xs_[0] = x0;
+}
+
+const boost::shared_ptr<crocoddyl::ShootingProblem>&
+RecedingHorizonQuadruped::get_problem() const {
+  return problem_;
+}
+
+const std::vector<Eigen::VectorXd>& RecedingHorizonQuadruped::get_xs() const {
+  return xs_;
+}
+
+const std::vector<Eigen::VectorXd>& RecedingHorizonQuadruped::get_us() const {
+  return us_;
+}
+
+std::size_t RecedingHorizonQuadruped::get_N() const { return N_; }
+
+const boost::shared_ptr<ActionModelQuadruped>&
+RecedingHorizonQuadruped::get_model(const std::size_t k) const {
+  if (k > N_) {
+    throw_pretty("Invalid argument: "
+                 << "k should be lower than " + std::to_string(N_ + 1));
+  }
+  return node(k).model;
+}
+
+}  // namespace quadruped_walkgen
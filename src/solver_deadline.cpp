@@ -0,0 +1,8 @@
+#include <quadruped-walkgen/solver_deadline.hpp>
+
+namespace quadruped_walkgen {
+
+template class SolverDeadline<crocoddyl::SolverDDP>;
+template class SolverDeadline<SolverQuadrupedDDP>;
+
+}  // namespace quadruped_walkgen
@@ -0,0 +1,277 @@
+#include <quadruped-walkgen/solver_quadruped_ddp.hpp>
+
+#include <limits>
+
+#include "crocoddyl/core/utils/exception.hpp"
+#include "quadruped-walkgen/multithreading.hpp"
+
+namespace quadruped_walkgen {
+
+SolverQuadrupedDDP::SolverQuadrupedDDP(
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem)
+    : crocoddyl::SolverDDP(problem) {
+  for (std::size_t t = 0; t < problem_->get_T(); ++t) {
+    get_quadruped_model(t);
+  }
+  if (problem_->get_terminalModel()->get_state()->get_ndx() != 12) {
+    throw_pretty("Invalid argument: "
+                 << "the terminal model should have a state of dimension 12");
+  }
+  FxTVxx_.setZero();
+  for (int i = 0; i < 4; i = i + 1) {
+    FuTVxx_[i].setZero();
+  }
+  ActiveSet empty;
+  empty.model = NULL;
+  empty.version = 0;
+  empty.friction.setZero();
+  empty.shoulder.setZero();
+  active_sets_.resize(problem_->get_T() + 1, empty);
+  has_active_sets_ = false;
+  set_default_nthreads(*problem_);
+  register_timings(*problem_);
+}
+
+SolverQuadrupedDDP::~SolverQuadrupedDDP() {
+  // The nodes may be destroyed with the problem, their addresses reused
+  unregister_timings(*problem_);
+}
+
+const ActionModelQuadruped& SolverQuadrupedDDP::get_quadruped_model(
+    const std::size_t t) const {
+  const ActionModelQuadruped* model = dynamic_cast<ActionModelQuadruped*>(
+      problem_->get_runningModels()[t].get());
+  if (model == NULL) {
+    throw_pretty("Invalid argument: "
+                 << "the running model " + std::to_string(t) +
+                        " is not an ActionModelQuadruped");
+  }
+  return *model;
+}
+
+void SolverQuadrupedDDP::backwardPass() {
+  const boost::shared_ptr<crocoddyl::ActionDataAbstract>& d_T =
+      problem_->get_terminalData();
+  const std::size_t T = problem_->get_T();
+  store_active_set(
+      dynamic_cast<const ActionModelQuadruped*>(
+          problem_->get_terminalModel().get()),
+      d_T.get(), active_sets_[T]);
+  has_active_sets_ = true;
+  Vxx_.back() = d_T->Lxx;
+  Vx_.back() = d_T->Lx;
+  if (!std::isnan(xreg_)) {
+    Vxx_.back().diagonal().array() += xreg_;
+  }
+  if (!is_feasible_) {
+    Vx_.back().noalias() += Vxx_.back() * fs_.back();
+  }
+
+  for (int t = static_cast<int>(problem_->get_T()) - 1; t >= 0; --t) {
+    const ActionModelQuadruped& m = get_quadruped_model(t);
+    const boost::shared_ptr<crocoddyl::ActionDataAbstract>& d =
+        problem_->get_runningDatas()[t];
+    QUADRUPED_WALKGEN_TIMING_PROBE(d.get(), BackwardPass);
+    store_active_set(&m, d.get(), active_sets_[t]);
+    const Eigen::Map<const Matrix12> Vxx_p(Vxx_[t + 1].data());
+    const Eigen::Map<const Vector12> Vx_p(Vx_[t + 1].data());
+    const Eigen::Map<const Matrix12> Fu(d->Fu.data());
+    const Eigen::Map<const Matrix12> Lxx(d->Lxx.data());
+    const Eigen::Map<const Matrix12> Luu(d->Luu.data());
+    const Eigen::Map<const Vector12> Lx(d->Lx.data());
+    const Eigen::Map<const Vector12> Lu(d->Lu.data());
+    Eigen::Map<Matrix12> Qxx(Qxx_[t].data());
+    Eigen::Map<Matrix12> Qxu(Qxu_[t].data());
+    Eigen::Map<Matrix12> Quu(Quu_[t].data());
+    Eigen::Map<Vector12> Qx(Qx_[t].data());
+    Eigen::Map<Vector12> Qu(Qu_[t].data());
+    Eigen::Map<Matrix12RowMajor> K(K_[t].data());
+    Eigen::Map<Vector12> k(k_[t].data());
+    Eigen::Map<Matrix12> Vxx(Vxx_[t].data());
+    Eigen::Map<Vector12> Vx(Vx_[t].data());
+
+    // Fx = [[I, dt*I], [0, I]]
+    const double dt = m.get_dt();
+    FxTVxx_.topRows<6>() = Vxx_p.topRows<6>();
+    FxTVxx_.bottomRows<6>() = dt * Vxx_p.topRows<6>() + Vxx_p.bottomRows<6>();
+    Qxx.leftCols<6>() = Lxx.leftCols<6>() + FxTVxx_.leftCols<6>();
+    Qxx.rightCols<6>() = Lxx.rightCols<6>() + dt * FxTVxx_.leftCols<6>() +
+                         FxTVxx_.rightCols<6>();
+    Qx.head<6>() = Lx.head<6>() + Vx_p.head<6>();
+    Qx.tail<6>() = Lx.tail<6>() + dt * Vx_p.head<6>() + Vx_p.tail<6>();
+
+    // The columns of Fu are zero for the feet in swing phase, and Lxu = 0
+    const Eigen::Matrix<double, 4, 1>& gait = m.get_gait();
+    Qxu.setZero();
+    Quu = Luu;
+    Qu = Lu;
+    for (int i = 0; i < 4; i = i + 1) {
+      if (gait(i) == 0.) {
+        continue;
+      }
+      FuTVxx_[i].noalias() = Fu.middleCols<3>(3 * i).transpose() * Vxx_p;
+      Qxu.middleCols<3>(3 * i).noalias() =
+          FxTVxx_ * Fu.middleCols<3>(3 * i);
+      Qu.segment<3>(3 * i).noalias() +=
+          Fu.middleCols<3>(3 * i).transpose() * Vx_p;
+      for (int j = 0; j <= i; j = j + 1) {
+        if (gait(j) == 0.) {
+          continue;
+        }
+        Quu.block<3, 3>(3 * i, 3 * j).noalias() +=
+            FuTVxx_[i] * Fu.middleCols<3>(3 * j);
+        if (j != i) {
+          Quu.block<3, 3>(3 * j, 3 * i) = Quu.block<3, 3>(3 * i, 3 * j)
+                                              .transpose();
+        }
+      }
+    }
+    if (!std::isnan(ureg_)) {
+      Quu.diagonal().array() += ureg_;
+    }
+
+    // Gains
+    Quu_llt_12_.compute(Quu);
+    if (Quu_llt_12_.info() != Eigen::Success) {
+      throw_pretty("backward_error");
+    }
+    K = Qxu.transpose();
+    Quu_llt_12_.solveInPlace(K);
+    k = Qu;
+    Quu_llt_12_.solveInPlace(k);
+    Eigen::Map<Vector12>(Quuk_[t].data()).noalias() = Quu * k;
+
+    // Value function
+    Vx = Qx;
+    Vx.noalias() -= K.transpose() * Qu;
+    Vxx = Qxx;
+    Vxx.noalias() -= Qxu * K;
+    Vxx = 0.5 * (Vxx + Vxx.transpose()).eval();
+    if (!std::isnan(xreg_)) {
+      Vxx.diagonal().array() += xreg_;
+    }
+    if (!is_feasible_) {
+      Vx.noalias() += Vxx * Eigen::Map<const Vector12>(fs_[t].data());
+    }
+    if (std::isnan(Vx.lpNorm<Eigen::Infinity>())) {
+      throw_pretty("backward_error");
+    }
+  }
+}
+
+bool SolverQuadrupedDDP::solve_x0(const Eigen::Ref<const Eigen::VectorXd>& x0,
+                                  const std::size_t maxiter) {
+  if (static_cast<std::size_t>(x0.size()) != 12) {
+    throw_pretty("Invalid argument: "
+                 << "x0 has wrong dimension (it should be 12)");
+  }
+  problem_->set_x0(x0);
+  const std::size_t T = problem_->get_T();
+
+  // The gains are the ones of the current solution if its last step was a
+  // full step from the linearisation point of the backward pass
+  bool reuse = has_active_sets_ && is_feasible_ && steplength_ == 1.;
+  for (std::size_t t = 0; reuse && t < T; ++t) {
+    reuse = &get_quadruped_model(t) == active_sets_[t].model &&
+            active_sets_[t].version == active_sets_[t].model->get_version();
+  }
+  const ActionModelQuadruped* m_T = dynamic_cast<const ActionModelQuadruped*>(
+      problem_->get_terminalModel().get());
+  if (reuse) {
+    reuse = m_T == active_sets_[T].model &&
+            (m_T == NULL || m_T->get_version() == active_sets_[T].version);
+  }
+
+  // Rollout with the gains, stopped if an active set flips
+  if (reuse) {
+    xs_try_[0] = x0;
+    cost_try_ = 0.;
+    for (std::size_t t = 0; reuse && t < T; ++t) {
+      const boost::shared_ptr<crocoddyl::ActionDataAbstract>& d =
+          problem_->get_runningDatas()[t];
+      Eigen::Map<Vector12> u(us_try_[t].data());
+      u = Eigen::Map<const Vector12>(us_[t].data());
+      u.noalias() -= Eigen::Map<const Matrix12RowMajor>(K_[t].data()) *
+                     (Eigen::Map<const Vector12>(xs_try_[t].data()) -
+                      Eigen::Map<const Vector12>(xs_[t].data()));
+      problem_->get_runningModels()[t]->calc(d, xs_try_[t], us_try_[t]);
+      xs_try_[t + 1] = d->xnext;
+      cost_try_ += d->cost;
+      reuse = same_active_set(&get_quadruped_model(t), d.get(),
+                              active_sets_[t]);
+    }
+    if (reuse) {
+      const boost::shared_ptr<crocoddyl::ActionDataAbstract>& d_T =
+          problem_->get_terminalData();
+      problem_->get_terminalModel()->calc(d_T, xs_try_[T]);
+      cost_try_ += d_T->cost;
+      reuse = same_active_set(m_T, d_T.get(), active_sets_[T]);
+    }
+  }
+  if (reuse) {
+    setCandidate(xs_try_, us_try_, true);
+    cost_ = cost_try_;
+    iter_ = 0;
+    // No backward pass at the new trajectory, so the stopping criteria and
+    // the expected improvement are not known
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    stop_ = nan;
+    d_.fill(nan);
+    dV_ = nan;
+    dVexp_ = nan;
+    return true;
+  }
+
+  // Full solve, warm started from the last solution
+  for (std::size_t t = 0; t < T; ++t) {
+    xs_try_[t] = xs_[t];
+    us_try_[t] = us_[t];
+  }
+  xs_try_[T] = xs_[T];
+  xs_try_[0] = x0;
+  solve(xs_try_, us_try_, maxiter);
+  return false;
+}
+
+void SolverQuadrupedDDP::store_active_set(
+    const ActionModelQuadruped* m, const crocoddyl::ActionDataAbstract* d,
+    ActiveSet& active_set) const {
+  active_set.model = m;
+  if (m == NULL) {
+    return;
+  }
+  const ActionDataQuadruped* data = static_cast<const ActionDataQuadruped*>(d);
+  active_set.version = data->version;
+  active_set.friction = data->friction.active;
+  active_set.shoulder = data->sh_active;
+}
+
+bool SolverQuadrupedDDP::same_active_set(
+    const ActionModelQuadruped* m, const crocoddyl::ActionDataAbstract* d,
+    const ActiveSet& active_set) const {
+  if (m != active_set.model) {
+    return false;
+  }
+  if (m == NULL) {
+    return true;
+  }
+  // calc updates the active faces of the friction pyramids and the shoulder
+  // distances, sh_active is only updated by calcDiff. The feet in swing phase
+  // do not change the gains, their forces stay at the ones of us and can
+  // cross a face around 0.
+  const ActionDataQuadruped* data = static_cast<const ActionDataQuadruped*>(d);
+  const Eigen::Matrix<double, 4, 1>& gait = m->get_gait();
+  for (int j = 0; j < 4; ++j) {
+    if (gait(j) == 0.) {
+      continue;
+    }
+    if (data->friction.active.row(j) != active_set.friction.row(j) ||
+        ConditionalTpl<double>::positive(data->sh_ub_max_[j]) !=
+            active_set.shoulder[j]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace quadruped_walkgen
@@ -0,0 +1,378 @@
+#include <quadruped-walkgen/solver_quadruped_qp.hpp>
+
+#include <limits>
+
+#include "crocoddyl/core/utils/exception.hpp"
+
+namespace quadruped_walkgen {
+
+SolverQuadrupedQP::SolverQuadrupedQP(
+    boost::shared_ptr<crocoddyl::ShootingProblem> problem)
+    : problem_(problem),
+      T_(problem->get_T()),
+      n_(12 * problem->get_T()),
+      m_(20 * problem->get_T()),
+      rho_(0.1),
+      sigma_(1e-6),
+      alpha_(1.6),
+      eps_abs_(1e-5),
+      eps_rel_(1e-5),
+      iter_(0),
+      r_prim_(0.),
+      r_dual_(0.) {
+  if (T_ == 0) {
+    throw_pretty("Invalid argument: "
+                 << "the problem should have at least one running node");
+  }
+  for (std::size_t t = 0; t < T_; ++t) {
+    get_quadruped_model(t);
+  }
+  if (dynamic_cast<ActionModelQuadruped*>(
+          problem_->get_terminalModel().get()) == NULL) {
+    throw_pretty("Invalid argument: "
+                 << "the terminal model is not an ActionModelQuadruped");
+  }
+
+  A_.resize(T_, Matrix12::Identity());
+  B_.resize(T_, Matrix12::Zero());
+  g_.resize(T_, Vector12::Zero());
+  G_.resize(T_ + 1, Matrix12::Zero());
+  xfree_.resize(T_ + 1, Vector12::Zero());
+  lambda_.resize(T_ + 1, Vector12::Zero());
+  mu_.resize(T_, 1.);
+  models_.assign(T_ + 1, NULL);
+  versions_.assign(T_ + 1, 0);
+
+  H_ = Eigen::MatrixXd::Zero(n_, n_);
+  q_ = Eigen::VectorXd::Zero(n_);
+  lb_ = Eigen::VectorXd::Zero(m_);
+  ub_ = Eigen::VectorXd::Zero(m_);
+  rho_vec_ = Eigen::VectorXd::Constant(m_, rho_);
+  K_ = Eigen::MatrixXd::Zero(n_, n_);
+  K_llt_ = Eigen::LLT<Eigen::MatrixXd>(n_);
+  factorised_ = false;
+  U_ = Eigen::VectorXd::Zero(n_);
+  U_tilde_ = Eigen::VectorXd::Zero(n_);
+  W_ = Eigen::VectorXd::Zero(m_);
+  W_tilde_ = Eigen::VectorXd::Zero(m_);
+  Y_ = Eigen::VectorXd::Zero(m_);
+  rhs_ = Eigen::VectorXd::Zero(n_);
+  CU_ = Eigen::VectorXd::Zero(m_);
+  CtY_ = Eigen::VectorXd::Zero(n_);
+
+  xs_.resize(T_ + 1, problem_->get_x0());
+  us_.resize(T_, Eigen::VectorXd::Zero(12));
+}
+
+SolverQuadrupedQP::~SolverQuadrupedQP() {}
+
+const ActionModelQuadruped& SolverQuadrupedQP::get_quadruped_model(
+    const std::size_t t) const {
+  const ActionModelQuadruped* model = dynamic_cast<ActionModelQuadruped*>(
+      problem_->get_runningModels()[t].get());
+  if (model == NULL) {
+    throw_pretty("Invalid argument: "
+                 << "the running model " + std::to_string(t) +
+                        " is not an ActionModelQuadruped");
+  }
+  return *model;
+}
+
+SolverQuadrupedQP::Matrix53 SolverQuadrupedQP::friction_cone(
+    const double mu) const {
+  Matrix53 C;
+  C << 1., 0., -mu, 1., 0., mu, 0., 1., -mu, 0., 1., mu, 0., 0., 1.;
+  return C;
+}
+
+bool SolverQuadrupedQP::solve(const std::size_t maxiter) {
+  condense();
+  const bool converged = solveQP(maxiter);
+
+  // Trajectory with the same layout as the DDP solvers
+  xs_[0] = problem_->get_x0();
+  for (std::size_t t = 0; t < T_; ++t) {
+    us_[t] = U_.segment<12>(12 * t);
+    xs_[t + 1] = A_[t] * xs_[t] + B_[t] * us_[t] + g_[t];
+  }
+  return converged;
+}
+
+bool SolverQuadrupedQP::update_versions() {
+  if (problem_->get_T() != T_) {
+    throw_pretty("Invalid argument: "
+                 << "the problem should keep " + std::to_string(T_) +
+                        " running nodes");
+  }
+  bool changed = false;
+  for (std::size_t t = 0; t <= T_; ++t) {
+    const ActionModelQuadruped* m =
+        t < T_ ? &get_quadruped_model(t)
+               : dynamic_cast<const ActionModelQuadruped*>(
+                     problem_->get_terminalModel().get());
+    if (m == NULL) {
+      throw_pretty("Invalid argument: "
+                   << "the terminal model is not an ActionModelQuadruped");
+    }
+    if (m != models_[t] || m->get_version() != versions_[t]) {
+      models_[t] = m;
+      versions_[t] = m->get_version();
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void SolverQuadrupedQP::condense() {
+  const ActionModelQuadruped& terminal =
+      static_cast<const ActionModelQuadruped&>(*problem_->get_terminalModel());
+  if (update_versions()) {
+    condenseHessian();
+  }
+
+  // States with zero forces
+  xfree_[0] = problem_->get_x0();
+  for (std::size_t t = 0; t < T_; ++t) {
+    xfree_[t + 1] = A_[t] * xfree_[t] + g_[t];
+  }
+
+  // Gradient, with the adjoint of the state cost along the free trajectory
+  Vector12 Q = terminal.get_state_weights().cwiseAbs2();
+  lambda_[T_] = Q.cwiseProduct(xfree_[T_] - terminal.get_xref());
+  for (std::size_t t = T_ - 1; t > 0; --t) {
+    const ActionModelQuadruped& m = get_quadruped_model(t);
+    Q = m.get_state_weights().cwiseAbs2();
+    lambda_[t] = Q.cwiseProduct(xfree_[t] - m.get_xref());
+    lambda_[t].noalias() += A_[t].transpose() * lambda_[t + 1];
+  }
+  for (std::size_t t = 0; t < T_; ++t) {
+    const ActionModelQuadruped& m = get_quadruped_model(t);
+    q_.segment<12>(12 * t).noalias() = B_[t].transpose() * lambda_[t + 1];
+    q_.segment<12>(12 * t) -=
+        m.get_force_weights().cwiseAbs2().cwiseProduct(m.get_uref());
+  }
+}
+
+void SolverQuadrupedQP::condenseHessian() {
+  const double inf = std::numeric_limits<double>::infinity();
+  const ActionModelQuadruped& terminal =
+      static_cast<const ActionModelQuadruped&>(*problem_->get_terminalModel());
+
+  // Dynamics and bounds of each node
+  for (std::size_t t = 0; t < T_; ++t) {
+    const ActionModelQuadruped& m = get_quadruped_model(t);
+    A_[t] = m.get_A();
+    B_[t] = m.get_B();
+    g_[t] = m.get_g();
+    if (m.get_implicit_integration()) {
+      // P+ = P + dt * V+
+      B_[t].topRows<6>() = m.get_dt() * B_[t].bottomRows<6>();
+      g_[t].head<6>() += m.get_dt() * g_[t].tail<6>();
+    }
+
+    mu_[t] = m.get_mu();
+    for (int i = 0; i < 4; i = i + 1) {
+      const std::size_t row = 20 * t + 5 * i;
+      if (m.get_gait()(i) != 0.) {
+        lb_.segment<5>(row) << -inf, 0., -inf, 0., m.get_min_fz_contact();
+        ub_.segment<5>(row) << 0., inf, 0., inf, m.get_max_fz_contact();
+      } else {
+        lb_.segment<5>(row).setZero();
+        ub_.segment<5>(row).setZero();
+      }
+    }
+  }
+
+  // Hessian, column of blocks by column of blocks
+  Matrix12 Z;
+  for (std::size_t j = 0; j < T_; ++j) {
+    G_[j + 1] = B_[j];
+    for (std::size_t k = j + 1; k < T_; ++k) {
+      G_[k + 1].noalias() = A_[k] * G_[k];
+    }
+    Z.noalias() = terminal.get_state_weights().cwiseAbs2().asDiagonal() *
+                  G_[T_];
+    for (std::size_t i = T_ - 1; i >= j + 1; --i) {
+      H_.block<12, 12>(12 * i, 12 * j).noalias() = B_[i].transpose() * Z;
+      const ActionModelQuadruped& m = get_quadruped_model(i);
+      Z = A_[i].transpose() * Z;
+      Z.noalias() += m.get_state_weights().cwiseAbs2().asDiagonal() * G_[i];
+    }
+    H_.block<12, 12>(12 * j, 12 * j).noalias() = B_[j].transpose() * Z;
+    H_.block<12, 12>(12 * j, 12 * j).diagonal() +=
+        get_quadruped_model(j).get_force_weights().cwiseAbs2();
+    for (std::size_t i = j + 1; i < T_; ++i) {
+      H_.block<12, 12>(12 * j, 12 * i) =
+          H_.block<12, 12>(12 * i, 12 * j).transpose();
+    }
+  }
+  factorised_ = false;
+}
+
+void SolverQuadrupedQP::multiplyC(const Eigen::VectorXd& U,
+                                  Eigen::VectorXd& CU) const {
+  for (std::size_t t = 0; t < T_; ++t) {
+    const Matrix53 C = friction_cone(mu_[t]);
+    for (int i = 0; i < 4; i = i + 1) {
+      CU.segment<5>(20 * t + 5 * i).noalias() =
+          C * U.segment<3>(12 * t + 3 * i);
+    }
+  }
+}
+
+void SolverQuadrupedQP::multiplyCt(const Eigen::VectorXd& Y,
+                                   Eigen::VectorXd& CtY) const {
+  for (std::size_t t = 0; t < T_; ++t) {
+    const Matrix53 C = friction_cone(mu_[t]);
+    for (int i = 0; i < 4; i = i + 1) {
+      CtY.segment<3>(12 * t + 3 * i).noalias() =
+          C.transpose() * Y.segment<5>(20 * t + 5 * i);
+    }
+  }
+}
+
+bool SolverQuadrupedQP::solveQP(const std::size_t maxiter) {
+  if (!factorised_) {
+    factorise();
+  }
+
+  // ADMM iterations, starting from the previous solution
+  bool converged = false;
+  for (iter_ = 0; iter_ < maxiter && !converged; ++iter_) {
+    // W_tilde_ holds rho * W - Y until it is overwritten by C * U_tilde
+    W_tilde_ = rho_vec_.cwiseProduct(W_) - Y_;
+    multiplyCt(W_tilde_, CtY_);
+    rhs_ = sigma_ * U_ - q_ + CtY_;
+    U_tilde_ = K_llt_.solve(rhs_);
+    multiplyC(U_tilde_, W_tilde_);
+
+    U_ = alpha_ * U_tilde_ + (1. - alpha_) * U_;
+    W_tilde_ = alpha_ * W_tilde_ + (1. - alpha_) * W_;
+    W_ = (W_tilde_ + Y_.cwiseQuotient(rho_vec_)).cwiseMax(lb_).cwiseMin(ub_);
+    Y_ += rho_vec_.cwiseProduct(W_tilde_ - W_);
+
+    // Residuals, checked every 5 iterations
+    if (iter_ % 5 == 4 || iter_ + 1 == maxiter) {
+      multiplyC(U_, CU_);
+      multiplyCt(Y_, CtY_);
+      rhs_.noalias() = H_ * U_;
+      r_prim_ = (CU_ - W_).lpNorm<Eigen::Infinity>();
+      r_dual_ = (rhs_ + q_ + CtY_).lpNorm<Eigen::Infinity>();
+      const double eps_prim =
+          eps_abs_ + eps_rel_ * std::max(CU_.lpNorm<Eigen::Infinity>(),
+                                         W_.lpNorm<Eigen::Infinity>());
+      const double eps_dual =
+          eps_abs_ +
+          eps_rel_ * std::max(std::max(rhs_.lpNorm<Eigen::Infinity>(),
+                                       CtY_.lpNorm<Eigen::Infinity>()),
+                              q_.lpNorm<Eigen::Infinity>());
+      converged = r_prim_ <= eps_prim && r_dual_ <= eps_dual;
+    }
+  }
+  return converged;
+}
+
+void SolverQuadrupedQP::factorise() {
+  // Larger penalty on the equality constraints (feet in swing phase)
+  for (std::size_t j = 0; j < m_; ++j) {
+    rho_vec_(j) = lb_(j) == ub_(j) ? 1e3 * rho_ : rho_;
+  }
+
+  // K = H + sigma I + C^T diag(rho) C
+  K_ = H_;
+  K_.diagonal().array() += sigma_;
+  for (std::size_t t = 0; t < T_; ++t) {
+    const Matrix53 C = friction_cone(mu_[t]);
+    for (int i = 0; i < 4; i = i + 1) {
+      K_.block<3, 3>(12 * t + 3 * i, 12 * t + 3 * i).noalias() +=
+          C.transpose() * rho_vec_.segment<5>(20 * t + 5 * i).asDiagonal() *
+          C;
+    }
+  }
+  K_llt_.compute(K_);
+  if (K_llt_.info() != Eigen::Success) {
+    throw_pretty("Invalid argument: "
+                 << "the condensed Hessian is not positive definite");
+  }
+  factorised_ = true;
+}
+
+void SolverQuadrupedQP::shift() {
+  if (T_ > 1) {
+    const Eigen::Index n = static_cast<Eigen::Index>(12 * (T_ - 1));
+    const Eigen::Index m = static_cast<Eigen::Index>(20 * (T_ - 1));
+    U_.head(n) = U_.tail(n).eval();
+    W_.head(m) = W_.tail(m).eval();
+    Y_.head(m) = Y_.tail(m).eval();
+  }
+}
+
+void SolverQuadrupedQP::reset() {
+  U_.setZero();
+  W_.setZero();
+  Y_.setZero();
+}
+
+const std::vector<Eigen::VectorXd>& SolverQuadrupedQP::get_xs() const {
+  return xs_;
+}
+
+const std::vector<Eigen::VectorXd>& SolverQuadrupedQP::get_us() const {
+  return us_;
+}
+
+const boost::shared_ptr<crocoddyl::ShootingProblem>&
+SolverQuadrupedQP::get_problem() const {
+  return problem_;
+}
+
+const Eigen::MatrixXd& SolverQuadrupedQP::get_H() const { return H_; }
+
+const Eigen::VectorXd& SolverQuadrupedQP::get_q() const { return q_; }
+
+std::size_t SolverQuadrupedQP::get_iter() const { return iter_; }
+
+double SolverQuadrupedQP::get_primal_residual() const { return r_prim_; }
+
+double SolverQuadrupedQP::get_dual_residual() const { return r_dual_; }
+
+const double& SolverQuadrupedQP::get_rho() const { return rho_; }
+void SolverQuadrupedQP::set_rho(const double& rho) {
+  if (rho <= 0.) {
+    throw_pretty("Invalid argument: "
+                 << "rho should be positive");
+  }
+  if (rho != rho_) {
+    rho_ = rho;
+    factorised_ = false;
+  }
+}
+
+const double& SolverQuadrupedQP::get_sigma() const { return sigma_; }
+void SolverQuadrupedQP::set_sigma(const double& sigma) {
+  if (sigma <= 0.) {
+    throw_pretty("Invalid argument: "
+                 << "sigma should be positive");
+  }
+  if (sigma != sigma_) {
+    sigma_ = sigma;
+    factorised_ = false;
+  }
+}
+
+const double& SolverQuadrupedQP::get_alpha() const { return alpha_; }
+void SolverQuadrupedQP::set_alpha(const double& alpha) {
+  if (alpha <= 0. || alpha >= 2.) {
+    throw_pretty("Invalid argument: "
+                 << "alpha should be in ]0, 2[");
+  }
+  alpha_ = alpha;
+}
+
+const double& SolverQuadrupedQP::get_eps_abs() const { return eps_abs_; }
+void SolverQuadrupedQP::set_eps_abs(const double& eps) { eps_abs_ = eps; }
+
+const double& SolverQuadrupedQP::get_eps_rel() const { return eps_rel_; }
+void SolverQuadrupedQP::set_eps_rel(const double& eps) { eps_rel_ = eps; }
+
+}  // namespace quadruped_walkgen
@@ -0,0 +1,225 @@
+#include <quadruped-walkgen/timing_probes.hpp>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+
+namespace quadruped_walkgen {
+
+// LatencyHistogram with atomic counters, written by the probes of any thread
+// and read while they record
+class AtomicLatencyHistogram {
+ public:
+  AtomicLatencyHistogram() { reset(); }
+
+  void record(const std::uint64_t ns) {
+    counts_[LatencyHistogram::bucket(ns)].fetch_add(1,
+                                                    std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t max = max_.load(std::memory_order_relaxed);
+    while (ns > max &&
+           !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  // The counters are read one by one, a snapshot taken while recording can
+  // miss the last records of some of them
+  LatencyHistogram snapshot() const {
+    LatencyHistogram histogram;
+    for (int b = 0; b < LatencyHistogram::Size; ++b) {
+      histogram.counts_[b] = counts_[b].load(std::memory_order_relaxed);
+    }
+    histogram.count_ = count_.load(std::memory_order_relaxed);
+    histogram.sum_ = sum_.load(std::memory_order_relaxed);
+    histogram.max_ = max_.load(std::memory_order_relaxed);
+    return histogram;
+  }
+
+  void reset() {
+    for (int b = 0; b < LatencyHistogram::Size; ++b) {
+      counts_[b].store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::uint64_t> counts_[LatencyHistogram::Size];
+  std::atomic<std::uint64_t> count_;
+  std::atomic<std::uint64_t> sum_;
+  std::atomic<std::uint64_t> max_;
+};
+
+namespace {
+
+// Histograms of the phases of a node position for a model type
+struct TimingSlot {
+  AtomicLatencyHistogram histograms[TimingPhase::Size];
+};
+
+typedef std::pair<std::type_index, std::size_t> SlotKey;
+
+// Object (model or data) to the slot of its position, open addressing with
+// linear probing. The entries are written under registry_mutex (slot, then
+// object with release) and read by the probes without lock. An unregistered
+// object leaves a Removed marker, so that the chains stay connected, which is
+// reused by the next insertions. The table is emptied when its last object
+// is unregistered.
+enum { TableBits = 14, TableSize = 1 << TableBits };
+
+struct ObjectEntry {
+  std::atomic<const void*> object;
+  std::atomic<TimingSlot*> slot;
+};
+
+ObjectEntry objects[TableSize];  // zero-initialised, static storage
+std::size_t n_objects = 0;       // Registered objects, under registry_mutex
+std::atomic<std::uint64_t> dropped(0);
+
+const void* removed() { return reinterpret_cast<const void*>(1); }
+
+// Slots by type and position, written under registry_mutex. The map owns the
+// slots, which are never deleted so the entries of the table stay valid.
+std::mutex registry_mutex;
+std::map<SlotKey, std::unique_ptr<TimingSlot> > slots;
+
+std::size_t object_hash(const void* object) {
+  // Fibonacci hashing of the address
+  return static_cast<std::size_t>(
+      (reinterpret_cast<std::uintptr_t>(object) * 0x9E3779B97F4A7C15ull) >>
+      (64 - TableBits));
+}
+
+TimingSlot* find_slot(const void* object) {
+  std::size_t i = object_hash(object);
+  for (std::size_t n = 0; n < TableSize; ++n, i = (i + 1) & (TableSize - 1)) {
+    const void* o = objects[i].object.load(std::memory_order_acquire);
+    if (o == object) {
+      return objects[i].slot.load(std::memory_order_relaxed);
+    }
+    if (o == NULL) {
+      return NULL;
+    }
+  }
+  return NULL;
+}
+
+// The functions below have to be called with registry_mutex locked
+
+void set_slot(const void* object, TimingSlot* slot) {
+  std::size_t i = object_hash(object);
+  std::size_t entry = TableSize;  // First free entry of the chain
+  for (std::size_t n = 0; n < TableSize; ++n, i = (i + 1) & (TableSize - 1)) {
+    const void* o = objects[i].object.load(std::memory_order_relaxed);
+    if (o == object) {
+      objects[i].slot.store(slot, std::memory_order_relaxed);
+      return;
+    }
+    if (o == removed() || o == NULL) {
+      if (entry == TableSize) {
+        entry = i;
+      }
+      if (o == NULL) {
+        break;
+      }
+    }
+  }
+  if (entry == TableSize) {
+    static bool warned = false;
+    if (!warned) {
+      std::cerr << "Warning: the table of the timing probes is full, the "
+                   "records of the new objects are dropped, unregister the "
+                   "problems that are not used anymore"
+                << std::endl;
+      warned = true;
+    }
+    return;
+  }
+  objects[entry].slot.store(slot, std::memory_order_relaxed);
+  objects[entry].object.store(object, std::memory_order_release);
+  ++n_objects;
+}
+
+void remove_slot(const void* object) {
+  std::size_t i = object_hash(object);
+  for (std::size_t n = 0; n < TableSize; ++n, i = (i + 1) & (TableSize - 1)) {
+    const void* o = objects[i].object.load(std::memory_order_relaxed);
+    if (o == NULL) {
+      return;
+    }
+    if (o == object) {
+      objects[i].object.store(removed(), std::memory_order_release);
+      objects[i].slot.store(NULL, std::memory_order_relaxed);
+      --n_objects;
+      break;
+    }
+  }
+  if (n_objects == 0) {
+    for (std::size_t j = 0; j < TableSize; ++j) {
+      objects[j].object.store(NULL, std::memory_order_release);
+    }
+  }
+}
+
+}  // namespace
+
+void register_timing_node(const void* model, const void* data,
+                          const std::type_info& type, const std::size_t node) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  std::unique_ptr<TimingSlot>& slot =
+      slots[SlotKey(std::type_index(type), node)];
+  if (!slot) {
+    slot.reset(new TimingSlot());
+  }
+  set_slot(model, slot.get());
+  set_slot(data, slot.get());
+}
+
+void unregister_timing_node(const void* model, const void* data) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  remove_slot(model);
+  remove_slot(data);
+}
+
+void record_timing(const void* object, const TimingPhase::Index phase,
+                   const std::uint64_t ns) {
+  TimingSlot* slot = find_slot(object);
+  if (slot == NULL) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  slot->histograms[phase].record(ns);
+}
+
+LatencyHistogram get_timing(const std::type_info& type, const std::size_t node,
+                            const TimingPhase::Index phase) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  std::map<SlotKey, std::unique_ptr<TimingSlot> >::const_iterator it =
+      slots.find(SlotKey(std::type_index(type), node));
+  if (it == slots.end()) {
+    return LatencyHistogram();
+  }
+  return it->second->histograms[phase].snapshot();
+}
+
+std::uint64_t get_dropped_timings() {
+  return dropped.load(std::memory_order_relaxed);
+}
+
+void reset_timings() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (std::map<SlotKey, std::unique_ptr<TimingSlot> >::iterator it =
+           slots.begin();
+       it != slots.end(); ++it) {
+    for (int i = 0; i < TimingPhase::Size; ++i) {
+      it->second->histograms[i].reset();
+    }
+  }
+  dropped.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace quadruped_walkgen